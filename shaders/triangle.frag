@@ -1,9 +1,13 @@
 #version 450
 
 layout(location = 0) in vec3 vColor;
+layout(location = 2) in vec2 vUv;
 layout(location = 0) out vec4 outColor;
 
+// Untextured draws are bound to a 1x1 white texture.
+layout(set = 0, binding = 0) uniform sampler2D albedo;
+
 void main()
 {
-    outColor = vec4(vColor, 1.0);
+    outColor = vec4(vColor, 1.0) * texture(albedo, vUv);
 }
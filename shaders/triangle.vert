@@ -4,6 +4,7 @@ layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec3 inColor;
 
 layout(location = 0) out vec3 vColor;
+layout(location = 2) out vec2 vUv;
 
 layout(push_constant) uniform PushConstants {
     mat4 mvp;
@@ -13,4 +14,5 @@ void main()
 {
     gl_Position = pc.mvp * vec4(inPosition, 1.0);
     vColor = inColor;
+    vUv = vec2(0.0);
 }
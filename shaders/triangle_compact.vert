@@ -0,0 +1,32 @@
+#version 450
+
+// Position arrives normalized to the mesh bounds; the bounds scale/offset is folded into mvp.
+layout(location = 0) in vec4 inPosition;
+layout(location = 1) in vec4 inColor;
+layout(location = 2) in vec2 inNormalOct;
+layout(location = 3) in vec2 inUv;
+
+layout(location = 0) out vec3 vColor;
+layout(location = 1) out vec3 vNormal;
+layout(location = 2) out vec2 vUv;
+
+layout(push_constant) uniform PushConstants {
+    mat4 mvp;
+} pc;
+
+vec3 decodeOctahedral(vec2 e)
+{
+    vec3 n = vec3(e.x, e.y, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.x += n.x >= 0.0 ? -t : t;
+    n.y += n.y >= 0.0 ? -t : t;
+    return normalize(n);
+}
+
+void main()
+{
+    gl_Position = pc.mvp * vec4(inPosition.xyz, 1.0);
+    vColor = inColor.rgb;
+    vNormal = decodeOctahedral(inNormalOct);
+    vUv = inUv;
+}
@@ -1,15 +1,98 @@
 #include "Simulation.h"
 
+#include "assets/AssetArchive.h"
 #include "assets/GlbLoader.h"
+#include "assets/PngDecoder.h"
+#include "assets/TextureCooker.h"
+#include "ecs/components/MeshRefComp.h"
+#include "ecs/components/RenderComp.h"
+#include "scenes/GlbGridScene.h"
+#include "scenes/SphereScene.h"
 
 #include <imgui.h>
 
-Simulation::Simulation()
+#include <array>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <utility>
+
+namespace {
+constexpr const char* kModelDirectory = "assets/models";
+constexpr const char* kCookedDirectory = "cooked";
+// Built by the asset_archive target; loose files are used when it is absent.
+constexpr const char* kAssetArchivePath = "assets.pak";
+constexpr const char* kPlanePath = "assets/models/Plane.glb";
+constexpr const char* kTexturedSpherePath = "assets/models/WarrenSphere.glb";
+constexpr std::array<const char*, 4> kGridScenePaths{
+    "assets/models/Torus.glb",
+    "assets/models/Cone.glb",
+    "assets/models/Capsule.glb",
+    "assets/models/Cuboid.glb"
+};
+
+const char* textureFormatName(TextureFormat format)
 {
-    const LoadedMesh planeMesh = appendGlbMeshVertices("assets/models/Plane.glb", vertexPackets_);
+    switch (format) {
+    case TextureFormat::Bc1RgbSrgb: return "BC1";
+    case TextureFormat::Bc3Srgb: return "BC3";
+    default: return "RGBA8";
+    }
+}
 
-    scenes_.emplace_back(std::make_unique<TestScene>(planeMesh.firstVertex, planeMesh.vertexCount));
+void cookImage(const std::string& label, const GlbImage& image, uint32_t textureId, std::vector<TextureAsset>& assets)
+{
+    TextureCookStats stats{};
+    assets.push_back(cookTexture(textureId, decodePng(image.bytes), TextureCookOptions{}, &stats));
+    std::cout << "[Assets] " << label << ": base color " << textureFormatName(assets.back().format) << ", "
+              << stats.mipLevels << " mips, " << stats.cookedBytes / 1024 << " KiB vs "
+              << stats.rgba8Bytes / 1024 << " KiB RGBA8, PSNR " << stats.psnr << " dB\n";
+}
+}
+
+Simulation::Simulation(VertexFormat vertexFormat)
+    : vertexFormat_(vertexFormat)
+    , assets_(vertexFormat, kCookedDirectory)
+{
+    if (std::error_code ec{}; std::filesystem::exists(kAssetArchivePath, ec)) {
+        try {
+            mountAssetArchive(std::make_unique<AssetArchive>(kAssetArchivePath));
+            std::cout << "[Assets] mounted " << kAssetArchivePath << " (" << mountedAssetArchive()->entryCount() << " entries)\n";
+        }
+        catch (const std::exception& e) {
+            std::cerr << "[Assets] " << e.what() << ", reading loose files\n";
+        }
+    }
+
+    std::vector<GlbPrototype> gridPrototypes{};
+    for (const char* path : kGridScenePaths) {
+        gridPrototypes.push_back(GlbPrototype{ .path = path, .materialTextureIds = assets_.acquireMaterialTextures(path) });
+    }
+
+    scenes_.emplace_back(std::make_unique<TestScene>(assets_, kPlanePath));
+    scenes_.emplace_back(std::make_unique<SphereScene>(assets_, kTexturedSpherePath, assets_.acquireMaterialTextures(kTexturedSpherePath)));
+    scenes_.emplace_back(std::make_unique<GlbGridScene>(assets_, std::move(gridPrototypes)));
     switchToScene(0);
+
+    if (!assetWatcher_.watch(kModelDirectory)) {
+        std::cerr << "[Assets] cannot watch " << kModelDirectory << ", mesh hot reload disabled\n";
+    }
+}
+
+std::vector<TextureAsset> Simulation::loadTextureAssets()
+{
+    std::vector<TextureAsset> assets{};
+    for (const AssetRegistry::TextureSource& source : assets_.takePendingTextures()) {
+        try {
+            cookImage(source.label, source.image, source.textureId, assets);
+        }
+        catch (const std::exception& e) {
+            std::cerr << "[Assets] " << source.label << ": texture import failed: " << e.what() << '\n';
+        }
+    }
+    return assets;
 }
 
 void Simulation::switchToScene(size_t sceneIndex)
@@ -21,12 +104,79 @@ void Simulation::switchToScene(size_t sceneIndex)
     if (hasActiveScene_) {
         scenes_[activeSceneIndex_]->onUnload(world_);
     }
+    // Nothing references the stream ranges between unload and load, so compaction is safe here.
+    assets_.collectGarbage();
     activeSceneIndex_ = sceneIndex;
     scenes_[activeSceneIndex_]->onLoad(world_);
+
+    const AssetRegistry::Stats stats = assets_.stats();
+    std::cout << "[Assets] registry: " << stats.residentFiles << " files, " << stats.residentGeometry << " geometry ranges resident; "
+              << stats.fileHits << " file / " << stats.geometryHits << " geometry / " << stats.textureHits << " texture hits, "
+              << stats.dedupedBytes / 1024 << " KiB deduplicated, " << stats.releasedBytes / 1024 << " KiB released\n";
     hasActiveScene_ = true;
     frameGraphDirty_ = true;
 }
 
+// Re-imports run on worker threads; the swap happens here, between frames, and only appends to
+// the streams, so draws already built from the old ranges stay valid until the next scene switch.
+void Simulation::pollAssetReloads()
+{
+    for (const std::string& path : assetWatcher_.poll()) {
+        // The edited loose file now wins over its archived copy.
+        if (AssetArchive* archive = mountedAssetArchive()) {
+            archive->shadow(path);
+        }
+        if (const std::optional<AssetRegistry::SceneKey> key = assets_.sceneForPath(path); key.has_value()) {
+            pendingReloads_.push_back(PendingReload{
+                .key = *key,
+                .imported = std::async(std::launch::async, AssetRegistry::importFile, path, vertexFormat_, assets_.cookedDirectory()) });
+        }
+    }
+
+    while (!pendingReloads_.empty()
+        && pendingReloads_.front().imported.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+        PendingReload reload = std::move(pendingReloads_.front());
+        pendingReloads_.erase(pendingReloads_.begin());
+        try {
+            if (assets_.replaceScene(reload.key, reload.imported.get())) {
+                refreshMeshRefs(reload.key);
+            }
+        }
+        catch (const std::exception& e) {
+            std::cerr << "[Assets] reload failed, keeping the previous mesh: " << e.what() << '\n';
+        }
+    }
+}
+
+void Simulation::refreshMeshRefs(AssetRegistry::SceneKey key)
+{
+    const GlbScene scene = assets_.scene(key);
+    world_.query<MeshRefComp, RenderComp>().each([&](Entity, MeshRefComp& ref, RenderComp& render) {
+        if (ref.scene != key) {
+            return;
+        }
+        // The node hierarchy is not respawned; primitives the new file no longer has are hidden.
+        if (ref.primitive >= scene.primitives.size()) {
+            render.visible = false;
+            return;
+        }
+        const LoadedMesh& mesh = scene.primitives[ref.primitive].mesh;
+        render.vertexCount = mesh.vertexCount;
+        render.firstVertex = mesh.firstVertex;
+        render.indexCount = mesh.indexCount;
+        render.firstIndex = mesh.firstIndex;
+        render.firstMeshlet = mesh.firstMeshlet;
+        render.meshletCount = mesh.meshletCount;
+        render.firstSkinVertex = mesh.firstSkinVertex;
+        render.skinVertexCount = mesh.skinVertexCount;
+        render.dequantScale = mesh.dequantScale;
+        render.dequantOffset = mesh.dequantOffset;
+        render.boundsCenter = mesh.boundsCenter;
+        render.boundsRadius = mesh.boundsRadius;
+    });
+    frameGraphDirty_ = true;
+}
+
 void Simulation::drawMainMenuBar()
 {
     if (!ImGui::BeginMainMenuBar()) {
@@ -48,8 +198,12 @@ void Simulation::drawMainMenuBar()
 
 void Simulation::tick(const SimulationFrameInput& input)
 {
+    pollAssetReloads();
     scenes_[activeSceneIndex_]->onUpdate(world_, input);
     spinningSys_.update(world_, input);
+    animationSys_.update(world_, input);
+    transformSys_.update(world_);
+    skinningSys_.update(world_);
     scenes_[activeSceneIndex_]->onDraw(world_);
     frameGraphDirty_ = true;
 }
@@ -58,7 +212,12 @@ FrameGraphInput Simulation::buildFrameGraphInput() const
 {
     if (frameGraphDirty_) {
         cachedFrameGraphInput_ = renderExtractSys_.build(world_);
-        cachedFrameGraphInput_.vertexPackets = vertexPackets_;
+        cachedFrameGraphInput_.vertexFormat = vertexFormat_;
+        cachedFrameGraphInput_.vertexPackets = assets_.vertexPackets();
+        cachedFrameGraphInput_.compactVertexPackets = assets_.compactVertexPackets();
+        cachedFrameGraphInput_.indices = assets_.indices();
+        cachedFrameGraphInput_.meshlets = assets_.meshlets();
+        cachedFrameGraphInput_.skinVertices = assets_.skinVertices();
         frameGraphDirty_ = false;
     }
     return cachedFrameGraphInput_;
@@ -1,29 +1,46 @@
 #pragma once
 
 #include <Engine.h>
+#include <FileWatcher.h>
 #include <ecs/World.h>
 
+#include "assets/AssetRegistry.h"
+#include "ecs/systems/AnimationSys.h"
 #include "ecs/systems/RenderExtractSys.h"
+#include "ecs/systems/SkinningSys.h"
 #include "ecs/systems/SpinningSys.h"
+#include "ecs/systems/TransformSys.h"
 #include "scenes/Scene.h"
 #include "scenes/TestScene.h"
 
+#include <future>
 #include <memory>
 #include <vector>
 
 class Simulation final : public IGameSimulation {
 public:
-    Simulation();
+    explicit Simulation(VertexFormat vertexFormat = VertexFormat::Float32);
 
     void tick(const SimulationFrameInput& input) override;
     void drawMainMenuBar() override;
+    [[nodiscard]] std::vector<TextureAsset> loadTextureAssets() override;
     [[nodiscard]] FrameGraphInput buildFrameGraphInput() const override;
 
 private:
+    struct PendingReload {
+        AssetRegistry::SceneKey key{ 0 };
+        std::future<AssetRegistry::ImportedFile> imported{};
+    };
+
     void switchToScene(size_t sceneIndex);
+    void pollAssetReloads();
+    void refreshMeshRefs(AssetRegistry::SceneKey key);
 
     World world_{};
     SpinningSys spinningSys_{};
+    AnimationSys animationSys_{};
+    TransformSys transformSys_{};
+    SkinningSys skinningSys_{};
     RenderExtractSys renderExtractSys_{};
 
     std::vector<std::unique_ptr<Scene>> scenes_{};
@@ -33,5 +50,10 @@ private:
     mutable FrameGraphInput cachedFrameGraphInput_{};
     mutable bool frameGraphDirty_{ true };
 
-    std::vector<VertexPacket> vertexPackets_{};
+    VertexFormat vertexFormat_{ VertexFormat::Float32 };
+    AssetRegistry assets_;
+
+    FileWatcher assetWatcher_{};
+    // In change order, so the newest save of a file is applied last.
+    std::vector<PendingReload> pendingReloads_{};
 };
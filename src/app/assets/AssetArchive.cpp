@@ -0,0 +1,300 @@
+#include "AssetArchive.h"
+
+#include "ContentHash.h"
+#include "LzCodec.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <type_traits>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+constexpr uint32_t kArchiveMagic = 0x4B415041U; // "APAK"
+constexpr uint32_t kArchiveVersion = 1;
+constexpr size_t kArchiveAlignment = 64;
+// Compressed entries must save at least 1/16 of their size, or decoding is not worth it.
+constexpr uint64_t kMinSavingsShift = 4;
+// An LZ length byte stands for at most 255 output bytes, which bounds a sane entry size.
+constexpr uint64_t kMaxLzExpansion = 255;
+
+struct ArchiveHeader {
+    uint32_t magic{ kArchiveMagic };
+    uint32_t version{ kArchiveVersion };
+    uint32_t entryCount{ 0 };
+    uint32_t slotCount{ 0 };
+    uint64_t entriesOffset{ 0 };
+    uint64_t slotsOffset{ 0 };
+    uint64_t namesOffset{ 0 };
+    uint64_t namesSize{ 0 };
+};
+static_assert(std::is_trivially_copyable_v<ArchiveHeader> && sizeof(ArchiveHeader) == 48);
+static_assert(std::is_trivially_copyable_v<AssetArchive::Entry> && sizeof(AssetArchive::Entry) == 48);
+
+size_t alignUp(size_t value) noexcept
+{
+    return (value + kArchiveAlignment - 1) & ~(kArchiveAlignment - 1);
+}
+
+uint64_t hashPath(std::string_view key) noexcept
+{
+    return hashBytes(key.data(), key.size());
+}
+
+template <typename T>
+void writePod(std::vector<uint8_t>& out, size_t offset, const T* values, size_t count)
+{
+    if (count != 0) {
+        std::memcpy(out.data() + offset, values, sizeof(T) * count);
+    }
+}
+
+std::unique_ptr<AssetArchive>& mountedArchive()
+{
+    static std::unique_ptr<AssetArchive> archive{};
+    return archive;
+}
+}
+
+std::string archivePathKey(std::string_view path)
+{
+    // Paths the app builds are usually normal already; lexically_normal() would dominate a lookup.
+    bool normal = !path.empty() && path.find('\\') == std::string_view::npos;
+    for (size_t start = 0; normal && start <= path.size();) {
+        const size_t end = std::min(path.find('/', start), path.size());
+        const std::string_view segment = path.substr(start, end - start);
+        normal = !segment.empty() && segment != "." && segment != "..";
+        start = end + 1;
+    }
+    if (normal) {
+        return std::string(path);
+    }
+
+    std::string key = std::filesystem::path(path).lexically_normal().generic_string();
+    while (key.starts_with("./")) {
+        key.erase(0, 2);
+    }
+    return key;
+}
+
+AssetArchive::AssetArchive(const std::string& path)
+    : path_(path)
+{
+#ifdef __linux__
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::runtime_error("AssetArchive: unable to open " + path);
+    }
+    struct stat info{};
+    if (::fstat(fd, &info) != 0 || info.st_size <= 0) {
+        ::close(fd);
+        throw std::runtime_error("AssetArchive: unable to size " + path);
+    }
+    size_ = static_cast<size_t>(info.st_size);
+    void* mapping = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        throw std::runtime_error("AssetArchive: unable to map " + path);
+    }
+    // Entries are read in whatever order scenes ask for them.
+    ::madvise(mapping, size_, MADV_RANDOM);
+    data_ = static_cast<const uint8_t*>(mapping);
+#else
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        throw std::runtime_error("AssetArchive: unable to open " + path);
+    }
+    bytes_.resize(static_cast<size_t>(file.tellg()));
+    file.seekg(0, std::ios::beg);
+    if (!file.read(reinterpret_cast<char*>(bytes_.data()), static_cast<std::streamsize>(bytes_.size()))) {
+        throw std::runtime_error("AssetArchive: failed to read " + path);
+    }
+    data_ = bytes_.data();
+    size_ = bytes_.size();
+#endif
+
+    try {
+        ArchiveHeader header{};
+        if (size_ < sizeof(header)) {
+            throw std::runtime_error("truncated header");
+        }
+        std::memcpy(&header, data_, sizeof(header));
+        if (header.magic != kArchiveMagic || header.version != kArchiveVersion) {
+            throw std::runtime_error("not an archive of this version");
+        }
+        const auto inBounds = [this](uint64_t offset, uint64_t length) {
+            return offset <= size_ && length <= size_ - offset;
+        };
+        if (!std::has_single_bit(header.slotCount) || header.slotCount <= header.entryCount
+            || header.entriesOffset % kArchiveAlignment != 0 || header.slotsOffset % alignof(uint32_t) != 0
+            || !inBounds(header.entriesOffset, uint64_t{ header.entryCount } * sizeof(Entry))
+            || !inBounds(header.slotsOffset, uint64_t{ header.slotCount } * sizeof(uint32_t))
+            || !inBounds(header.namesOffset, header.namesSize)) {
+            throw std::runtime_error("table of contents out of bounds");
+        }
+
+        entries_ = reinterpret_cast<const Entry*>(data_ + header.entriesOffset);
+        entryCount_ = header.entryCount;
+        slots_ = reinterpret_cast<const uint32_t*>(data_ + header.slotsOffset);
+        slotCount_ = header.slotCount;
+        names_ = reinterpret_cast<const char*>(data_ + header.namesOffset);
+        for (size_t i = 0; i < entryCount_; ++i) {
+            const Entry& e = entries_[i];
+            if (!inBounds(e.offset, e.storedSize) || uint64_t{ e.nameOffset } + e.nameLength > header.namesSize
+                || (e.compression == Compression::None && e.storedSize != e.size) || e.compression > Compression::Lz
+                || e.size / kMaxLzExpansion > e.storedSize) {
+                throw std::runtime_error("entry " + std::to_string(i) + " out of bounds");
+            }
+        }
+        // Probes stop at an empty slot, so at least one must exist.
+        size_t usedSlots = 0;
+        for (size_t slot = 0; slot < slotCount_; ++slot) {
+            if (slots_[slot] > entryCount_) {
+                throw std::runtime_error("slot " + std::to_string(slot) + " out of bounds");
+            }
+            usedSlots += slots_[slot] != 0 ? 1 : 0;
+        }
+        if (usedSlots > entryCount_) {
+            throw std::runtime_error("lookup table overfull");
+        }
+    }
+    catch (const std::exception& e) {
+#ifdef __linux__
+        ::munmap(const_cast<uint8_t*>(data_), size_);
+#endif
+        throw std::runtime_error("AssetArchive: " + path + ": " + e.what());
+    }
+}
+
+AssetArchive::~AssetArchive()
+{
+#ifdef __linux__
+    ::munmap(const_cast<uint8_t*>(data_), size_);
+#endif
+}
+
+std::vector<uint8_t> AssetArchive::build(std::vector<Input> inputs)
+{
+    std::ranges::sort(inputs, {}, &Input::path);
+    for (Input& input : inputs) {
+        input.path = archivePathKey(input.path);
+        if (input.path.size() > UINT16_MAX) {
+            throw std::runtime_error("AssetArchive: path too long: " + input.path);
+        }
+    }
+
+    const size_t slotCount = std::bit_ceil(inputs.size() * 2 + 1);
+    std::vector<Entry> entries(inputs.size());
+    std::vector<uint32_t> slots(slotCount, 0);
+    std::string names{};
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        Entry& entry = entries[i];
+        entry.pathHash = hashPath(inputs[i].path);
+        entry.size = inputs[i].bytes.size();
+        entry.sourceTime = inputs[i].sourceTime;
+        entry.nameOffset = static_cast<uint32_t>(names.size());
+        entry.nameLength = static_cast<uint16_t>(inputs[i].path.size());
+        names += inputs[i].path;
+
+        size_t slot = entry.pathHash & (slotCount - 1);
+        for (; slots[slot] != 0; slot = (slot + 1) & (slotCount - 1)) {
+            if (entries[slots[slot] - 1].pathHash == entry.pathHash && inputs[slots[slot] - 1].path == inputs[i].path) {
+                throw std::runtime_error("AssetArchive: duplicate path " + inputs[i].path);
+            }
+        }
+        slots[slot] = static_cast<uint32_t>(i + 1);
+    }
+
+    const size_t entriesOffset = alignUp(sizeof(ArchiveHeader));
+    const size_t slotsOffset = alignUp(entriesOffset + entries.size() * sizeof(Entry));
+    const size_t namesOffset = alignUp(slotsOffset + slots.size() * sizeof(uint32_t));
+
+    std::vector<uint8_t> out(alignUp(namesOffset + names.size()), 0);
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        const std::vector<uint8_t>& bytes = inputs[i].bytes;
+        std::vector<uint8_t> compressed = lzCompress(bytes.data(), bytes.size());
+        const bool useCompressed = compressed.size() < bytes.size() - (bytes.size() >> kMinSavingsShift);
+        const std::vector<uint8_t>& stored = useCompressed ? compressed : bytes;
+
+        entries[i].offset = out.size();
+        entries[i].storedSize = stored.size();
+        entries[i].compression = useCompressed ? Compression::Lz : Compression::None;
+        out.insert(out.end(), stored.begin(), stored.end());
+        out.resize(alignUp(out.size()), 0);
+    }
+
+    const ArchiveHeader header{
+        .entryCount = static_cast<uint32_t>(entries.size()),
+        .slotCount = static_cast<uint32_t>(slotCount),
+        .entriesOffset = entriesOffset,
+        .slotsOffset = slotsOffset,
+        .namesOffset = namesOffset,
+        .namesSize = names.size() };
+    writePod(out, 0, &header, 1);
+    writePod(out, entriesOffset, entries.data(), entries.size());
+    writePod(out, slotsOffset, slots.data(), slots.size());
+    writePod(out, namesOffset, names.data(), names.size());
+    return out;
+}
+
+const AssetArchive::Entry* AssetArchive::find(std::string_view path) const
+{
+    const std::string key = archivePathKey(path);
+    const uint64_t hash = hashPath(key);
+    for (size_t slot = hash & (slotCount_ - 1); slots_[slot] != 0; slot = (slot + 1) & (slotCount_ - 1)) {
+        const Entry& candidate = entries_[slots_[slot] - 1];
+        if (candidate.pathHash != hash || entryPath(candidate) != key) {
+            continue;
+        }
+        const std::scoped_lock lock(shadowMutex_);
+        return shadowed_.contains(key) ? nullptr : &candidate;
+    }
+    return nullptr;
+}
+
+std::vector<uint8_t> AssetArchive::read(const Entry& entry) const
+{
+    const uint8_t* stored = storedBytes(entry);
+    if (entry.compression == Compression::None) {
+        return std::vector<uint8_t>(stored, stored + entry.size);
+    }
+    std::vector<uint8_t> bytes(entry.size);
+    try {
+        lzDecompress(bytes.data(), bytes.size(), stored, entry.storedSize);
+    }
+    catch (const std::exception& e) {
+        throw std::runtime_error("AssetArchive: " + path_ + ": " + std::string(entryPath(entry)) + ": " + e.what());
+    }
+    return bytes;
+}
+
+std::string_view AssetArchive::entryPath(const Entry& entry) const noexcept
+{
+    return std::string_view(names_ + entry.nameOffset, entry.nameLength);
+}
+
+void AssetArchive::shadow(std::string_view path)
+{
+    const std::scoped_lock lock(shadowMutex_);
+    shadowed_.insert(archivePathKey(path));
+}
+
+void mountAssetArchive(std::unique_ptr<AssetArchive> archive)
+{
+    mountedArchive() = std::move(archive);
+}
+
+AssetArchive* mountedAssetArchive() noexcept
+{
+    return mountedArchive().get();
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+// A packed, read-only set of asset files, so a large asset set costs one open and one mapping
+// instead of an open/stat/read per file.
+//
+// Layout, little-endian and 64-byte aligned throughout:
+//   Header | Entry[entryCount] | uint32_t slots[slotCount] | path names | entry data...
+// slots is an open-addressing table over Entry::pathHash (linear probing, entry index + 1, 0 when
+// empty), so a lookup touches a few cache lines of the mapping and parses nothing. Entries are
+// stored raw or LZ compressed (see LzCodec.h), whichever is smaller.
+class AssetArchive {
+public:
+    enum class Compression : uint8_t {
+        None,
+        Lz
+    };
+
+    struct Entry {
+        uint64_t pathHash{ 0 };
+        uint64_t offset{ 0 };
+        uint64_t storedSize{ 0 };
+        uint64_t size{ 0 };
+        // Source last_write_time, so cooked copies of archived and loose files stay interchangeable.
+        int64_t sourceTime{ 0 };
+        uint32_t nameOffset{ 0 };
+        uint16_t nameLength{ 0 };
+        Compression compression{ Compression::None };
+        uint8_t reserved{ 0 };
+    };
+
+    struct Input {
+        // Relative, '/'-separated; the key reads are resolved against.
+        std::string path{};
+        std::vector<uint8_t> bytes{};
+        int64_t sourceTime{ 0 };
+    };
+
+    // Maps path; throws when it is not a valid archive.
+    explicit AssetArchive(const std::string& path);
+    ~AssetArchive();
+
+    AssetArchive(const AssetArchive&) = delete;
+    AssetArchive& operator=(const AssetArchive&) = delete;
+
+    [[nodiscard]] static std::vector<uint8_t> build(std::vector<Input> inputs);
+
+    // nullptr when path is not archived or has been shadowed.
+    [[nodiscard]] const Entry* find(std::string_view path) const;
+    [[nodiscard]] std::vector<uint8_t> read(const Entry& entry) const;
+    // The stored bytes in the mapping; only the contents for Compression::None.
+    [[nodiscard]] const uint8_t* storedBytes(const Entry& entry) const noexcept { return data_ + entry.offset; }
+
+    [[nodiscard]] size_t entryCount() const noexcept { return entryCount_; }
+    [[nodiscard]] const Entry& entry(size_t index) const noexcept { return entries_[index]; }
+    [[nodiscard]] std::string_view entryPath(const Entry& entry) const noexcept;
+
+    // Later reads of path go to the filesystem, e.g. after the loose file was edited for hot reload.
+    void shadow(std::string_view path);
+
+private:
+    std::string path_{};
+    const uint8_t* data_{ nullptr };
+    size_t size_{ 0 };
+    // Backing for platforms without mmap.
+    std::vector<uint8_t> bytes_{};
+
+    const Entry* entries_{ nullptr };
+    size_t entryCount_{ 0 };
+    const uint32_t* slots_{ nullptr };
+    size_t slotCount_{ 0 };
+    const char* names_{ nullptr };
+
+    mutable std::mutex shadowMutex_{};
+    std::unordered_set<std::string> shadowed_{};
+};
+
+// Archive keys are normalized relative paths with '/' separators.
+[[nodiscard]] std::string archivePathKey(std::string_view path);
+
+// Reads of archived paths anywhere in the app go through the mounted archive; mount once at
+// startup, before any worker reads.
+void mountAssetArchive(std::unique_ptr<AssetArchive> archive);
+[[nodiscard]] AssetArchive* mountedAssetArchive() noexcept;
@@ -0,0 +1,561 @@
+#include "AssetRegistry.h"
+
+#include "AssetArchive.h"
+#include "BatchFileReader.h"
+#include "ContentHash.h"
+#include "CookedScene.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+namespace {
+void logMeshImport(const std::string& label, const LoadedMesh& mesh)
+{
+    const QuantizationReport& report = mesh.quantization;
+    std::cout << "[Assets] " << label << ": " << mesh.vertexCount << " vertices, "
+              << report.bytesPerVertex << " B/vertex, max error position=" << report.maxPositionError
+              << " normal=" << report.maxNormalErrorDegrees << "deg color=" << report.maxColorError
+              << " uv=" << report.maxUvError << '\n';
+
+    const MeshOptimizationStats& optimization = mesh.optimization;
+    std::cout << "[Assets] " << label << ": " << mesh.indexCount / 3 << " triangles, ACMR "
+              << optimization.before.acmr << " -> " << optimization.after.acmr << ", ATVR "
+              << optimization.before.atvr << " -> " << optimization.after.atvr << '\n';
+
+    const MeshletBuildStats& meshlets = mesh.meshlets;
+    std::cout << "[Assets] " << label << ": " << meshlets.meshletCount << " meshlets, "
+              << meshlets.averageTriangles << " triangles / " << meshlets.averageVertices
+              << " vertices avg, " << meshlets.coneCullableMeshlets << " cone-cullable\n";
+}
+
+// Vertex packets have no padding, so their bytes are a faithful key.
+template <typename Vertex>
+uint64_t hashGeometry(const Vertex* vertices, const uint32_t* indices, const SkinVertexPacket* skinVertices, const LoadedMesh& mesh)
+{
+    uint64_t hash = hashBytes(vertices, sizeof(Vertex) * mesh.vertexCount);
+    hash = hashBytes(indices, sizeof(uint32_t) * mesh.indexCount, hash);
+    hash = hashBytes(skinVertices, sizeof(SkinVertexPacket) * mesh.skinVertexCount, hash);
+    hash = hashBytes(mesh.dequantScale.data(), sizeof(mesh.dequantScale), hash);
+    return hashBytes(mesh.dequantOffset.data(), sizeof(mesh.dequantOffset), hash);
+}
+
+template <typename Vertex>
+bool sameGeometry(const Vertex* vertices, const uint32_t* indices, const SkinVertexPacket* skinVertices, const LoadedMesh& mesh,
+    const std::vector<Vertex>& residentVertices, const std::vector<uint32_t>& residentIndices,
+    const std::vector<SkinVertexPacket>& residentSkinVertices, const LoadedMesh& resident)
+{
+    return mesh.vertexCount == resident.vertexCount
+        && mesh.indexCount == resident.indexCount
+        && mesh.skinVertexCount == resident.skinVertexCount
+        && mesh.dequantScale == resident.dequantScale
+        && mesh.dequantOffset == resident.dequantOffset
+        && std::memcmp(vertices, residentVertices.data() + resident.firstVertex, sizeof(Vertex) * mesh.vertexCount) == 0
+        && std::memcmp(indices, residentIndices.data() + resident.firstIndex, sizeof(uint32_t) * mesh.indexCount) == 0
+        && (mesh.skinVertexCount == 0
+            || std::memcmp(skinVertices, residentSkinVertices.data() + resident.firstSkinVertex, sizeof(SkinVertexPacket) * mesh.skinVertexCount) == 0);
+}
+
+AssetRegistry::ImportedFile importBytes(const std::string& path, const std::vector<uint8_t>& bytes, uint64_t contentHash, VertexFormat vertexFormat)
+{
+    AssetRegistry::ImportedFile imported{ .path = path, .contentHash = contentHash, .size = bytes.size(), .vertexFormat = vertexFormat };
+    if (vertexFormat == VertexFormat::Float32) {
+        imported.scene = loadGlbScene(path, bytes, imported.vertices, imported.indices, imported.meshlets, imported.skinVertices);
+    } else {
+        imported.scene = loadGlbScene(path, bytes, vertexFormat, imported.compactVertices, imported.indices, imported.meshlets, imported.skinVertices);
+    }
+    imported.scene.images.clear();
+    return imported;
+}
+
+// A current cooked copy when one exists, otherwise the source bytes. Processing waits until after
+// the content lookup, so acquiring a resident file skips it.
+struct OpenedFile {
+    std::optional<AssetRegistry::ImportedFile> cooked{};
+    std::vector<uint8_t> sourceBytes{};
+    CookedSceneStamp stamp{};
+    uint64_t contentHash{ 0 };
+    uint64_t size{ 0 };
+};
+
+std::string cookedPath(const std::string& cookedDirectory, const std::string& path, VertexFormat vertexFormat)
+{
+    const std::string source = std::filesystem::path(path).lexically_normal().generic_string();
+    std::ostringstream name{};
+    name << cookedDirectory << '/' << std::hex << hashBytes(source.data(), source.size())
+         << '-' << static_cast<uint32_t>(vertexFormat) << ".mesh";
+    return name.str();
+}
+
+// Cooked copies are read first; sources are read in a second batch for the files whose copy is
+// missing, stale or corrupt. Files in the mounted archive are taken from its mapping instead.
+std::vector<OpenedFile> openFiles(BatchFileReader& reader, const std::vector<std::string>& paths, VertexFormat vertexFormat, const std::string& cookedDirectory)
+{
+    const AssetArchive* archive = mountedAssetArchive();
+    std::vector<OpenedFile> opened(paths.size());
+    std::vector<const AssetArchive::Entry*> archived(paths.size(), nullptr);
+    std::vector<size_t> sourceOwners(paths.size());
+    for (size_t i = 0; i < paths.size(); ++i) {
+        sourceOwners[i] = i;
+        if (archive != nullptr) {
+            archived[i] = archive->find(paths[i]);
+        }
+    }
+
+    const auto useCooked = [&](size_t i, const std::string& label, const uint8_t* data, size_t size) {
+        OpenedFile& file = opened[i];
+        try {
+            file.cooked = readCookedScene(paths[i], data, size, file.stamp);
+        }
+        catch (const std::exception& e) {
+            std::cerr << "[Assets] " << label << ": " << e.what() << ", cooking again\n";
+        }
+        if (file.cooked.has_value()) {
+            file.contentHash = file.cooked->contentHash;
+            file.size = file.cooked->size;
+        }
+    };
+    const auto useSource = [&](size_t i, std::vector<uint8_t> bytes) {
+        OpenedFile& file = opened[i];
+        file.sourceBytes = std::move(bytes);
+        file.contentHash = hashBytes(file.sourceBytes.data(), file.sourceBytes.size());
+        file.size = file.sourceBytes.size();
+    };
+
+    if (!cookedDirectory.empty()) {
+        std::vector<std::string> cookedPaths{};
+        std::vector<size_t> cookedOwners{};
+        for (size_t i = 0; i < paths.size(); ++i) {
+            // Stamped before reading, so an edit racing the read leaves a cook that never matches.
+            opened[i].stamp = archived[i] != nullptr
+                ? CookedSceneStamp{ .sourceSize = archived[i]->size, .sourceTime = archived[i]->sourceTime, .vertexFormat = vertexFormat }
+                : stampSource(paths[i], vertexFormat);
+            std::string cachePath = cookedPath(cookedDirectory, paths[i], vertexFormat);
+            std::error_code ec{};
+            if (const AssetArchive::Entry* entry = archive != nullptr ? archive->find(cachePath) : nullptr) {
+                useCooked(i, cachePath, archive->read(*entry).data(), entry->size);
+            } else if (std::filesystem::exists(cachePath, ec)) {
+                cookedPaths.push_back(std::move(cachePath));
+                cookedOwners.push_back(i);
+            }
+        }
+
+        const std::vector<BatchFileReader::File> cooked = reader.readAll(cookedPaths);
+        for (size_t c = 0; c < cooked.size(); ++c) {
+            if (!cooked[c].error.empty()) {
+                std::cerr << "[Assets] " << cooked[c].path << ": " << cooked[c].error << ", cooking again\n";
+                continue;
+            }
+            useCooked(cookedOwners[c], cooked[c].path, cooked[c].data, cooked[c].size);
+        }
+        std::erase_if(sourceOwners, [&](size_t i) { return opened[i].cooked.has_value(); });
+    }
+
+    std::vector<std::string> sourcePaths{};
+    std::vector<size_t> looseOwners{};
+    for (const size_t i : sourceOwners) {
+        if (archived[i] != nullptr) {
+            useSource(i, archive->read(*archived[i]));
+        } else {
+            sourcePaths.push_back(paths[i]);
+            looseOwners.push_back(i);
+        }
+    }
+    const std::vector<BatchFileReader::File> sources = reader.readAll(sourcePaths);
+    for (size_t s = 0; s < sources.size(); ++s) {
+        if (!sources[s].error.empty()) {
+            throw std::runtime_error("Unable to open file: " + sources[s].path + ": " + sources[s].error);
+        }
+        useSource(looseOwners[s], std::vector<uint8_t>(sources[s].data, sources[s].data + sources[s].size));
+    }
+    return opened;
+}
+
+// Best effort: a failed write only costs the next load a full import. The temporary name is per
+// thread because hot reload cooks on workers.
+void writeCookedFile(const std::string& cachePath, const std::vector<uint8_t>& bytes)
+{
+    std::error_code ec{};
+    std::filesystem::create_directories(std::filesystem::path(cachePath).parent_path(), ec);
+    const std::string tempPath = cachePath + ".tmp" + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        if (!file) {
+            std::cerr << "[Assets] " << cachePath << ": cannot write cooked scene\n";
+            file.close();
+            std::filesystem::remove(tempPath, ec);
+            return;
+        }
+    }
+    std::filesystem::rename(tempPath, cachePath, ec);
+    if (ec) {
+        std::cerr << "[Assets] " << cachePath << ": " << ec.message() << '\n';
+        std::filesystem::remove(tempPath, ec);
+    }
+}
+
+AssetRegistry::ImportedFile finishImport(OpenedFile&& opened, const std::string& path, VertexFormat vertexFormat, const std::string& cookedDirectory)
+{
+    if (opened.cooked.has_value()) {
+        return std::move(*opened.cooked);
+    }
+
+    AssetRegistry::ImportedFile imported = importBytes(path, opened.sourceBytes, opened.contentHash, vertexFormat);
+    if (!cookedDirectory.empty()) {
+        const std::vector<uint8_t> cooked = writeCookedScene(imported, opened.stamp);
+        const size_t streamBytes = sizeof(VertexPacket) * imported.vertices.size()
+            + sizeof(CompactVertexPacket) * imported.compactVertices.size()
+            + sizeof(uint32_t) * imported.indices.size()
+            + sizeof(MeshletPacket) * imported.meshlets.size()
+            + sizeof(SkinVertexPacket) * imported.skinVertices.size();
+        std::cout << "[Assets] " << path << ": cooked " << streamBytes / 1024 << " KiB of streams into "
+                  << cooked.size() / 1024 << " KiB (source " << opened.size / 1024 << " KiB)\n";
+        writeCookedFile(cookedPath(cookedDirectory, path, vertexFormat), cooked);
+    }
+    return imported;
+}
+}
+
+AssetRegistry::AssetRegistry(VertexFormat vertexFormat, std::string cookedDirectory)
+    : vertexFormat_(vertexFormat)
+    , cookedDirectory_(std::move(cookedDirectory))
+{
+}
+
+// A 64-bit key collision between different contents moves the newcomer to the next free key.
+template <typename Vertex>
+uint64_t AssetRegistry::internGeometry(const LoadedMesh& mesh,
+    const std::vector<Vertex>& scratchVertices,
+    const std::vector<uint32_t>& scratchIndices,
+    const std::vector<MeshletPacket>& scratchMeshlets,
+    const std::vector<SkinVertexPacket>& scratchSkinVertices,
+    std::vector<Vertex>& vertices)
+{
+    const Vertex* sourceVertices = scratchVertices.data() + mesh.firstVertex;
+    const uint32_t* sourceIndices = scratchIndices.data() + mesh.firstIndex;
+    const SkinVertexPacket* sourceSkinVertices = scratchSkinVertices.data() + mesh.firstSkinVertex;
+
+    uint64_t key = hashGeometry(sourceVertices, sourceIndices, sourceSkinVertices, mesh);
+    for (auto it = geometry_.find(key); it != geometry_.end(); it = geometry_.find(++key)) {
+        if (sameGeometry(sourceVertices, sourceIndices, sourceSkinVertices, mesh, vertices, indices_, skinVertices_, it->second.mesh)) {
+            it->second.refs += 1;
+            stats_.geometryHits += 1;
+            stats_.dedupedBytes += sizeof(Vertex) * mesh.vertexCount
+                + sizeof(uint32_t) * mesh.indexCount
+                + sizeof(MeshletPacket) * mesh.meshletCount
+                + sizeof(SkinVertexPacket) * mesh.skinVertexCount;
+            return key;
+        }
+    }
+
+    LoadedMesh placed = mesh;
+    placed.firstVertex = static_cast<uint32_t>(vertices.size());
+    placed.firstIndex = static_cast<uint32_t>(indices_.size());
+    placed.firstMeshlet = static_cast<uint32_t>(meshlets_.size());
+    placed.firstSkinVertex = static_cast<uint32_t>(skinVertices_.size());
+
+    vertices.insert(vertices.end(), sourceVertices, sourceVertices + mesh.vertexCount);
+    indices_.insert(indices_.end(), sourceIndices, sourceIndices + mesh.indexCount);
+    skinVertices_.insert(skinVertices_.end(), sourceSkinVertices, sourceSkinVertices + mesh.skinVertexCount);
+    for (uint32_t m = 0; m < mesh.meshletCount; ++m) {
+        MeshletPacket meshlet = scratchMeshlets[mesh.firstMeshlet + m];
+        meshlet.firstIndex = meshlet.firstIndex - mesh.firstIndex + placed.firstIndex;
+        meshlets_.push_back(meshlet);
+    }
+
+    geometry_.emplace(key, Geometry{ .mesh = placed, .refs = 1 });
+    stats_.geometryUploads += 1;
+    return key;
+}
+
+AssetRegistry::ImportedFile AssetRegistry::importFile(const std::string& path, VertexFormat vertexFormat, const std::string& cookedDirectory)
+{
+    // One file on a worker thread gains nothing from a ring or a pool.
+    BatchFileReader reader(BatchFileReader::Options{ .backend = IoBackend::Workers, .workerCount = 1 });
+    std::vector<OpenedFile> opened = openFiles(reader, { path }, vertexFormat, cookedDirectory);
+    return finishImport(std::move(opened.front()), path, vertexFormat, cookedDirectory);
+}
+
+std::vector<uint64_t> AssetRegistry::internPrimitives(const ImportedFile& imported)
+{
+    std::vector<uint64_t> primitiveGeometry{};
+    primitiveGeometry.reserve(imported.scene.primitives.size());
+    for (size_t p = 0; p < imported.scene.primitives.size(); ++p) {
+        const uint32_t uploads = stats_.geometryUploads;
+        const LoadedMesh& mesh = imported.scene.primitives[p].mesh;
+        primitiveGeometry.push_back(vertexFormat_ == VertexFormat::Float32
+            ? internGeometry(mesh, imported.vertices, imported.indices, imported.meshlets, imported.skinVertices, vertexPackets_)
+            : internGeometry(mesh, imported.compactVertices, imported.indices, imported.meshlets, imported.skinVertices, compactVertexPackets_));
+        if (stats_.geometryUploads != uploads) {
+            logMeshImport(imported.path + " primitive " + std::to_string(p), mesh);
+        }
+    }
+    return primitiveGeometry;
+}
+
+AssetRegistry::SceneKey AssetRegistry::acquireScene(const std::string& path)
+{
+    return acquireScenes({ path }).front();
+}
+
+std::vector<AssetRegistry::SceneKey> AssetRegistry::acquireScenes(const std::vector<std::string>& paths)
+{
+    std::vector<OpenedFile> opened = openFiles(reader_, paths, vertexFormat_, cookedDirectory_);
+    std::vector<SceneKey> keys{};
+    keys.reserve(paths.size());
+    for (size_t i = 0; i < paths.size(); ++i) {
+        // Earlier files of the same batch are already interned, so duplicates within a batch hit too.
+        uint64_t contentHash = opened[i].contentHash;
+        std::optional<SceneKey> hit{};
+        for (auto it = filesByContent_.find(contentHash); it != filesByContent_.end(); it = filesByContent_.find(++contentHash)) {
+            File& file = files_.at(it->second);
+            if (file.size == opened[i].size) {
+                file.refs += 1;
+                stats_.fileHits += 1;
+                hit = it->second;
+                break;
+            }
+        }
+        if (hit.has_value()) {
+            keys.push_back(*hit);
+            continue;
+        }
+
+        ImportedFile imported = finishImport(std::move(opened[i]), paths[i], vertexFormat_, cookedDirectory_);
+        const uint32_t uploadsBefore = stats_.geometryUploads;
+        File file{ .contentHash = contentHash, .size = imported.size, .path = paths[i], .primitiveGeometry = internPrimitives(imported), .refs = 1 };
+        file.scene = std::move(imported.scene);
+
+        const uint32_t uploaded = stats_.geometryUploads - uploadsBefore;
+        std::cout << "[Assets] " << paths[i] << ": " << file.scene.nodes.size() << " nodes, " << file.scene.primitives.size()
+                  << " primitives (" << file.scene.primitives.size() - uploaded << " shared)\n";
+
+        const SceneKey key = nextSceneKey_++;
+        files_.emplace(key, std::move(file));
+        filesByContent_.emplace(contentHash, key);
+        stats_.fileImports += 1;
+        keys.push_back(key);
+    }
+    return keys;
+}
+
+void AssetRegistry::releaseScene(SceneKey key)
+{
+    const auto it = files_.find(key);
+    if (it == files_.end() || it->second.refs == 0) {
+        throw std::runtime_error("AssetRegistry: release of a scene that is not acquired");
+    }
+    it->second.refs -= 1;
+}
+
+GlbScene AssetRegistry::scene(SceneKey key) const
+{
+    const auto it = files_.find(key);
+    if (it == files_.end()) {
+        throw std::runtime_error("AssetRegistry: unknown scene key");
+    }
+
+    GlbScene out = it->second.scene;
+    for (size_t p = 0; p < out.primitives.size(); ++p) {
+        out.primitives[p].mesh = geometry_.at(it->second.primitiveGeometry[p]).mesh;
+    }
+    return out;
+}
+
+std::optional<AssetRegistry::SceneKey> AssetRegistry::sceneForPath(const std::string& path) const
+{
+    const std::filesystem::path wanted = std::filesystem::path(path).lexically_normal();
+    for (const auto& [key, file] : files_) {
+        if (file.refs != 0 && std::filesystem::path(file.path).lexically_normal() == wanted) {
+            return key;
+        }
+    }
+    return std::nullopt;
+}
+
+bool AssetRegistry::replaceScene(SceneKey key, ImportedFile&& imported)
+{
+    const auto fileIt = files_.find(key);
+    if (fileIt == files_.end()) {
+        throw std::runtime_error("AssetRegistry: reload of an unknown scene key");
+    }
+    if (imported.vertexFormat != vertexFormat_) {
+        throw std::runtime_error("AssetRegistry: reloaded file was imported with a different vertex format");
+    }
+
+    File& file = fileIt->second;
+    if (file.size == imported.size && file.contentHash == imported.contentHash) {
+        return false;
+    }
+
+    // Intern first so primitives that did not change keep their geometry and ranges.
+    std::vector<uint64_t> primitiveGeometry = internPrimitives(imported);
+    for (const uint64_t geometryKey : file.primitiveGeometry) {
+        Geometry& geometry = geometry_.at(geometryKey);
+        geometry.refs -= 1;
+        if (geometry.refs == 0) {
+            geometry_.erase(geometryKey);
+            compactionPending_ = true;
+        }
+    }
+
+    if (const auto it = filesByContent_.find(file.contentHash); it != filesByContent_.end() && it->second == key) {
+        filesByContent_.erase(it);
+    }
+    uint64_t contentHash = imported.contentHash;
+    while (filesByContent_.contains(contentHash)) {
+        ++contentHash;
+    }
+    filesByContent_.emplace(contentHash, key);
+
+    file.contentHash = contentHash;
+    file.size = imported.size;
+    file.path = std::move(imported.path);
+    file.scene = std::move(imported.scene);
+    file.primitiveGeometry = std::move(primitiveGeometry);
+    stats_.fileReloads += 1;
+
+    std::cout << "[Assets] reloaded " << file.path << ": " << file.scene.primitives.size() << " primitives\n";
+    return true;
+}
+
+uint32_t AssetRegistry::acquireTexture(std::string label, GlbImage&& image)
+{
+    uint64_t key = hashBytes(image.bytes.data(), image.bytes.size());
+    for (auto it = textures_.find(key); it != textures_.end(); it = textures_.find(++key)) {
+        if (it->second.size == image.bytes.size()) {
+            it->second.refs += 1;
+            stats_.textureHits += 1;
+            return it->second.textureId;
+        }
+    }
+
+    const uint32_t textureId = nextTextureId_++;
+    textures_.emplace(key, Texture{ .size = image.bytes.size(), .textureId = textureId, .refs = 1 });
+    pendingTextures_.push_back(TextureSource{ .label = std::move(label), .image = std::move(image), .textureId = textureId });
+    stats_.textureImports += 1;
+    return textureId;
+}
+
+std::vector<uint32_t> AssetRegistry::acquireMaterialTextures(const std::string& path)
+{
+    GlbScene materials = readGlbMaterials(path, readBinaryFile(path));
+
+    std::vector<uint32_t> imageTextureIds(materials.images.size(), kNoTexture);
+    std::vector<uint32_t> out{};
+    out.reserve(materials.materials.size());
+    for (const GlbMaterial& material : materials.materials) {
+        uint32_t textureId = kNoTexture;
+        if (material.baseColorImage < materials.images.size()) {
+            uint32_t& imageTextureId = imageTextureIds[material.baseColorImage];
+            if (imageTextureId == kNoTexture) {
+                imageTextureId = acquireTexture(path + " image " + std::to_string(material.baseColorImage),
+                    std::move(materials.images[material.baseColorImage]));
+            }
+            textureId = imageTextureId;
+        }
+        out.push_back(textureId);
+    }
+    return out;
+}
+
+std::vector<AssetRegistry::TextureSource> AssetRegistry::takePendingTextures()
+{
+    return std::exchange(pendingTextures_, {});
+}
+
+// Ranges were appended in import order, so walking survivors by firstVertex keeps every stream
+// in the same relative order and each meshlet's indices inside its geometry's index range.
+template <typename Vertex>
+void AssetRegistry::compact(std::vector<Vertex>& vertices)
+{
+    std::vector<Geometry*> survivors{};
+    survivors.reserve(geometry_.size());
+    for (auto& [_, geometry] : geometry_) {
+        survivors.push_back(&geometry);
+    }
+    std::ranges::sort(survivors, {}, [](const Geometry* geometry) { return geometry->mesh.firstVertex; });
+
+    const uint64_t bytesBefore = sizeof(Vertex) * vertices.size() + sizeof(uint32_t) * indices_.size()
+        + sizeof(MeshletPacket) * meshlets_.size() + sizeof(SkinVertexPacket) * skinVertices_.size();
+
+    std::vector<Vertex> newVertices{};
+    std::vector<uint32_t> newIndices{};
+    std::vector<MeshletPacket> newMeshlets{};
+    std::vector<SkinVertexPacket> newSkinVertices{};
+    for (Geometry* geometry : survivors) {
+        LoadedMesh& mesh = geometry->mesh;
+        const uint32_t firstIndex = static_cast<uint32_t>(newIndices.size());
+
+        newVertices.insert(newVertices.end(), vertices.begin() + mesh.firstVertex, vertices.begin() + mesh.firstVertex + mesh.vertexCount);
+        newIndices.insert(newIndices.end(), indices_.begin() + mesh.firstIndex, indices_.begin() + mesh.firstIndex + mesh.indexCount);
+        for (uint32_t m = 0; m < mesh.meshletCount; ++m) {
+            MeshletPacket meshlet = meshlets_[mesh.firstMeshlet + m];
+            meshlet.firstIndex = meshlet.firstIndex - mesh.firstIndex + firstIndex;
+            newMeshlets.push_back(meshlet);
+        }
+        newSkinVertices.insert(newSkinVertices.end(),
+            skinVertices_.begin() + mesh.firstSkinVertex, skinVertices_.begin() + mesh.firstSkinVertex + mesh.skinVertexCount);
+
+        mesh.firstVertex = static_cast<uint32_t>(newVertices.size()) - mesh.vertexCount;
+        mesh.firstIndex = firstIndex;
+        mesh.firstMeshlet = static_cast<uint32_t>(newMeshlets.size()) - mesh.meshletCount;
+        mesh.firstSkinVertex = static_cast<uint32_t>(newSkinVertices.size()) - mesh.skinVertexCount;
+    }
+
+    vertices = std::move(newVertices);
+    indices_ = std::move(newIndices);
+    meshlets_ = std::move(newMeshlets);
+    skinVertices_ = std::move(newSkinVertices);
+
+    const uint64_t bytesAfter = sizeof(Vertex) * vertices.size() + sizeof(uint32_t) * indices_.size()
+        + sizeof(MeshletPacket) * meshlets_.size() + sizeof(SkinVertexPacket) * skinVertices_.size();
+    stats_.releasedBytes += bytesBefore - bytesAfter;
+}
+
+void AssetRegistry::collectGarbage()
+{
+    bool released = false;
+    for (auto it = files_.begin(); it != files_.end();) {
+        if (it->second.refs != 0) {
+            ++it;
+            continue;
+        }
+        for (const uint64_t key : it->second.primitiveGeometry) {
+            geometry_.at(key).refs -= 1;
+        }
+        if (const auto content = filesByContent_.find(it->second.contentHash); content != filesByContent_.end() && content->second == it->first) {
+            filesByContent_.erase(content);
+        }
+        it = files_.erase(it);
+        released = true;
+    }
+    if (!released && !compactionPending_) {
+        return;
+    }
+    compactionPending_ = false;
+
+    std::erase_if(geometry_, [](const auto& entry) { return entry.second.refs == 0; });
+    if (vertexFormat_ == VertexFormat::Float32) {
+        compact(vertexPackets_);
+    } else {
+        compact(compactVertexPackets_);
+    }
+}
+
+AssetRegistry::Stats AssetRegistry::stats() const noexcept
+{
+    Stats out = stats_;
+    out.residentFiles = static_cast<uint32_t>(files_.size());
+    out.residentGeometry = static_cast<uint32_t>(geometry_.size());
+    return out;
+}
@@ -0,0 +1,153 @@
+#pragma once
+
+#include "BatchFileReader.h"
+#include "GlbLoader.h"
+
+#include <Engine.h>
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Content-addressed store for imported GLB files, their geometry and base color images. Files are
+// deduplicated by a hash of their bytes and geometry by a hash of its packed vertices, indices and skin weights, so the
+// same model loaded twice, or identical meshes in different files, occupy the vertex, index and
+// meshlet streams once. Scenes hold a reference while loaded; collectGarbage() drops what nobody
+// references and compacts the streams.
+class AssetRegistry {
+public:
+    using SceneKey = uint64_t;
+
+    struct Stats {
+        uint32_t residentFiles{ 0 };
+        uint32_t residentGeometry{ 0 };
+        uint32_t fileImports{ 0 };
+        uint32_t fileHits{ 0 };
+        uint32_t geometryUploads{ 0 };
+        uint32_t geometryHits{ 0 };
+        uint32_t textureImports{ 0 };
+        uint32_t textureHits{ 0 };
+        uint32_t fileReloads{ 0 };
+        // Stream bytes not appended because an identical range was already resident.
+        uint64_t dedupedBytes{ 0 };
+        // Stream bytes dropped by collectGarbage().
+        uint64_t releasedBytes{ 0 };
+    };
+
+    struct TextureSource {
+        std::string label{};
+        GlbImage image{};
+        uint32_t textureId{ kNoTexture };
+    };
+
+    // A parsed and processed file that has not touched the registry yet.
+    struct ImportedFile {
+        std::string path{};
+        uint64_t contentHash{ 0 };
+        uint64_t size{ 0 };
+        VertexFormat vertexFormat{ VertexFormat::Float32 };
+        GlbScene scene{};
+        std::vector<VertexPacket> vertices{};
+        std::vector<CompactVertexPacket> compactVertices{};
+        std::vector<uint32_t> indices{};
+        std::vector<MeshletPacket> meshlets{};
+        std::vector<SkinVertexPacket> skinVertices{};
+    };
+
+    // With a cooked directory, processed files are cached there compressed (see CookedScene.h) and
+    // reused until their source changes.
+    explicit AssetRegistry(VertexFormat vertexFormat = VertexFormat::Float32, std::string cookedDirectory = {});
+
+    // Reads and processes path without touching any registry state, so it may run on a worker.
+    [[nodiscard]] static ImportedFile importFile(const std::string& path, VertexFormat vertexFormat, const std::string& cookedDirectory = {});
+
+    // Imports path unless a file with identical contents is resident. Pair with releaseScene().
+    [[nodiscard]] SceneKey acquireScene(const std::string& path);
+    // Reads all files of the batch together before importing; keys are returned in path order.
+    [[nodiscard]] std::vector<SceneKey> acquireScenes(const std::vector<std::string>& paths);
+    void releaseScene(SceneKey key);
+    // Primitive ranges reflect the current stream layout; fetch again after collectGarbage().
+    [[nodiscard]] GlbScene scene(SceneKey key) const;
+
+    // The acquired scene imported from path, if any.
+    [[nodiscard]] std::optional<SceneKey> sceneForPath(const std::string& path) const;
+    // Swaps a re-imported file's geometry in under the same key; false when its contents did not
+    // change. New geometry is appended and the replaced ranges stay valid until collectGarbage().
+    bool replaceScene(SceneKey key, ImportedFile&& imported);
+
+    // Texture id per material of path; identical encoded images share one id. The engine uploads
+    // textures once at startup, so these references last for the session.
+    [[nodiscard]] std::vector<uint32_t> acquireMaterialTextures(const std::string& path);
+    // Images first acquired since the last call; their bytes move to the caller for cooking.
+    [[nodiscard]] std::vector<TextureSource> takePendingTextures();
+
+    // Moves surviving ranges, so call it only while no RenderComp refers to them.
+    void collectGarbage();
+
+    [[nodiscard]] VertexFormat vertexFormat() const noexcept { return vertexFormat_; }
+    [[nodiscard]] const std::string& cookedDirectory() const noexcept { return cookedDirectory_; }
+    [[nodiscard]] const std::vector<VertexPacket>& vertexPackets() const noexcept { return vertexPackets_; }
+    [[nodiscard]] const std::vector<CompactVertexPacket>& compactVertexPackets() const noexcept { return compactVertexPackets_; }
+    [[nodiscard]] const std::vector<uint32_t>& indices() const noexcept { return indices_; }
+    [[nodiscard]] const std::vector<MeshletPacket>& meshlets() const noexcept { return meshlets_; }
+    [[nodiscard]] const std::vector<SkinVertexPacket>& skinVertices() const noexcept { return skinVertices_; }
+    [[nodiscard]] Stats stats() const noexcept;
+
+private:
+    struct Geometry {
+        LoadedMesh mesh{};
+        // File primitives using this range.
+        uint32_t refs{ 0 };
+    };
+
+    struct File {
+        uint64_t contentHash{ 0 };
+        uint64_t size{ 0 };
+        std::string path{};
+        // Images are dropped; primitive meshes are resolved from primitiveGeometry on access.
+        GlbScene scene{};
+        std::vector<uint64_t> primitiveGeometry{};
+        uint32_t refs{ 0 };
+    };
+
+    struct Texture {
+        uint64_t size{ 0 };
+        uint32_t textureId{ kNoTexture };
+        uint32_t refs{ 0 };
+    };
+
+    template <typename Vertex>
+    [[nodiscard]] uint64_t internGeometry(const LoadedMesh& mesh,
+        const std::vector<Vertex>& scratchVertices,
+        const std::vector<uint32_t>& scratchIndices,
+        const std::vector<MeshletPacket>& scratchMeshlets,
+        const std::vector<SkinVertexPacket>& scratchSkinVertices,
+        std::vector<Vertex>& vertices);
+    [[nodiscard]] std::vector<uint64_t> internPrimitives(const ImportedFile& imported);
+    template <typename Vertex>
+    void compact(std::vector<Vertex>& vertices);
+    [[nodiscard]] uint32_t acquireTexture(std::string label, GlbImage&& image);
+
+    VertexFormat vertexFormat_{ VertexFormat::Float32 };
+    std::string cookedDirectory_{};
+    BatchFileReader reader_{};
+    std::vector<VertexPacket> vertexPackets_{};
+    std::vector<CompactVertexPacket> compactVertexPackets_{};
+    std::vector<uint32_t> indices_{};
+    std::vector<MeshletPacket> meshlets_{};
+    std::vector<SkinVertexPacket> skinVertices_{};
+
+    std::unordered_map<SceneKey, File> files_{};
+    // Content hash (probed forward on collision) to the file holding those bytes.
+    std::unordered_map<uint64_t, SceneKey> filesByContent_{};
+    SceneKey nextSceneKey_{ 0 };
+    // Reloads dropped geometry; its ranges are reclaimed by the next collectGarbage().
+    bool compactionPending_{ false };
+    std::unordered_map<uint64_t, Geometry> geometry_{};
+    std::unordered_map<uint64_t, Texture> textures_{};
+    std::vector<TextureSource> pendingTextures_{};
+    uint32_t nextTextureId_{ 0 };
+    Stats stats_{};
+};
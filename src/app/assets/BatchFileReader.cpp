@@ -0,0 +1,376 @@
+#include "BatchFileReader.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <thread>
+
+#ifdef __linux__
+#include <cerrno>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+// Page alignment satisfies O_DIRECT on every common block size.
+constexpr size_t kStagingAlignment = 4096;
+
+size_t alignUp(size_t value, size_t alignment) noexcept
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+[[maybe_unused]] std::string systemError(int error)
+{
+    return std::error_code(error, std::generic_category()).message();
+}
+}
+
+#ifdef __linux__
+// A raw io_uring instance (the kernel ABI, no liburing) used only from the owning thread.
+struct BatchFileReader::Ring {
+    int fd{ -1 };
+    uint32_t entries{ 0 };
+    void* sqMap{ MAP_FAILED };
+    size_t sqMapSize{ 0 };
+    void* cqMap{ MAP_FAILED };
+    size_t cqMapSize{ 0 };
+    io_uring_sqe* sqes{ nullptr };
+    size_t sqesSize{ 0 };
+    uint32_t* sqTail{ nullptr };
+    uint32_t* sqMask{ nullptr };
+    uint32_t* sqArray{ nullptr };
+    uint32_t* cqHead{ nullptr };
+    uint32_t* cqTail{ nullptr };
+    uint32_t* cqMask{ nullptr };
+    io_uring_cqe* cqes{ nullptr };
+
+    Ring() = default;
+    Ring(const Ring&) = delete;
+    Ring& operator=(const Ring&) = delete;
+
+    ~Ring()
+    {
+        if (sqes != nullptr) {
+            munmap(sqes, sqesSize);
+        }
+        if (cqMap != MAP_FAILED && cqMap != sqMap) {
+            munmap(cqMap, cqMapSize);
+        }
+        if (sqMap != MAP_FAILED) {
+            munmap(sqMap, sqMapSize);
+        }
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+
+    // Null when io_uring is unavailable (old kernel, seccomp, container policy) or lacks IORING_OP_READ.
+    static std::unique_ptr<Ring> create(uint32_t entries)
+    {
+        io_uring_params params{};
+        auto ring = std::make_unique<Ring>();
+        ring->fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+        if (ring->fd < 0) {
+            return nullptr;
+        }
+        ring->entries = params.sq_entries;
+
+        constexpr size_t kProbeOps = 256;
+        std::vector<uint8_t> probeStorage(sizeof(io_uring_probe) + kProbeOps * sizeof(io_uring_probe_op), 0);
+        auto* probe = reinterpret_cast<io_uring_probe*>(probeStorage.data());
+        if (syscall(__NR_io_uring_register, ring->fd, IORING_REGISTER_PROBE, probe, kProbeOps) < 0
+            || probe->last_op < IORING_OP_READ
+            || (probe->ops[IORING_OP_READ].flags & IO_URING_OP_SUPPORTED) == 0) {
+            return nullptr;
+        }
+
+        ring->sqMapSize = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+        ring->cqMapSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        const bool singleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (singleMap) {
+            ring->sqMapSize = ring->cqMapSize = std::max(ring->sqMapSize, ring->cqMapSize);
+        }
+
+        ring->sqMap = mmap(nullptr, ring->sqMapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+        if (ring->sqMap == MAP_FAILED) {
+            return nullptr;
+        }
+        ring->cqMap = singleMap
+            ? ring->sqMap
+            : mmap(nullptr, ring->cqMapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_CQ_RING);
+        if (ring->cqMap == MAP_FAILED) {
+            return nullptr;
+        }
+        ring->sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+        void* sqes = mmap(nullptr, ring->sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES);
+        if (sqes == MAP_FAILED) {
+            return nullptr;
+        }
+        ring->sqes = static_cast<io_uring_sqe*>(sqes);
+
+        auto* sq = static_cast<uint8_t*>(ring->sqMap);
+        auto* cq = static_cast<uint8_t*>(ring->cqMap);
+        ring->sqTail = reinterpret_cast<uint32_t*>(sq + params.sq_off.tail);
+        ring->sqMask = reinterpret_cast<uint32_t*>(sq + params.sq_off.ring_mask);
+        ring->sqArray = reinterpret_cast<uint32_t*>(sq + params.sq_off.array);
+        ring->cqHead = reinterpret_cast<uint32_t*>(cq + params.cq_off.head);
+        ring->cqTail = reinterpret_cast<uint32_t*>(cq + params.cq_off.tail);
+        ring->cqMask = reinterpret_cast<uint32_t*>(cq + params.cq_off.ring_mask);
+        ring->cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        return ring;
+    }
+};
+#else
+struct BatchFileReader::Ring {};
+#endif
+
+void BatchFileReader::AlignedFree::operator()(uint8_t* data) const noexcept
+{
+    ::operator delete(data, std::align_val_t{ kStagingAlignment });
+}
+
+BatchFileReader::BatchFileReader()
+    : BatchFileReader(Options{})
+{
+}
+
+BatchFileReader::BatchFileReader(const Options& options)
+    : options_(options)
+{
+    if (options_.chunkSize == 0 || options_.chunkSize % kStagingAlignment != 0) {
+        throw std::runtime_error("BatchFileReader: chunk size must be a non-zero multiple of 4096");
+    }
+    if (options_.workerCount == 0) {
+        options_.workerCount = std::clamp(std::thread::hardware_concurrency(), 2U, 8U);
+    }
+#ifdef __linux__
+    if (options_.backend != IoBackend::Workers) {
+        ring_ = Ring::create(std::max(options_.queueDepth, 1U));
+    }
+#endif
+    backend_ = ring_ != nullptr ? IoBackend::IoUring : IoBackend::Workers;
+}
+
+BatchFileReader::~BatchFileReader() = default;
+
+void BatchFileReader::ensureStaging(size_t size)
+{
+    if (size <= stagingSize_) {
+        return;
+    }
+    // Grow geometrically so a scene of slowly increasing loads does not reallocate every call.
+    const size_t capacity = alignUp(std::max(size, stagingSize_ + stagingSize_ / 2), kStagingAlignment);
+    staging_.reset(static_cast<uint8_t*>(::operator new(capacity, std::align_val_t{ kStagingAlignment })));
+    stagingSize_ = capacity;
+}
+
+std::vector<BatchFileReader::File> BatchFileReader::readAll(const std::vector<std::string>& paths)
+{
+    std::vector<File> files(paths.size());
+    std::vector<size_t> stagingOffsets(paths.size(), 0);
+    size_t stagingSize = 0;
+    for (size_t i = 0; i < paths.size(); ++i) {
+        files[i].path = paths[i];
+        std::error_code ec{};
+        const uintmax_t size = std::filesystem::file_size(paths[i], ec);
+        if (ec) {
+            files[i].error = ec.message();
+            continue;
+        }
+        files[i].size = static_cast<size_t>(size);
+        stagingOffsets[i] = stagingSize;
+        stagingSize += alignUp(files[i].size, kStagingAlignment);
+    }
+    ensureStaging(stagingSize);
+
+    std::vector<int> descriptors(paths.size(), -1);
+    std::vector<Chunk> chunks{};
+    for (uint32_t i = 0; i < paths.size(); ++i) {
+        if (!files[i].error.empty()) {
+            continue;
+        }
+        files[i].data = staging_.get() + stagingOffsets[i];
+#ifdef __linux__
+        const int flags = O_RDONLY | O_CLOEXEC;
+        descriptors[i] = options_.directIo ? open(paths[i].c_str(), flags | O_DIRECT) : -1;
+        if (descriptors[i] < 0) {
+            descriptors[i] = open(paths[i].c_str(), flags);
+        }
+        if (descriptors[i] < 0) {
+            files[i].error = systemError(errno);
+            continue;
+        }
+#endif
+        // Direct reads must cover whole blocks; the last one comes back short at end of file.
+        const size_t readableSize = options_.directIo ? alignUp(files[i].size, kStagingAlignment) : files[i].size;
+        for (size_t offset = 0; offset < readableSize; offset += options_.chunkSize) {
+            chunks.push_back(Chunk{ .file = i, .offset = offset, .length = std::min(options_.chunkSize, readableSize - offset) });
+        }
+    }
+
+    if (!chunks.empty()) {
+        if (ring_ != nullptr) {
+            readWithRing(descriptors, chunks, files);
+        } else {
+            readWithWorkers(descriptors, chunks, files);
+        }
+    }
+
+#ifdef __linux__
+    for (const int descriptor : descriptors) {
+        if (descriptor >= 0) {
+            close(descriptor);
+        }
+    }
+#endif
+    for (File& file : files) {
+        if (!file.error.empty()) {
+            file.data = nullptr;
+            file.size = 0;
+        }
+    }
+    return files;
+}
+
+void BatchFileReader::readWithRing(const std::vector<int>& descriptors, std::vector<Chunk>& chunks, std::vector<File>& files)
+{
+#ifdef __linux__
+    Ring& ring = *ring_;
+    std::vector<uint32_t> pending(chunks.size());
+    for (uint32_t i = 0; i < chunks.size(); ++i) {
+        pending[i] = static_cast<uint32_t>(chunks.size()) - 1 - i;
+    }
+    uint32_t inFlight = 0;
+    // Written to the SQ ring but not yet accepted by the kernel.
+    uint32_t unsubmitted = 0;
+
+    while (!pending.empty() || inFlight != 0 || unsubmitted != 0) {
+        uint32_t tail = std::atomic_ref<uint32_t>(*ring.sqTail).load(std::memory_order_relaxed);
+        while (!pending.empty() && inFlight + unsubmitted < ring.entries) {
+            const uint32_t chunkIndex = pending.back();
+            pending.pop_back();
+            const Chunk& chunk = chunks[chunkIndex];
+
+            const uint32_t slot = tail & *ring.sqMask;
+            io_uring_sqe& sqe = ring.sqes[slot];
+            std::memset(&sqe, 0, sizeof(sqe));
+            sqe.opcode = IORING_OP_READ;
+            sqe.fd = descriptors[chunk.file];
+            sqe.addr = reinterpret_cast<uint64_t>(files[chunk.file].data + chunk.offset);
+            sqe.len = static_cast<uint32_t>(chunk.length);
+            sqe.off = chunk.offset;
+            sqe.user_data = chunkIndex;
+            ring.sqArray[slot] = slot;
+            ++tail;
+            ++unsubmitted;
+        }
+        std::atomic_ref<uint32_t>(*ring.sqTail).store(tail, std::memory_order_release);
+
+        const long entered = syscall(__NR_io_uring_enter, ring.fd, unsubmitted, 1U, IORING_ENTER_GETEVENTS, nullptr, 0);
+        if (entered < 0) {
+            if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+                throw std::runtime_error("BatchFileReader: io_uring_enter failed: " + systemError(errno));
+            }
+        } else {
+            inFlight += static_cast<uint32_t>(entered);
+            unsubmitted -= static_cast<uint32_t>(entered);
+        }
+
+        uint32_t head = std::atomic_ref<uint32_t>(*ring.cqHead).load(std::memory_order_relaxed);
+        const uint32_t completedTail = std::atomic_ref<uint32_t>(*ring.cqTail).load(std::memory_order_acquire);
+        for (; head != completedTail; ++head) {
+            const io_uring_cqe& cqe = ring.cqes[head & *ring.cqMask];
+            const auto chunkIndex = static_cast<uint32_t>(cqe.user_data);
+            Chunk& chunk = chunks[chunkIndex];
+            File& file = files[chunk.file];
+            inFlight -= 1;
+
+            if (cqe.res == -EAGAIN || cqe.res == -EINTR) {
+                pending.push_back(chunkIndex);
+                continue;
+            }
+            if (cqe.res < 0) {
+                file.error = systemError(-cqe.res);
+                continue;
+            }
+            const size_t expected = chunk.offset < file.size ? std::min(chunk.length, file.size - static_cast<size_t>(chunk.offset)) : 0;
+            const auto transferred = static_cast<size_t>(cqe.res);
+            if (transferred >= expected) {
+                continue;
+            }
+            if (transferred == 0) {
+                file.error = "file shrank while reading";
+                continue;
+            }
+            // Short read before end of file: queue the remainder.
+            chunk.offset += transferred;
+            chunk.length -= transferred;
+            pending.push_back(chunkIndex);
+        }
+        std::atomic_ref<uint32_t>(*ring.cqHead).store(head, std::memory_order_release);
+    }
+#else
+    readWithWorkers(descriptors, chunks, files);
+#endif
+}
+
+void BatchFileReader::readWithWorkers(const std::vector<int>& descriptors, const std::vector<Chunk>& chunks, std::vector<File>& files)
+{
+    std::atomic<size_t> nextChunk{ 0 };
+    std::mutex errorMutex{};
+
+    const auto fail = [&](File& file, std::string error) {
+        const std::lock_guard lock(errorMutex);
+        if (file.error.empty()) {
+            file.error = std::move(error);
+        }
+    };
+
+    const auto work = [&]() {
+        for (size_t index = nextChunk.fetch_add(1); index < chunks.size(); index = nextChunk.fetch_add(1)) {
+            const Chunk& chunk = chunks[index];
+            File& file = files[chunk.file];
+            auto* target = const_cast<uint8_t*>(file.data) + chunk.offset;
+            const size_t expected = chunk.offset < file.size ? std::min(chunk.length, file.size - static_cast<size_t>(chunk.offset)) : 0;
+#ifdef __linux__
+            size_t done = 0;
+            while (done < expected) {
+                const ssize_t result = pread(descriptors[chunk.file], target + done, chunk.length - done, static_cast<off_t>(chunk.offset + done));
+                if (result < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (result <= 0) {
+                    fail(file, result < 0 ? systemError(errno) : "file shrank while reading");
+                    break;
+                }
+                done += static_cast<size_t>(result);
+            }
+#else
+            (void)descriptors;
+            std::ifstream stream(file.path, std::ios::binary);
+            stream.seekg(static_cast<std::streamoff>(chunk.offset));
+            if (!stream.read(reinterpret_cast<char*>(target), static_cast<std::streamsize>(expected))) {
+                fail(file, "read failed");
+            }
+#endif
+        }
+    };
+
+    const size_t threadCount = std::min<size_t>(options_.workerCount, chunks.size());
+    std::vector<std::jthread> threads{};
+    threads.reserve(threadCount - 1);
+    for (size_t t = 1; t < threadCount; ++t) {
+        threads.emplace_back(work);
+    }
+    work();
+}
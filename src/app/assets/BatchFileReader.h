@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+enum class IoBackend : uint8_t {
+    // io_uring when the kernel allows it, otherwise Workers.
+    Auto,
+    IoUring,
+    // Positional reads from a small pool of threads; the portable path.
+    Workers
+};
+
+// Reads many whole files per call, split into chunks that are all in flight at once, into one
+// page-aligned staging allocation reused across calls.
+class BatchFileReader {
+public:
+    struct Options {
+        IoBackend backend{ IoBackend::Auto };
+        // Bypass the page cache (Linux); files on filesystems that refuse it are read buffered.
+        bool directIo{ false };
+        uint32_t queueDepth{ 64 };
+        // 0 picks from the hardware thread count.
+        uint32_t workerCount{ 0 };
+        size_t chunkSize{ 512 * 1024 };
+    };
+
+    struct File {
+        std::string path{};
+        const uint8_t* data{ nullptr };
+        size_t size{ 0 };
+        // Empty on success.
+        std::string error{};
+    };
+
+    BatchFileReader();
+    explicit BatchFileReader(const Options& options);
+    ~BatchFileReader();
+
+    BatchFileReader(const BatchFileReader&) = delete;
+    BatchFileReader& operator=(const BatchFileReader&) = delete;
+
+    // Falls back to Workers when io_uring was requested but could not be set up.
+    [[nodiscard]] IoBackend backend() const noexcept { return backend_; }
+
+    // One result per path, in order. Bytes stay valid until the next call.
+    [[nodiscard]] std::vector<File> readAll(const std::vector<std::string>& paths);
+
+private:
+    struct Chunk {
+        uint32_t file{ 0 };
+        uint64_t offset{ 0 };
+        size_t length{ 0 };
+    };
+    struct Ring;
+
+    void ensureStaging(size_t size);
+    void readWithRing(const std::vector<int>& descriptors, std::vector<Chunk>& chunks, std::vector<File>& files);
+    void readWithWorkers(const std::vector<int>& descriptors, const std::vector<Chunk>& chunks, std::vector<File>& files);
+
+    Options options_{};
+    IoBackend backend_{ IoBackend::Workers };
+    std::unique_ptr<Ring> ring_{};
+
+    struct AlignedFree {
+        void operator()(uint8_t* data) const noexcept;
+    };
+    std::unique_ptr<uint8_t, AlignedFree> staging_{};
+    size_t stagingSize_{ 0 };
+};
@@ -0,0 +1,98 @@
+#include "ContentHash.h"
+
+#include <bit>
+#include <cstring>
+
+namespace {
+constexpr uint64_t kPrime1 = 0x9E3779B185EBCA87ULL;
+constexpr uint64_t kPrime2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr uint64_t kPrime3 = 0x165667B19E3779F9ULL;
+constexpr uint64_t kPrime4 = 0x85EBCA77C2B2AE63ULL;
+constexpr uint64_t kPrime5 = 0x27D4EB2F165667C5ULL;
+
+uint64_t read64(const uint8_t* p)
+{
+    uint64_t value = 0;
+    std::memcpy(&value, p, sizeof(value));
+    if constexpr (std::endian::native == std::endian::big) {
+        value = std::byteswap(value);
+    }
+    return value;
+}
+
+uint32_t read32(const uint8_t* p)
+{
+    uint32_t value = 0;
+    std::memcpy(&value, p, sizeof(value));
+    if constexpr (std::endian::native == std::endian::big) {
+        value = std::byteswap(value);
+    }
+    return value;
+}
+
+uint64_t round(uint64_t acc, uint64_t input)
+{
+    acc += input * kPrime2;
+    acc = std::rotl(acc, 31);
+    return acc * kPrime1;
+}
+
+uint64_t mergeRound(uint64_t acc, uint64_t value)
+{
+    acc ^= round(0, value);
+    return acc * kPrime1 + kPrime4;
+}
+}
+
+uint64_t hashBytes(const void* data, size_t size, uint64_t seed)
+{
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    const uint8_t* const end = p + size;
+    uint64_t hash = 0;
+
+    if (size >= 32) {
+        uint64_t v1 = seed + kPrime1 + kPrime2;
+        uint64_t v2 = seed + kPrime2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - kPrime1;
+        const uint8_t* const limit = end - 32;
+        do {
+            v1 = round(v1, read64(p));
+            v2 = round(v2, read64(p + 8));
+            v3 = round(v3, read64(p + 16));
+            v4 = round(v4, read64(p + 24));
+            p += 32;
+        } while (p <= limit);
+
+        hash = std::rotl(v1, 1) + std::rotl(v2, 7) + std::rotl(v3, 12) + std::rotl(v4, 18);
+        hash = mergeRound(hash, v1);
+        hash = mergeRound(hash, v2);
+        hash = mergeRound(hash, v3);
+        hash = mergeRound(hash, v4);
+    } else {
+        hash = seed + kPrime5;
+    }
+
+    hash += static_cast<uint64_t>(size);
+
+    for (; p + 8 <= end; p += 8) {
+        hash ^= round(0, read64(p));
+        hash = std::rotl(hash, 27) * kPrime1 + kPrime4;
+    }
+    if (p + 4 <= end) {
+        hash ^= static_cast<uint64_t>(read32(p)) * kPrime1;
+        hash = std::rotl(hash, 23) * kPrime2 + kPrime3;
+        p += 4;
+    }
+    for (; p < end; ++p) {
+        hash ^= static_cast<uint64_t>(*p) * kPrime5;
+        hash = std::rotl(hash, 11) * kPrime1;
+    }
+
+    hash ^= hash >> 33;
+    hash *= kPrime2;
+    hash ^= hash >> 29;
+    hash *= kPrime3;
+    hash ^= hash >> 32;
+    return hash;
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// XXH64 (https://github.com/Cyan4973/xxHash); stable across runs and platforms, so it can key
+// content-addressed caches.
+[[nodiscard]] uint64_t hashBytes(const void* data, size_t size, uint64_t seed = 0);
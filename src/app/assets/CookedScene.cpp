@@ -0,0 +1,405 @@
+#include "CookedScene.h"
+
+#include "GeometryCodec.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+
+namespace {
+constexpr uint32_t kCookedSceneMagic = 0x4E534B43U; // "CKSN"
+// Bump whenever the layout, the codecs or the import pipeline change what a cook produces.
+constexpr uint32_t kCookedSceneVersion = 3;
+// Magic, version, vertex format, source size and time, content hash and size.
+constexpr size_t kCookedHeaderSize = 3 * sizeof(uint32_t) + 4 * sizeof(uint64_t);
+
+enum class StreamCodec : uint8_t {
+    Raw,
+    Vertex
+};
+
+static_assert(std::is_trivially_copyable_v<LoadedMesh>, "LoadedMesh is written as raw bytes");
+
+class ByteWriter {
+public:
+    explicit ByteWriter(std::vector<uint8_t>& out) noexcept : out_(out) {}
+
+    template <typename T>
+    void pod(const T& value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        const auto* bytes = reinterpret_cast<const uint8_t*>(&value);
+        out_.insert(out_.end(), bytes, bytes + sizeof(T));
+    }
+
+    void bytes(const void* data, size_t size)
+    {
+        pod(static_cast<uint64_t>(size));
+        const auto* begin = static_cast<const uint8_t*>(data);
+        out_.insert(out_.end(), begin, begin + size);
+    }
+
+    void string(const std::string& value) { bytes(value.data(), value.size()); }
+
+private:
+    std::vector<uint8_t>& out_;
+};
+
+class ByteReader {
+public:
+    ByteReader(const uint8_t* data, size_t size) noexcept : cursor_(data), end_(data + size) {}
+
+    template <typename T>
+    [[nodiscard]] T pod()
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        T value{};
+        std::memcpy(&value, take(sizeof(T)), sizeof(T));
+        return value;
+    }
+
+    // Returns the start of a length-prefixed range and its size.
+    [[nodiscard]] const uint8_t* bytes(size_t& size)
+    {
+        const uint64_t length = pod<uint64_t>();
+        if (length > static_cast<uint64_t>(end_ - cursor_)) {
+            throw std::runtime_error("CookedScene: truncated data");
+        }
+        size = static_cast<size_t>(length);
+        return take(size);
+    }
+
+    [[nodiscard]] std::string string()
+    {
+        size_t size = 0;
+        const uint8_t* data = bytes(size);
+        return std::string(reinterpret_cast<const char*>(data), size);
+    }
+
+    // Guards element counts before allocating for them.
+    [[nodiscard]] uint32_t count(size_t minElementSize)
+    {
+        const uint32_t value = pod<uint32_t>();
+        if (static_cast<uint64_t>(value) * minElementSize > static_cast<uint64_t>(end_ - cursor_)) {
+            throw std::runtime_error("CookedScene: element count exceeds data");
+        }
+        return value;
+    }
+
+    [[nodiscard]] size_t remaining() const noexcept { return static_cast<size_t>(end_ - cursor_); }
+    [[nodiscard]] bool atEnd() const noexcept { return cursor_ == end_; }
+
+private:
+    const uint8_t* take(size_t size)
+    {
+        if (size > static_cast<size_t>(end_ - cursor_)) {
+            throw std::runtime_error("CookedScene: truncated data");
+        }
+        const uint8_t* data = cursor_;
+        cursor_ += size;
+        return data;
+    }
+
+    const uint8_t* cursor_{ nullptr };
+    const uint8_t* end_{ nullptr };
+};
+
+std::vector<float> readFloats(ByteReader& reader)
+{
+    size_t size = 0;
+    const uint8_t* data = reader.bytes(size);
+    if (size % sizeof(float) != 0) {
+        throw std::runtime_error("CookedScene: misaligned float array");
+    }
+    std::vector<float> values(size / sizeof(float));
+    if (size != 0) {
+        std::memcpy(values.data(), data, size);
+    }
+    return values;
+}
+
+// Float-heavy streams can code larger than they are; those are stored raw.
+template <typename T>
+void writeStream(ByteWriter& writer, const std::vector<T>& values)
+{
+    writer.pod(static_cast<uint32_t>(values.size()));
+    const std::vector<uint8_t> encoded = encodeVertexBuffer(values.data(), values.size(), sizeof(T));
+    if (encoded.size() < sizeof(T) * values.size()) {
+        writer.pod(StreamCodec::Vertex);
+        writer.bytes(encoded.data(), encoded.size());
+    } else {
+        writer.pod(StreamCodec::Raw);
+        writer.bytes(values.data(), sizeof(T) * values.size());
+    }
+}
+
+template <typename T>
+void readStream(ByteReader& reader, std::vector<T>& values)
+{
+    const uint32_t count = reader.pod<uint32_t>();
+    const StreamCodec codec = reader.pod<StreamCodec>();
+    size_t size = 0;
+    const uint8_t* data = reader.bytes(size);
+    if (codec == StreamCodec::Vertex && count > maxDecodedVertexCount(size, sizeof(T))) {
+        throw std::runtime_error("CookedScene: element count exceeds data");
+    }
+    if (codec == StreamCodec::Raw && static_cast<uint64_t>(count) * sizeof(T) != size) {
+        throw std::runtime_error("CookedScene: malformed stream");
+    }
+    values.resize(count);
+    if (codec == StreamCodec::Vertex) {
+        decodeVertexBuffer(values.data(), values.size(), sizeof(T), data, size);
+    } else if (codec == StreamCodec::Raw) {
+        if (size != 0) {
+            std::memcpy(values.data(), data, size);
+        }
+    } else {
+        throw std::runtime_error("CookedScene: malformed stream");
+    }
+}
+}
+
+CookedSceneStamp stampSource(const std::string& path, VertexFormat vertexFormat)
+{
+    return CookedSceneStamp{
+        .sourceSize = static_cast<uint64_t>(std::filesystem::file_size(path)),
+        .sourceTime = static_cast<int64_t>(std::filesystem::last_write_time(path).time_since_epoch().count()),
+        .vertexFormat = vertexFormat };
+}
+
+std::vector<uint8_t> writeCookedScene(const AssetRegistry::ImportedFile& imported, const CookedSceneStamp& stamp)
+{
+    std::vector<uint8_t> out{};
+    ByteWriter writer(out);
+    writer.pod(kCookedSceneMagic);
+    writer.pod(kCookedSceneVersion);
+    writer.pod(static_cast<uint32_t>(stamp.vertexFormat));
+    writer.pod(stamp.sourceSize);
+    writer.pod(stamp.sourceTime);
+    writer.pod(imported.contentHash);
+    writer.pod(imported.size);
+
+    const GlbScene& scene = imported.scene;
+    writer.pod(static_cast<uint32_t>(scene.nodes.size()));
+    for (const GlbNode& node : scene.nodes) {
+        writer.string(node.name);
+        writer.pod(node.parent);
+        writer.pod(node.mesh);
+        writer.pod(node.skin);
+        writer.pod(node.localMatrix);
+        writer.pod(node.translation);
+        writer.pod(node.rotation);
+        writer.pod(node.scale);
+    }
+    writer.pod(static_cast<uint32_t>(scene.meshes.size()));
+    for (const GlbMesh& mesh : scene.meshes) {
+        writer.pod(mesh);
+    }
+    writer.pod(static_cast<uint32_t>(scene.materials.size()));
+    for (const GlbMaterial& material : scene.materials) {
+        writer.string(material.name);
+        writer.pod(material.baseColorFactor);
+        writer.pod(material.baseColorImage);
+    }
+    writer.pod(static_cast<uint32_t>(scene.skins.size()));
+    for (const std::shared_ptr<const GlbSkin>& skin : scene.skins) {
+        writer.bytes(skin->joints.data(), skin->joints.size() * sizeof(uint32_t));
+        writer.bytes(skin->inverseBindMatrices.data(), skin->inverseBindMatrices.size() * sizeof(kGlbIdentityMatrix));
+    }
+    writer.pod(static_cast<uint32_t>(scene.animations.size()));
+    for (const std::shared_ptr<const GlbAnimation>& animation : scene.animations) {
+        writer.string(animation->name);
+        writer.pod(animation->duration);
+        writer.pod(static_cast<uint32_t>(animation->channels.size()));
+        for (const GlbAnimationChannel& channel : animation->channels) {
+            writer.pod(channel.node);
+            writer.pod(channel.path);
+            writer.pod(channel.interpolation);
+            writer.bytes(channel.times.data(), channel.times.size() * sizeof(float));
+            writer.bytes(channel.values.data(), channel.values.size() * sizeof(float));
+        }
+    }
+
+    // Indices are mesh-local, so each primitive is its own index-codec run.
+    writer.pod(static_cast<uint32_t>(scene.primitives.size()));
+    writer.pod(static_cast<uint32_t>(imported.indices.size()));
+    for (const GlbPrimitive& primitive : scene.primitives) {
+        const LoadedMesh& mesh = primitive.mesh;
+        writer.pod(mesh);
+        writer.pod(primitive.material);
+        const std::vector<uint8_t> encoded = encodeIndexBuffer(imported.indices.data() + mesh.firstIndex, mesh.indexCount);
+        writer.bytes(encoded.data(), encoded.size());
+    }
+
+    if (stamp.vertexFormat == VertexFormat::Float32) {
+        writeStream(writer, imported.vertices);
+    } else {
+        writeStream(writer, imported.compactVertices);
+    }
+    writeStream(writer, imported.meshlets);
+    writeStream(writer, imported.skinVertices);
+    return out;
+}
+
+std::optional<AssetRegistry::ImportedFile> readCookedScene(const std::string& path,
+    const uint8_t* data,
+    size_t size,
+    const CookedSceneStamp& stamp)
+{
+    ByteReader reader(data, size);
+    if (size < kCookedHeaderSize
+        || reader.pod<uint32_t>() != kCookedSceneMagic
+        || reader.pod<uint32_t>() != kCookedSceneVersion
+        || reader.pod<uint32_t>() != static_cast<uint32_t>(stamp.vertexFormat)
+        || reader.pod<uint64_t>() != stamp.sourceSize
+        || reader.pod<int64_t>() != stamp.sourceTime) {
+        return std::nullopt;
+    }
+
+    AssetRegistry::ImportedFile imported{ .path = path, .vertexFormat = stamp.vertexFormat };
+    imported.contentHash = reader.pod<uint64_t>();
+    imported.size = reader.pod<uint64_t>();
+
+    GlbScene& scene = imported.scene;
+    scene.nodes.resize(reader.count(sizeof(uint64_t) + 3 * sizeof(uint32_t) + sizeof(kGlbIdentityMatrix) + 10 * sizeof(float)));
+    for (GlbNode& node : scene.nodes) {
+        node.name = reader.string();
+        node.parent = reader.pod<uint32_t>();
+        node.mesh = reader.pod<uint32_t>();
+        node.skin = reader.pod<uint32_t>();
+        node.localMatrix = reader.pod<std::array<float, 16>>();
+        node.translation = reader.pod<std::array<float, 3>>();
+        node.rotation = reader.pod<std::array<float, 4>>();
+        node.scale = reader.pod<std::array<float, 3>>();
+    }
+    scene.meshes.resize(reader.count(sizeof(GlbMesh)));
+    for (GlbMesh& mesh : scene.meshes) {
+        mesh = reader.pod<GlbMesh>();
+    }
+    scene.materials.resize(reader.count(sizeof(uint64_t) + sizeof(GlbMaterial::baseColorFactor) + sizeof(uint32_t)));
+    for (GlbMaterial& material : scene.materials) {
+        material.name = reader.string();
+        material.baseColorFactor = reader.pod<std::array<float, 4>>();
+        material.baseColorImage = reader.pod<uint32_t>();
+    }
+    scene.skins.resize(reader.count(2 * sizeof(uint64_t)));
+    for (std::shared_ptr<const GlbSkin>& skin : scene.skins) {
+        auto result = std::make_shared<GlbSkin>();
+        size_t jointBytes = 0;
+        const uint8_t* joints = reader.bytes(jointBytes);
+        size_t matrixBytes = 0;
+        const uint8_t* matrices = reader.bytes(matrixBytes);
+        const size_t jointCount = jointBytes / sizeof(uint32_t);
+        if (jointBytes % sizeof(uint32_t) != 0 || matrixBytes != jointCount * sizeof(kGlbIdentityMatrix)) {
+            throw std::runtime_error("CookedScene: inconsistent skin");
+        }
+        result->joints.resize(jointCount);
+        result->inverseBindMatrices.resize(jointCount);
+        if (jointCount != 0) {
+            std::memcpy(result->joints.data(), joints, jointBytes);
+            std::memcpy(result->inverseBindMatrices.data(), matrices, matrixBytes);
+        }
+        for (const uint32_t joint : result->joints) {
+            if (joint >= scene.nodes.size()) {
+                throw std::runtime_error("CookedScene: skin joint out of range");
+            }
+        }
+        skin = std::move(result);
+    }
+    for (uint32_t n = 0; n < scene.nodes.size(); ++n) {
+        const GlbNode& node = scene.nodes[n];
+        if (node.parent != kNoGlbIndex && node.parent >= n) {
+            throw std::runtime_error("CookedScene: node parent out of range");
+        }
+        if (node.mesh != kNoGlbIndex && node.mesh >= scene.meshes.size()) {
+            throw std::runtime_error("CookedScene: node mesh out of range");
+        }
+        if (node.skin != kNoGlbIndex && node.skin >= scene.skins.size()) {
+            throw std::runtime_error("CookedScene: node skin out of range");
+        }
+    }
+    scene.animations.resize(reader.count(sizeof(uint64_t) + sizeof(float) + sizeof(uint32_t)));
+    for (std::shared_ptr<const GlbAnimation>& animation : scene.animations) {
+        auto clip = std::make_shared<GlbAnimation>();
+        clip->name = reader.string();
+        clip->duration = reader.pod<float>();
+        clip->channels.resize(reader.count(sizeof(uint32_t) + 2 + 2 * sizeof(uint64_t)));
+        for (GlbAnimationChannel& channel : clip->channels) {
+            channel.node = reader.pod<uint32_t>();
+            channel.path = reader.pod<GlbAnimationPath>();
+            channel.interpolation = reader.pod<GlbInterpolation>();
+            channel.times = readFloats(reader);
+            channel.values = readFloats(reader);
+            const size_t components = channel.path == GlbAnimationPath::Rotation ? 4 : 3;
+            const size_t valuesPerKey = channel.interpolation == GlbInterpolation::CubicSpline ? 3 : 1;
+            if (channel.node >= scene.nodes.size() || channel.path > GlbAnimationPath::Scale
+                || channel.interpolation > GlbInterpolation::CubicSpline || channel.times.empty()
+                || channel.values.size() != channel.times.size() * components * valuesPerKey) {
+                throw std::runtime_error("CookedScene: inconsistent animation channel");
+            }
+        }
+        animation = std::move(clip);
+    }
+
+    scene.primitives.resize(reader.count(sizeof(LoadedMesh) + sizeof(uint32_t) + sizeof(uint64_t)));
+    const uint32_t indexCount = reader.pod<uint32_t>();
+    if (indexCount > maxDecodedIndexCount(reader.remaining())) {
+        throw std::runtime_error("CookedScene: element count exceeds data");
+    }
+    imported.indices.resize(indexCount);
+    for (GlbPrimitive& primitive : scene.primitives) {
+        primitive.mesh = reader.pod<LoadedMesh>();
+        primitive.material = reader.pod<uint32_t>();
+        const LoadedMesh& mesh = primitive.mesh;
+        if (static_cast<uint64_t>(mesh.firstIndex) + mesh.indexCount > imported.indices.size()) {
+            throw std::runtime_error("CookedScene: primitive index range out of bounds");
+        }
+        size_t size = 0;
+        const uint8_t* data = reader.bytes(size);
+        decodeIndexBuffer(imported.indices.data() + mesh.firstIndex, mesh.indexCount, data, size);
+        // Indices are relative to the primitive's first vertex, as the .glb path validates them.
+        const auto decoded = std::span(imported.indices).subspan(mesh.firstIndex, mesh.indexCount);
+        if (std::ranges::any_of(decoded, [&](uint32_t index) { return index >= mesh.vertexCount; })) {
+            throw std::runtime_error("CookedScene: primitive index out of range");
+        }
+    }
+
+    if (stamp.vertexFormat == VertexFormat::Float32) {
+        readStream(reader, imported.vertices);
+    } else {
+        readStream(reader, imported.compactVertices);
+    }
+    readStream(reader, imported.meshlets);
+    readStream(reader, imported.skinVertices);
+    if (!reader.atEnd()) {
+        throw std::runtime_error("CookedScene: trailing data");
+    }
+
+    for (const GlbMesh& mesh : scene.meshes) {
+        if (static_cast<uint64_t>(mesh.firstPrimitive) + mesh.primitiveCount > scene.primitives.size()) {
+            throw std::runtime_error("CookedScene: mesh primitive range out of bounds");
+        }
+    }
+    const size_t vertexCount = stamp.vertexFormat == VertexFormat::Float32 ? imported.vertices.size() : imported.compactVertices.size();
+    for (const GlbPrimitive& primitive : scene.primitives) {
+        const LoadedMesh& mesh = primitive.mesh;
+        if (static_cast<uint64_t>(mesh.firstVertex) + mesh.vertexCount > vertexCount
+            || static_cast<uint64_t>(mesh.firstMeshlet) + mesh.meshletCount > imported.meshlets.size()
+            || (mesh.skinVertexCount != 0 && mesh.skinVertexCount != mesh.vertexCount)
+            || static_cast<uint64_t>(mesh.firstSkinVertex) + mesh.skinVertexCount > imported.skinVertices.size()) {
+            throw std::runtime_error("CookedScene: primitive range out of bounds");
+        }
+        const auto meshlets = std::span(imported.meshlets).subspan(mesh.firstMeshlet, mesh.meshletCount);
+        for (const MeshletPacket& meshlet : meshlets) {
+            if (meshlet.firstIndex < mesh.firstIndex
+                || static_cast<uint64_t>(meshlet.firstIndex) + meshlet.indexCount > static_cast<uint64_t>(mesh.firstIndex) + mesh.indexCount) {
+                throw std::runtime_error("CookedScene: meshlet index range out of bounds");
+            }
+        }
+    }
+    return imported;
+}
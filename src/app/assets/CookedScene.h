@@ -0,0 +1,31 @@
+#pragma once
+
+#include "AssetRegistry.h"
+
+#include <Engine.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Identifies the source a cooked scene was built from; a cooked file is only used while it matches.
+struct CookedSceneStamp {
+    uint64_t sourceSize{ 0 };
+    int64_t sourceTime{ 0 };
+    VertexFormat vertexFormat{ VertexFormat::Float32 };
+};
+
+[[nodiscard]] CookedSceneStamp stampSource(const std::string& path, VertexFormat vertexFormat);
+
+// The processed scene with its vertex, index and meshlet streams compressed by GeometryCodec, so a
+// load skips GLB parsing, optimization and meshlet building and reads a fraction of the bytes.
+[[nodiscard]] std::vector<uint8_t> writeCookedScene(const AssetRegistry::ImportedFile& imported, const CookedSceneStamp& stamp);
+
+// Empty when bytes were cooked from another source, vertex format or cook version; throws when the
+// data is corrupt. path is only copied into the result.
+[[nodiscard]] std::optional<AssetRegistry::ImportedFile> readCookedScene(const std::string& path,
+    const uint8_t* data,
+    size_t size,
+    const CookedSceneStamp& stamp);
@@ -0,0 +1,528 @@
+#include "GeometryCodec.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <stdexcept>
+#include <tuple>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GEOMETRY_CODEC_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+// Index code byte: the high nibble names an edge FIFO slot (kNoEdge when none matched), the low
+// nibble the third vertex: kNextVertex, 1 + a vertex FIFO slot, or kExplicitVertex followed by a
+// varint delta in the data section. Edge-less triangles code all three vertices in the data section.
+constexpr uint32_t kFifoSize = 16;
+constexpr uint32_t kEdgeSlots = 15;
+constexpr uint32_t kVertexSlots = 14;
+constexpr uint8_t kNoEdge = 15;
+constexpr uint8_t kNextVertex = 0;
+constexpr uint8_t kExplicitVertex = 15;
+constexpr uint32_t kUnusedIndex = 0xFFFFFFFFU;
+
+struct IndexCodecState {
+    std::array<std::array<uint32_t, 2>, kFifoSize> edges{};
+    std::array<uint32_t, kFifoSize> vertices{};
+    uint32_t edgeOffset{ 0 };
+    uint32_t vertexOffset{ 0 };
+    uint32_t next{ 0 };
+    uint32_t last{ 0 };
+
+    IndexCodecState()
+    {
+        edges.fill({ kUnusedIndex, kUnusedIndex });
+        vertices.fill(kUnusedIndex);
+    }
+
+    // Stored in the direction a neighbouring triangle walks the shared edge.
+    void pushEdge(uint32_t a, uint32_t b) noexcept
+    {
+        edges[edgeOffset] = { a, b };
+        edgeOffset = (edgeOffset + 1) % kFifoSize;
+    }
+
+    void pushVertex(uint32_t v) noexcept
+    {
+        vertices[vertexOffset] = v;
+        vertexOffset = (vertexOffset + 1) % kFifoSize;
+    }
+
+    [[nodiscard]] const std::array<uint32_t, 2>& edge(uint32_t slot) const noexcept
+    {
+        return edges[(edgeOffset + kFifoSize - 1 - slot) % kFifoSize];
+    }
+
+    [[nodiscard]] uint32_t vertex(uint32_t slot) const noexcept
+    {
+        return vertices[(vertexOffset + kFifoSize - 1 - slot) % kFifoSize];
+    }
+};
+
+void writeVarint(std::vector<uint8_t>& out, uint32_t value)
+{
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+uint32_t readVarint(const uint8_t*& cursor, const uint8_t* end)
+{
+    uint32_t value = 0;
+    for (uint32_t shift = 0; shift < 35; shift += 7) {
+        if (cursor == end) {
+            throw std::runtime_error("GeometryCodec: truncated index data");
+        }
+        const uint8_t byte = *cursor++;
+        value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return value;
+        }
+    }
+    throw std::runtime_error("GeometryCodec: malformed varint");
+}
+
+uint32_t zigzag(uint32_t delta) noexcept
+{
+    return (delta << 1) ^ (0U - (delta >> 31));
+}
+
+uint32_t unzigzag(uint32_t value) noexcept
+{
+    return (value >> 1) ^ (0U - (value & 1));
+}
+
+// Codes v and updates the vertex state; returns the nibble.
+uint8_t encodeVertex(IndexCodecState& state, uint32_t v, std::vector<uint8_t>& data)
+{
+    if (v == state.next) {
+        state.next += 1;
+        state.pushVertex(v);
+        return kNextVertex;
+    }
+    for (uint32_t slot = 0; slot < kVertexSlots; ++slot) {
+        if (state.vertex(slot) == v) {
+            return static_cast<uint8_t>(1 + slot);
+        }
+    }
+    writeVarint(data, zigzag(v - state.last));
+    state.last = v;
+    state.pushVertex(v);
+    return kExplicitVertex;
+}
+
+uint32_t decodeVertex(IndexCodecState& state, uint8_t code, const uint8_t*& cursor, const uint8_t* end)
+{
+    if (code == kNextVertex) {
+        const uint32_t v = state.next++;
+        state.pushVertex(v);
+        return v;
+    }
+    if (code != kExplicitVertex) {
+        return state.vertex(code - 1U);
+    }
+    const uint32_t v = state.last + unzigzag(readVarint(cursor, end));
+    state.last = v;
+    state.pushVertex(v);
+    return v;
+}
+
+constexpr size_t kVertexBlockSize = 256;
+constexpr size_t kVertexGroupSize = 16;
+
+uint8_t zigzag8(uint8_t delta) noexcept
+{
+    return static_cast<uint8_t>((delta << 1) ^ (0U - (delta >> 7)));
+}
+
+// Group modes: 0 all zero, 1 two bits, 2 four bits, 3 raw bytes. In the packed modes the largest
+// code is an escape whose value follows the packed bits, so a few outliers do not widen the group.
+constexpr std::array<size_t, 4> kGroupPackedBytes{ 0, 4, 8, 16 };
+constexpr std::array<uint8_t, 4> kGroupEscape{ 0, 3, 15, 0 };
+
+size_t escapeCount(const uint8_t* values, uint8_t escape) noexcept
+{
+    return static_cast<size_t>(std::count_if(values, values + kVertexGroupSize, [&](uint8_t value) { return value >= escape; }));
+}
+
+void encodeGroup(const uint8_t* values, std::vector<uint8_t>& out, uint8_t& mode)
+{
+    if (std::all_of(values, values + kVertexGroupSize, [](uint8_t value) { return value == 0; })) {
+        mode = 0;
+        return;
+    }
+
+    mode = 3;
+    size_t best = kGroupPackedBytes[3];
+    for (uint8_t candidate = 1; candidate <= 2; ++candidate) {
+        const size_t bytes = kGroupPackedBytes[candidate] + escapeCount(values, kGroupEscape[candidate]);
+        if (bytes < best) {
+            best = bytes;
+            mode = candidate;
+        }
+    }
+
+    if (mode == 3) {
+        out.insert(out.end(), values, values + kVertexGroupSize);
+        return;
+    }
+
+    const uint8_t escape = kGroupEscape[mode];
+    const uint32_t bits = mode == 1 ? 2 : 4;
+    const size_t packedAt = out.size();
+    out.resize(packedAt + kGroupPackedBytes[mode], 0);
+    for (size_t i = 0; i < kVertexGroupSize; ++i) {
+        const uint8_t code = std::min(values[i], escape);
+        const size_t bit = i * bits;
+        out[packedAt + bit / 8] = static_cast<uint8_t>(out[packedAt + bit / 8] | (code << (bit % 8)));
+    }
+    for (size_t i = 0; i < kVertexGroupSize; ++i) {
+        if (values[i] >= escape) {
+            out.push_back(values[i]);
+        }
+    }
+}
+
+#ifdef GEOMETRY_CODEC_SSE2
+__m128i unpackGroup(uint8_t mode, const uint8_t* payload)
+{
+    switch (mode) {
+    case 1: {
+        int32_t packed = 0;
+        std::memcpy(&packed, payload, sizeof(packed));
+        const __m128i bits = _mm_cvtsi32_si128(packed);
+        const __m128i mask = _mm_set1_epi8(3);
+        const __m128i v0 = _mm_and_si128(bits, mask);
+        const __m128i v1 = _mm_and_si128(_mm_srli_epi16(bits, 2), mask);
+        const __m128i v2 = _mm_and_si128(_mm_srli_epi16(bits, 4), mask);
+        const __m128i v3 = _mm_and_si128(_mm_srli_epi16(bits, 6), mask);
+        return _mm_unpacklo_epi16(_mm_unpacklo_epi8(v0, v1), _mm_unpacklo_epi8(v2, v3));
+    }
+    case 2: {
+        const __m128i bits = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(payload));
+        const __m128i mask = _mm_set1_epi8(15);
+        return _mm_unpacklo_epi8(_mm_and_si128(bits, mask), _mm_and_si128(_mm_srli_epi16(bits, 4), mask));
+    }
+    case 3:
+        return _mm_loadu_si128(reinterpret_cast<const __m128i*>(payload));
+    default:
+        return _mm_setzero_si128();
+    }
+}
+
+__m128i unzigzagBytes(__m128i value)
+{
+    const __m128i magnitude = _mm_and_si128(_mm_srli_epi16(value, 1), _mm_set1_epi8(0x7F));
+    const __m128i sign = _mm_sub_epi8(_mm_setzero_si128(), _mm_and_si128(value, _mm_set1_epi8(1)));
+    return _mm_xor_si128(magnitude, sign);
+}
+
+// Byte-wise running sum of four 4-byte vertex words, continuing from the last word of previous.
+__m128i prefixSum(__m128i words, __m128i previous)
+{
+    words = _mm_add_epi8(words, _mm_slli_si128(words, 4));
+    words = _mm_add_epi8(words, _mm_slli_si128(words, 8));
+    return _mm_add_epi8(words, _mm_shuffle_epi32(previous, 0xFF));
+}
+#else
+uint8_t unzigzag8(uint8_t value) noexcept
+{
+    return static_cast<uint8_t>((value >> 1) ^ (0U - (value & 1U)));
+}
+
+void unpackGroup(uint8_t mode, const uint8_t* payload, uint8_t* values)
+{
+    for (size_t i = 0; i < kVertexGroupSize; ++i) {
+        switch (mode) {
+        case 1: values[i] = static_cast<uint8_t>((payload[i / 4] >> ((i % 4) * 2)) & 3); break;
+        case 2: values[i] = static_cast<uint8_t>((payload[i / 2] >> ((i % 2) * 4)) & 15); break;
+        case 3: values[i] = payload[i]; break;
+        default: values[i] = 0; break;
+        }
+    }
+}
+#endif
+
+// Decodes one byte plane of a block: 2-bit group modes, then the group payloads.
+const uint8_t* decodePlane(const uint8_t* cursor, const uint8_t* end, size_t groupCount, uint8_t* plane)
+{
+    const size_t modeBytes = (groupCount + 3) / 4;
+    if (static_cast<size_t>(end - cursor) < modeBytes) {
+        throw std::runtime_error("GeometryCodec: truncated vertex data");
+    }
+    const uint8_t* modes = cursor;
+    cursor += modeBytes;
+
+    for (size_t group = 0; group < groupCount; ++group) {
+        const uint8_t mode = static_cast<uint8_t>((modes[group / 4] >> ((group % 4) * 2)) & 3);
+        if (static_cast<size_t>(end - cursor) < kGroupPackedBytes[mode]) {
+            throw std::runtime_error("GeometryCodec: truncated vertex data");
+        }
+        uint8_t* values = plane + group * kVertexGroupSize;
+#ifdef GEOMETRY_CODEC_SSE2
+        const __m128i unpacked = unpackGroup(mode, cursor);
+        _mm_store_si128(reinterpret_cast<__m128i*>(values), unpacked);
+        cursor += kGroupPackedBytes[mode];
+        if (mode == 1 || mode == 2) {
+            auto escapes = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(unpacked, _mm_set1_epi8(static_cast<char>(kGroupEscape[mode])))));
+            if (static_cast<size_t>(end - cursor) < static_cast<size_t>(std::popcount(escapes))) {
+                throw std::runtime_error("GeometryCodec: truncated vertex data");
+            }
+            for (; escapes != 0; escapes &= escapes - 1) {
+                values[std::countr_zero(escapes)] = *cursor++;
+            }
+        }
+#else
+        unpackGroup(mode, cursor, values);
+        cursor += kGroupPackedBytes[mode];
+        if (mode == 1 || mode == 2) {
+            for (size_t i = 0; i < kVertexGroupSize; ++i) {
+                if (values[i] == kGroupEscape[mode]) {
+                    if (cursor == end) {
+                        throw std::runtime_error("GeometryCodec: truncated vertex data");
+                    }
+                    values[i] = *cursor++;
+                }
+            }
+        }
+#endif
+    }
+    return cursor;
+}
+}
+
+std::vector<uint8_t> encodeIndexBuffer(const uint32_t* indices, size_t indexCount)
+{
+    if (indexCount % 3 != 0) {
+        throw std::runtime_error("GeometryCodec: index count must be a multiple of 3");
+    }
+
+    const size_t triangleCount = indexCount / 3;
+    std::vector<uint8_t> codes{};
+    std::vector<uint8_t> data{};
+    codes.reserve(triangleCount);
+
+    IndexCodecState state{};
+    for (size_t t = 0; t < triangleCount; ++t) {
+        uint32_t a = indices[t * 3 + 0];
+        uint32_t b = indices[t * 3 + 1];
+        uint32_t c = indices[t * 3 + 2];
+
+        uint32_t edgeSlot = kNoEdge;
+        for (uint32_t slot = 0; slot < kEdgeSlots && edgeSlot == kNoEdge; ++slot) {
+            const std::array<uint32_t, 2>& edge = state.edge(slot);
+            if (edge[0] == a && edge[1] == b) {
+                edgeSlot = slot;
+            } else if (edge[0] == b && edge[1] == c) {
+                edgeSlot = slot;
+                std::tie(a, b, c) = std::tuple{ b, c, a };
+            } else if (edge[0] == c && edge[1] == a) {
+                edgeSlot = slot;
+                std::tie(a, b, c) = std::tuple{ c, a, b };
+            }
+        }
+
+        if (edgeSlot != kNoEdge) {
+            const uint8_t third = encodeVertex(state, c, data);
+            codes.push_back(static_cast<uint8_t>((edgeSlot << 4) | third));
+            state.pushEdge(c, b);
+            state.pushEdge(a, c);
+        } else {
+            codes.push_back(static_cast<uint8_t>(kNoEdge << 4));
+            // Each nibble is appended before its own varint so the decoder can read them in order.
+            for (const uint32_t v : { a, b, c }) {
+                const size_t codeAt = data.size();
+                data.push_back(0);
+                data[codeAt] = encodeVertex(state, v, data);
+            }
+            state.pushEdge(b, a);
+            state.pushEdge(c, b);
+            state.pushEdge(a, c);
+        }
+    }
+
+    codes.insert(codes.end(), data.begin(), data.end());
+    return codes;
+}
+
+void decodeIndexBuffer(uint32_t* destination, size_t indexCount, const uint8_t* data, size_t size)
+{
+    if (indexCount % 3 != 0) {
+        throw std::runtime_error("GeometryCodec: index count must be a multiple of 3");
+    }
+
+    const size_t triangleCount = indexCount / 3;
+    if (size < triangleCount) {
+        throw std::runtime_error("GeometryCodec: truncated index codes");
+    }
+    const uint8_t* codes = data;
+    const uint8_t* cursor = data + triangleCount;
+    const uint8_t* end = data + size;
+
+    IndexCodecState state{};
+    for (size_t t = 0; t < triangleCount; ++t) {
+        const uint8_t code = codes[t];
+        const uint32_t edgeSlot = code >> 4;
+        uint32_t a = 0;
+        uint32_t b = 0;
+        uint32_t c = 0;
+
+        if (edgeSlot != kNoEdge) {
+            a = state.edge(edgeSlot)[0];
+            b = state.edge(edgeSlot)[1];
+            c = decodeVertex(state, static_cast<uint8_t>(code & 15), cursor, end);
+            state.pushEdge(c, b);
+            state.pushEdge(a, c);
+        } else {
+            std::array<uint32_t, 3> triangle{};
+            for (uint32_t& v : triangle) {
+                if (cursor == end) {
+                    throw std::runtime_error("GeometryCodec: truncated index data");
+                }
+                const uint8_t vertexCode = *cursor++;
+                if (vertexCode > kExplicitVertex) {
+                    throw std::runtime_error("GeometryCodec: malformed vertex code");
+                }
+                v = decodeVertex(state, vertexCode, cursor, end);
+            }
+            std::tie(a, b, c) = std::tuple{ triangle[0], triangle[1], triangle[2] };
+            state.pushEdge(b, a);
+            state.pushEdge(c, b);
+            state.pushEdge(a, c);
+        }
+
+        if (a == kUnusedIndex || b == kUnusedIndex || c == kUnusedIndex) {
+            throw std::runtime_error("GeometryCodec: reference to an empty FIFO slot");
+        }
+        destination[t * 3 + 0] = a;
+        destination[t * 3 + 1] = b;
+        destination[t * 3 + 2] = c;
+    }
+}
+
+// Every triangle takes at least its code byte.
+size_t maxDecodedIndexCount(size_t size) noexcept
+{
+    return size * 3;
+}
+
+std::vector<uint8_t> encodeVertexBuffer(const void* vertices, size_t vertexCount, size_t vertexSize)
+{
+    if (vertexSize == 0 || vertexSize % 4 != 0) {
+        throw std::runtime_error("GeometryCodec: vertex size must be a non-zero multiple of 4");
+    }
+
+    const uint8_t* source = static_cast<const uint8_t*>(vertices);
+    std::vector<uint8_t> out{};
+    std::vector<uint8_t> previous(vertexSize, 0);
+    std::array<uint8_t, kVertexBlockSize> plane{};
+    std::vector<uint8_t> payload{};
+
+    for (size_t blockStart = 0; blockStart < vertexCount; blockStart += kVertexBlockSize) {
+        const size_t count = std::min(kVertexBlockSize, vertexCount - blockStart);
+        const size_t groupCount = (count + kVertexGroupSize - 1) / kVertexGroupSize;
+
+        for (size_t k = 0; k < vertexSize; ++k) {
+            plane.fill(0);
+            for (size_t i = 0; i < count; ++i) {
+                const uint8_t value = source[(blockStart + i) * vertexSize + k];
+                plane[i] = zigzag8(static_cast<uint8_t>(value - previous[k]));
+                previous[k] = value;
+            }
+
+            std::vector<uint8_t> modes((groupCount + 3) / 4, 0);
+            payload.clear();
+            for (size_t group = 0; group < groupCount; ++group) {
+                uint8_t mode = 0;
+                encodeGroup(plane.data() + group * kVertexGroupSize, payload, mode);
+                modes[group / 4] = static_cast<uint8_t>(modes[group / 4] | (mode << ((group % 4) * 2)));
+            }
+            out.insert(out.end(), modes.begin(), modes.end());
+            out.insert(out.end(), payload.begin(), payload.end());
+        }
+    }
+    return out;
+}
+
+void decodeVertexBuffer(void* destination, size_t vertexCount, size_t vertexSize, const uint8_t* data, size_t size)
+{
+    if (vertexSize == 0 || vertexSize % 4 != 0) {
+        throw std::runtime_error("GeometryCodec: vertex size must be a non-zero multiple of 4");
+    }
+
+    uint8_t* target = static_cast<uint8_t*>(destination);
+    const uint8_t* cursor = data;
+    const uint8_t* end = data + size;
+    std::vector<uint32_t> previous(vertexSize / 4, 0);
+    alignas(16) std::array<std::array<uint8_t, kVertexBlockSize>, 4> planes{};
+
+    for (size_t blockStart = 0; blockStart < vertexCount; blockStart += kVertexBlockSize) {
+        const size_t count = std::min(kVertexBlockSize, vertexCount - blockStart);
+        const size_t groupCount = (count + kVertexGroupSize - 1) / kVertexGroupSize;
+
+        // Four byte planes make one 32-bit word per vertex, rebuilt 16 vertices at a time.
+        for (size_t word = 0; word < vertexSize / 4; ++word) {
+            for (auto& plane : planes) {
+                cursor = decodePlane(cursor, end, groupCount, plane.data());
+            }
+
+            uint8_t* out = target + blockStart * vertexSize + word * 4;
+#ifdef GEOMETRY_CODEC_SSE2
+            __m128i last = _mm_cvtsi32_si128(static_cast<int32_t>(previous[word]));
+            last = _mm_shuffle_epi32(last, 0x00);
+            for (size_t group = 0; group < groupCount; ++group) {
+                const size_t offset = group * kVertexGroupSize;
+                const __m128i p0 = unzigzagBytes(_mm_load_si128(reinterpret_cast<const __m128i*>(planes[0].data() + offset)));
+                const __m128i p1 = unzigzagBytes(_mm_load_si128(reinterpret_cast<const __m128i*>(planes[1].data() + offset)));
+                const __m128i p2 = unzigzagBytes(_mm_load_si128(reinterpret_cast<const __m128i*>(planes[2].data() + offset)));
+                const __m128i p3 = unzigzagBytes(_mm_load_si128(reinterpret_cast<const __m128i*>(planes[3].data() + offset)));
+
+                const __m128i low01 = _mm_unpacklo_epi8(p0, p1);
+                const __m128i high01 = _mm_unpackhi_epi8(p0, p1);
+                const __m128i low23 = _mm_unpacklo_epi8(p2, p3);
+                const __m128i high23 = _mm_unpackhi_epi8(p2, p3);
+                alignas(16) std::array<uint32_t, kVertexGroupSize> decoded{};
+                last = prefixSum(_mm_unpacklo_epi16(low01, low23), last);
+                _mm_store_si128(reinterpret_cast<__m128i*>(decoded.data() + 0), last);
+                last = prefixSum(_mm_unpackhi_epi16(low01, low23), last);
+                _mm_store_si128(reinterpret_cast<__m128i*>(decoded.data() + 4), last);
+                last = prefixSum(_mm_unpacklo_epi16(high01, high23), last);
+                _mm_store_si128(reinterpret_cast<__m128i*>(decoded.data() + 8), last);
+                last = prefixSum(_mm_unpackhi_epi16(high01, high23), last);
+                _mm_store_si128(reinterpret_cast<__m128i*>(decoded.data() + 12), last);
+
+                const size_t valid = std::min(kVertexGroupSize, count - offset);
+                for (size_t i = 0; i < valid; ++i) {
+                    std::memcpy(out + (offset + i) * vertexSize, &decoded[i], 4);
+                }
+            }
+            previous[word] = static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_shuffle_epi32(last, 0xFF)));
+#else
+            std::array<uint8_t, 4> value{};
+            std::memcpy(value.data(), &previous[word], 4);
+            for (size_t i = 0; i < count; ++i) {
+                for (size_t b = 0; b < 4; ++b) {
+                    value[b] = static_cast<uint8_t>(value[b] + unzigzag8(planes[b][i]));
+                }
+                std::memcpy(out + i * vertexSize, value.data(), 4);
+            }
+            std::memcpy(&previous[word], value.data(), 4);
+#endif
+        }
+    }
+
+    if (cursor != end) {
+        throw std::runtime_error("GeometryCodec: trailing vertex data");
+    }
+}
+
+// Every block of up to kVertexBlockSize vertices takes at least one mode byte per byte plane.
+size_t maxDecodedVertexCount(size_t size, size_t vertexSize) noexcept
+{
+    return vertexSize == 0 ? 0 : size / vertexSize * kVertexBlockSize;
+}
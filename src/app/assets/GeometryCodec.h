@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Lossless compression for cooked mesh streams, after meshoptimizer's index and vertex codecs.
+//
+// Index buffers are coded one triangle at a time against FIFOs of recent edges and vertices, so
+// cache-optimized lists mostly cost a byte per triangle. A triangle may decode rotated, (a, b, c)
+// as (b, c, a), which keeps its winding and every meshlet range.
+//
+// Vertex buffers are split into byte planes, delta coded against the previous vertex and packed
+// 16 vertices at a time into 0, 2, 4 or 8 bits per byte, with escapes for outliers. Decoding uses
+// SSE2 when available.
+
+[[nodiscard]] std::vector<uint8_t> encodeIndexBuffer(const uint32_t* indices, size_t indexCount);
+void decodeIndexBuffer(uint32_t* destination, size_t indexCount, const uint8_t* data, size_t size);
+// Most indices size coded bytes can decode to, for bounding a count before allocating for it.
+[[nodiscard]] size_t maxDecodedIndexCount(size_t size) noexcept;
+
+// vertexSize must be a multiple of 4.
+[[nodiscard]] std::vector<uint8_t> encodeVertexBuffer(const void* vertices, size_t vertexCount, size_t vertexSize);
+void decodeVertexBuffer(void* destination, size_t vertexCount, size_t vertexSize, const uint8_t* data, size_t size);
+[[nodiscard]] size_t maxDecodedVertexCount(size_t size, size_t vertexSize) noexcept;
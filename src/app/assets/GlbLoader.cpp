@@ -1,5 +1,7 @@
 #include "GlbLoader.h"
 
+#include "AssetArchive.h"
+
 #include <algorithm>
 #include <array>
 #include <cmath>
@@ -10,6 +12,7 @@
 #include <stdexcept>
 #include <string_view>
 #include <unordered_map>
+#include <utility>
 #include <variant>
 
 namespace {
@@ -158,6 +161,7 @@ uint32_t asU32(const JsonValue& value)
 size_t componentSize(uint32_t componentType)
 {
     switch (componentType) {
+    case 5121: return sizeof(uint8_t);
     case 5123: return sizeof(uint16_t);
     case 5125: return sizeof(uint32_t);
     case 5126: return sizeof(float);
@@ -171,6 +175,7 @@ size_t typeCount(const std::string& type)
     if (type == "VEC2") return 2;
     if (type == "VEC3") return 3;
     if (type == "VEC4") return 4;
+    if (type == "MAT4") return 16;
     throw std::runtime_error("Unsupported GLB accessor type");
 }
 
@@ -213,7 +218,7 @@ AccessorView getAccessor(const JsonObject& root, const std::vector<uint8_t>& bin
 std::array<float, 3> readVec3(const std::vector<uint8_t>& binChunk, const AccessorView& view, uint32_t index)
 {
     if (view.componentType != 5126 || view.type != "VEC3") {
-        throw std::runtime_error("Only FLOAT VEC3 POSITION attributes are supported");
+        throw std::runtime_error("Only FLOAT VEC3 POSITION/NORMAL attributes are supported");
     }
 
     std::array<float, 3> out{};
@@ -222,6 +227,18 @@ std::array<float, 3> readVec3(const std::vector<uint8_t>& binChunk, const Access
     return out;
 }
 
+std::array<float, 2> readVec2(const std::vector<uint8_t>& binChunk, const AccessorView& view, uint32_t index)
+{
+    if (view.componentType != 5126 || view.type != "VEC2") {
+        throw std::runtime_error("Only FLOAT VEC2 TEXCOORD_0 attributes are supported");
+    }
+
+    std::array<float, 2> out{};
+    const size_t offset = view.byteOffset + static_cast<size_t>(index) * view.byteStride;
+    std::memcpy(out.data(), binChunk.data() + offset, sizeof(float) * 2);
+    return out;
+}
+
 std::array<float, 3> readColor(const std::vector<uint8_t>& binChunk, const AccessorView& view, uint32_t index)
 {
     if (view.componentType != 5126 || (view.type != "VEC3" && view.type != "VEC4")) {
@@ -235,6 +252,50 @@ std::array<float, 3> readColor(const std::vector<uint8_t>& binChunk, const Acces
     return { color[0], color[1], color[2] };
 }
 
+std::array<uint16_t, 4> readJoints(const std::vector<uint8_t>& binChunk, const AccessorView& view, uint32_t index)
+{
+    if (view.type != "VEC4" || (view.componentType != 5121 && view.componentType != 5123)) {
+        throw std::runtime_error("Only UNSIGNED_BYTE / UNSIGNED_SHORT VEC4 JOINTS_0 attributes are supported");
+    }
+
+    const size_t offset = view.byteOffset + static_cast<size_t>(index) * view.byteStride;
+    std::array<uint16_t, 4> out{};
+    if (view.componentType == 5121) {
+        for (size_t i = 0; i < 4; ++i) {
+            out[i] = binChunk[offset + i];
+        }
+    } else {
+        std::memcpy(out.data(), binChunk.data() + offset, sizeof(uint16_t) * 4);
+    }
+    return out;
+}
+
+std::array<float, 4> readWeights(const std::vector<uint8_t>& binChunk, const AccessorView& view, uint32_t index)
+{
+    if (view.type != "VEC4") {
+        throw std::runtime_error("Only VEC4 WEIGHTS_0 attributes are supported");
+    }
+
+    const size_t offset = view.byteOffset + static_cast<size_t>(index) * view.byteStride;
+    std::array<float, 4> out{};
+    if (view.componentType == 5126) {
+        std::memcpy(out.data(), binChunk.data() + offset, sizeof(float) * 4);
+    } else if (view.componentType == 5121) {
+        for (size_t i = 0; i < 4; ++i) {
+            out[i] = static_cast<float>(binChunk[offset + i]) / 255.0F;
+        }
+    } else if (view.componentType == 5123) {
+        std::array<uint16_t, 4> raw{};
+        std::memcpy(raw.data(), binChunk.data() + offset, sizeof(uint16_t) * 4);
+        for (size_t i = 0; i < 4; ++i) {
+            out[i] = static_cast<float>(raw[i]) / 65535.0F;
+        }
+    } else {
+        throw std::runtime_error("Unsupported WEIGHTS_0 componentType");
+    }
+    return out;
+}
+
 uint32_t readIndex(const std::vector<uint8_t>& binChunk, const AccessorView& view, uint32_t index)
 {
     const size_t offset = view.byteOffset + static_cast<size_t>(index) * view.byteStride;
@@ -250,22 +311,67 @@ uint32_t readIndex(const std::vector<uint8_t>& binChunk, const AccessorView& vie
     }
     throw std::runtime_error("Only UNSIGNED_SHORT / UNSIGNED_INT indices are supported");
 }
-}
 
-LoadedMesh appendGlbMeshVertices(const std::string& path, std::vector<VertexPacket>& outVertices)
+// One vertex with every attribute the loader understands, before packing.
+struct SourceVertex {
+    std::array<float, 3> position{ 0.0F, 0.0F, 0.0F };
+    std::array<float, 3> normal{ 0.0F, 0.0F, 0.0F };
+    std::array<float, 3> color{ 1.0F, 1.0F, 1.0F };
+    std::array<float, 2> uv{ 0.0F, 0.0F };
+    std::array<uint16_t, 4> joints{ 0, 0, 0, 0 };
+    std::array<float, 4> weights{ 1.0F, 0.0F, 0.0F, 0.0F };
+};
+
+struct SourceMesh {
+    std::vector<SourceVertex> vertices{};
+    std::vector<uint32_t> indices{};
+    // Has JOINTS_0 and WEIGHTS_0.
+    bool skinned{ false };
+    MeshOptimizationStats optimization{};
+};
+
+void normalize(std::array<float, 3>& v)
 {
-    std::ifstream file(path, std::ios::binary | std::ios::ate);
-    if (!file) {
-        throw std::runtime_error("Unable to open GLB file: " + path);
+    const float length = std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+    if (length <= 0.0F) {
+        v = { 0.0F, 0.0F, 1.0F };
+        return;
     }
+    v = { v[0] / length, v[1] / length, v[2] / length };
+}
 
-    const std::streamsize size = file.tellg();
-    file.seekg(0, std::ios::beg);
-    std::vector<uint8_t> bytes(static_cast<size_t>(size));
-    if (!file.read(reinterpret_cast<char*>(bytes.data()), size)) {
-        throw std::runtime_error("Failed to read GLB file: " + path);
+// Area-weighted smooth normals for primitives exported without NORMAL.
+void generateNormals(SourceMesh& mesh)
+{
+    for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3) {
+        SourceVertex& a = mesh.vertices[mesh.indices[i]];
+        SourceVertex& b = mesh.vertices[mesh.indices[i + 1]];
+        SourceVertex& c = mesh.vertices[mesh.indices[i + 2]];
+        const std::array<float, 3> e0{ b.position[0] - a.position[0], b.position[1] - a.position[1], b.position[2] - a.position[2] };
+        const std::array<float, 3> e1{ c.position[0] - a.position[0], c.position[1] - a.position[1], c.position[2] - a.position[2] };
+        const std::array<float, 3> n{
+            e0[1] * e1[2] - e0[2] * e1[1],
+            e0[2] * e1[0] - e0[0] * e1[2],
+            e0[0] * e1[1] - e0[1] * e1[0]
+        };
+        for (SourceVertex* vertex : { &a, &b, &c }) {
+            vertex->normal[0] += n[0];
+            vertex->normal[1] += n[1];
+            vertex->normal[2] += n[2];
+        }
+    }
+    for (SourceVertex& vertex : mesh.vertices) {
+        normalize(vertex.normal);
     }
+}
+
+struct GlbDocument {
+    JsonObject root{};
+    std::vector<uint8_t> binChunk{};
+};
 
+GlbDocument parseGlbDocument(const std::vector<uint8_t>& bytes)
+{
     if (bytes.size() < 20) {
         throw std::runtime_error("Invalid GLB file (too small)");
     }
@@ -292,13 +398,22 @@ LoadedMesh appendGlbMeshVertices(const std::string& path, std::vector<VertexPack
     if (binType != 0x004E4942) {
         throw std::runtime_error("Missing BIN chunk in GLB file");
     }
-    std::vector<uint8_t> binChunk(binLength);
-    std::memcpy(binChunk.data(), bytes.data() + cursor, binLength);
+    GlbDocument document{};
+    document.binChunk.resize(binLength);
+    std::memcpy(document.binChunk.data(), bytes.data() + cursor, binLength);
+    document.root = JsonParser(jsonText).parseValue().asObject();
+    return document;
+}
 
-    const JsonObject root = JsonParser(jsonText).parseValue().asObject();
-    const auto& meshes = expectField<JsonValue>(root, "meshes").asArray();
-    const auto& mesh = meshes.at(0).asObject();
-    const auto& primitive = expectField<JsonValue>(mesh, "primitives").asArray().at(0).asObject();
+GlbDocument readGlbDocument(const std::string& path)
+{
+    return parseGlbDocument(readBinaryFile(path));
+}
+
+SourceMesh readGlbPrimitive(const GlbDocument& document, const JsonObject& primitive)
+{
+    const JsonObject& root = document.root;
+    const std::vector<uint8_t>& binChunk = document.binChunk;
     const auto& attributes = expectField<JsonValue>(primitive, "attributes").asObject();
 
     const uint32_t positionAccessorIndex = asU32(expectField<JsonValue>(attributes, "POSITION"));
@@ -309,30 +424,741 @@ LoadedMesh appendGlbMeshVertices(const std::string& path, std::vector<VertexPack
         ? getAccessor(root, binChunk, asU32(attributes.at("COLOR_0")))
         : AccessorView{};
 
-    const uint32_t firstVertex = static_cast<uint32_t>(outVertices.size());
+    const bool hasNormalAttribute = attributes.contains("NORMAL");
+    const AccessorView normalAccessor = hasNormalAttribute
+        ? getAccessor(root, binChunk, asU32(attributes.at("NORMAL")))
+        : AccessorView{};
 
-    auto emitVertex = [&](uint32_t index) {
-        const auto p = readVec3(binChunk, positionAccessor, index);
-        const std::array<float, 3> color = hasColorAttribute
-            ? readColor(binChunk, colorAccessor, index)
-            : std::array<float, 3>{ 1.0F, 1.0F, 1.0F };
-        outVertices.push_back(VertexPacket{ .position = p, .color = color });
-    };
+    const bool hasUvAttribute = attributes.contains("TEXCOORD_0");
+    const AccessorView uvAccessor = hasUvAttribute
+        ? getAccessor(root, binChunk, asU32(attributes.at("TEXCOORD_0")))
+        : AccessorView{};
+
+    const bool hasSkinAttributes = attributes.contains("JOINTS_0") && attributes.contains("WEIGHTS_0");
+    const AccessorView jointAccessor = hasSkinAttributes
+        ? getAccessor(root, binChunk, asU32(attributes.at("JOINTS_0")))
+        : AccessorView{};
+    const AccessorView weightAccessor = hasSkinAttributes
+        ? getAccessor(root, binChunk, asU32(attributes.at("WEIGHTS_0")))
+        : AccessorView{};
+    if (hasSkinAttributes && (jointAccessor.count != positionAccessor.count || weightAccessor.count != positionAccessor.count)) {
+        throw std::runtime_error("GLB JOINTS_0/WEIGHTS_0 count differs from POSITION count");
+    }
+
+    SourceMesh out{};
+    out.skinned = hasSkinAttributes;
+    out.vertices.resize(positionAccessor.count);
+    for (uint32_t i = 0; i < positionAccessor.count; ++i) {
+        SourceVertex& vertex = out.vertices[i];
+        vertex.position = readVec3(binChunk, positionAccessor, i);
+        if (hasNormalAttribute) {
+            vertex.normal = readVec3(binChunk, normalAccessor, i);
+        }
+        if (hasColorAttribute) {
+            vertex.color = readColor(binChunk, colorAccessor, i);
+        }
+        if (hasUvAttribute) {
+            vertex.uv = readVec2(binChunk, uvAccessor, i);
+        }
+        if (hasSkinAttributes) {
+            vertex.joints = readJoints(binChunk, jointAccessor, i);
+            vertex.weights = readWeights(binChunk, weightAccessor, i);
+        }
+    }
 
     if (primitive.contains("indices")) {
         const uint32_t indexAccessorIndex = asU32(primitive.at("indices"));
         const AccessorView indexAccessor = getAccessor(root, binChunk, indexAccessorIndex);
+        out.indices.resize(indexAccessor.count);
         for (uint32_t i = 0; i < indexAccessor.count; ++i) {
-            emitVertex(readIndex(binChunk, indexAccessor, i));
+            out.indices[i] = readIndex(binChunk, indexAccessor, i);
         }
     } else {
+        out.indices.resize(positionAccessor.count);
         for (uint32_t i = 0; i < positionAccessor.count; ++i) {
-            emitVertex(i);
+            out.indices[i] = i;
+        }
+    }
+
+    if (!hasNormalAttribute) {
+        generateNormals(out);
+    }
+
+    return out;
+}
+
+// Cache order first, then overdraw clusters (which keep the cache order inside each cluster), then
+// renumber vertices in first-use order so vertex fetch walks memory linearly.
+void optimizeMesh(SourceMesh& mesh)
+{
+    const uint32_t vertexCount = static_cast<uint32_t>(mesh.vertices.size());
+    mesh.optimization.before = analyzeVertexCache(mesh.indices, vertexCount);
+
+    std::vector<std::array<float, 3>> positions(mesh.vertices.size());
+    for (size_t i = 0; i < mesh.vertices.size(); ++i) {
+        positions[i] = mesh.vertices[i].position;
+    }
+
+    mesh.indices = optimizeOverdraw(optimizeVertexCache(mesh.indices, vertexCount), positions);
+
+    uint32_t uniqueVertexCount = 0;
+    const std::vector<uint32_t> remap = buildVertexFetchRemap(mesh.indices, vertexCount, uniqueVertexCount);
+    std::vector<SourceVertex> remapped(uniqueVertexCount);
+    for (uint32_t v = 0; v < vertexCount; ++v) {
+        if (remap[v] != kUnusedVertex) {
+            remapped[remap[v]] = mesh.vertices[v];
         }
     }
+    mesh.vertices = std::move(remapped);
+    for (uint32_t& index : mesh.indices) {
+        index = remap[index];
+    }
+
+    mesh.optimization.after = analyzeVertexCache(mesh.indices, uniqueVertexCount);
+}
+
+const JsonObject& firstPrimitive(const JsonObject& root)
+{
+    const auto& mesh = expectField<JsonValue>(root, "meshes").asArray().at(0).asObject();
+    return expectField<JsonValue>(mesh, "primitives").asArray().at(0).asObject();
+}
+
+SourceMesh loadOptimizedGlbPrimitive(const GlbDocument& document, const JsonObject& primitive)
+{
+    SourceMesh mesh = readGlbPrimitive(document, primitive);
+    optimizeMesh(mesh);
+    return mesh;
+}
+
+// Meshlets are cut from the optimized triangle order in object space, so their bounds stay valid
+// for compact formats (the dequant transform is applied after culling, see DrawPacket::cullMvp).
+LoadedMesh appendIndices(const SourceMesh& source, std::vector<uint32_t>& outIndices, std::vector<MeshletPacket>& outMeshlets, uint32_t firstVertex)
+{
+    LoadedMesh mesh{};
+    mesh.firstVertex = firstVertex;
+    mesh.vertexCount = static_cast<uint32_t>(source.vertices.size());
+    mesh.firstIndex = static_cast<uint32_t>(outIndices.size());
+    mesh.indexCount = static_cast<uint32_t>(source.indices.size());
+    mesh.optimization = source.optimization;
+    outIndices.insert(outIndices.end(), source.indices.begin(), source.indices.end());
+
+    std::vector<std::array<float, 3>> positions(source.vertices.size());
+    for (size_t i = 0; i < source.vertices.size(); ++i) {
+        positions[i] = source.vertices[i].position;
+    }
+    std::vector<MeshletPacket> meshlets = buildMeshlets(source.indices, positions, &mesh.meshlets);
+    for (MeshletPacket& meshlet : meshlets) {
+        meshlet.firstIndex += mesh.firstIndex;
+    }
+    mesh.firstMeshlet = static_cast<uint32_t>(outMeshlets.size());
+    mesh.meshletCount = static_cast<uint32_t>(meshlets.size());
+    outMeshlets.insert(outMeshlets.end(), meshlets.begin(), meshlets.end());
+    return mesh;
+}
+
+MeshBounds computeBounds(const std::vector<SourceVertex>& vertices)
+{
+    if (vertices.empty()) {
+        return MeshBounds{};
+    }
 
-    return LoadedMesh{
-        .firstVertex = firstVertex,
-        .vertexCount = static_cast<uint32_t>(outVertices.size()) - firstVertex,
+    MeshBounds bounds{ .min = vertices.front().position, .max = vertices.front().position };
+    for (const SourceVertex& vertex : vertices) {
+        for (size_t axis = 0; axis < 3; ++axis) {
+            bounds.min[axis] = std::min(bounds.min[axis], vertex.position[axis]);
+            bounds.max[axis] = std::max(bounds.max[axis], vertex.position[axis]);
+        }
+    }
+    return bounds;
+}
+
+float maxAbsDifference(const float* a, const float* b, size_t count)
+{
+    float result = 0.0F;
+    for (size_t i = 0; i < count; ++i) {
+        result = std::max(result, std::abs(a[i] - b[i]));
+    }
+    return result;
+}
+
+void setBoundingSphere(LoadedMesh& mesh, const MeshBounds& bounds)
+{
+    const std::array<float, 3> half = bounds.halfExtent();
+    mesh.boundsCenter = bounds.center();
+    mesh.boundsRadius = std::sqrt(half[0] * half[0] + half[1] * half[1] + half[2] * half[2]);
+}
+
+float angleDegrees(const std::array<float, 3>& a, const std::array<float, 3>& b)
+{
+    const float lengthA = std::sqrt(a[0] * a[0] + a[1] * a[1] + a[2] * a[2]);
+    const float lengthB = std::sqrt(b[0] * b[0] + b[1] * b[1] + b[2] * b[2]);
+    if (lengthA <= 0.0F || lengthB <= 0.0F) {
+        return 0.0F;
+    }
+    const float cosine = std::clamp((a[0] * b[0] + a[1] * b[1] + a[2] * b[2]) / (lengthA * lengthB), -1.0F, 1.0F);
+    return std::acos(cosine) * (180.0F / 3.14159265358979F);
+}
+
+LoadedMesh appendSourceMesh(const SourceMesh& source, std::vector<VertexPacket>& outVertices, std::vector<uint32_t>& outIndices, std::vector<MeshletPacket>& outMeshlets)
+{
+    LoadedMesh mesh = appendIndices(source, outIndices, outMeshlets, static_cast<uint32_t>(outVertices.size()));
+    setBoundingSphere(mesh, computeBounds(source.vertices));
+    mesh.quantization.bytesPerVertex = sizeof(VertexPacket);
+
+    outVertices.reserve(outVertices.size() + source.vertices.size());
+    for (const SourceVertex& vertex : source.vertices) {
+        outVertices.push_back(VertexPacket{ .position = vertex.position, .color = vertex.color });
+    }
+    return mesh;
+}
+
+LoadedMesh appendSourceMesh(const SourceMesh& source,
+    VertexFormat format,
+    std::vector<CompactVertexPacket>& outVertices,
+    std::vector<uint32_t>& outIndices,
+    std::vector<MeshletPacket>& outMeshlets)
+{
+    const MeshBounds bounds = computeBounds(source.vertices);
+    LoadedMesh mesh = appendIndices(source, outIndices, outMeshlets, static_cast<uint32_t>(outVertices.size()));
+    mesh.dequantScale = bounds.halfExtent();
+    mesh.dequantOffset = bounds.center();
+    setBoundingSphere(mesh, bounds);
+    mesh.quantization.bytesPerVertex = sizeof(CompactVertexPacket);
+
+    outVertices.reserve(outVertices.size() + source.vertices.size());
+    for (const SourceVertex& vertex : source.vertices) {
+        const CompactVertexPacket packed = quantizeVertex(format, bounds, vertex.position, vertex.normal, vertex.color, vertex.uv);
+        outVertices.push_back(packed);
+
+        const std::array<float, 3> position = dequantizePosition(format, bounds, packed);
+        const std::array<float, 3> color = dequantizeColor(packed);
+        const std::array<float, 2> uv = dequantizeUv(packed);
+        QuantizationReport& report = mesh.quantization;
+        report.maxPositionError = std::max(report.maxPositionError, maxAbsDifference(position.data(), vertex.position.data(), 3));
+        report.maxNormalErrorDegrees = std::max(report.maxNormalErrorDegrees, angleDegrees(dequantizeNormal(packed), vertex.normal));
+        report.maxColorError = std::max(report.maxColorError, maxAbsDifference(color.data(), vertex.color.data(), 3));
+        report.maxUvError = std::max(report.maxUvError, maxAbsDifference(uv.data(), vertex.uv.data(), 2));
+    }
+
+    return mesh;
+}
+
+// Weights renormalized and rounded to unorm16 so that each vertex sums to exactly 65535; the
+// rounding remainder goes to the largest weight. Weightless vertices bind fully to joint 0.
+SkinVertexPacket packSkinVertex(const SourceVertex& vertex)
+{
+    float sum = 0.0F;
+    for (const float weight : vertex.weights) {
+        sum += std::max(weight, 0.0F);
+    }
+    if (sum <= 0.0F) {
+        return SkinVertexPacket{ .joints = vertex.joints };
+    }
+
+    SkinVertexPacket out{ .joints = vertex.joints };
+    uint32_t total = 0;
+    size_t largest = 0;
+    for (size_t i = 0; i < 4; ++i) {
+        out.weights[i] = static_cast<uint16_t>(std::lround(std::max(vertex.weights[i], 0.0F) / sum * 65535.0F));
+        total += out.weights[i];
+        if (out.weights[i] > out.weights[largest]) {
+            largest = i;
+        }
+    }
+    out.weights[largest] = static_cast<uint16_t>(static_cast<int32_t>(out.weights[largest]) + 65535 - static_cast<int32_t>(total));
+    return out;
+}
+
+void appendSkinVertices(const SourceMesh& source, LoadedMesh& mesh, std::vector<SkinVertexPacket>& outSkinVertices)
+{
+    if (!source.skinned) {
+        return;
+    }
+    mesh.firstSkinVertex = static_cast<uint32_t>(outSkinVertices.size());
+    mesh.skinVertexCount = mesh.vertexCount;
+    outSkinVertices.reserve(outSkinVertices.size() + source.vertices.size());
+    for (const SourceVertex& vertex : source.vertices) {
+        outSkinVertices.push_back(packSkinVertex(vertex));
+    }
+}
+
+GlbImage readImage(const GlbDocument& document, const std::string& path, uint32_t imageIndex)
+{
+    const JsonObject& root = document.root;
+    const auto& image = expectField<JsonValue>(root, "images").asArray().at(imageIndex).asObject();
+
+    GlbImage out{};
+    out.mimeType = image.contains("mimeType") ? image.at("mimeType").asString() : std::string{};
+
+    if (image.contains("bufferView")) {
+        const auto& view = expectField<JsonValue>(root, "bufferViews").asArray().at(asU32(image.at("bufferView"))).asObject();
+        const uint32_t offset = view.contains("byteOffset") ? asU32(view.at("byteOffset")) : 0;
+        const uint32_t length = asU32(expectField<JsonValue>(view, "byteLength"));
+        if (static_cast<uint64_t>(offset) + length > document.binChunk.size()) {
+            throw std::runtime_error("Image bufferView exceeds GLB BIN chunk");
+        }
+        out.bytes.assign(document.binChunk.begin() + offset, document.binChunk.begin() + offset + length);
+        return out;
+    }
+
+    const std::string& uri = expectField<JsonValue>(image, "uri").asString();
+    if (uri.starts_with("data:")) {
+        throw std::runtime_error("Data URI images are not supported: " + path);
+    }
+    const size_t slash = path.find_last_of("/\\");
+    out.bytes = readBinaryFile(slash == std::string::npos ? uri : path.substr(0, slash + 1) + uri);
+    return out;
+}
+
+// Image index of a material's baseColorTexture, or kNoGlbIndex.
+uint32_t baseColorImageIndex(const JsonObject& root, const JsonObject& material)
+{
+    if (!material.contains("pbrMetallicRoughness")) {
+        return kNoGlbIndex;
+    }
+    const auto& pbr = material.at("pbrMetallicRoughness").asObject();
+    if (!pbr.contains("baseColorTexture")) {
+        return kNoGlbIndex;
+    }
+    const uint32_t textureIndex = asU32(expectField<JsonValue>(pbr.at("baseColorTexture").asObject(), "index"));
+    const auto& texture = expectField<JsonValue>(root, "textures").asArray().at(textureIndex).asObject();
+    return texture.contains("source") ? asU32(texture.at("source")) : kNoGlbIndex;
+}
+
+template <size_t N>
+std::array<float, N> readNumbers(const JsonObject& obj, const std::string& field, const std::array<float, N>& fallback)
+{
+    if (!obj.contains(field)) {
+        return fallback;
+    }
+    const JsonArray& values = obj.at(field).asArray();
+    if (values.size() != N) {
+        throw std::runtime_error("Unexpected GLB array length for field: " + field);
+    }
+    std::array<float, N> out{};
+    for (size_t i = 0; i < N; ++i) {
+        out[i] = static_cast<float>(values[i].asNumber());
+    }
+    return out;
+}
+
+GlbMaterial readMaterial(const JsonObject& root, const JsonObject& material)
+{
+    GlbMaterial out{};
+    out.name = material.contains("name") ? material.at("name").asString() : std::string{};
+    if (material.contains("pbrMetallicRoughness")) {
+        out.baseColorFactor = readNumbers<4>(material.at("pbrMetallicRoughness").asObject(), "baseColorFactor", out.baseColorFactor);
+    }
+    out.baseColorImage = baseColorImageIndex(root, material);
+    return out;
+}
+
+// Column-major T * R * S, with the rotation as an (x, y, z, w) quaternion.
+std::array<float, 16> composeNodeMatrix(const std::array<float, 3>& t, const std::array<float, 4>& q, const std::array<float, 3>& s)
+{
+    const float x = q[0];
+    const float y = q[1];
+    const float z = q[2];
+    const float w = q[3];
+
+    return {
+        (1.0F - 2.0F * (y * y + z * z)) * s[0], 2.0F * (x * y + z * w) * s[0], 2.0F * (x * z - y * w) * s[0], 0.0F,
+        2.0F * (x * y - z * w) * s[1], (1.0F - 2.0F * (x * x + z * z)) * s[1], 2.0F * (y * z + x * w) * s[1], 0.0F,
+        2.0F * (x * z + y * w) * s[2], 2.0F * (y * z - x * w) * s[2], (1.0F - 2.0F * (x * x + y * y)) * s[2], 0.0F,
+        t[0], t[1], t[2], 1.0F
     };
 }
+
+// Either the node's matrix or its translation, rotation and scale.
+void readNodePose(const JsonObject& node, GlbNode& out)
+{
+    if (node.contains("matrix")) {
+        out.localMatrix = readNumbers<16>(node, "matrix", kGlbIdentityMatrix);
+        return;
+    }
+    out.translation = readNumbers<3>(node, "translation", out.translation);
+    out.rotation = readNumbers<4>(node, "rotation", out.rotation);
+    out.scale = readNumbers<3>(node, "scale", out.scale);
+    out.localMatrix = composeNodeMatrix(out.translation, out.rotation, out.scale);
+}
+
+// Nodes reachable from the default scene (or every parentless node when the file has no scenes),
+// depth-first so each parent precedes its children. outSceneIndices maps glTF node indices to
+// indices in the result, kNoGlbIndex for nodes outside the scene.
+std::vector<GlbNode> readNodeHierarchy(const JsonObject& root, std::vector<uint32_t>& outSceneIndices)
+{
+    outSceneIndices.clear();
+    if (!root.contains("nodes")) {
+        return {};
+    }
+    const JsonArray& nodes = root.at("nodes").asArray();
+    outSceneIndices.assign(nodes.size(), kNoGlbIndex);
+
+    std::vector<uint32_t> roots{};
+    if (root.contains("scenes")) {
+        const uint32_t sceneIndex = root.contains("scene") ? asU32(root.at("scene")) : 0;
+        const auto& scene = root.at("scenes").asArray().at(sceneIndex).asObject();
+        if (scene.contains("nodes")) {
+            for (const JsonValue& node : scene.at("nodes").asArray()) {
+                roots.push_back(asU32(node));
+            }
+        }
+    } else {
+        std::vector<bool> isChild(nodes.size(), false);
+        for (const JsonValue& node : nodes) {
+            const JsonObject& object = node.asObject();
+            if (object.contains("children")) {
+                for (const JsonValue& child : object.at("children").asArray()) {
+                    isChild.at(asU32(child)) = true;
+                }
+            }
+        }
+        for (uint32_t i = 0; i < nodes.size(); ++i) {
+            if (!isChild[i]) {
+                roots.push_back(i);
+            }
+        }
+    }
+
+    std::vector<GlbNode> out{};
+    out.reserve(nodes.size());
+    std::vector<bool> visited(nodes.size(), false);
+    // (glTF node index, parent index in out)
+    std::vector<std::pair<uint32_t, uint32_t>> stack{};
+    for (auto it = roots.rbegin(); it != roots.rend(); ++it) {
+        stack.emplace_back(*it, kNoGlbIndex);
+    }
+
+    while (!stack.empty()) {
+        const auto [nodeIndex, parent] = stack.back();
+        stack.pop_back();
+        if (nodeIndex >= nodes.size()) {
+            throw std::runtime_error("GLB node index out of range");
+        }
+        if (visited[nodeIndex]) {
+            throw std::runtime_error("GLB node hierarchy is not a tree");
+        }
+        visited[nodeIndex] = true;
+
+        const JsonObject& node = nodes[nodeIndex].asObject();
+        const uint32_t self = static_cast<uint32_t>(out.size());
+        outSceneIndices[nodeIndex] = self;
+        GlbNode& added = out.emplace_back(GlbNode{
+            .name = node.contains("name") ? node.at("name").asString() : std::string{},
+            .parent = parent,
+            .mesh = node.contains("mesh") ? asU32(node.at("mesh")) : kNoGlbIndex,
+            .skin = node.contains("skin") ? asU32(node.at("skin")) : kNoGlbIndex });
+        readNodePose(node, added);
+
+        if (node.contains("children")) {
+            const JsonArray& children = node.at("children").asArray();
+            for (auto it = children.rbegin(); it != children.rend(); ++it) {
+                stack.emplace_back(asU32(*it), self);
+            }
+        }
+    }
+    return out;
+}
+
+std::vector<float> readFloats(const GlbDocument& document, uint32_t accessorIndex, size_t components)
+{
+    const AccessorView view = getAccessor(document.root, document.binChunk, accessorIndex);
+    if (view.componentType != 5126 || typeCount(view.type) != components) {
+        throw std::runtime_error("Only FLOAT animation sampler and inverse bind matrix accessors are supported");
+    }
+    std::vector<float> out(static_cast<size_t>(view.count) * components);
+    for (uint32_t i = 0; i < view.count; ++i) {
+        const size_t offset = view.byteOffset + static_cast<size_t>(i) * view.byteStride;
+        std::memcpy(out.data() + static_cast<size_t>(i) * components, document.binChunk.data() + offset, sizeof(float) * components);
+    }
+    return out;
+}
+
+// Translation, rotation and scale channels targeting nodes of the default scene; morph target
+// weights are not supported and skipped.
+std::vector<std::shared_ptr<const GlbAnimation>> readAnimations(const GlbDocument& document, const std::vector<uint32_t>& sceneIndices)
+{
+    const JsonObject& root = document.root;
+    std::vector<std::shared_ptr<const GlbAnimation>> out{};
+    if (!root.contains("animations")) {
+        return out;
+    }
+
+    for (const JsonValue& animationValue : root.at("animations").asArray()) {
+        const JsonObject& animation = animationValue.asObject();
+        const JsonArray& samplers = expectField<JsonArray>(animation, "samplers").asArray();
+        auto clip = std::make_shared<GlbAnimation>();
+        clip->name = animation.contains("name") ? animation.at("name").asString() : std::string{};
+
+        for (const JsonValue& channelValue : expectField<JsonArray>(animation, "channels").asArray()) {
+            const JsonObject& channel = channelValue.asObject();
+            const JsonObject& target = expectField<JsonObject>(channel, "target").asObject();
+            if (!target.contains("node")) {
+                continue;
+            }
+            const uint32_t node = asU32(target.at("node"));
+            if (node >= sceneIndices.size()) {
+                throw std::runtime_error("GLB animation targets a missing node");
+            }
+            const std::string& pathName = expectField<JsonValue>(target, "path").asString();
+            if (sceneIndices[node] == kNoGlbIndex || (pathName != "translation" && pathName != "rotation" && pathName != "scale")) {
+                continue;
+            }
+
+            GlbAnimationChannel track{ .node = sceneIndices[node], .path = GlbAnimationPath::Scale };
+            if (pathName == "translation") {
+                track.path = GlbAnimationPath::Translation;
+            } else if (pathName == "rotation") {
+                track.path = GlbAnimationPath::Rotation;
+            }
+            const JsonObject& sampler = samplers.at(asU32(expectField<JsonValue>(channel, "sampler"))).asObject();
+            const std::string interpolation = sampler.contains("interpolation") ? sampler.at("interpolation").asString() : "LINEAR";
+            if (interpolation == "STEP") {
+                track.interpolation = GlbInterpolation::Step;
+            } else if (interpolation == "CUBICSPLINE") {
+                track.interpolation = GlbInterpolation::CubicSpline;
+            } else if (interpolation != "LINEAR") {
+                throw std::runtime_error("Unsupported GLB animation interpolation: " + interpolation);
+            }
+
+            const size_t components = track.path == GlbAnimationPath::Rotation ? 4 : 3;
+            const size_t valuesPerKey = track.interpolation == GlbInterpolation::CubicSpline ? 3 : 1;
+            track.times = readFloats(document, asU32(expectField<JsonValue>(sampler, "input")), 1);
+            track.values = readFloats(document, asU32(expectField<JsonValue>(sampler, "output")), components);
+            if (track.times.empty() || track.values.size() != track.times.size() * components * valuesPerKey
+                || !std::ranges::is_sorted(track.times)) {
+                throw std::runtime_error("GLB animation sampler keys are inconsistent");
+            }
+            clip->duration = std::max(clip->duration, track.times.back());
+            clip->channels.push_back(std::move(track));
+        }
+
+        if (!clip->channels.empty()) {
+            out.push_back(std::move(clip));
+        }
+    }
+    return out;
+}
+
+// Joints are remapped to scene node indices; kNoGlbIndex marks joints outside the default scene,
+// which loadScene rejects for skins a scene node actually uses.
+std::vector<std::shared_ptr<const GlbSkin>> readSkins(const GlbDocument& document, const std::vector<uint32_t>& sceneIndices)
+{
+    const JsonObject& root = document.root;
+    std::vector<std::shared_ptr<const GlbSkin>> out{};
+    if (!root.contains("skins")) {
+        return out;
+    }
+
+    for (const JsonValue& skinValue : root.at("skins").asArray()) {
+        const JsonObject& skin = skinValue.asObject();
+        auto result = std::make_shared<GlbSkin>();
+        for (const JsonValue& joint : expectField<JsonArray>(skin, "joints").asArray()) {
+            const uint32_t node = asU32(joint);
+            if (node >= sceneIndices.size()) {
+                throw std::runtime_error("GLB skin references a missing node");
+            }
+            result->joints.push_back(sceneIndices[node]);
+        }
+        if (result->joints.size() > 65536) {
+            throw std::runtime_error("GLB skin has more joints than JOINTS_0 can address");
+        }
+
+        result->inverseBindMatrices.assign(result->joints.size(), kGlbIdentityMatrix);
+        if (skin.contains("inverseBindMatrices")) {
+            const std::vector<float> matrices = readFloats(document, asU32(skin.at("inverseBindMatrices")), 16);
+            if (matrices.size() != result->joints.size() * 16) {
+                throw std::runtime_error("GLB skin inverseBindMatrices count differs from joint count");
+            }
+            for (size_t j = 0; j < result->joints.size(); ++j) {
+                std::memcpy(result->inverseBindMatrices[j].data(), matrices.data() + j * 16, sizeof(float) * 16);
+            }
+        }
+        out.push_back(std::move(result));
+    }
+    return out;
+}
+
+// Every glTF mesh is imported once, whatever the number of nodes referencing it. Primitives other
+// than triangle lists are skipped.
+void readMaterialsAndImages(const GlbDocument& document, const std::string& path, GlbScene& scene)
+{
+    const JsonObject& root = document.root;
+    if (root.contains("images")) {
+        const uint32_t imageCount = static_cast<uint32_t>(root.at("images").asArray().size());
+        scene.images.reserve(imageCount);
+        for (uint32_t i = 0; i < imageCount; ++i) {
+            scene.images.push_back(readImage(document, path, i));
+        }
+    }
+
+    if (root.contains("materials")) {
+        for (const JsonValue& material : root.at("materials").asArray()) {
+            scene.materials.push_back(readMaterial(root, material.asObject()));
+        }
+    }
+}
+
+template <typename AppendFn>
+GlbScene loadScene(const std::string& path, const std::vector<uint8_t>& fileBytes, AppendFn&& appendPrimitive)
+{
+    const GlbDocument document = parseGlbDocument(fileBytes);
+    const JsonObject& root = document.root;
+
+    GlbScene scene{};
+    readMaterialsAndImages(document, path, scene);
+
+    if (root.contains("meshes")) {
+        for (const JsonValue& meshValue : root.at("meshes").asArray()) {
+            GlbMesh mesh{ .firstPrimitive = static_cast<uint32_t>(scene.primitives.size()) };
+            for (const JsonValue& primitiveValue : expectField<JsonValue>(meshValue.asObject(), "primitives").asArray()) {
+                const JsonObject& primitive = primitiveValue.asObject();
+                if (primitive.contains("mode") && asU32(primitive.at("mode")) != 4) {
+                    continue;
+                }
+                scene.primitives.push_back(GlbPrimitive{
+                    .mesh = appendPrimitive(loadOptimizedGlbPrimitive(document, primitive)),
+                    .material = primitive.contains("material") ? asU32(primitive.at("material")) : kNoGlbIndex });
+            }
+            mesh.primitiveCount = static_cast<uint32_t>(scene.primitives.size()) - mesh.firstPrimitive;
+            scene.meshes.push_back(mesh);
+        }
+    }
+
+    std::vector<uint32_t> sceneIndices{};
+    scene.nodes = readNodeHierarchy(root, sceneIndices);
+    scene.skins = readSkins(document, sceneIndices);
+    for (const GlbNode& node : scene.nodes) {
+        if (node.mesh != kNoGlbIndex && node.mesh >= scene.meshes.size()) {
+            throw std::runtime_error("GLB node references a missing mesh: " + path);
+        }
+        if (node.skin == kNoGlbIndex) {
+            continue;
+        }
+        if (node.skin >= scene.skins.size()) {
+            throw std::runtime_error("GLB node references a missing skin: " + path);
+        }
+        if (std::ranges::find(scene.skins[node.skin]->joints, kNoGlbIndex) != scene.skins[node.skin]->joints.end()) {
+            throw std::runtime_error("GLB skin joint lies outside the default scene: " + path);
+        }
+    }
+    scene.animations = readAnimations(document, sceneIndices);
+    return scene;
+}
+}
+
+LoadedMesh appendGlbMesh(const std::string& path, std::vector<VertexPacket>& outVertices, std::vector<uint32_t>& outIndices, std::vector<MeshletPacket>& outMeshlets)
+{
+    const GlbDocument document = readGlbDocument(path);
+    return appendSourceMesh(loadOptimizedGlbPrimitive(document, firstPrimitive(document.root)), outVertices, outIndices, outMeshlets);
+}
+
+LoadedMesh appendGlbMesh(const std::string& path,
+    VertexFormat format,
+    std::vector<CompactVertexPacket>& outVertices,
+    std::vector<uint32_t>& outIndices,
+    std::vector<MeshletPacket>& outMeshlets)
+{
+    if (format == VertexFormat::Float32) {
+        throw std::runtime_error("appendGlbMesh: compact overload requires a compact VertexFormat");
+    }
+
+    const GlbDocument document = readGlbDocument(path);
+    return appendSourceMesh(loadOptimizedGlbPrimitive(document, firstPrimitive(document.root)), format, outVertices, outIndices, outMeshlets);
+}
+
+GlbScene loadGlbScene(const std::string& path,
+    std::vector<VertexPacket>& outVertices,
+    std::vector<uint32_t>& outIndices,
+    std::vector<MeshletPacket>& outMeshlets,
+    std::vector<SkinVertexPacket>& outSkinVertices)
+{
+    return loadGlbScene(path, readBinaryFile(path), outVertices, outIndices, outMeshlets, outSkinVertices);
+}
+
+GlbScene loadGlbScene(const std::string& path,
+    VertexFormat format,
+    std::vector<CompactVertexPacket>& outVertices,
+    std::vector<uint32_t>& outIndices,
+    std::vector<MeshletPacket>& outMeshlets,
+    std::vector<SkinVertexPacket>& outSkinVertices)
+{
+    return loadGlbScene(path, readBinaryFile(path), format, outVertices, outIndices, outMeshlets, outSkinVertices);
+}
+
+GlbScene loadGlbScene(const std::string& path,
+    const std::vector<uint8_t>& fileBytes,
+    std::vector<VertexPacket>& outVertices,
+    std::vector<uint32_t>& outIndices,
+    std::vector<MeshletPacket>& outMeshlets,
+    std::vector<SkinVertexPacket>& outSkinVertices)
+{
+    return loadScene(path, fileBytes, [&](const SourceMesh& source) {
+        LoadedMesh mesh = appendSourceMesh(source, outVertices, outIndices, outMeshlets);
+        appendSkinVertices(source, mesh, outSkinVertices);
+        return mesh;
+    });
+}
+
+GlbScene loadGlbScene(const std::string& path,
+    const std::vector<uint8_t>& fileBytes,
+    VertexFormat format,
+    std::vector<CompactVertexPacket>& outVertices,
+    std::vector<uint32_t>& outIndices,
+    std::vector<MeshletPacket>& outMeshlets,
+    std::vector<SkinVertexPacket>& outSkinVertices)
+{
+    if (format == VertexFormat::Float32) {
+        throw std::runtime_error("loadGlbScene: compact overload requires a compact VertexFormat");
+    }
+
+    return loadScene(path, fileBytes, [&](const SourceMesh& source) {
+        LoadedMesh mesh = appendSourceMesh(source, format, outVertices, outIndices, outMeshlets);
+        appendSkinVertices(source, mesh, outSkinVertices);
+        return mesh;
+    });
+}
+
+GlbScene readGlbMaterials(const std::string& path, const std::vector<uint8_t>& fileBytes)
+{
+    GlbScene scene{};
+    readMaterialsAndImages(parseGlbDocument(fileBytes), path, scene);
+    return scene;
+}
+
+GlbImage readGlbBaseColorImage(const std::string& path)
+{
+    const GlbDocument document = readGlbDocument(path);
+    const JsonObject& root = document.root;
+
+    const JsonObject& primitive = firstPrimitive(root);
+    if (!primitive.contains("material") || !root.contains("materials")) {
+        return GlbImage{};
+    }
+
+    const auto& material = root.at("materials").asArray().at(asU32(primitive.at("material"))).asObject();
+    const uint32_t imageIndex = baseColorImageIndex(root, material);
+    return imageIndex == kNoGlbIndex ? GlbImage{} : readImage(document, path, imageIndex);
+}
+
+std::vector<uint8_t> readBinaryFile(const std::string& path)
+{
+    if (const AssetArchive* archive = mountedAssetArchive()) {
+        if (const AssetArchive::Entry* entry = archive->find(path)) {
+            return archive->read(*entry);
+        }
+    }
+
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        throw std::runtime_error("Unable to open file: " + path);
+    }
+
+    const std::streamsize size = file.tellg();
+    file.seekg(0, std::ios::beg);
+    std::vector<uint8_t> bytes(static_cast<size_t>(size));
+    if (!file.read(reinterpret_cast<char*>(bytes.data()), size)) {
+        throw std::runtime_error("Failed to read file: " + path);
+    }
+    return bytes;
+}
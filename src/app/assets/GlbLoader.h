@@ -1,14 +1,187 @@
 #pragma once
 
+#include "MeshOptimizer.h"
+#include "MeshletBuilder.h"
+#include "VertexQuantization.h"
+
 #include <Engine.h>
 
+#include <array>
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 
+// Indices are mesh-local; firstVertex is the base vertex added at draw time.
 struct LoadedMesh {
     uint32_t firstVertex{ 0 };
     uint32_t vertexCount{ 0 };
+    uint32_t firstIndex{ 0 };
+    uint32_t indexCount{ 0 };
+    // Meshlet index ranges are absolute into the shared index stream.
+    uint32_t firstMeshlet{ 0 };
+    uint32_t meshletCount{ 0 };
+    // Joint influences parallel to the vertex range; skinVertexCount is 0 for rigid meshes and
+    // vertexCount otherwise.
+    uint32_t firstSkinVertex{ 0 };
+    uint32_t skinVertexCount{ 0 };
+    // Compact formats store positions normalized to the mesh bounds; model * T(offset) * S(scale)
+    // restores object space. Identity for VertexFormat::Float32.
+    std::array<float, 3> dequantScale{ 1.0F, 1.0F, 1.0F };
+    std::array<float, 3> dequantOffset{ 0.0F, 0.0F, 0.0F };
+    // Object-space sphere around the AABB, for screen coverage estimates.
+    std::array<float, 3> boundsCenter{ 0.0F, 0.0F, 0.0F };
+    float boundsRadius{ 0.0F };
+    QuantizationReport quantization{};
+    MeshOptimizationStats optimization{};
+    MeshletBuildStats meshlets{};
+};
+
+LoadedMesh appendGlbMesh(const std::string& path,
+    std::vector<VertexPacket>& outVertices,
+    std::vector<uint32_t>& outIndices,
+    std::vector<MeshletPacket>& outMeshlets);
+LoadedMesh appendGlbMesh(const std::string& path,
+    VertexFormat format,
+    std::vector<CompactVertexPacket>& outVertices,
+    std::vector<uint32_t>& outIndices,
+    std::vector<MeshletPacket>& outMeshlets);
+
+inline constexpr uint32_t kNoGlbIndex = 0xFFFFFFFFU;
+inline constexpr std::array<float, 16> kGlbIdentityMatrix{
+    1.0F, 0.0F, 0.0F, 0.0F,
+    0.0F, 1.0F, 0.0F, 0.0F,
+    0.0F, 0.0F, 1.0F, 0.0F,
+    0.0F, 0.0F, 0.0F, 1.0F
+};
+
+struct GlbImage {
+    std::string mimeType{};
+    std::vector<uint8_t> bytes{};
+};
+
+struct GlbMaterial {
+    std::string name{};
+    std::array<float, 4> baseColorFactor{ 1.0F, 1.0F, 1.0F, 1.0F };
+    // Index into GlbScene::images.
+    uint32_t baseColorImage{ kNoGlbIndex };
+};
+
+// A triangle primitive appended to the shared streams; every node using its mesh draws this range.
+struct GlbPrimitive {
+    LoadedMesh mesh{};
+    // Index into GlbScene::materials.
+    uint32_t material{ kNoGlbIndex };
+};
+
+// Range of GlbScene::primitives; indexed like the file's meshes.
+struct GlbMesh {
+    uint32_t firstPrimitive{ 0 };
+    uint32_t primitiveCount{ 0 };
+};
+
+struct GlbNode {
+    std::string name{};
+    // Index into GlbScene::nodes; parents always precede their children.
+    uint32_t parent{ kNoGlbIndex };
+    // Index into GlbScene::meshes.
+    uint32_t mesh{ kNoGlbIndex };
+    // Index into GlbScene::skins; deforms this node's mesh, whose vertices are then in the space
+    // of the node itself rather than posed by its transform alone.
+    uint32_t skin{ kNoGlbIndex };
+    // Column-major, relative to the parent.
+    std::array<float, 16> localMatrix{ kGlbIdentityMatrix };
+    // localMatrix as T * R * S with an (x, y, z, w) rotation; animation channels replace single
+    // components of it. Identity for nodes given as a matrix, which glTF does not let animate.
+    std::array<float, 3> translation{ 0.0F, 0.0F, 0.0F };
+    std::array<float, 4> rotation{ 0.0F, 0.0F, 0.0F, 1.0F };
+    std::array<float, 3> scale{ 1.0F, 1.0F, 1.0F };
 };
 
-LoadedMesh appendGlbMeshVertices(const std::string& path, std::vector<VertexPacket>& outVertices);
+// Joint j of a skin is node joints[j]; a vertex bound to it follows
+// inverse(meshNodeWorld) * world(joints[j]) * inverseBindMatrices[j].
+struct GlbSkin {
+    // Indices into GlbScene::nodes.
+    std::vector<uint32_t> joints{};
+    // Column-major, one per joint.
+    std::vector<std::array<float, 16>> inverseBindMatrices{};
+};
+
+enum class GlbAnimationPath : uint8_t {
+    Translation,
+    Rotation,
+    Scale
+};
+
+enum class GlbInterpolation : uint8_t {
+    Linear,
+    Step,
+    CubicSpline
+};
+
+// Keyframes of one node property: 3 floats per key for translation and scale, 4 (x, y, z, w) for
+// rotation. CubicSpline keys store the in-tangent, the value and the out-tangent, in that order.
+struct GlbAnimationChannel {
+    // Index into GlbScene::nodes.
+    uint32_t node{ kNoGlbIndex };
+    GlbAnimationPath path{ GlbAnimationPath::Translation };
+    GlbInterpolation interpolation{ GlbInterpolation::Linear };
+    // Seconds, non-decreasing.
+    std::vector<float> times{};
+    std::vector<float> values{};
+};
+
+struct GlbAnimation {
+    std::string name{};
+    // Last keyframe time over all channels.
+    float duration{ 0.0F };
+    std::vector<GlbAnimationChannel> channels{};
+};
+
+// The default scene of a GLB file with its node hierarchy. Meshes are imported once and shared by
+// every node that references them.
+struct GlbScene {
+    std::vector<GlbNode> nodes{};
+    std::vector<GlbMesh> meshes{};
+    std::vector<GlbPrimitive> primitives{};
+    std::vector<GlbMaterial> materials{};
+    std::vector<GlbImage> images{};
+    // Shared for the same reason as animations.
+    std::vector<std::shared_ptr<const GlbSkin>> skins{};
+    // Shared, so entities playing a clip keep it alive across a reload of the file.
+    std::vector<std::shared_ptr<const GlbAnimation>> animations{};
+};
+
+// outSkinVertices receives JOINTS_0/WEIGHTS_0 of skinned primitives (see LoadedMesh::firstSkinVertex).
+GlbScene loadGlbScene(const std::string& path,
+    std::vector<VertexPacket>& outVertices,
+    std::vector<uint32_t>& outIndices,
+    std::vector<MeshletPacket>& outMeshlets,
+    std::vector<SkinVertexPacket>& outSkinVertices);
+GlbScene loadGlbScene(const std::string& path,
+    VertexFormat format,
+    std::vector<CompactVertexPacket>& outVertices,
+    std::vector<uint32_t>& outIndices,
+    std::vector<MeshletPacket>& outMeshlets,
+    std::vector<SkinVertexPacket>& outSkinVertices);
+// fileBytes holds the whole .glb as read from path; path only resolves external image URIs.
+GlbScene loadGlbScene(const std::string& path,
+    const std::vector<uint8_t>& fileBytes,
+    std::vector<VertexPacket>& outVertices,
+    std::vector<uint32_t>& outIndices,
+    std::vector<MeshletPacket>& outMeshlets,
+    std::vector<SkinVertexPacket>& outSkinVertices);
+GlbScene loadGlbScene(const std::string& path,
+    const std::vector<uint8_t>& fileBytes,
+    VertexFormat format,
+    std::vector<CompactVertexPacket>& outVertices,
+    std::vector<uint32_t>& outIndices,
+    std::vector<MeshletPacket>& outMeshlets,
+    std::vector<SkinVertexPacket>& outSkinVertices);
+// Materials and images only; no geometry is decoded.
+GlbScene readGlbMaterials(const std::string& path, const std::vector<uint8_t>& fileBytes);
+
+// Encoded bytes (as stored, e.g. PNG) of the first primitive's baseColorTexture; empty if it has none.
+GlbImage readGlbBaseColorImage(const std::string& path);
+
+std::vector<uint8_t> readBinaryFile(const std::string& path);
@@ -0,0 +1,165 @@
+#include "LzCodec.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+constexpr size_t kMinMatch = 4;
+constexpr size_t kMaxDistance = 65535;
+constexpr uint32_t kHashBits = 16;
+constexpr size_t kLengthEscape = 15;
+// Literal runs this long start skipping ahead, so incompressible data costs little to try.
+constexpr uint32_t kSkipShift = 6;
+
+uint32_t read32(const uint8_t* p) noexcept
+{
+    uint32_t value{};
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+uint32_t hashPosition(const uint8_t* p) noexcept
+{
+    return (read32(p) * 2654435761U) >> (32U - kHashBits);
+}
+
+void writeLength(std::vector<uint8_t>& out, size_t length)
+{
+    length -= kLengthEscape;
+    for (; length >= 255; length -= 255) {
+        out.push_back(255);
+    }
+    out.push_back(static_cast<uint8_t>(length));
+}
+
+void writeSequence(std::vector<uint8_t>& out, const uint8_t* literals, size_t literalCount, size_t matchLength, size_t distance)
+{
+    const size_t matchCode = matchLength == 0 ? 0 : matchLength - kMinMatch;
+    out.push_back(static_cast<uint8_t>((std::min(literalCount, kLengthEscape) << 4) | std::min(matchCode, kLengthEscape)));
+    if (literalCount >= kLengthEscape) {
+        writeLength(out, literalCount);
+    }
+    out.insert(out.end(), literals, literals + literalCount);
+    if (matchLength == 0) {
+        return;
+    }
+    out.push_back(static_cast<uint8_t>(distance & 0xFFU));
+    out.push_back(static_cast<uint8_t>(distance >> 8));
+    if (matchCode >= kLengthEscape) {
+        writeLength(out, matchCode);
+    }
+}
+
+[[noreturn]] void corrupt()
+{
+    throw std::runtime_error("lzDecompress: corrupt data");
+}
+}
+
+std::vector<uint8_t> lzCompress(const uint8_t* data, size_t size)
+{
+    if (size >= std::numeric_limits<uint32_t>::max()) {
+        throw std::runtime_error("lzCompress: input larger than 4 GiB");
+    }
+
+    std::vector<uint8_t> out{};
+    out.reserve(size / 2 + 16);
+    // Position + 1 of the last occurrence of each hashed 4-byte prefix; 0 when none.
+    std::vector<uint32_t> table(size_t{ 1 } << kHashBits, 0);
+
+    size_t anchor = 0;
+    size_t position = 0;
+    while (position + kMinMatch <= size) {
+        const uint32_t hash = hashPosition(data + position);
+        const uint32_t candidate = table[hash];
+        table[hash] = static_cast<uint32_t>(position + 1);
+
+        if (candidate != 0) {
+            const size_t match = candidate - 1;
+            if (position - match <= kMaxDistance && read32(data + match) == read32(data + position)) {
+                size_t length = kMinMatch;
+                while (position + length < size && data[match + length] == data[position + length]) {
+                    ++length;
+                }
+                writeSequence(out, data + anchor, position - anchor, length, position - match);
+                position += length;
+                anchor = position;
+                // Seed the table at the end of the match so a following repeat is found.
+                if (position + kMinMatch <= size && position >= 2) {
+                    table[hashPosition(data + position - 2)] = static_cast<uint32_t>(position - 2 + 1);
+                }
+                continue;
+            }
+        }
+        position += 1 + ((position - anchor) >> kSkipShift);
+    }
+    writeSequence(out, data + anchor, size - anchor, 0, 0);
+    return out;
+}
+
+void lzDecompress(uint8_t* destination, size_t size, const uint8_t* data, size_t dataSize)
+{
+    const uint8_t* in = data;
+    const uint8_t* const inEnd = data + dataSize;
+    uint8_t* out = destination;
+    uint8_t* const outEnd = destination + size;
+
+    const auto readLength = [&](size_t length) {
+        if (length != kLengthEscape) {
+            return length;
+        }
+        uint8_t byte = 255;
+        while (byte == 255) {
+            if (in == inEnd) {
+                corrupt();
+            }
+            byte = *in++;
+            length += byte;
+        }
+        return length;
+    };
+
+    for (;;) {
+        if (in == inEnd) {
+            corrupt();
+        }
+        const uint8_t token = *in++;
+        const size_t literalCount = readLength(token >> 4);
+        if (literalCount > static_cast<size_t>(inEnd - in) || literalCount > static_cast<size_t>(outEnd - out)) {
+            corrupt();
+        }
+        if (literalCount != 0) {
+            std::memcpy(out, in, literalCount);
+        }
+        out += literalCount;
+        in += literalCount;
+        if (in == inEnd) {
+            break;
+        }
+
+        if (inEnd - in < 2) {
+            corrupt();
+        }
+        const size_t distance = static_cast<size_t>(in[0]) | (static_cast<size_t>(in[1]) << 8);
+        in += 2;
+        const size_t length = readLength(token & 0xFU) + kMinMatch;
+        if (distance == 0 || distance > static_cast<size_t>(out - destination) || length > static_cast<size_t>(outEnd - out)) {
+            corrupt();
+        }
+        // A match closer than its length repeats the last distance bytes; everything copied so far
+        // continues that period, so each copy can double in size without overlapping.
+        const uint8_t* source = out - distance;
+        for (size_t remaining = length; remaining != 0;) {
+            const size_t count = std::min(static_cast<size_t>(out - source), remaining);
+            std::memcpy(out, source, count);
+            out += count;
+            remaining -= count;
+        }
+    }
+
+    if (out != outEnd) {
+        corrupt();
+    }
+}
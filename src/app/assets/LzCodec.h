@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// General-purpose byte compression for archive entries, in the spirit of LZ4: greedy matches
+// against a 64 KiB window, no entropy stage, so decoding is a handful of copies per sequence.
+//
+// A sequence is a token byte (literal count in the high nibble, match length minus 4 in the low
+// nibble, 15 meaning more length bytes follow), the literals, then a 16-bit little-endian match
+// distance. The last sequence carries literals only.
+
+[[nodiscard]] std::vector<uint8_t> lzCompress(const uint8_t* data, size_t size);
+// Throws when data does not decode to exactly size bytes.
+void lzDecompress(uint8_t* destination, size_t size, const uint8_t* data, size_t dataSize);
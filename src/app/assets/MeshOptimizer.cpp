@@ -0,0 +1,310 @@
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+constexpr uint32_t kForsythCacheSize = 32;
+constexpr float kForsythCacheDecayPower = 1.5F;
+constexpr float kForsythLastTriangleScore = 0.75F;
+constexpr float kForsythValenceBoostScale = 2.0F;
+constexpr float kForsythValenceBoostPower = 0.5F;
+
+float forsythVertexScore(int32_t cachePosition, uint32_t remainingValence)
+{
+    if (remainingValence == 0) {
+        return -1.0F;
+    }
+
+    float score = 0.0F;
+    if (cachePosition >= 0) {
+        if (cachePosition < 3) {
+            score = kForsythLastTriangleScore;
+        } else {
+            const float scaler = 1.0F / static_cast<float>(kForsythCacheSize - 3);
+            score = std::pow(1.0F - static_cast<float>(cachePosition - 3) * scaler, kForsythCacheDecayPower);
+        }
+    }
+    score += kForsythValenceBoostScale * std::pow(static_cast<float>(remainingValence), -kForsythValenceBoostPower);
+    return score;
+}
+
+void validateTriangleList(const std::vector<uint32_t>& indices, uint32_t vertexCount)
+{
+    if (indices.size() % 3 != 0) {
+        throw std::runtime_error("MeshOptimizer: index count must be a multiple of 3");
+    }
+    for (const uint32_t index : indices) {
+        if (index >= vertexCount) {
+            throw std::runtime_error("MeshOptimizer: index out of range");
+        }
+    }
+}
+}
+
+VertexCacheStats analyzeVertexCache(const std::vector<uint32_t>& indices, uint32_t vertexCount, uint32_t cacheSize)
+{
+    validateTriangleList(indices, vertexCount);
+
+    // Timestamp FIFO: a vertex is resident while fewer than cacheSize misses happened since it entered.
+    std::vector<uint32_t> insertedAt(vertexCount, 0);
+    uint32_t misses = 0;
+    for (const uint32_t index : indices) {
+        if (insertedAt[index] == 0 || misses + 1 - insertedAt[index] > cacheSize) {
+            ++misses;
+            insertedAt[index] = misses;
+        }
+    }
+
+    VertexCacheStats stats{};
+    stats.transformedVertices = misses;
+    const size_t triangleCount = indices.size() / 3;
+    stats.acmr = triangleCount != 0 ? static_cast<float>(misses) / static_cast<float>(triangleCount) : 0.0F;
+    stats.atvr = vertexCount != 0 ? static_cast<float>(misses) / static_cast<float>(vertexCount) : 0.0F;
+    return stats;
+}
+
+std::vector<uint32_t> optimizeVertexCache(const std::vector<uint32_t>& indices, uint32_t vertexCount)
+{
+    validateTriangleList(indices, vertexCount);
+
+    const size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0) {
+        return {};
+    }
+
+    std::vector<uint32_t> valence(vertexCount, 0);
+    for (const uint32_t index : indices) {
+        ++valence[index];
+    }
+
+    std::vector<uint32_t> adjacencyOffset(static_cast<size_t>(vertexCount) + 1, 0);
+    for (uint32_t v = 0; v < vertexCount; ++v) {
+        adjacencyOffset[v + 1] = adjacencyOffset[v] + valence[v];
+    }
+    std::vector<uint32_t> adjacency(indices.size());
+    {
+        std::vector<uint32_t> fill(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+        for (size_t t = 0; t < triangleCount; ++t) {
+            for (size_t k = 0; k < 3; ++k) {
+                adjacency[fill[indices[t * 3 + k]]++] = static_cast<uint32_t>(t);
+            }
+        }
+    }
+
+    std::vector<int32_t> cachePosition(vertexCount, -1);
+    std::vector<float> vertexScore(vertexCount);
+    for (uint32_t v = 0; v < vertexCount; ++v) {
+        vertexScore[v] = forsythVertexScore(-1, valence[v]);
+    }
+
+    std::vector<float> triangleScore(triangleCount);
+    for (size_t t = 0; t < triangleCount; ++t) {
+        triangleScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+    }
+
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<uint32_t> cache{};
+    std::vector<uint32_t> nextCache{};
+    cache.reserve(kForsythCacheSize + 3);
+    nextCache.reserve(kForsythCacheSize + 3);
+
+    std::vector<uint32_t> result{};
+    result.reserve(indices.size());
+
+    size_t scanCursor = 0;
+    size_t bestTriangle = 0;
+    for (size_t t = 1; t < triangleCount; ++t) {
+        if (triangleScore[t] > triangleScore[bestTriangle]) {
+            bestTriangle = t;
+        }
+    }
+
+    for (size_t emittedCount = 0; emittedCount < triangleCount; ++emittedCount) {
+        emitted[bestTriangle] = true;
+        const uint32_t* tri = &indices[bestTriangle * 3];
+
+        nextCache.clear();
+        for (size_t k = 0; k < 3; ++k) {
+            const uint32_t v = tri[k];
+            result.push_back(v);
+            nextCache.push_back(v);
+
+            // Drop the emitted triangle from the vertex's remaining adjacency.
+            uint32_t* begin = adjacency.data() + adjacencyOffset[v];
+            uint32_t* end = begin + valence[v];
+            uint32_t* found = std::find(begin, end, static_cast<uint32_t>(bestTriangle));
+            if (found != end) {
+                std::swap(*found, *(end - 1));
+                --valence[v];
+            }
+        }
+        for (const uint32_t v : cache) {
+            if (v != tri[0] && v != tri[1] && v != tri[2]) {
+                nextCache.push_back(v);
+            }
+        }
+
+        for (size_t i = kForsythCacheSize; i < nextCache.size(); ++i) {
+            cachePosition[nextCache[i]] = -1;
+            vertexScore[nextCache[i]] = forsythVertexScore(-1, valence[nextCache[i]]);
+        }
+        if (nextCache.size() > kForsythCacheSize) {
+            nextCache.resize(kForsythCacheSize);
+        }
+        std::swap(cache, nextCache);
+
+        for (size_t i = 0; i < cache.size(); ++i) {
+            cachePosition[cache[i]] = static_cast<int32_t>(i);
+            vertexScore[cache[i]] = forsythVertexScore(static_cast<int32_t>(i), valence[cache[i]]);
+        }
+
+        // Only triangles touching the cache changed score; the best candidate is among them.
+        float bestScore = -1.0F;
+        bool hasCandidate = false;
+        for (const uint32_t v : cache) {
+            for (uint32_t a = adjacencyOffset[v]; a < adjacencyOffset[v] + valence[v]; ++a) {
+                const uint32_t t = adjacency[a];
+                const float score = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+                triangleScore[t] = score;
+                if (score > bestScore) {
+                    bestScore = score;
+                    bestTriangle = t;
+                    hasCandidate = true;
+                }
+            }
+        }
+
+        if (!hasCandidate) {
+            while (scanCursor < triangleCount && emitted[scanCursor]) {
+                ++scanCursor;
+            }
+            bestTriangle = scanCursor;
+        }
+    }
+
+    return result;
+}
+
+std::vector<uint32_t> optimizeOverdraw(const std::vector<uint32_t>& indices,
+    const std::vector<std::array<float, 3>>& positions,
+    uint32_t cacheSize)
+{
+    const uint32_t vertexCount = static_cast<uint32_t>(positions.size());
+    validateTriangleList(indices, vertexCount);
+
+    const size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0) {
+        return {};
+    }
+
+    // Hard cluster boundaries: triangles whose three vertices all miss the FIFO cache.
+    std::vector<size_t> clusterStarts{};
+    {
+        std::vector<uint32_t> insertedAt(vertexCount, 0);
+        uint32_t misses = 0;
+        for (size_t t = 0; t < triangleCount; ++t) {
+            uint32_t triangleMisses = 0;
+            for (size_t k = 0; k < 3; ++k) {
+                const uint32_t v = indices[t * 3 + k];
+                if (insertedAt[v] == 0 || misses + 1 - insertedAt[v] > cacheSize) {
+                    ++misses;
+                    insertedAt[v] = misses;
+                    ++triangleMisses;
+                }
+            }
+            if (t == 0 || triangleMisses == 3) {
+                clusterStarts.push_back(t);
+            }
+        }
+    }
+
+    std::array<float, 3> meshCentroid{ 0.0F, 0.0F, 0.0F };
+    float meshArea = 0.0F;
+
+    struct Cluster {
+        size_t firstTriangle{ 0 };
+        size_t triangleCount{ 0 };
+        std::array<float, 3> centroid{ 0.0F, 0.0F, 0.0F };
+        std::array<float, 3> normal{ 0.0F, 0.0F, 0.0F };
+        float sortKey{ 0.0F };
+    };
+
+    std::vector<Cluster> clusters(clusterStarts.size());
+    for (size_t c = 0; c < clusterStarts.size(); ++c) {
+        Cluster& cluster = clusters[c];
+        cluster.firstTriangle = clusterStarts[c];
+        cluster.triangleCount = (c + 1 < clusterStarts.size() ? clusterStarts[c + 1] : triangleCount) - cluster.firstTriangle;
+
+        float clusterArea = 0.0F;
+        for (size_t t = cluster.firstTriangle; t < cluster.firstTriangle + cluster.triangleCount; ++t) {
+            const std::array<float, 3>& p0 = positions[indices[t * 3]];
+            const std::array<float, 3>& p1 = positions[indices[t * 3 + 1]];
+            const std::array<float, 3>& p2 = positions[indices[t * 3 + 2]];
+            const std::array<float, 3> e0{ p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+            const std::array<float, 3> e1{ p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+            const std::array<float, 3> n{
+                e0[1] * e1[2] - e0[2] * e1[1],
+                e0[2] * e1[0] - e0[0] * e1[2],
+                e0[0] * e1[1] - e0[1] * e1[0]
+            };
+            const float area = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+            for (size_t axis = 0; axis < 3; ++axis) {
+                const float center = (p0[axis] + p1[axis] + p2[axis]) / 3.0F;
+                cluster.centroid[axis] += center * area;
+                cluster.normal[axis] += n[axis];
+                meshCentroid[axis] += center * area;
+            }
+            clusterArea += area;
+        }
+        meshArea += clusterArea;
+
+        if (clusterArea > 0.0F) {
+            for (size_t axis = 0; axis < 3; ++axis) {
+                cluster.centroid[axis] /= clusterArea;
+            }
+        }
+    }
+
+    if (meshArea > 0.0F) {
+        for (size_t axis = 0; axis < 3; ++axis) {
+            meshCentroid[axis] /= meshArea;
+        }
+    }
+
+    for (Cluster& cluster : clusters) {
+        const float normalLength = std::sqrt(cluster.normal[0] * cluster.normal[0] + cluster.normal[1] * cluster.normal[1] + cluster.normal[2] * cluster.normal[2]);
+        if (normalLength <= 0.0F) {
+            continue;
+        }
+        cluster.sortKey = ((cluster.centroid[0] - meshCentroid[0]) * cluster.normal[0] +
+            (cluster.centroid[1] - meshCentroid[1]) * cluster.normal[1] +
+            (cluster.centroid[2] - meshCentroid[2]) * cluster.normal[2]) / normalLength;
+    }
+
+    std::ranges::stable_sort(clusters, [](const Cluster& a, const Cluster& b) { return a.sortKey > b.sortKey; });
+
+    std::vector<uint32_t> result{};
+    result.reserve(indices.size());
+    for (const Cluster& cluster : clusters) {
+        const auto begin = indices.begin() + static_cast<std::ptrdiff_t>(cluster.firstTriangle * 3);
+        result.insert(result.end(), begin, begin + static_cast<std::ptrdiff_t>(cluster.triangleCount * 3));
+    }
+    return result;
+}
+
+std::vector<uint32_t> buildVertexFetchRemap(const std::vector<uint32_t>& indices, uint32_t vertexCount, uint32_t& outUniqueVertexCount)
+{
+    validateTriangleList(indices, vertexCount);
+
+    std::vector<uint32_t> remap(vertexCount, kUnusedVertex);
+    uint32_t next = 0;
+    for (const uint32_t index : indices) {
+        if (remap[index] == kUnusedVertex) {
+            remap[index] = next++;
+        }
+    }
+    outUniqueVertexCount = next;
+    return remap;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+struct VertexCacheStats {
+    // Average cache miss ratio: transformed vertices per triangle (0.5 is the ideal for a grid, 3 the worst case).
+    float acmr{ 0.0F };
+    // Average transformed vertex ratio: transformed vertices per unique vertex (1 is optimal).
+    float atvr{ 0.0F };
+    uint32_t transformedVertices{ 0 };
+};
+
+struct MeshOptimizationStats {
+    VertexCacheStats before{};
+    VertexCacheStats after{};
+};
+
+inline constexpr uint32_t kVertexCacheAnalysisSize = 16;
+
+// Simulates a FIFO post-transform cache over a triangle list.
+[[nodiscard]] VertexCacheStats analyzeVertexCache(const std::vector<uint32_t>& indices, uint32_t vertexCount, uint32_t cacheSize = kVertexCacheAnalysisSize);
+
+// Reorders triangles for post-transform cache locality (Forsyth's linear-speed scoring).
+[[nodiscard]] std::vector<uint32_t> optimizeVertexCache(const std::vector<uint32_t>& indices, uint32_t vertexCount);
+
+// Reorders cache-optimized triangles so clusters facing away from the mesh centre are drawn first, which
+// approximates front-to-back order from most viewpoints. Clusters are split only where the cache is
+// already cold, so the ACMR of the input order is preserved.
+[[nodiscard]] std::vector<uint32_t> optimizeOverdraw(const std::vector<uint32_t>& indices,
+    const std::vector<std::array<float, 3>>& positions,
+    uint32_t cacheSize = kVertexCacheAnalysisSize);
+
+// Returns remap[oldVertex] = newVertex in first-use order, or kUnusedVertex for unreferenced vertices.
+inline constexpr uint32_t kUnusedVertex = 0xFFFFFFFFU;
+[[nodiscard]] std::vector<uint32_t> buildVertexFetchRemap(const std::vector<uint32_t>& indices, uint32_t vertexCount, uint32_t& outUniqueVertexCount);
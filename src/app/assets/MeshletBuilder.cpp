@@ -0,0 +1,156 @@
+#include "MeshletBuilder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+using Vec3 = std::array<float, 3>;
+
+Vec3 sub(const Vec3& a, const Vec3& b) noexcept
+{
+    return { a[0] - b[0], a[1] - b[1], a[2] - b[2] };
+}
+
+Vec3 cross(const Vec3& a, const Vec3& b) noexcept
+{
+    return { a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0] };
+}
+
+float dot(const Vec3& a, const Vec3& b) noexcept
+{
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+float length(const Vec3& v) noexcept
+{
+    return std::sqrt(dot(v, v));
+}
+
+MeshletPacket finishMeshlet(const std::vector<uint32_t>& indices,
+    const std::vector<Vec3>& positions,
+    uint32_t firstIndex,
+    uint32_t indexCount)
+{
+    Vec3 minBound = positions[indices[firstIndex]];
+    Vec3 maxBound = minBound;
+    for (uint32_t i = firstIndex; i < firstIndex + indexCount; ++i) {
+        const Vec3& p = positions[indices[i]];
+        for (size_t axis = 0; axis < 3; ++axis) {
+            minBound[axis] = std::min(minBound[axis], p[axis]);
+            maxBound[axis] = std::max(maxBound[axis], p[axis]);
+        }
+    }
+
+    const Vec3 center{ (minBound[0] + maxBound[0]) * 0.5F, (minBound[1] + maxBound[1]) * 0.5F, (minBound[2] + maxBound[2]) * 0.5F };
+    float radius = 0.0F;
+    for (uint32_t i = firstIndex; i < firstIndex + indexCount; ++i) {
+        radius = std::max(radius, length(sub(positions[indices[i]], center)));
+    }
+
+    std::vector<Vec3> normals{};
+    normals.reserve(indexCount / 3);
+    Vec3 axis{ 0.0F, 0.0F, 0.0F };
+    for (uint32_t i = firstIndex; i + 2 < firstIndex + indexCount; i += 3) {
+        const Vec3& p0 = positions[indices[i]];
+        const Vec3 n = cross(sub(positions[indices[i + 1]], p0), sub(positions[indices[i + 2]], p0));
+        const float area = length(n);
+        if (area <= 0.0F) {
+            continue;
+        }
+        normals.push_back({ n[0] / area, n[1] / area, n[2] / area });
+        for (size_t k = 0; k < 3; ++k) {
+            axis[k] += normals.back()[k];
+        }
+    }
+
+    MeshletPacket meshlet{};
+    meshlet.boundingSphere = { center[0], center[1], center[2], radius };
+    meshlet.firstIndex = firstIndex;
+    meshlet.indexCount = indexCount;
+
+    const float axisLength = length(axis);
+    if (normals.empty() || axisLength <= 0.0F) {
+        return meshlet;
+    }
+    axis = { axis[0] / axisLength, axis[1] / axisLength, axis[2] / axisLength };
+
+    float minDot = 1.0F;
+    for (const Vec3& n : normals) {
+        minDot = std::min(minDot, dot(n, axis));
+    }
+
+    // A cone wider than a hemisphere can never be fully backfacing; keep cutoff at 1 to disable the test.
+    const float cutoff = minDot <= 0.0F ? 1.0F : std::sqrt(std::max(0.0F, 1.0F - minDot * minDot));
+    meshlet.cone = { axis[0], axis[1], axis[2], cutoff };
+    return meshlet;
+}
+}
+
+std::vector<MeshletPacket> buildMeshlets(const std::vector<uint32_t>& indices,
+    const std::vector<std::array<float, 3>>& positions,
+    MeshletBuildStats* outStats,
+    uint32_t maxVertices,
+    uint32_t maxTriangles)
+{
+    if (indices.size() % 3 != 0) {
+        throw std::runtime_error("buildMeshlets: index count must be a multiple of 3");
+    }
+    if (maxVertices < 3 || maxTriangles == 0) {
+        throw std::runtime_error("buildMeshlets: meshlet limits are too small");
+    }
+
+    std::vector<MeshletPacket> meshlets{};
+    std::vector<uint32_t> meshletVertices{};
+    meshletVertices.reserve(maxVertices);
+
+    uint64_t totalVertices = 0;
+    uint32_t firstIndex = 0;
+    uint32_t triangleCount = 0;
+
+    const auto flush = [&](uint32_t endIndex) {
+        if (triangleCount == 0) {
+            return;
+        }
+        meshlets.push_back(finishMeshlet(indices, positions, firstIndex, endIndex - firstIndex));
+        totalVertices += meshletVertices.size();
+        firstIndex = endIndex;
+        triangleCount = 0;
+        meshletVertices.clear();
+    };
+
+    for (uint32_t i = 0; i < indices.size(); i += 3) {
+        uint32_t newVertices = 0;
+        for (uint32_t k = 0; k < 3; ++k) {
+            const uint32_t v = indices[i + k];
+            if (v >= positions.size()) {
+                throw std::runtime_error("buildMeshlets: index out of range");
+            }
+            if (std::find(meshletVertices.begin(), meshletVertices.end(), v) == meshletVertices.end()) {
+                ++newVertices;
+            }
+        }
+        if (meshletVertices.size() + newVertices > maxVertices || triangleCount + 1 > maxTriangles) {
+            flush(i);
+        }
+        for (uint32_t k = 0; k < 3; ++k) {
+            const uint32_t v = indices[i + k];
+            if (std::find(meshletVertices.begin(), meshletVertices.end(), v) == meshletVertices.end()) {
+                meshletVertices.push_back(v);
+            }
+        }
+        ++triangleCount;
+    }
+    flush(static_cast<uint32_t>(indices.size()));
+
+    if (outStats != nullptr) {
+        *outStats = MeshletBuildStats{};
+        outStats->meshletCount = static_cast<uint32_t>(meshlets.size());
+        if (!meshlets.empty()) {
+            outStats->averageTriangles = static_cast<float>(indices.size() / 3) / static_cast<float>(meshlets.size());
+            outStats->averageVertices = static_cast<float>(totalVertices) / static_cast<float>(meshlets.size());
+        }
+        outStats->coneCullableMeshlets = static_cast<uint32_t>(std::ranges::count_if(meshlets, [](const MeshletPacket& m) { return m.cone[3] < 1.0F; }));
+    }
+    return meshlets;
+}
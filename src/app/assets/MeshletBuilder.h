@@ -0,0 +1,25 @@
+#pragma once
+
+#include <Engine.h>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+inline constexpr uint32_t kMeshletMaxVertices = 128;
+inline constexpr uint32_t kMeshletMaxTriangles = 128;
+
+struct MeshletBuildStats {
+    uint32_t meshletCount{ 0 };
+    float averageTriangles{ 0.0F };
+    float averageVertices{ 0.0F };
+    uint32_t coneCullableMeshlets{ 0 };
+};
+
+// Splits a triangle list, in its current order, into contiguous meshlets and computes each
+// meshlet's bounding sphere and normal cone. Meshlet firstIndex is relative to `indices`.
+[[nodiscard]] std::vector<MeshletPacket> buildMeshlets(const std::vector<uint32_t>& indices,
+    const std::vector<std::array<float, 3>>& positions,
+    MeshletBuildStats* outStats = nullptr,
+    uint32_t maxVertices = kMeshletMaxVertices,
+    uint32_t maxTriangles = kMeshletMaxTriangles);
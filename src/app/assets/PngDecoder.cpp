@@ -0,0 +1,491 @@
+#include "PngDecoder.h"
+
+#include "AssetArchive.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+class BitReader {
+public:
+    BitReader(const uint8_t* data, size_t size)
+        : data_(data)
+        , size_(size)
+    {
+    }
+
+    uint32_t bits(uint32_t count)
+    {
+        while (bitCount_ < count) {
+            if (pos_ >= size_) {
+                throw std::runtime_error("decodePng: truncated deflate stream");
+            }
+            bitBuffer_ |= static_cast<uint64_t>(data_[pos_++]) << bitCount_;
+            bitCount_ += 8;
+        }
+        const uint32_t value = static_cast<uint32_t>(bitBuffer_ & ((1ULL << count) - 1ULL));
+        bitBuffer_ >>= count;
+        bitCount_ -= count;
+        return value;
+    }
+
+    void alignToByte() noexcept
+    {
+        bitBuffer_ = 0;
+        bitCount_ = 0;
+    }
+
+    [[nodiscard]] const uint8_t* bytes(size_t count)
+    {
+        if (pos_ + count > size_) {
+            throw std::runtime_error("decodePng: truncated stored block");
+        }
+        const uint8_t* out = data_ + pos_;
+        pos_ += count;
+        return out;
+    }
+
+private:
+    const uint8_t* data_{ nullptr };
+    size_t size_{ 0 };
+    size_t pos_{ 0 };
+    uint64_t bitBuffer_{ 0 };
+    uint32_t bitCount_{ 0 };
+};
+
+constexpr uint32_t kMaxCodeBits = 15;
+
+// Canonical Huffman table decoded one bit at a time (the layout used by zlib's puff).
+struct Huffman {
+    std::array<uint16_t, kMaxCodeBits + 1> counts{};
+    std::vector<uint16_t> symbols{};
+
+    void build(const uint8_t* lengths, size_t symbolCount)
+    {
+        counts.fill(0);
+        for (size_t i = 0; i < symbolCount; ++i) {
+            ++counts[lengths[i]];
+        }
+        std::array<uint16_t, kMaxCodeBits + 1> offsets{};
+        for (uint32_t len = 1; len < kMaxCodeBits; ++len) {
+            offsets[len + 1] = static_cast<uint16_t>(offsets[len] + counts[len]);
+        }
+        symbols.assign(symbolCount, 0);
+        for (size_t i = 0; i < symbolCount; ++i) {
+            if (lengths[i] != 0) {
+                symbols[offsets[lengths[i]]++] = static_cast<uint16_t>(i);
+            }
+        }
+    }
+
+    [[nodiscard]] uint32_t decode(BitReader& reader) const
+    {
+        int32_t code = 0;
+        int32_t first = 0;
+        int32_t index = 0;
+        for (uint32_t len = 1; len <= kMaxCodeBits; ++len) {
+            code |= static_cast<int32_t>(reader.bits(1));
+            const int32_t count = counts[len];
+            if (code - count < first) {
+                return symbols[static_cast<size_t>(index + (code - first))];
+            }
+            index += count;
+            first = (first + count) << 1;
+            code <<= 1;
+        }
+        throw std::runtime_error("decodePng: invalid Huffman code");
+    }
+};
+
+constexpr std::array<uint16_t, 29> kLengthBase{ 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+constexpr std::array<uint8_t, 29> kLengthExtra{ 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+constexpr std::array<uint16_t, 30> kDistanceBase{ 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+constexpr std::array<uint8_t, 30> kDistanceExtra{ 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+constexpr std::array<uint8_t, 19> kCodeLengthOrder{ 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+void inflateBlock(BitReader& reader, const Huffman& literals, const Huffman& distances, std::vector<uint8_t>& out)
+{
+    while (true) {
+        const uint32_t symbol = literals.decode(reader);
+        if (symbol < 256) {
+            out.push_back(static_cast<uint8_t>(symbol));
+            continue;
+        }
+        if (symbol == 256) {
+            return;
+        }
+
+        const uint32_t lengthCode = symbol - 257;
+        if (lengthCode >= kLengthBase.size()) {
+            throw std::runtime_error("decodePng: invalid length symbol");
+        }
+        const uint32_t length = kLengthBase[lengthCode] + reader.bits(kLengthExtra[lengthCode]);
+
+        const uint32_t distanceCode = distances.decode(reader);
+        if (distanceCode >= kDistanceBase.size()) {
+            throw std::runtime_error("decodePng: invalid distance symbol");
+        }
+        const uint32_t distance = kDistanceBase[distanceCode] + reader.bits(kDistanceExtra[distanceCode]);
+        if (distance > out.size()) {
+            throw std::runtime_error("decodePng: distance exceeds decoded data");
+        }
+
+        // Byte-wise copy: overlapping matches (distance < length) repeat the window.
+        const size_t start = out.size() - distance;
+        for (uint32_t i = 0; i < length; ++i) {
+            out.push_back(out[start + i]);
+        }
+    }
+}
+
+void buildFixedTables(Huffman& literals, Huffman& distances)
+{
+    std::array<uint8_t, 288> literalLengths{};
+    for (size_t i = 0; i < literalLengths.size(); ++i) {
+        literalLengths[i] = i < 144 ? 8 : i < 256 ? 9 : i < 280 ? 7 : 8;
+    }
+    literals.build(literalLengths.data(), literalLengths.size());
+
+    std::array<uint8_t, 30> distanceLengths{};
+    distanceLengths.fill(5);
+    distances.build(distanceLengths.data(), distanceLengths.size());
+}
+
+void buildDynamicTables(BitReader& reader, Huffman& literals, Huffman& distances)
+{
+    const uint32_t literalCount = reader.bits(5) + 257;
+    const uint32_t distanceCount = reader.bits(5) + 1;
+    const uint32_t codeLengthCount = reader.bits(4) + 4;
+
+    std::array<uint8_t, 19> codeLengthLengths{};
+    for (uint32_t i = 0; i < codeLengthCount; ++i) {
+        codeLengthLengths[kCodeLengthOrder[i]] = static_cast<uint8_t>(reader.bits(3));
+    }
+    Huffman codeLengths{};
+    codeLengths.build(codeLengthLengths.data(), codeLengthLengths.size());
+
+    std::array<uint8_t, 288 + 32> lengths{};
+    uint32_t count = 0;
+    while (count < literalCount + distanceCount) {
+        const uint32_t symbol = codeLengths.decode(reader);
+        if (symbol < 16) {
+            lengths[count++] = static_cast<uint8_t>(symbol);
+            continue;
+        }
+
+        uint8_t value = 0;
+        uint32_t repeat = 0;
+        if (symbol == 16) {
+            if (count == 0) {
+                throw std::runtime_error("decodePng: repeat without previous length");
+            }
+            value = lengths[count - 1];
+            repeat = 3 + reader.bits(2);
+        } else if (symbol == 17) {
+            repeat = 3 + reader.bits(3);
+        } else {
+            repeat = 11 + reader.bits(7);
+        }
+        if (count + repeat > literalCount + distanceCount) {
+            throw std::runtime_error("decodePng: code lengths overflow");
+        }
+        for (uint32_t i = 0; i < repeat; ++i) {
+            lengths[count++] = value;
+        }
+    }
+
+    literals.build(lengths.data(), literalCount);
+    distances.build(lengths.data() + literalCount, distanceCount);
+}
+
+std::vector<uint8_t> zlibInflate(const std::vector<uint8_t>& stream, size_t expectedSize)
+{
+    if (stream.size() < 2) {
+        throw std::runtime_error("decodePng: zlib stream too small");
+    }
+    const uint8_t cmf = stream[0];
+    const uint8_t flg = stream[1];
+    if ((cmf & 0x0F) != 8 || ((cmf << 8) | flg) % 31 != 0 || (flg & 0x20) != 0) {
+        throw std::runtime_error("decodePng: unsupported zlib header");
+    }
+
+    std::vector<uint8_t> out{};
+    out.reserve(expectedSize);
+
+    BitReader reader(stream.data() + 2, stream.size() - 2);
+    bool lastBlock = false;
+    while (!lastBlock) {
+        lastBlock = reader.bits(1) != 0;
+        const uint32_t type = reader.bits(2);
+        if (type == 0) {
+            reader.alignToByte();
+            const uint8_t* header = reader.bytes(4);
+            const uint16_t length = static_cast<uint16_t>(header[0] | (header[1] << 8));
+            const uint16_t inverse = static_cast<uint16_t>(header[2] | (header[3] << 8));
+            if (length != static_cast<uint16_t>(~inverse)) {
+                throw std::runtime_error("decodePng: stored block length mismatch");
+            }
+            const uint8_t* data = reader.bytes(length);
+            out.insert(out.end(), data, data + length);
+        } else if (type == 1 || type == 2) {
+            Huffman literals{};
+            Huffman distances{};
+            if (type == 1) {
+                buildFixedTables(literals, distances);
+            } else {
+                buildDynamicTables(reader, literals, distances);
+            }
+            inflateBlock(reader, literals, distances, out);
+        } else {
+            throw std::runtime_error("decodePng: invalid deflate block type");
+        }
+    }
+    return out;
+}
+
+uint32_t readBe32(const uint8_t* p) noexcept
+{
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) | (static_cast<uint32_t>(p[2]) << 8) | p[3];
+}
+
+uint32_t crc32(const uint8_t* data, size_t size) noexcept
+{
+    static const std::array<uint32_t, 256> table = [] {
+        std::array<uint32_t, 256> t{};
+        for (uint32_t n = 0; n < 256; ++n) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1U) != 0 ? 0xEDB88320U ^ (c >> 1) : c >> 1;
+            }
+            t[n] = c;
+        }
+        return t;
+    }();
+
+    uint32_t crc = 0xFFFFFFFFU;
+    for (size_t i = 0; i < size; ++i) {
+        crc = table[(crc ^ data[i]) & 0xFFU] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFU;
+}
+
+uint8_t paeth(uint8_t a, uint8_t b, uint8_t c) noexcept
+{
+    const int p = static_cast<int>(a) + static_cast<int>(b) - static_cast<int>(c);
+    const int pa = p > a ? p - a : a - p;
+    const int pb = p > b ? p - b : b - p;
+    const int pc = p > c ? p - c : c - p;
+    if (pa <= pb && pa <= pc) {
+        return a;
+    }
+    return pb <= pc ? b : c;
+}
+
+// Reverses the per-scanline filters in place; returns the unfiltered rows without filter bytes.
+std::vector<uint8_t> unfilter(const std::vector<uint8_t>& filtered, uint32_t height, size_t rowBytes, size_t pixelBytes)
+{
+    if (filtered.size() < static_cast<size_t>(height) * (rowBytes + 1)) {
+        throw std::runtime_error("decodePng: image data is truncated");
+    }
+
+    std::vector<uint8_t> rows(static_cast<size_t>(height) * rowBytes);
+    for (uint32_t y = 0; y < height; ++y) {
+        const uint8_t filter = filtered[y * (rowBytes + 1)];
+        const uint8_t* src = filtered.data() + y * (rowBytes + 1) + 1;
+        uint8_t* dst = rows.data() + y * rowBytes;
+        const uint8_t* prev = y > 0 ? dst - rowBytes : nullptr;
+
+        for (size_t x = 0; x < rowBytes; ++x) {
+            const uint8_t a = x >= pixelBytes ? dst[x - pixelBytes] : 0;
+            const uint8_t b = prev != nullptr ? prev[x] : 0;
+            const uint8_t c = (prev != nullptr && x >= pixelBytes) ? prev[x - pixelBytes] : 0;
+            switch (filter) {
+            case 0: dst[x] = src[x]; break;
+            case 1: dst[x] = static_cast<uint8_t>(src[x] + a); break;
+            case 2: dst[x] = static_cast<uint8_t>(src[x] + b); break;
+            case 3: dst[x] = static_cast<uint8_t>(src[x] + ((static_cast<uint32_t>(a) + b) >> 1)); break;
+            case 4: dst[x] = static_cast<uint8_t>(src[x] + paeth(a, b, c)); break;
+            default: throw std::runtime_error("decodePng: invalid scanline filter");
+            }
+        }
+    }
+    return rows;
+}
+
+uint32_t channelCount(uint8_t colorType)
+{
+    switch (colorType) {
+    case 0: return 1;
+    case 2: return 3;
+    case 3: return 1;
+    case 4: return 2;
+    case 6: return 4;
+    default: throw std::runtime_error("decodePng: invalid color type");
+    }
+}
+}
+
+RgbaImage decodePng(const std::vector<uint8_t>& bytes)
+{
+    static constexpr std::array<uint8_t, 8> kSignature{ 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    if (bytes.size() >= 12 && std::memcmp(bytes.data(), "RIFF", 4) == 0 && std::memcmp(bytes.data() + 8, "WEBP", 4) == 0) {
+        throw std::runtime_error("decodePng: data is a WebP image, not PNG");
+    }
+    if (bytes.size() < kSignature.size() || std::memcmp(bytes.data(), kSignature.data(), kSignature.size()) != 0) {
+        throw std::runtime_error("decodePng: missing PNG signature");
+    }
+
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint8_t bitDepth = 0;
+    uint8_t colorType = 0;
+    std::vector<uint8_t> compressed{};
+    std::array<std::array<uint8_t, 4>, 256> palette{};
+    std::array<uint16_t, 3> transparentKey{};
+    bool hasTransparentKey = false;
+    bool seenHeader = false;
+
+    size_t cursor = kSignature.size();
+    while (cursor + 12 <= bytes.size()) {
+        const uint32_t length = readBe32(bytes.data() + cursor);
+        if (cursor + 12 + static_cast<size_t>(length) > bytes.size()) {
+            throw std::runtime_error("decodePng: chunk exceeds file size");
+        }
+        const uint8_t* type = bytes.data() + cursor + 4;
+        const uint8_t* data = type + 4;
+        if (crc32(type, static_cast<size_t>(length) + 4) != readBe32(data + length)) {
+            throw std::runtime_error("decodePng: chunk CRC mismatch");
+        }
+        cursor += 12 + static_cast<size_t>(length);
+
+        if (std::memcmp(type, "IHDR", 4) == 0) {
+            if (length != 13) {
+                throw std::runtime_error("decodePng: invalid IHDR");
+            }
+            width = readBe32(data);
+            height = readBe32(data + 4);
+            bitDepth = data[8];
+            colorType = data[9];
+            if (data[10] != 0 || data[11] != 0) {
+                throw std::runtime_error("decodePng: unsupported compression or filter method");
+            }
+            if (data[12] != 0) {
+                throw std::runtime_error("decodePng: interlaced images are not supported");
+            }
+            seenHeader = true;
+        } else if (std::memcmp(type, "PLTE", 4) == 0) {
+            for (uint32_t i = 0; i < length / 3 && i < palette.size(); ++i) {
+                palette[i] = { data[i * 3], data[i * 3 + 1], data[i * 3 + 2], 255 };
+            }
+        } else if (std::memcmp(type, "tRNS", 4) == 0) {
+            if (colorType == 3) {
+                for (uint32_t i = 0; i < length && i < palette.size(); ++i) {
+                    palette[i][3] = data[i];
+                }
+            } else {
+                for (uint32_t i = 0; i < 3 && (i + 1) * 2 <= length; ++i) {
+                    transparentKey[i] = static_cast<uint16_t>((data[i * 2] << 8) | data[i * 2 + 1]);
+                }
+                hasTransparentKey = true;
+            }
+        } else if (std::memcmp(type, "IDAT", 4) == 0) {
+            compressed.insert(compressed.end(), data, data + length);
+        } else if (std::memcmp(type, "IEND", 4) == 0) {
+            break;
+        }
+    }
+
+    if (!seenHeader || width == 0 || height == 0) {
+        throw std::runtime_error("decodePng: missing IHDR");
+    }
+    const bool validDepth = colorType == 3
+        ? (bitDepth == 1 || bitDepth == 2 || bitDepth == 4 || bitDepth == 8)
+        : (bitDepth == 8 || bitDepth == 16);
+    if (!validDepth) {
+        throw std::runtime_error("decodePng: unsupported bit depth");
+    }
+
+    const uint32_t channels = channelCount(colorType);
+    const size_t rowBytes = (static_cast<size_t>(width) * channels * bitDepth + 7) / 8;
+    const size_t pixelBytes = std::max<size_t>(1, channels * bitDepth / 8);
+    const std::vector<uint8_t> rows = unfilter(
+        zlibInflate(compressed, static_cast<size_t>(height) * (rowBytes + 1)), height, rowBytes, pixelBytes);
+
+    RgbaImage image{};
+    image.width = width;
+    image.height = height;
+    image.pixels.resize(static_cast<size_t>(width) * height * 4);
+
+    const size_t sampleBytes = bitDepth / 8;
+    for (uint32_t y = 0; y < height; ++y) {
+        const uint8_t* row = rows.data() + y * rowBytes;
+        for (uint32_t x = 0; x < width; ++x) {
+            uint8_t* out = image.pixels.data() + (static_cast<size_t>(y) * width + x) * 4;
+
+            if (colorType == 3) {
+                const size_t bit = static_cast<size_t>(x) * bitDepth;
+                const uint32_t shift = 8 - bitDepth - static_cast<uint32_t>(bit % 8);
+                const uint8_t index = static_cast<uint8_t>((row[bit / 8] >> shift) & ((1U << bitDepth) - 1U));
+                std::memcpy(out, palette[index].data(), 4);
+                continue;
+            }
+
+            // 16-bit samples keep their high byte; the key comparison uses the full value.
+            const uint8_t* pixel = row + static_cast<size_t>(x) * channels * sampleBytes;
+            std::array<uint16_t, 4> sample{};
+            for (uint32_t c = 0; c < channels; ++c) {
+                sample[c] = sampleBytes == 2
+                    ? static_cast<uint16_t>((pixel[c * 2] << 8) | pixel[c * 2 + 1])
+                    : pixel[c];
+            }
+            const auto narrow = [&](uint16_t v) { return static_cast<uint8_t>(sampleBytes == 2 ? v >> 8 : v); };
+
+            switch (colorType) {
+            case 0:
+                out[0] = out[1] = out[2] = narrow(sample[0]);
+                out[3] = (hasTransparentKey && sample[0] == transparentKey[0]) ? 0 : 255;
+                break;
+            case 2:
+                out[0] = narrow(sample[0]);
+                out[1] = narrow(sample[1]);
+                out[2] = narrow(sample[2]);
+                out[3] = (hasTransparentKey && sample[0] == transparentKey[0] && sample[1] == transparentKey[1] && sample[2] == transparentKey[2]) ? 0 : 255;
+                break;
+            case 4:
+                out[0] = out[1] = out[2] = narrow(sample[0]);
+                out[3] = narrow(sample[1]);
+                break;
+            default:
+                for (uint32_t c = 0; c < 4; ++c) {
+                    out[c] = narrow(sample[c]);
+                }
+                break;
+            }
+        }
+    }
+    return image;
+}
+
+RgbaImage loadPng(const std::string& path)
+{
+    if (const AssetArchive* archive = mountedAssetArchive()) {
+        if (const AssetArchive::Entry* entry = archive->find(path)) {
+            return decodePng(archive->read(*entry));
+        }
+    }
+
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        throw std::runtime_error("loadPng: unable to open " + path);
+    }
+    const std::streamsize size = file.tellg();
+    file.seekg(0, std::ios::beg);
+    std::vector<uint8_t> bytes(static_cast<size_t>(size));
+    if (!file.read(reinterpret_cast<char*>(bytes.data()), size)) {
+        throw std::runtime_error("loadPng: failed to read " + path);
+    }
+    return decodePng(bytes);
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Tightly packed RGBA8, rows top to bottom.
+struct RgbaImage {
+    uint32_t width{ 0 };
+    uint32_t height{ 0 };
+    std::vector<uint8_t> pixels{};
+};
+
+// Decodes non-interlaced PNGs (grey, grey+alpha, RGB, RGBA at 8/16 bits, palette at 1-8 bits) to RGBA8.
+[[nodiscard]] RgbaImage decodePng(const std::vector<uint8_t>& bytes);
+[[nodiscard]] RgbaImage loadPng(const std::string& path);
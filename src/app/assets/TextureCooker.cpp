@@ -0,0 +1,478 @@
+#include "TextureCooker.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+using Color = std::array<float, 3>;
+
+float srgbToLinear(uint8_t value) noexcept
+{
+    static const std::array<float, 256> table = [] {
+        std::array<float, 256> t{};
+        for (size_t i = 0; i < t.size(); ++i) {
+            const float c = static_cast<float>(i) / 255.0F;
+            t[i] = c <= 0.04045F ? c / 12.92F : std::pow((c + 0.055F) / 1.055F, 2.4F);
+        }
+        return t;
+    }();
+    return table[value];
+}
+
+uint8_t linearToSrgb(float value) noexcept
+{
+    const float c = std::clamp(value, 0.0F, 1.0F);
+    const float s = c <= 0.0031308F ? c * 12.92F : 1.055F * std::pow(c, 1.0F / 2.4F) - 0.055F;
+    return static_cast<uint8_t>(std::lround(s * 255.0F));
+}
+
+RgbaImage downsample(const RgbaImage& src)
+{
+    RgbaImage dst{};
+    dst.width = std::max(1U, src.width / 2);
+    dst.height = std::max(1U, src.height / 2);
+    dst.pixels.resize(static_cast<size_t>(dst.width) * dst.height * 4);
+
+    for (uint32_t y = 0; y < dst.height; ++y) {
+        for (uint32_t x = 0; x < dst.width; ++x) {
+            std::array<float, 4> sum{};
+            for (uint32_t dy = 0; dy < 2; ++dy) {
+                for (uint32_t dx = 0; dx < 2; ++dx) {
+                    const uint32_t sx = std::min(x * 2 + dx, src.width - 1);
+                    const uint32_t sy = std::min(y * 2 + dy, src.height - 1);
+                    const uint8_t* p = src.pixels.data() + (static_cast<size_t>(sy) * src.width + sx) * 4;
+                    for (size_t c = 0; c < 3; ++c) {
+                        sum[c] += srgbToLinear(p[c]);
+                    }
+                    sum[3] += static_cast<float>(p[3]);
+                }
+            }
+            uint8_t* out = dst.pixels.data() + (static_cast<size_t>(y) * dst.width + x) * 4;
+            for (size_t c = 0; c < 3; ++c) {
+                out[c] = linearToSrgb(sum[c] * 0.25F);
+            }
+            out[3] = static_cast<uint8_t>(std::lround(sum[3] * 0.25F));
+        }
+    }
+    return dst;
+}
+
+uint16_t packRgb565(const Color& c) noexcept
+{
+    const auto r = static_cast<uint16_t>(std::lround(std::clamp(c[0], 0.0F, 255.0F) * 31.0F / 255.0F));
+    const auto g = static_cast<uint16_t>(std::lround(std::clamp(c[1], 0.0F, 255.0F) * 63.0F / 255.0F));
+    const auto b = static_cast<uint16_t>(std::lround(std::clamp(c[2], 0.0F, 255.0F) * 31.0F / 255.0F));
+    return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+}
+
+Color unpackRgb565(uint16_t v) noexcept
+{
+    const uint32_t r = (v >> 11) & 31U;
+    const uint32_t g = (v >> 5) & 63U;
+    const uint32_t b = v & 31U;
+    return { static_cast<float>((r << 3) | (r >> 2)), static_cast<float>((g << 2) | (g >> 4)), static_cast<float>((b << 3) | (b >> 2)) };
+}
+
+std::array<Color, 4> colorPalette(uint16_t c0, uint16_t c1) noexcept
+{
+    const Color a = unpackRgb565(c0);
+    const Color b = unpackRgb565(c1);
+    std::array<Color, 4> palette{ a, b, Color{}, Color{} };
+    for (size_t k = 0; k < 3; ++k) {
+        palette[2][k] = (2.0F * a[k] + b[k]) / 3.0F;
+        palette[3][k] = (a[k] + 2.0F * b[k]) / 3.0F;
+    }
+    return palette;
+}
+
+float distanceSquared(const Color& a, const Color& b) noexcept
+{
+    const float dr = a[0] - b[0];
+    const float dg = a[1] - b[1];
+    const float db = a[2] - b[2];
+    return dr * dr + dg * dg + db * db;
+}
+
+// Assigns palette indices and returns the summed squared error.
+float assignIndices(const std::array<Color, 16>& texels, uint16_t c0, uint16_t c1, uint32_t& outIndices) noexcept
+{
+    const std::array<Color, 4> palette = colorPalette(c0, c1);
+    float error = 0.0F;
+    outIndices = 0;
+    for (uint32_t i = 0; i < 16; ++i) {
+        uint32_t best = 0;
+        float bestDistance = distanceSquared(texels[i], palette[0]);
+        for (uint32_t p = 1; p < 4; ++p) {
+            const float d = distanceSquared(texels[i], palette[p]);
+            if (d < bestDistance) {
+                bestDistance = d;
+                best = p;
+            }
+        }
+        outIndices |= best << (i * 2);
+        error += bestDistance;
+    }
+    return error;
+}
+
+// Least-squares endpoints for a fixed index assignment.
+bool refitEndpoints(const std::array<Color, 16>& texels, uint32_t indices, Color& outA, Color& outB) noexcept
+{
+    static constexpr std::array<float, 4> kWeightA{ 1.0F, 0.0F, 2.0F / 3.0F, 1.0F / 3.0F };
+    float aa = 0.0F;
+    float bb = 0.0F;
+    float ab = 0.0F;
+    Color ax{};
+    Color bx{};
+    for (uint32_t i = 0; i < 16; ++i) {
+        const float wa = kWeightA[(indices >> (i * 2)) & 3U];
+        const float wb = 1.0F - wa;
+        aa += wa * wa;
+        bb += wb * wb;
+        ab += wa * wb;
+        for (size_t k = 0; k < 3; ++k) {
+            ax[k] += wa * texels[i][k];
+            bx[k] += wb * texels[i][k];
+        }
+    }
+    const float det = aa * bb - ab * ab;
+    if (std::abs(det) < 1e-6F) {
+        return false;
+    }
+    for (size_t k = 0; k < 3; ++k) {
+        outA[k] = (ax[k] * bb - bx[k] * ab) / det;
+        outB[k] = (bx[k] * aa - ax[k] * ab) / det;
+    }
+    return true;
+}
+
+// Principal-axis endpoints with a least-squares refinement pass. Always emits four-colour mode
+// (c0 > c1), which is also how BC2/BC3 interpret their colour block.
+void encodeColorBlock(const std::array<Color, 16>& texels, uint8_t* out) noexcept
+{
+    Color mean{};
+    for (const Color& t : texels) {
+        for (size_t k = 0; k < 3; ++k) {
+            mean[k] += t[k] / 16.0F;
+        }
+    }
+
+    std::array<float, 6> cov{};
+    for (const Color& t : texels) {
+        const Color d{ t[0] - mean[0], t[1] - mean[1], t[2] - mean[2] };
+        cov[0] += d[0] * d[0];
+        cov[1] += d[0] * d[1];
+        cov[2] += d[0] * d[2];
+        cov[3] += d[1] * d[1];
+        cov[4] += d[1] * d[2];
+        cov[5] += d[2] * d[2];
+    }
+
+    Color axis{ 1.0F, 1.0F, 1.0F };
+    for (int iteration = 0; iteration < 8; ++iteration) {
+        const Color next{
+            cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2],
+            cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2],
+            cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2]
+        };
+        const float length = std::sqrt(next[0] * next[0] + next[1] * next[1] + next[2] * next[2]);
+        if (length < 1e-6F) {
+            break;
+        }
+        axis = { next[0] / length, next[1] / length, next[2] / length };
+    }
+
+    float minT = 0.0F;
+    float maxT = 0.0F;
+    for (const Color& t : texels) {
+        const float proj = (t[0] - mean[0]) * axis[0] + (t[1] - mean[1]) * axis[1] + (t[2] - mean[2]) * axis[2];
+        minT = std::min(minT, proj);
+        maxT = std::max(maxT, proj);
+    }
+    // Inset the extremes slightly; the interpolated entries then cover the interior better.
+    const float inset = (maxT - minT) / 16.0F;
+    minT += inset;
+    maxT -= inset;
+
+    Color a{};
+    Color b{};
+    for (size_t k = 0; k < 3; ++k) {
+        a[k] = mean[k] + axis[k] * maxT;
+        b[k] = mean[k] + axis[k] * minT;
+    }
+
+    uint16_t c0 = packRgb565(a);
+    uint16_t c1 = packRgb565(b);
+    uint32_t indices = 0;
+    float error = assignIndices(texels, c0, c1, indices);
+
+    Color refitA{};
+    Color refitB{};
+    if (refitEndpoints(texels, indices, refitA, refitB)) {
+        const uint16_t r0 = packRgb565(refitA);
+        const uint16_t r1 = packRgb565(refitB);
+        uint32_t refitIndices = 0;
+        const float refitError = assignIndices(texels, r0, r1, refitIndices);
+        if (refitError < error) {
+            c0 = r0;
+            c1 = r1;
+            indices = refitIndices;
+            error = refitError;
+        }
+    }
+
+    if (c0 < c1) {
+        std::swap(c0, c1);
+        // Swap endpoints 0<->1 and the two interpolants 2<->3: flip the low bit of every index.
+        indices ^= 0x55555555U;
+    } else if (c0 == c1) {
+        indices = 0;
+    }
+
+    std::memcpy(out, &c0, 2);
+    std::memcpy(out + 2, &c1, 2);
+    std::memcpy(out + 4, &indices, 4);
+}
+
+void encodeAlphaBlock(const std::array<uint8_t, 16>& alpha, uint8_t* out) noexcept
+{
+    const uint8_t a0 = *std::ranges::max_element(alpha);
+    const uint8_t a1 = *std::ranges::min_element(alpha);
+
+    std::array<float, 8> palette{ static_cast<float>(a0), static_cast<float>(a1) };
+    for (int i = 1; i <= 6; ++i) {
+        palette[static_cast<size_t>(i + 1)] = (static_cast<float>(7 - i) * a0 + static_cast<float>(i) * a1) / 7.0F;
+    }
+
+    uint64_t bits = 0;
+    if (a0 != a1) {
+        for (uint32_t i = 0; i < 16; ++i) {
+            uint64_t best = 0;
+            float bestDistance = std::abs(palette[0] - static_cast<float>(alpha[i]));
+            for (uint32_t p = 1; p < 8; ++p) {
+                const float d = std::abs(palette[p] - static_cast<float>(alpha[i]));
+                if (d < bestDistance) {
+                    bestDistance = d;
+                    best = p;
+                }
+            }
+            bits |= best << (i * 3);
+        }
+    }
+
+    out[0] = a0;
+    out[1] = a1;
+    for (size_t i = 0; i < 6; ++i) {
+        out[2 + i] = static_cast<uint8_t>(bits >> (i * 8));
+    }
+}
+
+// Edge blocks replicate the last row/column so partial blocks do not pull in black.
+void gatherBlock(const RgbaImage& image, uint32_t bx, uint32_t by, std::array<Color, 16>& colors, std::array<uint8_t, 16>& alpha) noexcept
+{
+    for (uint32_t py = 0; py < 4; ++py) {
+        for (uint32_t px = 0; px < 4; ++px) {
+            const uint32_t x = std::min(bx * 4 + px, image.width - 1);
+            const uint32_t y = std::min(by * 4 + py, image.height - 1);
+            const uint8_t* p = image.pixels.data() + (static_cast<size_t>(y) * image.width + x) * 4;
+            colors[py * 4 + px] = { static_cast<float>(p[0]), static_cast<float>(p[1]), static_cast<float>(p[2]) };
+            alpha[py * 4 + px] = p[3];
+        }
+    }
+}
+
+std::vector<uint8_t> compressBlocks(const RgbaImage& image, bool withAlpha)
+{
+    const uint32_t blocksX = (image.width + 3) / 4;
+    const uint32_t blocksY = (image.height + 3) / 4;
+    const size_t blockBytes = withAlpha ? 16 : 8;
+    std::vector<uint8_t> out(static_cast<size_t>(blocksX) * blocksY * blockBytes);
+
+    std::array<Color, 16> colors{};
+    std::array<uint8_t, 16> alpha{};
+    for (uint32_t by = 0; by < blocksY; ++by) {
+        for (uint32_t bx = 0; bx < blocksX; ++bx) {
+            gatherBlock(image, bx, by, colors, alpha);
+            uint8_t* block = out.data() + (static_cast<size_t>(by) * blocksX + bx) * blockBytes;
+            if (withAlpha) {
+                encodeAlphaBlock(alpha, block);
+                block += 8;
+            }
+            encodeColorBlock(colors, block);
+        }
+    }
+    return out;
+}
+
+bool hasTranslucentTexels(const RgbaImage& image) noexcept
+{
+    for (size_t i = 3; i < image.pixels.size(); i += 4) {
+        if (image.pixels[i] != 255) {
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t bytesForLevel(TextureFormat format, uint32_t width, uint32_t height) noexcept
+{
+    const size_t blocks = static_cast<size_t>((width + 3) / 4) * ((height + 3) / 4);
+    switch (format) {
+    case TextureFormat::Bc1RgbSrgb: return blocks * 8;
+    case TextureFormat::Bc3Srgb: return blocks * 16;
+    default: return static_cast<size_t>(width) * height * 4;
+    }
+}
+
+float computePsnr(const RgbaImage& reference, const RgbaImage& test) noexcept
+{
+    double squaredError = 0.0;
+    for (size_t i = 0; i < reference.pixels.size(); ++i) {
+        const double d = static_cast<double>(reference.pixels[i]) - static_cast<double>(test.pixels[i]);
+        squaredError += d * d;
+    }
+    if (squaredError == 0.0) {
+        return 0.0F;
+    }
+    const double mse = squaredError / static_cast<double>(reference.pixels.size());
+    return static_cast<float>(10.0 * std::log10(255.0 * 255.0 / mse));
+}
+}
+
+std::vector<RgbaImage> buildMipChain(const RgbaImage& base)
+{
+    if (base.width == 0 || base.height == 0 || base.pixels.size() != static_cast<size_t>(base.width) * base.height * 4) {
+        throw std::runtime_error("buildMipChain: invalid source image");
+    }
+    std::vector<RgbaImage> chain{ base };
+    while (chain.back().width > 1 || chain.back().height > 1) {
+        chain.push_back(downsample(chain.back()));
+    }
+    return chain;
+}
+
+std::vector<uint8_t> compressBc1(const RgbaImage& image)
+{
+    return compressBlocks(image, false);
+}
+
+std::vector<uint8_t> compressBc3(const RgbaImage& image)
+{
+    return compressBlocks(image, true);
+}
+
+RgbaImage decompressBc(const std::vector<uint8_t>& blocks, uint32_t width, uint32_t height, TextureFormat format)
+{
+    if (format == TextureFormat::Rgba8Srgb) {
+        throw std::runtime_error("decompressBc: format is not block compressed");
+    }
+    if (blocks.size() < bytesForLevel(format, width, height)) {
+        throw std::runtime_error("decompressBc: block data is truncated");
+    }
+
+    const bool withAlpha = format == TextureFormat::Bc3Srgb;
+    const size_t blockBytes = withAlpha ? 16 : 8;
+    const uint32_t blocksX = (width + 3) / 4;
+
+    RgbaImage image{};
+    image.width = width;
+    image.height = height;
+    image.pixels.resize(static_cast<size_t>(width) * height * 4);
+
+    for (uint32_t y = 0; y < height; ++y) {
+        for (uint32_t x = 0; x < width; ++x) {
+            const uint8_t* block = blocks.data() + (static_cast<size_t>(y / 4) * blocksX + x / 4) * blockBytes;
+            const uint32_t texel = (y % 4) * 4 + (x % 4);
+            uint8_t* out = image.pixels.data() + (static_cast<size_t>(y) * width + x) * 4;
+
+            out[3] = 255;
+            if (withAlpha) {
+                uint64_t bits = 0;
+                for (size_t i = 0; i < 6; ++i) {
+                    bits |= static_cast<uint64_t>(block[2 + i]) << (i * 8);
+                }
+                const uint32_t index = static_cast<uint32_t>((bits >> (texel * 3)) & 7U);
+                const float a0 = block[0];
+                const float a1 = block[1];
+                float value = 0.0F;
+                if (index == 0) {
+                    value = a0;
+                } else if (index == 1) {
+                    value = a1;
+                } else if (block[0] > block[1]) {
+                    value = (static_cast<float>(8 - index) * a0 + static_cast<float>(index - 1) * a1) / 7.0F;
+                } else if (index < 6) {
+                    value = (static_cast<float>(6 - index) * a0 + static_cast<float>(index - 1) * a1) / 5.0F;
+                } else {
+                    value = index == 6 ? 0.0F : 255.0F;
+                }
+                out[3] = static_cast<uint8_t>(std::lround(value));
+                block += 8;
+            }
+
+            uint16_t c0 = 0;
+            uint16_t c1 = 0;
+            uint32_t indices = 0;
+            std::memcpy(&c0, block, 2);
+            std::memcpy(&c1, block + 2, 2);
+            std::memcpy(&indices, block + 4, 4);
+            const Color color = colorPalette(c0, c1)[(indices >> (texel * 2)) & 3U];
+            for (size_t c = 0; c < 3; ++c) {
+                out[c] = static_cast<uint8_t>(std::lround(color[c]));
+            }
+        }
+    }
+    return image;
+}
+
+TextureAsset cookTexture(uint32_t textureId, const RgbaImage& image, const TextureCookOptions& options, TextureCookStats* outStats)
+{
+    TextureAsset asset{};
+    asset.textureId = textureId;
+    asset.sampler = options.sampler;
+
+    const bool gpuMips = !options.blockCompress && options.gpuMipGeneration;
+    asset.generateMips = gpuMips;
+    if (options.blockCompress) {
+        asset.format = hasTranslucentTexels(image) ? TextureFormat::Bc3Srgb : TextureFormat::Bc1RgbSrgb;
+    }
+
+    const std::vector<RgbaImage> chain = buildMipChain(image);
+    const size_t cookedLevels = gpuMips ? 1 : chain.size();
+
+    TextureCookStats stats{};
+    stats.mipLevels = static_cast<uint32_t>(chain.size());
+    for (const RgbaImage& level : chain) {
+        stats.rgba8Bytes += level.pixels.size();
+    }
+
+    for (size_t i = 0; i < cookedLevels; ++i) {
+        const RgbaImage& level = chain[i];
+        std::vector<uint8_t> bytes{};
+        switch (asset.format) {
+        case TextureFormat::Bc1RgbSrgb: bytes = compressBc1(level); break;
+        case TextureFormat::Bc3Srgb: bytes = compressBc3(level); break;
+        default: bytes = level.pixels; break;
+        }
+
+        asset.mips.push_back(TextureMipLevel{
+            .width = level.width,
+            .height = level.height,
+            .offset = asset.data.size(),
+            .size = bytes.size() });
+        asset.data.insert(asset.data.end(), bytes.begin(), bytes.end());
+    }
+
+    stats.cookedBytes = asset.data.size();
+    if (asset.format != TextureFormat::Rgba8Srgb) {
+        const std::vector<uint8_t> base(asset.data.begin(), asset.data.begin() + static_cast<std::ptrdiff_t>(asset.mips.front().size));
+        stats.psnr = computePsnr(image, decompressBc(base, image.width, image.height, asset.format));
+    }
+    if (outStats != nullptr) {
+        *outStats = stats;
+    }
+    return asset;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "PngDecoder.h"
+
+#include <Engine.h>
+
+#include <cstdint>
+#include <vector>
+
+struct TextureCookOptions {
+    // BC1 for opaque images, BC3 when any texel is translucent; otherwise RGBA8.
+    bool blockCompress{ true };
+    // RGBA8 only: ship the base level and let the engine blit the rest of the chain.
+    bool gpuMipGeneration{ false };
+    TextureSamplerDesc sampler{};
+};
+
+struct TextureCookStats {
+    // Full mip chain as uncompressed RGBA8, for comparison with the cooked size.
+    uint64_t rgba8Bytes{ 0 };
+    uint64_t cookedBytes{ 0 };
+    uint32_t mipLevels{ 0 };
+    // Base level error of the cooked data against the source, in dB (0 when lossless).
+    float psnr{ 0.0F };
+};
+
+// Gamma-correct 2x2 box filter down to 1x1; element 0 is the source image.
+[[nodiscard]] std::vector<RgbaImage> buildMipChain(const RgbaImage& base);
+
+[[nodiscard]] std::vector<uint8_t> compressBc1(const RgbaImage& image);
+[[nodiscard]] std::vector<uint8_t> compressBc3(const RgbaImage& image);
+[[nodiscard]] RgbaImage decompressBc(const std::vector<uint8_t>& blocks, uint32_t width, uint32_t height, TextureFormat format);
+
+[[nodiscard]] TextureAsset cookTexture(uint32_t textureId,
+    const RgbaImage& image,
+    const TextureCookOptions& options = {},
+    TextureCookStats* outStats = nullptr);
@@ -0,0 +1,217 @@
+#include "VertexQuantization.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace {
+int8_t floatToSnorm8(float value) noexcept
+{
+    const float clamped = std::clamp(value, -1.0F, 1.0F);
+    return static_cast<int8_t>(std::lround(clamped * 127.0F));
+}
+
+float snorm8ToFloat(int8_t value) noexcept
+{
+    return std::max(static_cast<float>(value) / 127.0F, -1.0F);
+}
+
+uint8_t floatToUnorm8(float value) noexcept
+{
+    const float clamped = std::clamp(value, 0.0F, 1.0F);
+    return static_cast<uint8_t>(std::lround(clamped * 255.0F));
+}
+
+float safeInverse(float value) noexcept
+{
+    return value > 0.0F ? 1.0F / value : 0.0F;
+}
+}
+
+std::array<float, 3> MeshBounds::center() const noexcept
+{
+    return {
+        (min[0] + max[0]) * 0.5F,
+        (min[1] + max[1]) * 0.5F,
+        (min[2] + max[2]) * 0.5F
+    };
+}
+
+std::array<float, 3> MeshBounds::halfExtent() const noexcept
+{
+    return {
+        (max[0] - min[0]) * 0.5F,
+        (max[1] - min[1]) * 0.5F,
+        (max[2] - min[2]) * 0.5F
+    };
+}
+
+uint16_t floatToHalf(float value) noexcept
+{
+    const uint32_t bits = std::bit_cast<uint32_t>(value);
+    const uint32_t sign = (bits >> 16U) & 0x8000U;
+    const uint32_t exponent = (bits >> 23U) & 0xFFU;
+    uint32_t mantissa = bits & 0x7FFFFFU;
+
+    if (exponent == 0xFFU) {
+        return static_cast<uint16_t>(sign | 0x7C00U | (mantissa != 0 ? 0x200U : 0U));
+    }
+
+    const int32_t halfExponent = static_cast<int32_t>(exponent) - 127 + 15;
+    if (halfExponent >= 0x1F) {
+        return static_cast<uint16_t>(sign | 0x7C00U);
+    }
+
+    if (halfExponent <= 0) {
+        if (halfExponent < -10) {
+            return static_cast<uint16_t>(sign);
+        }
+        mantissa |= 0x800000U;
+        const uint32_t shift = static_cast<uint32_t>(14 - halfExponent);
+        uint32_t halfMantissa = mantissa >> shift;
+        const uint32_t remainder = mantissa & ((1U << shift) - 1U);
+        const uint32_t halfway = 1U << (shift - 1U);
+        if (remainder > halfway || (remainder == halfway && (halfMantissa & 1U) != 0)) {
+            ++halfMantissa;
+        }
+        return static_cast<uint16_t>(sign | halfMantissa);
+    }
+
+    uint32_t half = sign | (static_cast<uint32_t>(halfExponent) << 10U) | (mantissa >> 13U);
+    const uint32_t remainder = mantissa & 0x1FFFU;
+    if (remainder > 0x1000U || (remainder == 0x1000U && (half & 1U) != 0)) {
+        ++half;
+    }
+    return static_cast<uint16_t>(half);
+}
+
+float halfToFloat(uint16_t value) noexcept
+{
+    const uint32_t sign = (static_cast<uint32_t>(value) & 0x8000U) << 16U;
+    const uint32_t exponent = (value >> 10U) & 0x1FU;
+    uint32_t mantissa = value & 0x3FFU;
+
+    if (exponent == 0) {
+        if (mantissa == 0) {
+            return std::bit_cast<float>(sign);
+        }
+        int32_t e = -1;
+        do {
+            ++e;
+            mantissa <<= 1U;
+        } while ((mantissa & 0x400U) == 0);
+        mantissa &= 0x3FFU;
+        const uint32_t bits = sign | (static_cast<uint32_t>(127 - 15 - e) << 23U) | (mantissa << 13U);
+        return std::bit_cast<float>(bits);
+    }
+
+    if (exponent == 0x1FU) {
+        return std::bit_cast<float>(sign | 0x7F800000U | (mantissa << 13U));
+    }
+
+    return std::bit_cast<float>(sign | ((exponent + 127U - 15U) << 23U) | (mantissa << 13U));
+}
+
+int16_t floatToSnorm16(float value) noexcept
+{
+    const float clamped = std::clamp(value, -1.0F, 1.0F);
+    return static_cast<int16_t>(std::lround(clamped * 32767.0F));
+}
+
+float snorm16ToFloat(int16_t value) noexcept
+{
+    return std::max(static_cast<float>(value) / 32767.0F, -1.0F);
+}
+
+std::array<float, 2> encodeOctahedral(const std::array<float, 3>& normal) noexcept
+{
+    const float l1 = std::abs(normal[0]) + std::abs(normal[1]) + std::abs(normal[2]);
+    if (l1 <= 0.0F) {
+        return { 0.0F, 0.0F };
+    }
+
+    float x = normal[0] / l1;
+    float y = normal[1] / l1;
+    if (normal[2] < 0.0F) {
+        const float foldedX = (1.0F - std::abs(y)) * (x >= 0.0F ? 1.0F : -1.0F);
+        const float foldedY = (1.0F - std::abs(x)) * (y >= 0.0F ? 1.0F : -1.0F);
+        x = foldedX;
+        y = foldedY;
+    }
+    return { x, y };
+}
+
+std::array<float, 3> decodeOctahedral(const std::array<float, 2>& encoded) noexcept
+{
+    float x = encoded[0];
+    float y = encoded[1];
+    const float z = 1.0F - std::abs(x) - std::abs(y);
+    const float t = std::max(-z, 0.0F);
+    x += x >= 0.0F ? -t : t;
+    y += y >= 0.0F ? -t : t;
+
+    const float length = std::sqrt(x * x + y * y + z * z);
+    if (length <= 0.0F) {
+        return { 0.0F, 0.0F, 1.0F };
+    }
+    return { x / length, y / length, z / length };
+}
+
+CompactVertexPacket quantizeVertex(VertexFormat format,
+    const MeshBounds& bounds,
+    const std::array<float, 3>& position,
+    const std::array<float, 3>& normal,
+    const std::array<float, 3>& color,
+    const std::array<float, 2>& uv) noexcept
+{
+    const std::array<float, 3> center = bounds.center();
+    const std::array<float, 3> halfExtent = bounds.halfExtent();
+
+    CompactVertexPacket out{};
+    for (size_t axis = 0; axis < 3; ++axis) {
+        const float normalized = (position[axis] - center[axis]) * safeInverse(halfExtent[axis]);
+        out.position[axis] = (format == VertexFormat::CompactHalf)
+            ? floatToHalf(std::clamp(normalized, -1.0F, 1.0F))
+            : static_cast<uint16_t>(floatToSnorm16(normalized));
+    }
+
+    const std::array<float, 2> octahedral = encodeOctahedral(normal);
+    out.normal = { floatToSnorm8(octahedral[0]), floatToSnorm8(octahedral[1]) };
+    out.color = { floatToUnorm8(color[0]), floatToUnorm8(color[1]), floatToUnorm8(color[2]), 255 };
+    out.uv = { floatToHalf(uv[0]), floatToHalf(uv[1]) };
+    return out;
+}
+
+std::array<float, 3> dequantizePosition(VertexFormat format, const MeshBounds& bounds, const CompactVertexPacket& vertex) noexcept
+{
+    const std::array<float, 3> center = bounds.center();
+    const std::array<float, 3> halfExtent = bounds.halfExtent();
+
+    std::array<float, 3> out{};
+    for (size_t axis = 0; axis < 3; ++axis) {
+        const float normalized = (format == VertexFormat::CompactHalf)
+            ? halfToFloat(vertex.position[axis])
+            : snorm16ToFloat(static_cast<int16_t>(vertex.position[axis]));
+        out[axis] = center[axis] + normalized * halfExtent[axis];
+    }
+    return out;
+}
+
+std::array<float, 3> dequantizeNormal(const CompactVertexPacket& vertex) noexcept
+{
+    return decodeOctahedral({ snorm8ToFloat(vertex.normal[0]), snorm8ToFloat(vertex.normal[1]) });
+}
+
+std::array<float, 3> dequantizeColor(const CompactVertexPacket& vertex) noexcept
+{
+    return {
+        static_cast<float>(vertex.color[0]) / 255.0F,
+        static_cast<float>(vertex.color[1]) / 255.0F,
+        static_cast<float>(vertex.color[2]) / 255.0F
+    };
+}
+
+std::array<float, 2> dequantizeUv(const CompactVertexPacket& vertex) noexcept
+{
+    return { halfToFloat(vertex.uv[0]), halfToFloat(vertex.uv[1]) };
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <Engine.h>
+
+#include <array>
+#include <cstdint>
+
+struct MeshBounds {
+    std::array<float, 3> min{ 0.0F, 0.0F, 0.0F };
+    std::array<float, 3> max{ 0.0F, 0.0F, 0.0F };
+
+    [[nodiscard]] std::array<float, 3> center() const noexcept;
+    [[nodiscard]] std::array<float, 3> halfExtent() const noexcept;
+};
+
+struct QuantizationReport {
+    float maxPositionError{ 0.0F };
+    float maxNormalErrorDegrees{ 0.0F };
+    float maxColorError{ 0.0F };
+    float maxUvError{ 0.0F };
+    uint32_t bytesPerVertex{ 0 };
+};
+
+[[nodiscard]] uint16_t floatToHalf(float value) noexcept;
+[[nodiscard]] float halfToFloat(uint16_t value) noexcept;
+
+[[nodiscard]] int16_t floatToSnorm16(float value) noexcept;
+[[nodiscard]] float snorm16ToFloat(int16_t value) noexcept;
+
+[[nodiscard]] std::array<float, 2> encodeOctahedral(const std::array<float, 3>& normal) noexcept;
+[[nodiscard]] std::array<float, 3> decodeOctahedral(const std::array<float, 2>& encoded) noexcept;
+
+// Packs one vertex relative to the mesh bounds. Positions are remapped to [-1, 1] so that the
+// draw transform can undo the remap with a single scale + offset (see LoadedMesh::dequant*).
+[[nodiscard]] CompactVertexPacket quantizeVertex(VertexFormat format,
+    const MeshBounds& bounds,
+    const std::array<float, 3>& position,
+    const std::array<float, 3>& normal,
+    const std::array<float, 3>& color,
+    const std::array<float, 2>& uv) noexcept;
+
+[[nodiscard]] std::array<float, 3> dequantizePosition(VertexFormat format, const MeshBounds& bounds, const CompactVertexPacket& vertex) noexcept;
+[[nodiscard]] std::array<float, 3> dequantizeNormal(const CompactVertexPacket& vertex) noexcept;
+[[nodiscard]] std::array<float, 3> dequantizeColor(const CompactVertexPacket& vertex) noexcept;
+[[nodiscard]] std::array<float, 2> dequantizeUv(const CompactVertexPacket& vertex) noexcept;
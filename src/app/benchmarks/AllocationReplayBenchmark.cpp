@@ -0,0 +1,442 @@
+// Replays an allocation trace recorded by GpuAllocator::startTrace (Engine::RunConfig's
+// allocationTracePath, APP_ALLOCATION_TRACE for the app) against several allocation strategies on
+// a mock memory backend, so allocator changes can be judged on a real workload without a GPU.
+//
+//   allocation_replay <trace> [blockSizeMiB] [dedicatedThresholdMiB]    defaults to 64 and 16
+//
+// Strategies:
+//   tlsf       GpuAllocator's pooled path: blocks of blockSize per (memory type, pool, tiling),
+//              each sub-allocated by TlsfAllocator.
+//   first-fit  The same blocks with the sorted first-fit free list TLSF replaced.
+//   dedicated  One memory object per allocation; the committed-memory floor.
+// Allocations the trace marks dedicated, and those at or above the threshold, get their own
+// memory object in every strategy. Blocks are kept once empty, as GpuAllocator keeps them until a
+// GpuDefragmenter pass releases them. The slab cache in front of small allocations is not modelled.
+//
+// Events are replayed back to back; only the strategy call is timed, so the latencies exclude the
+// driver's vkAllocateMemory cost the mock backend stands in for. Fragmentation is
+// 1 - (sum of each block's largest free range) / (free bytes of all blocks): 0 when every block's
+// free space is one range. It is sampled whenever committed memory reaches a new peak and once
+// more at the end.
+//
+// TLSF trades fit for constant-time lookup, so on traces mixing many sizes and alignments it can
+// peak above first-fit: ranges in buckets below the one it searches are passed over even when
+// they would fit. A gap here is that trade, not a leak; a gap on same-size churn is a bug.
+#include "GpuAllocationTrace.h"
+#include "TlsfAllocator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace {
+constexpr uint64_t kMiB = 1024ull * 1024ull;
+
+// Stands in for vkAllocateMemory / vkFreeMemory: counts memory objects and committed bytes.
+class MockMemoryBackend {
+public:
+    void allocate(uint64_t size)
+    {
+        ++objects_;
+        committedBytes_ += size;
+        peakObjects_ = std::max(peakObjects_, objects_);
+        peakCommittedBytes_ = std::max(peakCommittedBytes_, committedBytes_);
+    }
+
+    void free(uint64_t size) noexcept
+    {
+        --objects_;
+        committedBytes_ -= size;
+    }
+
+    [[nodiscard]] uint64_t objects() const noexcept { return objects_; }
+    [[nodiscard]] uint64_t committedBytes() const noexcept { return committedBytes_; }
+    [[nodiscard]] uint64_t peakObjects() const noexcept { return peakObjects_; }
+    [[nodiscard]] uint64_t peakCommittedBytes() const noexcept { return peakCommittedBytes_; }
+
+private:
+    uint64_t objects_{ 0 };
+    uint64_t committedBytes_{ 0 };
+    uint64_t peakObjects_{ 0 };
+    uint64_t peakCommittedBytes_{ 0 };
+};
+
+// The strategy GpuAllocator used before TLSF (as in allocator_benchmark): scan ranges in offset
+// order, then re-sort and merge after every change.
+class FirstFitRanges {
+public:
+    struct Range {
+        uint64_t offset{ 0 };
+        uint64_t size{ 0 };
+    };
+
+    explicit FirstFitRanges(uint64_t capacity) : ranges_{ Range{ 0, capacity } } {}
+
+    std::optional<Range> allocate(uint64_t size, uint64_t alignment)
+    {
+        for (size_t i = 0; i < ranges_.size(); ++i) {
+            const Range range = ranges_[i];
+            const uint64_t alignedOffset = (range.offset + alignment - 1) & ~(alignment - 1);
+            const uint64_t endOffset = alignedOffset + size;
+            if (endOffset > range.offset + range.size) {
+                continue;
+            }
+            ranges_.erase(ranges_.begin() + static_cast<std::ptrdiff_t>(i));
+            if (alignedOffset > range.offset) {
+                ranges_.push_back({ range.offset, alignedOffset - range.offset });
+            }
+            if (endOffset < range.offset + range.size) {
+                ranges_.push_back({ endOffset, range.offset + range.size - endOffset });
+            }
+            merge();
+            return Range{ alignedOffset, size };
+        }
+        return std::nullopt;
+    }
+
+    void free(const Range& range)
+    {
+        ranges_.push_back(range);
+        merge();
+    }
+
+    [[nodiscard]] uint64_t freeBytes() const noexcept
+    {
+        uint64_t bytes = 0;
+        for (const Range& range : ranges_) {
+            bytes += range.size;
+        }
+        return bytes;
+    }
+
+    [[nodiscard]] uint64_t largestFreeRange() const noexcept
+    {
+        uint64_t largest = 0;
+        for (const Range& range : ranges_) {
+            largest = std::max(largest, range.size);
+        }
+        return largest;
+    }
+
+private:
+    void merge()
+    {
+        std::ranges::sort(ranges_, {}, &Range::offset);
+        size_t out = 0;
+        for (size_t i = 1; i < ranges_.size(); ++i) {
+            if (ranges_[out].offset + ranges_[out].size == ranges_[i].offset) {
+                ranges_[out].size += ranges_[i].size;
+            }
+            else {
+                ranges_[++out] = ranges_[i];
+            }
+        }
+        ranges_.resize(ranges_.empty() ? 0 : out + 1);
+    }
+
+    std::vector<Range> ranges_;
+};
+
+// Adapts the two block sub-allocators to one interface; handles are whatever free() needs.
+struct TlsfRanges {
+    using Handle = uint32_t;
+    static constexpr const char* kName = "tlsf";
+
+    explicit TlsfRanges(uint64_t capacity) : tlsf(capacity) {}
+
+    std::optional<Handle> allocate(uint64_t size, uint64_t alignment)
+    {
+        const auto allocation = tlsf.allocate(size, alignment);
+        return allocation.has_value() ? std::optional<Handle>(allocation->node) : std::nullopt;
+    }
+    void free(Handle handle) noexcept { tlsf.free(handle); }
+    [[nodiscard]] uint64_t freeBytes() const noexcept { return tlsf.freeBytes(); }
+    [[nodiscard]] uint64_t largestFreeRange() const noexcept { return tlsf.largestFreeRange(); }
+
+    TlsfAllocator tlsf;
+};
+
+struct FirstFitBlockRanges {
+    using Handle = FirstFitRanges::Range;
+    static constexpr const char* kName = "first-fit";
+
+    explicit FirstFitBlockRanges(uint64_t capacity) : ranges(capacity) {}
+
+    std::optional<Handle> allocate(uint64_t size, uint64_t alignment) { return ranges.allocate(size, alignment); }
+    void free(Handle handle) { ranges.free(handle); }
+    [[nodiscard]] uint64_t freeBytes() const noexcept { return ranges.freeBytes(); }
+    [[nodiscard]] uint64_t largestFreeRange() const noexcept { return ranges.largestFreeRange(); }
+
+    FirstFitRanges ranges;
+};
+
+struct ReplayConfig {
+    uint64_t blockSize{ 64 * kMiB };
+    uint64_t dedicatedThreshold{ 16 * kMiB };
+};
+
+[[nodiscard]] bool wantsDedicated(const GpuAllocationEvent& event, const ReplayConfig& config) noexcept
+{
+    return (event.flags & GpuAllocationEvent::Dedicated) != 0 || event.size >= config.dedicatedThreshold;
+}
+
+// GpuAllocator's pooled layout around a block sub-allocator: blocks per (memory type, pool,
+// tiling), searched in creation order, a new block when none fits.
+template <typename Ranges>
+class BlockStrategy {
+public:
+    static constexpr const char* kName = Ranges::kName;
+
+    BlockStrategy(MockMemoryBackend& backend, const ReplayConfig& config) : backend_(backend), config_(config) {}
+
+    // False when the allocation cannot be placed at all.
+    bool allocate(const GpuAllocationEvent& event)
+    {
+        std::optional<Live>& live = slotFor(event.id);
+        if (wantsDedicated(event, config_)) {
+            backend_.allocate(event.size);
+            live = Live{ .size = event.size, .dedicated = true };
+            return true;
+        }
+
+        std::vector<Block>& blocks = pools_[poolKey(event)];
+        for (uint32_t i = 0; i < blocks.size(); ++i) {
+            if (const auto handle = blocks[i].ranges->allocate(event.size, event.alignment)) {
+                live = Live{ .size = event.size, .pool = poolKey(event), .block = i, .handle = *handle };
+                return true;
+            }
+        }
+
+        // Room for the worst-case alignment padding, as GpuAllocator sizes oversized blocks.
+        const uint64_t blockSize = std::max(config_.blockSize, event.size + event.alignment);
+        blocks.push_back(Block{ std::make_unique<Ranges>(blockSize), blockSize });
+        backend_.allocate(blockSize);
+        const auto handle = blocks.back().ranges->allocate(event.size, event.alignment);
+        if (!handle.has_value()) {
+            return false;
+        }
+        live = Live{ .size = event.size, .pool = poolKey(event), .block = static_cast<uint32_t>(blocks.size() - 1), .handle = *handle };
+        return true;
+    }
+
+    void free(uint64_t id)
+    {
+        if (id >= live_.size() || !live_[id].has_value()) {
+            return;
+        }
+        const Live& live = *live_[id];
+        if (live.dedicated) {
+            backend_.free(live.size);
+        }
+        else {
+            pools_[live.pool][live.block].ranges->free(live.handle);
+        }
+        live_[id].reset();
+    }
+
+    [[nodiscard]] double fragmentation() const noexcept
+    {
+        uint64_t freeBytes = 0;
+        uint64_t largestFree = 0;
+        for (const auto& [_, blocks] : pools_) {
+            for (const Block& block : blocks) {
+                freeBytes += block.ranges->freeBytes();
+                largestFree += block.ranges->largestFreeRange();
+            }
+        }
+        return freeBytes > 0 ? 1.0 - static_cast<double>(largestFree) / static_cast<double>(freeBytes) : 0.0;
+    }
+
+private:
+    using PoolKey = std::tuple<uint8_t, uint8_t, bool>;
+
+    struct Block {
+        std::unique_ptr<Ranges> ranges{};
+        uint64_t size{ 0 };
+    };
+
+    struct Live {
+        uint64_t size{ 0 };
+        bool dedicated{ false };
+        PoolKey pool{};
+        uint32_t block{ 0 };
+        typename Ranges::Handle handle{};
+    };
+
+    [[nodiscard]] static PoolKey poolKey(const GpuAllocationEvent& event) noexcept
+    {
+        return { event.memoryTypeIndex, event.pool, (event.flags & GpuAllocationEvent::OptimalTiling) != 0 };
+    }
+
+    std::optional<Live>& slotFor(uint64_t id)
+    {
+        if (id >= live_.size()) {
+            live_.resize(static_cast<size_t>(id) + 1);
+        }
+        return live_[id];
+    }
+
+    MockMemoryBackend& backend_;
+    ReplayConfig config_{};
+    std::map<PoolKey, std::vector<Block>> pools_{};
+    std::vector<std::optional<Live>> live_{};
+};
+
+class DedicatedStrategy {
+public:
+    static constexpr const char* kName = "dedicated";
+
+    DedicatedStrategy(MockMemoryBackend& backend, const ReplayConfig&) : backend_(backend) {}
+
+    bool allocate(const GpuAllocationEvent& event)
+    {
+        if (event.id >= sizes_.size()) {
+            sizes_.resize(static_cast<size_t>(event.id) + 1, 0);
+        }
+        backend_.allocate(event.size);
+        sizes_[event.id] = event.size;
+        return true;
+    }
+
+    void free(uint64_t id) noexcept
+    {
+        if (id < sizes_.size() && sizes_[id] > 0) {
+            backend_.free(sizes_[id]);
+            sizes_[id] = 0;
+        }
+    }
+
+    // Every free byte is returned to the backend.
+    [[nodiscard]] double fragmentation() const noexcept { return 0.0; }
+
+private:
+    MockMemoryBackend& backend_;
+    std::vector<uint64_t> sizes_{};
+};
+
+struct Percentiles {
+    double p50Ns{ 0.0 };
+    double p90Ns{ 0.0 };
+    double p99Ns{ 0.0 };
+    double p999Ns{ 0.0 };
+    double maxNs{ 0.0 };
+};
+
+Percentiles summarize(std::vector<double>& samples)
+{
+    if (samples.empty()) {
+        return {};
+    }
+    std::ranges::sort(samples);
+    const auto at = [&samples](size_t perMille) { return samples[std::min(samples.size() - 1, samples.size() * perMille / 1000)]; };
+    return Percentiles{ at(500), at(900), at(990), at(999), samples.back() };
+}
+
+void printLatency(const char* label, std::vector<double>& samples)
+{
+    const Percentiles p = summarize(samples);
+    std::cout << "  " << label << " ns: p50 " << p.p50Ns << ", p90 " << p.p90Ns << ", p99 " << p.p99Ns
+              << ", p99.9 " << p.p999Ns << ", max " << p.maxNs << '\n';
+}
+
+template <typename Fn>
+double timeNs(Fn&& fn)
+{
+    const auto start = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+template <typename Strategy>
+void replay(const std::vector<GpuAllocationEvent>& events, const ReplayConfig& config)
+{
+    MockMemoryBackend backend{};
+    Strategy strategy(backend, config);
+
+    std::vector<double> allocateNs{};
+    std::vector<double> freeNs{};
+    uint64_t failures = 0;
+    uint64_t peakCommitted = 0;
+    double fragmentationAtPeak = 0.0;
+    for (const GpuAllocationEvent& event : events) {
+        if (event.op == GpuAllocationEvent::Op::Allocate) {
+            bool placed = false;
+            allocateNs.push_back(timeNs([&]() { placed = strategy.allocate(event); }));
+            failures += placed ? 0 : 1;
+        }
+        else {
+            freeNs.push_back(timeNs([&]() { strategy.free(event.id); }));
+        }
+        if (backend.committedBytes() > peakCommitted) {
+            peakCommitted = backend.committedBytes();
+            fragmentationAtPeak = strategy.fragmentation();
+        }
+    }
+
+    std::cout << Strategy::kName << ": peak " << (backend.peakCommittedBytes() / kMiB) << " MiB committed in "
+              << backend.peakObjects() << " memory objects (end " << (backend.committedBytes() / kMiB) << " MiB in "
+              << backend.objects() << "), fragmentation " << fragmentationAtPeak << " at peak, "
+              << strategy.fragmentation() << " at end, " << failures << " failures\n";
+    printLatency("allocate", allocateNs);
+    printLatency("free", freeNs);
+}
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2) {
+        std::cerr << "usage: allocation_replay <trace> [blockSizeMiB] [dedicatedThresholdMiB]\n";
+        return 1;
+    }
+    ReplayConfig config{};
+    if (argc > 2) {
+        config.blockSize = std::stoull(argv[2]) * kMiB;
+    }
+    if (argc > 3) {
+        config.dedicatedThreshold = std::stoull(argv[3]) * kMiB;
+    }
+
+    std::vector<GpuAllocationEvent> events{};
+    try {
+        events = readGpuAllocationTrace(argv[1]);
+    }
+    catch (const std::runtime_error& error) {
+        std::cerr << error.what() << '\n';
+        return 1;
+    }
+
+    // The workload itself, independent of any strategy.
+    uint64_t allocations = 0;
+    uint64_t liveBytes = 0;
+    uint64_t peakLiveBytes = 0;
+    std::vector<uint64_t> sizes{};
+    for (const GpuAllocationEvent& event : events) {
+        if (event.op == GpuAllocationEvent::Op::Allocate) {
+            ++allocations;
+            sizes.push_back(event.size);
+            liveBytes += event.size;
+            peakLiveBytes = std::max(peakLiveBytes, liveBytes);
+        }
+        else {
+            liveBytes -= sizes[event.id];
+        }
+    }
+    const double seconds = events.empty() ? 0.0 : static_cast<double>(events.back().timestampNs) / 1e9;
+    std::cout << "trace: " << allocations << " allocations, " << (events.size() - allocations) << " frees over "
+              << seconds << " s, peak " << (peakLiveBytes / kMiB) << " MiB live, " << (liveBytes / kMiB)
+              << " MiB never freed\n";
+
+    replay<BlockStrategy<TlsfRanges>>(events, config);
+    replay<BlockStrategy<FirstFitBlockRanges>>(events, config);
+    replay<DedicatedStrategy>(events, config);
+    return 0;
+}
@@ -0,0 +1,243 @@
+// Stresses GpuAllocator's block sub-allocator at increasing live allocation counts: the TLSF
+// allocator every pooled VkDeviceMemory block uses, against the sorted first-fit free list it
+// replaced. Each row fills one block to the live count, then times a random free followed by a
+// random allocate, so the live count stays constant while the free space fragments.
+//
+//   allocator_benchmark [maxLive]        defaults to 100000
+//
+// TLSF does constant work per call, but not constant-latency work: its node pool holds about two
+// nodes per live allocation (the second being alignment padding or a hole), so at 100k it is
+// ~8 MiB and every dependent node read free() makes on a random victim misses the cache. The
+// tlsf-recent rows free the allocation made by the previous iteration instead, keeping the
+// victim's nodes warm; the gap between the two rows is memory latency, not search length.
+// First-fit grows with the live count, so its churn is cut short at large counts and skipped
+// past kFirstFitMaxLive, where filling alone takes minutes.
+#include "TlsfAllocator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+constexpr uint64_t kCapacity = 64ull * 1024ull * 1024ull * 1024ull;
+constexpr size_t kTlsfChurnOps = 200000;
+constexpr size_t kFirstFitChurnOps = 2000;
+constexpr size_t kFirstFitMaxLive = 10000;
+
+struct Request {
+    uint64_t size{ 0 };
+    uint64_t alignment{ 0 };
+};
+
+// Buffer- and image-like requirements: mostly small, power-of-two aligned.
+Request randomRequest(std::mt19937_64& rng)
+{
+    static constexpr uint64_t kAlignments[] = { 16, 64, 256, 4096, 65536 };
+    std::uniform_int_distribution<uint64_t> size(256, 256 * 1024);
+    std::uniform_int_distribution<size_t> alignment(0, std::size(kAlignments) - 1);
+    return Request{ size(rng), kAlignments[alignment(rng)] };
+}
+
+// The strategy GpuAllocator used before TLSF: scan ranges in offset order, then re-sort and
+// merge after every change.
+class FirstFitRanges {
+public:
+    struct Range {
+        uint64_t offset{ 0 };
+        uint64_t size{ 0 };
+    };
+
+    explicit FirstFitRanges(uint64_t capacity) : ranges_{ Range{ 0, capacity } } {}
+
+    std::optional<Range> allocate(uint64_t size, uint64_t alignment)
+    {
+        for (size_t i = 0; i < ranges_.size(); ++i) {
+            const Range range = ranges_[i];
+            const uint64_t alignedOffset = (range.offset + alignment - 1) & ~(alignment - 1);
+            const uint64_t endOffset = alignedOffset + size;
+            if (endOffset > range.offset + range.size) {
+                continue;
+            }
+            ranges_.erase(ranges_.begin() + static_cast<std::ptrdiff_t>(i));
+            if (alignedOffset > range.offset) {
+                ranges_.push_back({ range.offset, alignedOffset - range.offset });
+            }
+            if (endOffset < range.offset + range.size) {
+                ranges_.push_back({ endOffset, range.offset + range.size - endOffset });
+            }
+            merge();
+            return Range{ alignedOffset, size };
+        }
+        return std::nullopt;
+    }
+
+    void free(const Range& range)
+    {
+        ranges_.push_back(range);
+        merge();
+    }
+
+private:
+    void merge()
+    {
+        std::ranges::sort(ranges_, {}, &Range::offset);
+        size_t out = 0;
+        for (size_t i = 1; i < ranges_.size(); ++i) {
+            if (ranges_[out].offset + ranges_[out].size == ranges_[i].offset) {
+                ranges_[out].size += ranges_[i].size;
+            }
+            else {
+                ranges_[++out] = ranges_[i];
+            }
+        }
+        ranges_.resize(out + 1);
+    }
+
+    std::vector<Range> ranges_;
+};
+
+struct Latency {
+    double meanNs{ 0.0 };
+    double p99Ns{ 0.0 };
+};
+
+Latency summarize(std::vector<double>& samples)
+{
+    if (samples.empty()) {
+        return {};
+    }
+    double sum = 0.0;
+    for (const double sample : samples) {
+        sum += sample;
+    }
+    const size_t p99 = std::min(samples.size() - 1, samples.size() * 99 / 100);
+    std::ranges::nth_element(samples, samples.begin() + static_cast<std::ptrdiff_t>(p99));
+    return Latency{ sum / static_cast<double>(samples.size()), samples[p99] };
+}
+
+void report(const char* name, size_t live, size_t ops, Latency allocate, Latency free)
+{
+    std::cout << name << " live=" << live << " ops=" << ops
+              << ": allocate mean " << allocate.meanNs << " ns, p99 " << allocate.p99Ns << " ns"
+              << " | free mean " << free.meanNs << " ns, p99 " << free.p99Ns << " ns\n";
+}
+
+// Times one call; the clock's own overhead is included but identical for both strategies.
+template <typename Fn>
+double timeNs(Fn&& fn)
+{
+    const auto start = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Which live allocation each churn iteration frees.
+enum class FreeOrder {
+    Random,
+    // The one the previous iteration allocated; the first iteration takes the last fill.
+    Recent
+};
+
+template <typename Allocator, typename Handle, typename AllocateFn, typename FreeFn>
+void churn(const char* name, FreeOrder order, size_t live, size_t ops, Allocator& allocator, AllocateFn&& allocateOne,
+    FreeFn&& freeOne)
+{
+    std::mt19937_64 rng(live);
+    std::vector<Handle> handles{};
+    handles.reserve(live);
+    while (handles.size() < live) {
+        const Request request = randomRequest(rng);
+        std::optional<Handle> handle = allocateOne(allocator, request);
+        if (!handle.has_value()) {
+            std::cerr << name << ": out of space while filling to " << live << '\n';
+            std::exit(1);
+        }
+        handles.push_back(*handle);
+    }
+
+    std::vector<double> allocateNs{};
+    std::vector<double> freeNs{};
+    allocateNs.reserve(ops);
+    freeNs.reserve(ops);
+    size_t victim = handles.size() - 1;
+    for (size_t op = 0; op < ops; ++op) {
+        if (order == FreeOrder::Random) {
+            victim = std::uniform_int_distribution<size_t>(0, handles.size() - 1)(rng);
+        }
+        // Read outside the timed call so the handle array's own cache miss is not charged to free.
+        const Handle freed = handles[victim];
+        freeNs.push_back(timeNs([&]() { freeOne(allocator, freed); }));
+
+        const Request request = randomRequest(rng);
+        std::optional<Handle> handle{};
+        allocateNs.push_back(timeNs([&]() { handle = allocateOne(allocator, request); }));
+        if (!handle.has_value()) {
+            std::cerr << name << ": out of space during churn at " << live << '\n';
+            std::exit(1);
+        }
+        handles[victim] = *handle;
+    }
+
+    report(name, live, ops, summarize(allocateNs), summarize(freeNs));
+
+    for (const Handle& handle : handles) {
+        freeOne(allocator, handle);
+    }
+}
+
+void benchmarkTlsf(const char* name, FreeOrder order, size_t live)
+{
+    TlsfAllocator allocator(kCapacity);
+    churn<TlsfAllocator, TlsfAllocator::Allocation>(name, order, live, kTlsfChurnOps, allocator,
+        [](TlsfAllocator& tlsf, const Request& request) { return tlsf.allocate(request.size, request.alignment); },
+        [](TlsfAllocator& tlsf, const TlsfAllocator::Allocation& allocation) { tlsf.free(allocation.node); });
+
+    // Everything was returned, so the block must have coalesced back into one range.
+    if (allocator.allocationCount() != 0 || allocator.freeRangeCount() != 1 || allocator.freeBytes() != kCapacity) {
+        std::cerr << name << ": block did not coalesce after freeing every allocation\n";
+        std::exit(1);
+    }
+}
+
+void benchmarkFirstFit(size_t live)
+{
+    FirstFitRanges allocator(kCapacity);
+    // Scaled so every row takes similar wall time; the per-op cost is what matters.
+    const size_t ops = std::max<size_t>(100, kFirstFitChurnOps * 1000 / std::max<size_t>(live, 1000));
+    churn<FirstFitRanges, FirstFitRanges::Range>("first-fit", FreeOrder::Random, live, ops, allocator,
+        [](FirstFitRanges& ranges, const Request& request) { return ranges.allocate(request.size, request.alignment); },
+        [](FirstFitRanges& ranges, const FirstFitRanges::Range& range) { ranges.free(range); });
+}
+}
+
+int main(int argc, char** argv)
+{
+    const size_t maxLive = argc > 1 ? std::stoull(argv[1]) : 100000;
+
+    std::vector<size_t> liveCounts{};
+    for (size_t live = 1000; live < maxLive; live *= 10) {
+        liveCounts.push_back(live);
+    }
+    liveCounts.push_back(maxLive);
+
+    for (const size_t live : liveCounts) {
+        benchmarkTlsf("tlsf", FreeOrder::Random, live);
+    }
+    for (const size_t live : liveCounts) {
+        benchmarkTlsf("tlsf-recent", FreeOrder::Recent, live);
+    }
+    for (const size_t live : liveCounts) {
+        if (live > kFirstFitMaxLive) {
+            std::cout << "first-fit live=" << live << ": skipped\n";
+            continue;
+        }
+        benchmarkFirstFit(live);
+    }
+    return 0;
+}
@@ -0,0 +1,221 @@
+// Measures small sub-allocation throughput as threads are added: GpuAllocator's small path (a
+// SlabCache over a TLSF block) against the single mutex every request used to take. Each thread
+// keeps a window of live allocations and replaces a random one per op, with sizes from 256 B to
+// 64 KiB, so both strategies see the same alloc/free mix and the TLSF block never runs dry.
+//
+//   allocator_contention_benchmark [maxThreads] [opsPerThread]    defaults to 32 and 200000
+//
+// The slab cache should scale close to linearly up to the core count, since a thread only locks
+// once per kBatchSlots slots; the mutex row flattens or drops as soon as a second thread joins.
+// Past the core count both rows only show oversubscription.
+#include "SlabCache.h"
+#include "TlsfAllocator.h"
+
+#include <barrier>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+constexpr uint64_t kCapacity = 16ull * 1024ull * 1024ull * 1024ull;
+constexpr size_t kLivePerThread = 256;
+
+using Slabs = SlabCache<uint32_t>;
+
+uint64_t randomSize(std::mt19937_64& rng)
+{
+    return std::uniform_int_distribution<uint64_t>(Slabs::kMinSlotSize, Slabs::kMaxSlotSize)(rng);
+}
+
+// One TLSF range behind one lock, as GpuAllocator served every request before the slab cache.
+class LockedTlsf {
+public:
+    struct Handle {
+        uint32_t node{ TlsfAllocator::kInvalidNode };
+    };
+
+    LockedTlsf() : tlsf_(kCapacity) {}
+
+    std::optional<Handle> allocate(uint64_t size)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const std::optional<TlsfAllocator::Allocation> allocation = tlsf_.allocate(size, 256);
+        if (!allocation.has_value()) {
+            return std::nullopt;
+        }
+        return Handle{ allocation->node };
+    }
+
+    void free(const Handle& handle)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tlsf_.free(handle.node);
+    }
+
+    [[nodiscard]] uint32_t allocationCount() const noexcept { return tlsf_.allocationCount(); }
+
+private:
+    std::mutex mutex_{};
+    TlsfAllocator tlsf_;
+};
+
+// The same TLSF range, carved into slabs on demand like GpuAllocator::acquireSlab does.
+class CachedTlsf {
+public:
+    struct Handle {
+        Slabs::Slot slot{};
+        uint64_t size{ 0 };
+    };
+
+    CachedTlsf()
+        : tlsf_(kCapacity)
+        , slabs_(
+              [this](uint64_t, uint64_t size, uint64_t alignment) -> std::optional<Slabs::AcquiredSlab> {
+                  std::lock_guard<std::mutex> lock(mutex_);
+                  const std::optional<TlsfAllocator::Allocation> allocation = tlsf_.allocate(size, alignment);
+                  if (!allocation.has_value()) {
+                      return std::nullopt;
+                  }
+                  return Slabs::AcquiredSlab{ allocation->offset, allocation->node };
+              },
+              [this](uint64_t, const Slabs::Slab& slab) {
+                  std::lock_guard<std::mutex> lock(mutex_);
+                  tlsf_.free(slab.payload);
+              })
+    {
+    }
+
+    std::optional<Handle> allocate(uint64_t size)
+    {
+        const std::optional<Slot> slot = slabs_.allocate(0, *Slabs::classFor(size, 256), 0, size);
+        if (!slot.has_value()) {
+            return std::nullopt;
+        }
+        return Handle{ *slot, size };
+    }
+
+    void free(const Handle& handle) { slabs_.free(handle.slot, 0, handle.size); }
+
+    void trim() { slabs_.trim(); }
+    [[nodiscard]] Slabs::Stats stats() const { return slabs_.stats(); }
+    [[nodiscard]] uint32_t allocationCount() const noexcept { return tlsf_.allocationCount(); }
+
+private:
+    using Slot = Slabs::Slot;
+
+    std::mutex mutex_{};
+    TlsfAllocator tlsf_;
+    Slabs slabs_;
+};
+
+// Runs every thread through the same number of replace ops and returns total ops per second.
+// Fill and teardown happen outside the timed region.
+template <typename Allocator>
+double churn(const char* name, Allocator& allocator, size_t threadCount, size_t opsPerThread)
+{
+    using Handle = typename Allocator::Handle;
+
+    std::barrier<> start(static_cast<std::ptrdiff_t>(threadCount + 1));
+    std::barrier<> done(static_cast<std::ptrdiff_t>(threadCount + 1));
+    std::vector<std::jthread> threads{};
+    threads.reserve(threadCount);
+    for (size_t t = 0; t < threadCount; ++t) {
+        threads.emplace_back([&, t]() {
+            std::mt19937_64 rng(t + 1);
+            std::vector<Handle> handles{};
+            handles.reserve(kLivePerThread);
+            const auto allocateOne = [&]() {
+                std::optional<Handle> handle = allocator.allocate(randomSize(rng));
+                if (!handle.has_value()) {
+                    std::cerr << name << ": out of space\n";
+                    std::exit(1);
+                }
+                return *handle;
+            };
+            while (handles.size() < kLivePerThread) {
+                handles.push_back(allocateOne());
+            }
+
+            start.arrive_and_wait();
+            for (size_t op = 0; op < opsPerThread; ++op) {
+                const size_t victim = std::uniform_int_distribution<size_t>(0, kLivePerThread - 1)(rng);
+                allocator.free(handles[victim]);
+                handles[victim] = allocateOne();
+            }
+            done.arrive_and_wait();
+
+            for (const Handle& handle : handles) {
+                allocator.free(handle);
+            }
+        });
+    }
+
+    start.arrive_and_wait();
+    const auto begin = std::chrono::steady_clock::now();
+    done.arrive_and_wait();
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    // Exiting threads hand their slab caches back, after which every slab is whole again.
+    threads.clear();
+    if constexpr (requires { allocator.trim(); }) {
+        allocator.trim();
+    }
+    return static_cast<double>(threadCount * opsPerThread) / seconds;
+}
+
+void report(const char* name, size_t threadCount, double opsPerSecond, double singleThread)
+{
+    const double speedup = opsPerSecond / singleThread;
+    std::cout << name << " threads=" << threadCount << ": " << opsPerSecond / 1e6 << " Mops/s"
+              << ", speedup " << speedup << "x, efficiency " << 100.0 * speedup / static_cast<double>(threadCount)
+              << "%\n";
+}
+}
+
+int main(int argc, char** argv)
+{
+    const size_t maxThreads = argc > 1 ? std::stoull(argv[1]) : 32;
+    const size_t opsPerThread = argc > 2 ? std::stoull(argv[2]) : 200000;
+
+    std::vector<size_t> threadCounts{};
+    for (size_t threads = 1; threads < maxThreads; threads *= 2) {
+        threadCounts.push_back(threads);
+    }
+    threadCounts.push_back(maxThreads);
+
+    std::cout << "hardware threads: " << std::thread::hardware_concurrency() << '\n';
+
+    double lockedSingle = 0.0;
+    for (const size_t threads : threadCounts) {
+        LockedTlsf allocator{};
+        const double opsPerSecond = churn("mutex", allocator, threads, opsPerThread);
+        lockedSingle = threads == 1 ? opsPerSecond : lockedSingle;
+        report("mutex", threads, opsPerSecond, lockedSingle);
+        if (allocator.allocationCount() != 0) {
+            std::cerr << "mutex: allocations leaked\n";
+            return 1;
+        }
+    }
+
+    double cachedSingle = 0.0;
+    for (const size_t threads : threadCounts) {
+        CachedTlsf allocator{};
+        const double opsPerSecond = churn("slab", allocator, threads, opsPerThread);
+        cachedSingle = threads == 1 ? opsPerSecond : cachedSingle;
+        report("slab", threads, opsPerSecond, cachedSingle);
+        const Slabs::Stats stats = allocator.stats();
+        std::cout << "  slab refills/spills " << stats.refills << '/' << stats.spills << ", slabs left " << stats.slabCount << '\n';
+        // Every slot came home and trim() ran, so every slab must have gone back to the block.
+        if (allocator.allocationCount() != 0) {
+            std::cerr << "slab: " << allocator.allocationCount() << " slabs still carved after trim\n";
+            return 1;
+        }
+    }
+    return 0;
+}
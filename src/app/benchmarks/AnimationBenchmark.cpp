@@ -0,0 +1,138 @@
+// Times AnimationSys over many entities against a naive sampler that binary-searches every channel
+// and slerps with glm per entity.
+//
+//   animation_benchmark [entities] [keys per channel]
+//
+// Each entity plays translation, rotation and scale channels of one synthetic clip, with linear,
+// step and cubic spline clips mixed, at staggered start times.
+#include "ecs/components/AnimationComp.h"
+#include "ecs/components/TransformComp.h"
+#include "ecs/systems/AnimationSys.h"
+
+#include <ecs/World.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace {
+constexpr int kFrames = 240;
+constexpr float kFrameSeconds = 1.0F / 60.0F;
+
+std::shared_ptr<const GlbAnimation> makeClip(GlbInterpolation interpolation, size_t keyCount, std::mt19937& rng)
+{
+    std::uniform_real_distribution<float> value(-1.0F, 1.0F);
+    auto clip = std::make_shared<GlbAnimation>();
+    clip->duration = static_cast<float>(keyCount - 1) * 0.1F;
+    for (const GlbAnimationPath path : { GlbAnimationPath::Translation, GlbAnimationPath::Rotation, GlbAnimationPath::Scale }) {
+        GlbAnimationChannel channel{ .node = 0, .path = path, .interpolation = interpolation };
+        const size_t components = path == GlbAnimationPath::Rotation ? 4 : 3;
+        const size_t valuesPerKey = interpolation == GlbInterpolation::CubicSpline ? 3 : 1;
+        for (size_t k = 0; k < keyCount; ++k) {
+            channel.times.push_back(static_cast<float>(k) * 0.1F);
+            for (size_t v = 0; v < valuesPerKey; ++v) {
+                glm::vec4 sample{ value(rng), value(rng), value(rng), value(rng) };
+                if (path == GlbAnimationPath::Rotation && (valuesPerKey == 1 || v == 1)) {
+                    sample = glm::normalize(sample);
+                }
+                channel.values.insert(channel.values.end(), &sample.x, &sample.x + components);
+            }
+        }
+        clip->channels.push_back(std::move(channel));
+    }
+    return clip;
+}
+
+// What sampling costs without cursors or batching: a search per channel and glm per entity.
+void sampleNaive(World& world, float deltaSeconds)
+{
+    world.query<AnimationComp, TransformComp>().each([&](Entity, AnimationComp& animation, TransformComp& transform) {
+        const GlbAnimation& clip = *animation.clip;
+        animation.time = std::fmod(animation.time + deltaSeconds * animation.speed, clip.duration);
+        glm::vec3 t{ 0.0F };
+        glm::quat r{ 1.0F, 0.0F, 0.0F, 0.0F };
+        glm::vec3 s{ 1.0F };
+        for (const GlbAnimationChannel& channel : clip.channels) {
+            const size_t components = channel.path == GlbAnimationPath::Rotation ? 4 : 3;
+            const size_t stride = channel.interpolation == GlbInterpolation::CubicSpline ? 3 * components : components;
+            const size_t offset = channel.interpolation == GlbInterpolation::CubicSpline ? components : 0;
+            const auto next = std::upper_bound(channel.times.begin(), channel.times.end(), animation.time);
+            const size_t k1 = std::min<size_t>(static_cast<size_t>(next - channel.times.begin()), channel.times.size() - 1);
+            const size_t k0 = k1 == 0 ? 0 : k1 - 1;
+            const float span = channel.times[k1] - channel.times[k0];
+            const float u = channel.interpolation == GlbInterpolation::Step || span <= 0.0F
+                ? 0.0F
+                : std::clamp((animation.time - channel.times[k0]) / span, 0.0F, 1.0F);
+            const float* a = channel.values.data() + k0 * stride + offset;
+            const float* b = channel.values.data() + k1 * stride + offset;
+            if (channel.path == GlbAnimationPath::Rotation) {
+                r = glm::slerp(glm::quat(a[3], a[0], a[1], a[2]), glm::quat(b[3], b[0], b[1], b[2]), u);
+            } else {
+                const glm::vec3 v = glm::mix(glm::vec3(a[0], a[1], a[2]), glm::vec3(b[0], b[1], b[2]), u);
+                (channel.path == GlbAnimationPath::Translation ? t : s) = v;
+            }
+        }
+        const glm::mat4 local = glm::translate(glm::mat4(1.0F), t) * glm::mat4_cast(r) * glm::scale(glm::mat4(1.0F), s);
+        const float* data = glm::value_ptr(local);
+        std::copy(data, data + 16, transform.local.begin());
+    });
+}
+
+template <typename Fn>
+void report(const char* name, size_t entityCount, Fn&& frame)
+{
+    double best = 1e30;
+    double total = 0.0;
+    for (int f = 0; f < kFrames; ++f) {
+        const auto start = std::chrono::steady_clock::now();
+        frame();
+        const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        best = std::min(best, ms);
+        total += ms;
+    }
+    const double mean = total / kFrames;
+    std::cout << name << ": " << mean << " ms/frame mean, " << best << " ms best, "
+              << mean * 1e6 / static_cast<double>(entityCount) << " ns/entity\n";
+}
+}
+
+int main(int argc, char** argv)
+{
+    const size_t entityCount = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 10000;
+    const size_t keyCount = std::max<size_t>(argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 64, 2);
+
+    std::mt19937 rng(42);
+    const std::array<std::shared_ptr<const GlbAnimation>, 3> clips{
+        makeClip(GlbInterpolation::Linear, keyCount, rng),
+        makeClip(GlbInterpolation::Step, keyCount, rng),
+        makeClip(GlbInterpolation::CubicSpline, keyCount, rng)
+    };
+
+    World world{};
+    const std::vector<Entity> entities = world.createEntities(entityCount);
+    std::vector<AnimationComp> animations(entityCount);
+    for (size_t i = 0; i < entityCount; ++i) {
+        AnimationComp& animation = animations[i];
+        animation.clip = clips[i % clips.size()];
+        animation.channels = { 0, 1, 2 };
+        animation.time = std::fmod(static_cast<float>(i) * 0.37F, animation.clip->duration);
+    }
+    world.insertComponents(entities, std::vector<TransformComp>(entityCount));
+    world.insertComponents(entities, std::move(animations));
+
+    std::cout << entityCount << " entities, " << keyCount << " keys per channel, " << kFrames << " frames\n";
+    AnimationSys animationSys{};
+    const SimulationFrameInput input{ .deltaSeconds = kFrameSeconds };
+    report("AnimationSys", entityCount, [&]() { animationSys.update(world, input); });
+    report("naive (search + glm)", entityCount, [&]() { sampleNaive(world, kFrameSeconds); });
+    return 0;
+}
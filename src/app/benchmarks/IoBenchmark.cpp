@@ -0,0 +1,114 @@
+// Compares asset read paths over a set of files: one blocking std::ifstream per file (what
+// readBinaryFile does), BatchFileReader's worker pool, and io_uring, each buffered and O_DIRECT.
+//
+//   io_benchmark [directory]             reads every regular file under directory
+//   io_benchmark --generate N KiB        writes N files of KiB each to a temp directory first
+//
+// Buffered runs after the first are served from the page cache; the O_DIRECT rows show device
+// throughput.
+#include "assets/BatchFileReader.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+constexpr int kRuns = 5;
+
+std::vector<std::string> generateFiles(size_t count, size_t kib)
+{
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "io_benchmark";
+    std::filesystem::create_directories(directory);
+    std::mt19937 rng(1234);
+    std::vector<char> bytes(kib * 1024);
+    std::vector<std::string> paths{};
+    for (size_t i = 0; i < count; ++i) {
+        std::generate(bytes.begin(), bytes.end(), [&]() { return static_cast<char>(rng()); });
+        const std::filesystem::path path = directory / ("file" + std::to_string(i) + ".bin");
+        std::ofstream(path, std::ios::binary).write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        paths.push_back(path.string());
+    }
+    return paths;
+}
+
+std::vector<std::string> listFiles(const std::string& directory)
+{
+    std::vector<std::string> paths{};
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(directory)) {
+        if (entry.is_regular_file()) {
+            paths.push_back(entry.path().string());
+        }
+    }
+    std::ranges::sort(paths);
+    return paths;
+}
+
+template <typename Fn>
+void report(const char* name, uint64_t totalBytes, size_t fileCount, Fn&& readAll)
+{
+    double best = 1e30;
+    for (int run = 0; run < kRuns; ++run) {
+        const auto start = std::chrono::steady_clock::now();
+        readAll();
+        best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+    std::cout << name << ": " << best * 1000.0 << " ms, "
+              << static_cast<double>(totalBytes) / (1024.0 * 1024.0) / best << " MiB/s, "
+              << static_cast<double>(fileCount) / best << " files/s\n";
+}
+
+void benchmarkReader(const char* name, const BatchFileReader::Options& options, const std::vector<std::string>& paths, uint64_t totalBytes)
+{
+    BatchFileReader reader(options);
+    if (options.backend == IoBackend::IoUring && reader.backend() != IoBackend::IoUring) {
+        std::cout << name << ": io_uring unavailable, skipped\n";
+        return;
+    }
+    report(name, totalBytes, paths.size(), [&]() {
+        for (const BatchFileReader::File& file : reader.readAll(paths)) {
+            if (!file.error.empty()) {
+                std::cerr << file.path << ": " << file.error << '\n';
+                std::exit(1);
+            }
+        }
+    });
+}
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<std::string> paths{};
+    if (argc == 4 && std::string(argv[1]) == "--generate") {
+        paths = generateFiles(std::strtoull(argv[2], nullptr, 10), std::strtoull(argv[3], nullptr, 10));
+    } else {
+        paths = listFiles(argc > 1 ? argv[1] : "assets");
+    }
+
+    uint64_t totalBytes = 0;
+    for (const std::string& path : paths) {
+        totalBytes += std::filesystem::file_size(path);
+    }
+    std::cout << paths.size() << " files, " << totalBytes / 1024 << " KiB, best of " << kRuns << " runs\n";
+
+    report("ifstream, one file at a time", totalBytes, paths.size(), [&]() {
+        std::vector<char> bytes{};
+        for (const std::string& path : paths) {
+            std::ifstream file(path, std::ios::binary | std::ios::ate);
+            bytes.resize(static_cast<size_t>(file.tellg()));
+            file.seekg(0);
+            file.read(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        }
+    });
+
+    benchmarkReader("workers", { .backend = IoBackend::Workers }, paths, totalBytes);
+    benchmarkReader("workers, O_DIRECT", { .backend = IoBackend::Workers, .directIo = true }, paths, totalBytes);
+    benchmarkReader("io_uring", { .backend = IoBackend::IoUring }, paths, totalBytes);
+    benchmarkReader("io_uring, O_DIRECT", { .backend = IoBackend::IoUring, .directIo = true }, paths, totalBytes);
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "../../assets/GlbLoader.h"
+
+#include <array>
+#include <cstdint>
+#include <memory>
+
+inline constexpr uint32_t kNoAnimationChannel = 0xFFFFFFFFU;
+
+// Plays one node's channels of a shared clip. AnimationSys samples them into TransformComp::local
+// every frame; components without a channel keep the rest pose.
+struct AnimationComp {
+    std::shared_ptr<const GlbAnimation> clip{};
+    // Index into clip->channels per GlbAnimationPath.
+    std::array<uint32_t, 3> channels{ kNoAnimationChannel, kNoAnimationChannel, kNoAnimationChannel };
+    std::array<float, 3> restTranslation{ 0.0F, 0.0F, 0.0F };
+    std::array<float, 4> restRotation{ 0.0F, 0.0F, 0.0F, 1.0F };
+    std::array<float, 3> restScale{ 1.0F, 1.0F, 1.0F };
+    float time{ 0.0F };
+    float speed{ 1.0F };
+    bool loop{ true };
+    // Key each channel sampled last; the next search starts there, so steady playback costs O(1).
+    std::array<uint32_t, 3> cursors{ 0, 0, 0 };
+};
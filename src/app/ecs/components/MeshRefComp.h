@@ -0,0 +1,10 @@
+#pragma once
+
+#include <cstdint>
+
+// Where a RenderComp's ranges came from, so a hot-reloaded file can refresh them in place.
+struct MeshRefComp {
+    // AssetRegistry::SceneKey of the acquired file.
+    uint64_t scene{ 0 };
+    uint32_t primitive{ 0 };
+};
@@ -0,0 +1,8 @@
+#pragma once
+
+#include <ecs/Entity.h>
+
+// The parent must be created before the child so TransformSys sees it first.
+struct ParentComp {
+    Entity parent{};
+};
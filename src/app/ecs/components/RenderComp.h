@@ -3,13 +3,30 @@
 #include <array>
 #include <cstdint>
 
+#include <Engine.h>
+
 struct RenderComp {
     uint32_t viewId{ 0 };
     uint32_t materialId{ 1 };
     uint32_t vertexCount{ 3 };
     uint32_t firstVertex{ 0 };
+    uint32_t indexCount{ 0 };
+    uint32_t firstIndex{ 0 };
+    uint32_t firstMeshlet{ 0 };
+    uint32_t meshletCount{ 0 };
+    // Into AssetRegistry::skinVertices(); 0 for rigid meshes.
+    uint32_t firstSkinVertex{ 0 };
+    uint32_t skinVertexCount{ 0 };
+    uint32_t textureId{ kNoTexture };
     bool visible{ true };
 
     bool overrideClearColor{ false };
     std::array<float, 4> clearColor{ 0.02F, 0.02F, 0.08F, 1.0F };
+
+    std::array<float, 3> dequantScale{ 1.0F, 1.0F, 1.0F };
+    std::array<float, 3> dequantOffset{ 0.0F, 0.0F, 0.0F };
+
+    // Object-space bounding sphere; a zero radius reports full-screen coverage.
+    std::array<float, 3> boundsCenter{ 0.0F, 0.0F, 0.0F };
+    float boundsRadius{ 0.0F };
 };
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "../../assets/GlbLoader.h"
+
+#include <ecs/Entity.h>
+
+#include <array>
+#include <memory>
+#include <vector>
+
+// Deforms the entity's RenderComp mesh with a shared skin. SkinningSys rebuilds the palette from
+// the joint entities' world transforms after TransformSys; RenderExtractSys hands it to the GPU.
+struct SkinComp {
+    std::shared_ptr<const GlbSkin> skin{};
+    // Entity per skin joint, parallel to skin->joints.
+    std::vector<Entity> joints{};
+    // Column-major, bind-pose mesh space to posed mesh space, one per joint.
+    std::vector<std::array<float, 16>> palette{};
+    // Mesh-space box around the posed vertices; replaces the bind-pose bounds for culling,
+    // coverage and requantization.
+    std::array<float, 3> posedMin{ 0.0F, 0.0F, 0.0F };
+    std::array<float, 3> posedMax{ 0.0F, 0.0F, 0.0F };
+};
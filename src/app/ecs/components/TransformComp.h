@@ -0,0 +1,20 @@
+#pragma once
+
+#include <array>
+
+// Column-major matrices. TransformSys derives world from local and the ParentComp chain; entities
+// carrying it ignore PositionComp, RotationComp and ScaleComp when rendered.
+struct TransformComp {
+    std::array<float, 16> local{
+        1.0F, 0.0F, 0.0F, 0.0F,
+        0.0F, 1.0F, 0.0F, 0.0F,
+        0.0F, 0.0F, 1.0F, 0.0F,
+        0.0F, 0.0F, 0.0F, 1.0F
+    };
+    std::array<float, 16> world{
+        1.0F, 0.0F, 0.0F, 0.0F,
+        0.0F, 1.0F, 0.0F, 0.0F,
+        0.0F, 0.0F, 1.0F, 0.0F,
+        0.0F, 0.0F, 0.0F, 1.0F
+    };
+};
@@ -0,0 +1,262 @@
+#include "AnimationSys.h"
+
+#include "../components/AnimationComp.h"
+#include "../components/TransformComp.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ANIMATION_SYS_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+#ifdef ANIMATION_SYS_SSE2
+constexpr size_t kLanes = 4;
+#endif
+
+size_t componentCount(GlbAnimationPath path) noexcept
+{
+    return path == GlbAnimationPath::Rotation ? 4 : 3;
+}
+
+void holdValue(const float* value, std::array<const float*, 4>& sources, std::array<float, 4>& weights) noexcept
+{
+    sources = { value, value, value, value };
+    weights = { 1.0F, 0.0F, 0.0F, 0.0F };
+}
+
+// Moves cursor to the key at or before time and expresses the sample as weighted keys and tangents.
+void prepareChannel(const GlbAnimationChannel& channel, float time, uint32_t& cursor,
+    std::array<const float*, 4>& sources, std::array<float, 4>& weights)
+{
+    const std::vector<float>& times = channel.times;
+    const size_t components = componentCount(channel.path);
+    const bool cubic = channel.interpolation == GlbInterpolation::CubicSpline;
+    // Cubic spline keys are (in-tangent, value, out-tangent).
+    const size_t stride = cubic ? 3 * components : components;
+    const float* keys = channel.values.data() + (cubic ? components : 0);
+    const auto last = static_cast<uint32_t>(times.size() - 1);
+
+    if (last == 0 || time <= times.front()) {
+        cursor = 0;
+        holdValue(keys, sources, weights);
+        return;
+    }
+    if (time >= times[last]) {
+        cursor = last;
+        holdValue(keys + last * stride, sources, weights);
+        return;
+    }
+
+    // Playback moves forward a key or so per frame; a loop wrap or a seek falls back to a search.
+    if (cursor >= last || times[cursor] > time) {
+        cursor = static_cast<uint32_t>(std::upper_bound(times.begin(), times.end(), time) - times.begin()) - 1;
+    }
+    while (times[cursor + 1] <= time) {
+        ++cursor;
+    }
+
+    const float* k0 = keys + cursor * stride;
+    const float* k1 = k0 + stride;
+    if (channel.interpolation == GlbInterpolation::Step) {
+        holdValue(k0, sources, weights);
+        return;
+    }
+
+    const float dt = times[cursor + 1] - times[cursor];
+    const float u = (time - times[cursor]) / dt;
+    if (!cubic) {
+        float w1 = u;
+        // Shortest arc: q and -q are the same rotation.
+        if (channel.path == GlbAnimationPath::Rotation && k0[0] * k1[0] + k0[1] * k1[1] + k0[2] * k1[2] + k0[3] * k1[3] < 0.0F) {
+            w1 = -u;
+        }
+        sources = { k0, k0, k1, k1 };
+        weights = { 1.0F - u, 0.0F, w1, 0.0F };
+        return;
+    }
+
+    // Hermite basis; tangents are per second, so they scale with the key interval.
+    const float u2 = u * u;
+    const float u3 = u2 * u;
+    sources = { k0, k0 + components, k1, k1 - components };
+    weights = {
+        2.0F * u3 - 3.0F * u2 + 1.0F,
+        (u3 - 2.0F * u2 + u) * dt,
+        -2.0F * u3 + 3.0F * u2,
+        (u3 - u2) * dt };
+}
+
+#ifndef ANIMATION_SYS_SSE2
+float blend(const std::array<const float*, 4>& sources, const std::array<float, 4>& weights, size_t component) noexcept
+{
+    return weights[0] * sources[0][component] + weights[1] * sources[1][component]
+        + weights[2] * sources[2][component] + weights[3] * sources[3][component];
+}
+#endif
+}
+
+void AnimationSys::update(World& world, const SimulationFrameInput& input)
+{
+    jobs_.clear();
+    world.query<AnimationComp, TransformComp>().each([&](Entity, AnimationComp& animation, TransformComp& transform) {
+        if (!animation.clip) {
+            return;
+        }
+        const GlbAnimation& clip = *animation.clip;
+        animation.time += input.deltaSeconds * animation.speed;
+        if (animation.loop && clip.duration > 0.0F) {
+            animation.time = std::fmod(animation.time, clip.duration);
+            if (animation.time < 0.0F) {
+                animation.time += clip.duration;
+            }
+        } else {
+            animation.time = std::clamp(animation.time, 0.0F, clip.duration);
+        }
+
+        Job& job = jobs_.emplace_back();
+        job.local = transform.local.data();
+        const std::array<const float*, 3> rest{ animation.restTranslation.data(), animation.restRotation.data(), animation.restScale.data() };
+        for (size_t path = 0; path < 3; ++path) {
+            PathSample& sample = job.paths[path];
+            const uint32_t channel = animation.channels[path];
+            if (channel >= clip.channels.size()) {
+                holdValue(rest[path], sample.sources, sample.weights);
+                continue;
+            }
+            prepareChannel(clip.channels[channel], animation.time, animation.cursors[path], sample.sources, sample.weights);
+        }
+    });
+
+    writePoses(jobs_.data(), jobs_.size());
+}
+
+#ifdef ANIMATION_SYS_SSE2
+void AnimationSys::writePoses(const Job* jobs, size_t count)
+{
+    // Short batches are padded with the last job, writing to scratch.
+    alignas(16) std::array<float, 16> scratch{};
+
+    for (size_t base = 0; base < count; base += kLanes) {
+        std::array<const Job*, kLanes> lane{};
+        std::array<float*, kLanes> out{};
+        for (size_t l = 0; l < kLanes; ++l) {
+            const size_t index = std::min(base + l, count - 1);
+            lane[l] = &jobs[index];
+            out[l] = base + l < count ? jobs[index].local : scratch.data();
+        }
+
+        const auto blend = [&](size_t path, size_t component) {
+            __m128 sum = _mm_setzero_ps();
+            for (size_t term = 0; term < 4; ++term) {
+                const __m128 value = _mm_set_ps(
+                    lane[3]->paths[path].sources[term][component], lane[2]->paths[path].sources[term][component],
+                    lane[1]->paths[path].sources[term][component], lane[0]->paths[path].sources[term][component]);
+                const __m128 weight = _mm_set_ps(
+                    lane[3]->paths[path].weights[term], lane[2]->paths[path].weights[term],
+                    lane[1]->paths[path].weights[term], lane[0]->paths[path].weights[term]);
+                sum = _mm_add_ps(sum, _mm_mul_ps(value, weight));
+            }
+            return sum;
+        };
+
+        const __m128 tx = blend(0, 0);
+        const __m128 ty = blend(0, 1);
+        const __m128 tz = blend(0, 2);
+        __m128 x = blend(1, 0);
+        __m128 y = blend(1, 1);
+        __m128 z = blend(1, 2);
+        __m128 w = blend(1, 3);
+        const __m128 sx = blend(2, 0);
+        const __m128 sy = blend(2, 1);
+        const __m128 sz = blend(2, 2);
+
+        // Blended quaternions are renormalized (nlerp for linear keys).
+        const __m128 lengthSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_add_ps(_mm_mul_ps(z, z), _mm_mul_ps(w, w)));
+        const __m128 inverseLength = _mm_div_ps(_mm_set1_ps(1.0F), _mm_sqrt_ps(_mm_max_ps(lengthSq, _mm_set1_ps(1e-20F))));
+        x = _mm_mul_ps(x, inverseLength);
+        y = _mm_mul_ps(y, inverseLength);
+        z = _mm_mul_ps(z, inverseLength);
+        w = _mm_mul_ps(w, inverseLength);
+
+        const __m128 one = _mm_set1_ps(1.0F);
+        const __m128 two = _mm_set1_ps(2.0F);
+        const __m128 xx = _mm_mul_ps(x, x);
+        const __m128 yy = _mm_mul_ps(y, y);
+        const __m128 zz = _mm_mul_ps(z, z);
+        const __m128 xy = _mm_mul_ps(x, y);
+        const __m128 xz = _mm_mul_ps(x, z);
+        const __m128 yz = _mm_mul_ps(y, z);
+        const __m128 xw = _mm_mul_ps(x, w);
+        const __m128 yw = _mm_mul_ps(y, w);
+        const __m128 zw = _mm_mul_ps(z, w);
+        const __m128 zero = _mm_setzero_ps();
+
+        // Column-major T * R * S, as GlbLoader composes node matrices.
+        const __m128 m[16]{
+            _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))), sx),
+            _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xy, zw)), sx),
+            _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xz, yw)), sx),
+            zero,
+            _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xy, zw)), sy),
+            _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))), sy),
+            _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(yz, xw)), sy),
+            zero,
+            _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xz, yw)), sz),
+            _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(yz, xw)), sz),
+            _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))), sz),
+            zero,
+            tx,
+            ty,
+            tz,
+            one
+        };
+
+        // Each group of four rows transposes into one column of each lane's matrix.
+        for (size_t column = 0; column < 4; ++column) {
+            __m128 r0 = m[column * 4];
+            __m128 r1 = m[column * 4 + 1];
+            __m128 r2 = m[column * 4 + 2];
+            __m128 r3 = m[column * 4 + 3];
+            _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+            _mm_storeu_ps(out[0] + column * 4, r0);
+            _mm_storeu_ps(out[1] + column * 4, r1);
+            _mm_storeu_ps(out[2] + column * 4, r2);
+            _mm_storeu_ps(out[3] + column * 4, r3);
+        }
+    }
+}
+#else
+void AnimationSys::writePoses(const Job* jobs, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        const Job& job = jobs[i];
+        const auto value = [&](size_t path, size_t component) {
+            return blend(job.paths[path].sources, job.paths[path].weights, component);
+        };
+        std::array<float, 4> q{ value(1, 0), value(1, 1), value(1, 2), value(1, 3) };
+        const float inverseLength = 1.0F / std::sqrt(std::max(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3], 1e-20F));
+        for (float& c : q) {
+            c *= inverseLength;
+        }
+        const float x = q[0];
+        const float y = q[1];
+        const float z = q[2];
+        const float w = q[3];
+        const float sx = value(2, 0);
+        const float sy = value(2, 1);
+        const float sz = value(2, 2);
+
+        const std::array<float, 16> local{
+            (1.0F - 2.0F * (y * y + z * z)) * sx, 2.0F * (x * y + z * w) * sx, 2.0F * (x * z - y * w) * sx, 0.0F,
+            2.0F * (x * y - z * w) * sy, (1.0F - 2.0F * (x * x + z * z)) * sy, 2.0F * (y * z + x * w) * sy, 0.0F,
+            2.0F * (x * z + y * w) * sz, 2.0F * (y * z - x * w) * sz, (1.0F - 2.0F * (x * x + y * y)) * sz, 0.0F,
+            value(0, 0), value(0, 1), value(0, 2), 1.0F
+        };
+        std::copy(local.begin(), local.end(), job.local);
+    }
+}
+#endif
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <Engine.h>
+#include <ecs/World.h>
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+// Advances every AnimationComp and writes the sampled pose to TransformComp::local; run it before
+// TransformSys.
+//
+// A scalar pass walks each channel's cached key cursor and reduces step, linear and cubic spline
+// keys alike to four weighted sources per component. A second pass blends those and builds the
+// local matrices four entities at a time with SSE2 when available.
+class AnimationSys final {
+public:
+    void update(World& world, const SimulationFrameInput& input);
+
+private:
+    // value = sum of weights[i] * sources[i] for one of translation, rotation or scale.
+    struct PathSample {
+        std::array<const float*, 4> sources{};
+        std::array<float, 4> weights{};
+    };
+    struct Job {
+        std::array<PathSample, 3> paths{};
+        float* local{ nullptr };
+    };
+
+    static void writePoses(const Job* jobs, size_t count);
+
+    // Reused across frames.
+    std::vector<Job> jobs_{};
+};
@@ -4,8 +4,11 @@
 #include "../components/RenderComp.h"
 #include "../components/RotationComp.h"
 #include "../components/ScaleComp.h"
+#include "../components/SkinComp.h"
+#include "../components/TransformComp.h"
 
 #include <algorithm>
+#include <cmath>
 #include <glm/ext/matrix_clip_space.hpp>
 #include <glm/ext/matrix_transform.hpp>
 #include <glm/glm.hpp>
@@ -14,6 +17,55 @@
 #include <utility>
 #include <vector>
 
+namespace {
+// Projects the bounding sphere's center and its offsets along each object axis; the largest NDC
+// displacement is the projected radius, i.e. the diameter over the viewport height (NDC spans 2).
+float screenCoverage(const glm::mat4& clipFromObject, const std::array<float, 3>& center, float radius)
+{
+    if (radius <= 0.0F) {
+        return 1.0F;
+    }
+    const glm::vec3 c(center[0], center[1], center[2]);
+    const glm::vec4 clipCenter = clipFromObject * glm::vec4(c, 1.0F);
+    if (clipCenter.w <= 1e-4F) {
+        return 1.0F;
+    }
+    const glm::vec2 ndcCenter = glm::vec2(clipCenter) / clipCenter.w;
+
+    float coverage = 0.0F;
+    for (int axis = 0; axis < 3; ++axis) {
+        glm::vec3 offset(0.0F);
+        offset[axis] = radius;
+        const glm::vec4 clipEdge = clipFromObject * glm::vec4(c + offset, 1.0F);
+        if (clipEdge.w <= 1e-4F) {
+            return 1.0F;
+        }
+        const glm::vec2 delta = glm::vec2(clipEdge) / clipEdge.w - ndcCenter;
+        coverage = std::max({ coverage, std::abs(delta.x), std::abs(delta.y) });
+    }
+    return coverage;
+}
+
+// Side and far planes of the clip volume pulled back into object space (Gribb-Hartmann); the
+// side planes meet at the eye, so spheres behind it are rejected without a near plane.
+bool outsideFrustum(const glm::mat4& clipFromObject, const std::array<float, 3>& center, float radius)
+{
+    if (radius <= 0.0F) {
+        return false;
+    }
+    const glm::mat4 m = glm::transpose(clipFromObject);
+    const std::array<glm::vec4, 5> planes{ m[3] + m[0], m[3] - m[0], m[3] + m[1], m[3] - m[1], m[3] - m[2] };
+    const glm::vec3 c(center[0], center[1], center[2]);
+    for (const glm::vec4& plane : planes) {
+        const float length = glm::length(glm::vec3(plane));
+        if (length > 0.0F && glm::dot(glm::vec3(plane), c) + plane.w < -radius * length) {
+            return true;
+        }
+    }
+    return false;
+}
+}
+
 FrameGraphInput RenderExtractSys::build(const World& world) const
 {
     FrameGraphInput output{};
@@ -28,6 +80,7 @@ FrameGraphInput RenderExtractSys::build(const World& world) const
     };
 
     std::vector<DrawBuildPacket> pendingDraws{};
+    uint32_t skinnedVertexCount = 0;
 
     const glm::mat4 projection = glm::perspective(glm::radians(55.0F), 800.0F / 600.0F, 0.1F, 100.0F);
     const glm::mat4 view3D = glm::lookAt(glm::vec3(0.0F, 1.5F, 3.5F), glm::vec3(0.0F, 0.0F, 0.0F), glm::vec3(0.0F, 1.0F, 0.0F));
@@ -44,42 +97,102 @@ FrameGraphInput RenderExtractSys::build(const World& world) const
             viewMap.emplace(render.viewId, RenderViewPacket{ .viewId = render.viewId });
         }
 
-        const PositionComp* position = world.getComponent<PositionComp>(entity);
-        const ScaleComp* scale = world.getComponent<ScaleComp>(entity);
-        const RotationComp* rotation = world.getComponent<RotationComp>(entity);
+        // Skinned vertices are written normalized to the posed box, which also replaces the
+        // bind-pose bounds below.
+        const SkinComp* skin = world.getComponent<SkinComp>(entity);
+        const bool skinned = skin != nullptr && render.skinVertexCount != 0 && !skin->palette.empty();
+        std::array<float, 3> dequantScale = render.dequantScale;
+        std::array<float, 3> dequantOffset = render.dequantOffset;
+        std::array<float, 3> boundsCenter = render.boundsCenter;
+        float boundsRadius = render.boundsRadius;
+        if (skinned) {
+            for (size_t axis = 0; axis < 3; ++axis) {
+                dequantOffset[axis] = 0.5F * (skin->posedMin[axis] + skin->posedMax[axis]);
+                dequantScale[axis] = 0.5F * (skin->posedMax[axis] - skin->posedMin[axis]);
+            }
+            boundsCenter = dequantOffset;
+            boundsRadius = glm::length(glm::vec3(dequantScale[0], dequantScale[1], dequantScale[2]));
+        }
 
-        const glm::vec3 translation = position != nullptr
-            ? glm::vec3(position->x, position->y, position->z)
-            : glm::vec3(0.0F);
-        const glm::vec3 scaling = scale != nullptr
-            ? glm::vec3(scale->x, scale->y, scale->z)
-            : glm::vec3(1.0F);
-        const float angle = rotation != nullptr ? rotation->angleRadians : 0.0F;
+        // Compact vertex streams hold bounds-normalized positions; undo that in the model matrix.
+        const glm::mat4 dequant = glm::scale(
+            glm::translate(glm::mat4(1.0F), glm::vec3(dequantOffset[0], dequantOffset[1], dequantOffset[2])),
+            glm::vec3(dequantScale[0], dequantScale[1], dequantScale[2]));
 
-        glm::mat4 model = glm::translate(glm::mat4(1.0F), translation);
-        if (render.materialId == 3) {
-            model = glm::rotate(model, angle, glm::vec3(0.1F, 1.0F, 0.0F));
+        // Meshlet bounds live in object space before dequantization, so culling gets its own matrix.
+        glm::mat4 model(1.0F);
+        if (const TransformComp* transform = world.getComponent<TransformComp>(entity); transform != nullptr) {
+            model = glm::make_mat4(transform->world.data());
+        } else {
+            const PositionComp* position = world.getComponent<PositionComp>(entity);
+            const ScaleComp* scale = world.getComponent<ScaleComp>(entity);
+            const RotationComp* rotation = world.getComponent<RotationComp>(entity);
+
+            const glm::vec3 translation = position != nullptr
+                ? glm::vec3(position->x, position->y, position->z)
+                : glm::vec3(0.0F);
+            const glm::vec3 scaling = scale != nullptr
+                ? glm::vec3(scale->x, scale->y, scale->z)
+                : glm::vec3(1.0F);
+            const float angle = rotation != nullptr ? rotation->angleRadians : 0.0F;
+            const glm::vec3 axis = render.materialId == 3 ? glm::vec3(0.1F, 1.0F, 0.0F) : glm::vec3(0.0F, 0.0F, 1.0F);
+
+            model = glm::translate(model, translation);
+            model = glm::rotate(model, angle, axis);
             model = glm::scale(model, scaling);
-
+        }
+        if (render.materialId == 3) {
             const glm::mat4 clipFix = glm::scale(glm::mat4(1.0F), glm::vec3(1.0F, -1.0F, 1.0F));
             model = clipFix * projection * view3D * model;
-        } else {
-            model = glm::rotate(model, angle, glm::vec3(0.0F, 0.0F, 1.0F));
-            model = glm::scale(model, scaling);
         }
+        if (outsideFrustum(model, boundsCenter, boundsRadius)) {
+            return;
+        }
+        const glm::mat4 mvp = model * dequant;
 
         std::array<float, 16> mvpPacked{};
-        const float* mvpData = glm::value_ptr(model);
+        const float* mvpData = glm::value_ptr(mvp);
         std::copy(mvpData, mvpData + mvpPacked.size(), mvpPacked.begin());
 
+        std::array<float, 16> cullMvpPacked{};
+        const float* cullMvpData = glm::value_ptr(model);
+        std::copy(cullMvpData, cullMvpData + cullMvpPacked.size(), cullMvpPacked.begin());
+
+        // Only instances that survive culling are skinned. Meshlet bounds describe the bind pose,
+        // so skinned draws skip cluster culling.
+        uint32_t firstVertex = render.firstVertex;
+        if (skinned) {
+            firstVertex = skinnedVertexCount;
+            output.skinning.push_back(SkinningPacket{
+                .firstVertex = render.firstVertex,
+                .vertexCount = render.vertexCount,
+                .firstSkinVertex = render.firstSkinVertex,
+                .firstJoint = static_cast<uint32_t>(output.jointMatrices.size()),
+                .outputFirstVertex = firstVertex,
+                .dequantScale = render.dequantScale,
+                .dequantOffset = render.dequantOffset,
+                .outputDequantScale = dequantScale,
+                .outputDequantOffset = dequantOffset });
+            output.jointMatrices.insert(output.jointMatrices.end(), skin->palette.begin(), skin->palette.end());
+            skinnedVertexCount += render.vertexCount;
+        }
+
         pendingDraws.push_back(DrawBuildPacket{
             .entity = entity,
             .draw = DrawPacket{
                 .viewId = render.viewId,
                 .materialId = render.materialId,
                 .vertexCount = render.vertexCount,
-                .firstVertex = render.firstVertex,
-                .mvp = mvpPacked }
+                .firstVertex = firstVertex,
+                .indexCount = render.indexCount,
+                .firstIndex = render.firstIndex,
+                .firstMeshlet = render.firstMeshlet,
+                .meshletCount = skinned ? 0 : render.meshletCount,
+                .textureId = render.textureId,
+                .screenCoverage = screenCoverage(model, boundsCenter, boundsRadius),
+                .skinned = skinned,
+                .mvp = mvpPacked,
+                .cullMvp = cullMvpPacked }
             });
     });
 
@@ -0,0 +1,49 @@
+#include "SkinningSys.h"
+
+#include "../components/RenderComp.h"
+#include "../components/SkinComp.h"
+#include "../components/TransformComp.h"
+
+#include <algorithm>
+#include <cmath>
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <limits>
+
+// A posed vertex is a convex combination of its joints' transforms of the bind-pose vertex, so the
+// box around every joint's transform of the bind-pose bounding sphere contains the posed mesh.
+void SkinningSys::update(World& world) const
+{
+    world.query<SkinComp, RenderComp, TransformComp>().each([&](Entity, SkinComp& skin, const RenderComp& render, const TransformComp& transform) {
+        const size_t jointCount = skin.joints.size();
+        skin.palette.resize(jointCount);
+
+        const glm::mat4 meshFromWorld = glm::inverse(glm::make_mat4(transform.world.data()));
+        const glm::vec3 center(render.boundsCenter[0], render.boundsCenter[1], render.boundsCenter[2]);
+        glm::vec3 posedMin(std::numeric_limits<float>::max());
+        glm::vec3 posedMax(std::numeric_limits<float>::lowest());
+
+        for (size_t j = 0; j < jointCount; ++j) {
+            glm::mat4 jointWorld(1.0F);
+            if (const TransformComp* joint = world.getComponent<TransformComp>(skin.joints[j]); joint != nullptr) {
+                jointWorld = glm::make_mat4(joint->world.data());
+            }
+            const glm::mat4 matrix = meshFromWorld * jointWorld * glm::make_mat4(skin.skin->inverseBindMatrices[j].data());
+            const float* data = glm::value_ptr(matrix);
+            std::copy(data, data + 16, skin.palette[j].begin());
+
+            const float scale = std::max({ glm::length(glm::vec3(matrix[0])), glm::length(glm::vec3(matrix[1])), glm::length(glm::vec3(matrix[2])) });
+            const glm::vec3 posedCenter = glm::vec3(matrix * glm::vec4(center, 1.0F));
+            const glm::vec3 radius(render.boundsRadius * scale);
+            posedMin = glm::min(posedMin, posedCenter - radius);
+            posedMax = glm::max(posedMax, posedCenter + radius);
+        }
+
+        if (jointCount == 0) {
+            posedMin = center - glm::vec3(render.boundsRadius);
+            posedMax = center + glm::vec3(render.boundsRadius);
+        }
+        skin.posedMin = { posedMin.x, posedMin.y, posedMin.z };
+        skin.posedMax = { posedMax.x, posedMax.y, posedMax.z };
+    });
+}
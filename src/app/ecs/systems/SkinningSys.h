@@ -0,0 +1,10 @@
+#pragma once
+
+#include <ecs/World.h>
+
+// Rebuilds every SkinComp's joint palette and posed bounds from the joints' world transforms; run
+// it after TransformSys.
+class SkinningSys final {
+public:
+    void update(World& world) const;
+};
@@ -0,0 +1,33 @@
+#include "TransformSys.h"
+
+#include "../components/ParentComp.h"
+#include "../components/RotationComp.h"
+#include "../components/TransformComp.h"
+
+#include <algorithm>
+#include <glm/ext/matrix_transform.hpp>
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+// One pass in creation order: parents are created before their children, so a parent's world
+// matrix is already current when its children read it.
+void TransformSys::update(World& world) const
+{
+    world.query<TransformComp>().each([&](Entity entity, TransformComp& transform) {
+        glm::mat4 matrix = glm::make_mat4(transform.local.data());
+
+        // Spin about the node's local up axis on top of its authored transform.
+        if (const RotationComp* rotation = world.getComponent<RotationComp>(entity); rotation != nullptr) {
+            matrix = glm::rotate(matrix, rotation->angleRadians, glm::vec3(0.0F, 1.0F, 0.0F));
+        }
+
+        if (const ParentComp* parent = world.getComponent<ParentComp>(entity); parent != nullptr) {
+            if (const TransformComp* parentTransform = world.getComponent<TransformComp>(parent->parent); parentTransform != nullptr) {
+                matrix = glm::make_mat4(parentTransform->world.data()) * matrix;
+            }
+        }
+
+        const float* data = glm::value_ptr(matrix);
+        std::copy(data, data + transform.world.size(), transform.world.begin());
+    });
+}
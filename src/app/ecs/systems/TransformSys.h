@@ -0,0 +1,8 @@
+#pragma once
+
+#include <ecs/World.h>
+
+class TransformSys final {
+public:
+    void update(World& world) const;
+};
@@ -1,14 +1,29 @@
+#include <cstdlib>
+
 #include <Engine.h>
 #include "Simulation.h"
 
 int main()
 {
-    Simulation simulation{};
+    constexpr VertexFormat vertexFormat = VertexFormat::CompactSnorm16;
+
+    Simulation simulation{ vertexFormat };
     Engine engine{};
 
     Engine::RunConfig cfg{};
-    cfg.vertexShaderPath = "shaders/triangle.vert.spv";
+    cfg.vertexFormat = vertexFormat;
+    cfg.vertexShaderPath = vertexFormat == VertexFormat::Float32
+        ? "shaders/triangle.vert.spv"
+        : "shaders/triangle_compact.vert.spv";
     cfg.fragmentShaderPath = "shaders/triangle.frag.spv";
+    cfg.clusterCullShaderPath = "shaders/cluster_cull.comp.spv";
+    cfg.skinningShaderPath = "shaders/skinning.comp.spv";
+    cfg.textureBudgetBytes = 16ULL * 1024ULL * 1024ULL;
+    cfg.allocationTracePath = std::getenv("APP_ALLOCATION_TRACE");
+#if defined(APP_SHADER_SOURCE_DIR) && defined(APP_SHADER_COMPILER)
+    cfg.shaderSourceDir = APP_SHADER_SOURCE_DIR;
+    cfg.shaderCompilerPath = APP_SHADER_COMPILER;
+#endif
 
     engine.run(simulation, cfg);
 }
@@ -0,0 +1,87 @@
+#include "GlbGridScene.h"
+
+#include "GlbSceneSpawner.h"
+
+#include <chrono>
+#include <iostream>
+
+namespace {
+constexpr float kCellSpacing = 0.3F;
+constexpr float kInstanceScale = 0.08F;
+
+void clearWorld(World& world)
+{
+    world.destroyEntities(world.entities());
+}
+
+std::array<float, 16> gridCellMatrix(uint32_t column, uint32_t row, uint32_t gridSize)
+{
+    const float half = 0.5F * static_cast<float>(gridSize - 1);
+    const float x = (static_cast<float>(column) - half) * kCellSpacing;
+    const float z = (static_cast<float>(row) - half) * kCellSpacing;
+    return {
+        kInstanceScale, 0.0F, 0.0F, 0.0F,
+        0.0F, kInstanceScale, 0.0F, 0.0F,
+        0.0F, 0.0F, kInstanceScale, 0.0F,
+        x, 0.0F, z, 1.0F
+    };
+}
+}
+
+void GlbGridScene::onLoad(World& world)
+{
+    clearWorld(world);
+    if (prototypes_.empty() || gridSize_ == 0) {
+        return;
+    }
+
+    std::vector<std::string> paths{};
+    paths.reserve(prototypes_.size());
+    for (const GlbPrototype& prototype : prototypes_) {
+        paths.push_back(prototype.path);
+    }
+    sceneKeys_ = assets_.acquireScenes(paths);
+
+    const auto start = std::chrono::steady_clock::now();
+
+    std::vector<GlbSpawnDesc> descs(prototypes_.size());
+    for (size_t p = 0; p < prototypes_.size(); ++p) {
+        descs[p].materialTextureIds = prototypes_[p].materialTextureIds;
+        descs[p].rootSpinRadiansPerSecond = 0.6F;
+        descs[p].sceneKey = sceneKeys_[p];
+        descs[p].rootTransforms.reserve(static_cast<size_t>(gridSize_) * gridSize_ / prototypes_.size() + 1);
+    }
+    for (uint32_t row = 0; row < gridSize_; ++row) {
+        for (uint32_t column = 0; column < gridSize_; ++column) {
+            const size_t cell = static_cast<size_t>(row) * gridSize_ + column;
+            descs[cell % prototypes_.size()].rootTransforms.push_back(gridCellMatrix(column, row, gridSize_));
+        }
+    }
+
+    size_t instanceCount = 0;
+    for (size_t p = 0; p < prototypes_.size(); ++p) {
+        const GlbScene& scene = assets_.scene(sceneKeys_[p]);
+        // Animated files loop their first clip.
+        descs[p].animation = scene.animations.empty() ? kNoGlbIndex : 0;
+        instanceCount += spawnGlbScene(world, scene, descs[p]).size();
+    }
+
+    const double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "[Scene] " << name() << ": spawned " << instanceCount << " instances, "
+              << world.entities().size() << " entities in " << elapsedMs << " ms\n";
+}
+
+void GlbGridScene::onUnload(World& world)
+{
+    clearWorld(world);
+    for (const AssetRegistry::SceneKey key : sceneKeys_) {
+        assets_.releaseScene(key);
+    }
+    sceneKeys_.clear();
+}
+
+void GlbGridScene::onUpdate(World& world, const SimulationFrameInput& input)
+{
+    (void)world;
+    (void)input;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "Scene.h"
+
+#include "../assets/AssetRegistry.h"
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct GlbPrototype {
+    std::string path{};
+    // Texture id per scene material.
+    std::vector<uint32_t> materialTextureIds{};
+};
+
+// Bulk-spawns a gridSize x gridSize field of imported glTF scenes, cycling through the prototypes.
+class GlbGridScene final : public Scene {
+public:
+    GlbGridScene(AssetRegistry& assets, std::vector<GlbPrototype> prototypes, uint32_t gridSize = 40)
+        : assets_(assets)
+        , prototypes_(std::move(prototypes))
+        , gridSize_(gridSize)
+    {
+    }
+
+    [[nodiscard]] const char* name() const override { return "glTF Scene Grid"; }
+    void onLoad(World& world) override;
+    void onUnload(World& world) override;
+    void onUpdate(World& world, const SimulationFrameInput& input) override;
+
+private:
+    AssetRegistry& assets_;
+    std::vector<GlbPrototype> prototypes_{};
+    std::vector<AssetRegistry::SceneKey> sceneKeys_{};
+    uint32_t gridSize_{ 40 };
+};
@@ -0,0 +1,254 @@
+#include "GlbSceneSpawner.h"
+
+#include "../ecs/components/AnimationComp.h"
+#include "../ecs/components/MeshRefComp.h"
+#include "../ecs/components/ParentComp.h"
+#include "../ecs/components/RenderComp.h"
+#include "../ecs/components/RotationComp.h"
+#include "../ecs/components/SkinComp.h"
+#include "../ecs/components/TransformComp.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace {
+// Entity layout of one instance: slot 0 is the root, slot 1 + n is scene node n, and the
+// remaining slots hold the second and later primitives of each node's mesh.
+struct SpawnSlot {
+    uint32_t parentSlot{ kNoGlbIndex };
+    uint32_t node{ kNoGlbIndex };
+    uint32_t primitive{ kNoGlbIndex };
+};
+
+std::vector<SpawnSlot> buildSlots(const GlbScene& scene)
+{
+    std::vector<SpawnSlot> slots{};
+    slots.reserve(1 + scene.nodes.size());
+    slots.push_back(SpawnSlot{});
+
+    for (uint32_t n = 0; n < scene.nodes.size(); ++n) {
+        const GlbNode& node = scene.nodes[n];
+        SpawnSlot slot{ .parentSlot = node.parent == kNoGlbIndex ? 0 : node.parent + 1, .node = n };
+        if (node.mesh != kNoGlbIndex && scene.meshes[node.mesh].primitiveCount > 0) {
+            slot.primitive = scene.meshes[node.mesh].firstPrimitive;
+        }
+        slots.push_back(slot);
+    }
+
+    for (uint32_t n = 0; n < scene.nodes.size(); ++n) {
+        const GlbNode& node = scene.nodes[n];
+        if (node.mesh == kNoGlbIndex) {
+            continue;
+        }
+        const GlbMesh& mesh = scene.meshes[node.mesh];
+        for (uint32_t p = 1; p < mesh.primitiveCount; ++p) {
+            slots.push_back(SpawnSlot{ .parentSlot = n + 1, .primitive = mesh.firstPrimitive + p });
+        }
+    }
+    return slots;
+}
+
+// AnimationComp template per slot; slots whose node no channel targets have no clip.
+std::vector<AnimationComp> buildSlotAnimations(const GlbScene& scene, const std::vector<SpawnSlot>& slots, uint32_t animation)
+{
+    std::vector<AnimationComp> out(slots.size());
+    if (animation >= scene.animations.size()) {
+        return out;
+    }
+    const std::shared_ptr<const GlbAnimation>& clip = scene.animations[animation];
+    for (size_t s = 0; s < slots.size(); ++s) {
+        const uint32_t node = slots[s].node;
+        if (node == kNoGlbIndex) {
+            continue;
+        }
+        AnimationComp& comp = out[s];
+        for (uint32_t c = 0; c < clip->channels.size(); ++c) {
+            if (clip->channels[c].node == node) {
+                comp.channels[static_cast<size_t>(clip->channels[c].path)] = c;
+                comp.clip = clip;
+            }
+        }
+        comp.restTranslation = scene.nodes[node].translation;
+        comp.restRotation = scene.nodes[node].rotation;
+        comp.restScale = scene.nodes[node].scale;
+    }
+    return out;
+}
+
+// Skin deforming each slot's primitive, or kNoGlbIndex. Extra primitive slots take the skin of the
+// node they hang off.
+std::vector<uint32_t> buildSlotSkins(const GlbScene& scene, const std::vector<SpawnSlot>& slots)
+{
+    std::vector<uint32_t> out(slots.size(), kNoGlbIndex);
+    for (size_t s = 0; s < slots.size(); ++s) {
+        const SpawnSlot& slot = slots[s];
+        if (slot.primitive == kNoGlbIndex || scene.primitives[slot.primitive].mesh.skinVertexCount == 0) {
+            continue;
+        }
+        const uint32_t node = slot.node != kNoGlbIndex ? slot.node : slot.parentSlot - 1;
+        out[s] = scene.nodes[node].skin;
+    }
+    return out;
+}
+
+RenderComp makeRenderComp(const GlbScene& scene, uint32_t primitiveIndex, const GlbSpawnDesc& desc)
+{
+    const GlbPrimitive& primitive = scene.primitives[primitiveIndex];
+    const LoadedMesh& mesh = primitive.mesh;
+    const uint32_t textureId = primitive.material < desc.materialTextureIds.size()
+        ? desc.materialTextureIds[primitive.material]
+        : kNoTexture;
+
+    return RenderComp{
+        .viewId = 0,
+        .materialId = 3,
+        .vertexCount = mesh.vertexCount,
+        .firstVertex = mesh.firstVertex,
+        .indexCount = mesh.indexCount,
+        .firstIndex = mesh.firstIndex,
+        .firstMeshlet = mesh.firstMeshlet,
+        .meshletCount = mesh.meshletCount,
+        .firstSkinVertex = mesh.firstSkinVertex,
+        .skinVertexCount = mesh.skinVertexCount,
+        .textureId = textureId,
+        .visible = true,
+        .overrideClearColor = true,
+        .clearColor = desc.clearColor,
+        .dequantScale = mesh.dequantScale,
+        .dequantOffset = mesh.dequantOffset,
+        .boundsCenter = mesh.boundsCenter,
+        .boundsRadius = mesh.boundsRadius
+    };
+}
+}
+
+std::vector<Entity> spawnGlbScene(World& world, const GlbScene& scene, const GlbSpawnDesc& desc)
+{
+    const std::vector<SpawnSlot> slots = buildSlots(scene);
+    const size_t instanceCount = desc.rootTransforms.size();
+    const size_t slotCount = slots.size();
+    const std::vector<Entity> entities = world.createEntities(instanceCount * slotCount);
+
+    size_t renderSlotCount = 0;
+    for (const SpawnSlot& slot : slots) {
+        renderSlotCount += slot.primitive != kNoGlbIndex ? 1 : 0;
+    }
+
+    std::vector<TransformComp> transforms{};
+    std::vector<Entity> childEntities{};
+    std::vector<ParentComp> parents{};
+    std::vector<Entity> renderEntities{};
+    std::vector<RenderComp> renders{};
+    std::vector<Entity> roots{};
+    transforms.reserve(entities.size());
+    childEntities.reserve(entities.size() - instanceCount);
+    parents.reserve(entities.size() - instanceCount);
+    renderEntities.reserve(instanceCount * renderSlotCount);
+    renders.reserve(instanceCount * renderSlotCount);
+    roots.reserve(instanceCount);
+
+    // Mesh ranges are identical for every instance; build them once.
+    std::vector<RenderComp> slotRenders(slotCount);
+    for (size_t s = 0; s < slotCount; ++s) {
+        if (slots[s].primitive != kNoGlbIndex) {
+            slotRenders[s] = makeRenderComp(scene, slots[s].primitive, desc);
+        }
+    }
+
+    for (size_t instance = 0; instance < instanceCount; ++instance) {
+        const size_t base = instance * slotCount;
+        roots.push_back(entities[base]);
+
+        for (size_t s = 0; s < slotCount; ++s) {
+            const SpawnSlot& slot = slots[s];
+            const Entity entity = entities[base + s];
+
+            TransformComp transform{};
+            if (s == 0) {
+                transform.local = desc.rootTransforms[instance];
+            } else if (slot.node != kNoGlbIndex) {
+                transform.local = scene.nodes[slot.node].localMatrix;
+            }
+            transforms.push_back(transform);
+
+            if (s != 0) {
+                childEntities.push_back(entity);
+                parents.push_back(ParentComp{ .parent = entities[base + slot.parentSlot] });
+            }
+            if (slot.primitive != kNoGlbIndex) {
+                renderEntities.push_back(entity);
+                renders.push_back(slotRenders[s]);
+            }
+        }
+    }
+
+    world.insertComponents(entities, std::move(transforms));
+    world.insertComponents(childEntities, std::move(parents));
+    if (desc.sceneKey.has_value()) {
+        std::vector<MeshRefComp> meshRefs{};
+        meshRefs.reserve(renderEntities.size());
+        for (size_t instance = 0; instance < instanceCount; ++instance) {
+            for (const SpawnSlot& slot : slots) {
+                if (slot.primitive != kNoGlbIndex) {
+                    meshRefs.push_back(MeshRefComp{ .scene = *desc.sceneKey, .primitive = slot.primitive });
+                }
+            }
+        }
+        world.insertComponents(renderEntities, std::move(meshRefs));
+    }
+    world.insertComponents(renderEntities, std::move(renders));
+
+    const std::vector<AnimationComp> slotAnimations = buildSlotAnimations(scene, slots, desc.animation);
+    if (std::ranges::any_of(slotAnimations, [](const AnimationComp& comp) { return comp.clip != nullptr; })) {
+        const float duration = scene.animations[desc.animation]->duration;
+        std::vector<Entity> animatedEntities{};
+        std::vector<AnimationComp> animations{};
+        for (size_t instance = 0; instance < instanceCount; ++instance) {
+            // Staggered like the spin below.
+            const float startTime = duration > 0.0F ? std::fmod(static_cast<float>(instance) * 0.37F, duration) : 0.0F;
+            for (size_t s = 0; s < slotCount; ++s) {
+                if (slotAnimations[s].clip != nullptr) {
+                    animatedEntities.push_back(entities[instance * slotCount + s]);
+                    animations.push_back(slotAnimations[s]);
+                    animations.back().time = startTime;
+                }
+            }
+        }
+        world.insertComponents(animatedEntities, std::move(animations));
+    }
+
+    const std::vector<uint32_t> slotSkins = buildSlotSkins(scene, slots);
+    if (std::ranges::any_of(slotSkins, [](uint32_t skin) { return skin != kNoGlbIndex; })) {
+        std::vector<Entity> skinnedEntities{};
+        std::vector<SkinComp> skins{};
+        for (size_t instance = 0; instance < instanceCount; ++instance) {
+            const size_t base = instance * slotCount;
+            for (size_t s = 0; s < slotCount; ++s) {
+                if (slotSkins[s] == kNoGlbIndex) {
+                    continue;
+                }
+                SkinComp comp{ .skin = scene.skins[slotSkins[s]] };
+                comp.joints.reserve(comp.skin->joints.size());
+                for (const uint32_t joint : comp.skin->joints) {
+                    comp.joints.push_back(entities[base + 1 + joint]);
+                }
+                skinnedEntities.push_back(entities[base + s]);
+                skins.push_back(std::move(comp));
+            }
+        }
+        world.insertComponents(skinnedEntities, std::move(skins));
+    }
+
+    if (desc.rootSpinRadiansPerSecond != 0.0F) {
+        // Stagger the start angles so identical instances do not move in lockstep.
+        std::vector<RotationComp> rotations(instanceCount);
+        for (size_t instance = 0; instance < instanceCount; ++instance) {
+            rotations[instance] = RotationComp{
+                .angleRadians = std::fmod(static_cast<float>(instance) * 0.61F, 6.283185307F),
+                .angularVelocityRadiansPerSecond = desc.rootSpinRadiansPerSecond };
+        }
+        world.insertComponents(roots, std::move(rotations));
+    }
+    return roots;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "../assets/GlbLoader.h"
+
+#include <ecs/World.h>
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+struct GlbSpawnDesc {
+    // One copy of the scene per entry, parented to a root entity with this local matrix (column-major).
+    std::vector<std::array<float, 16>> rootTransforms{};
+    // Texture id per scene material; materials without an entry draw untextured.
+    std::vector<uint32_t> materialTextureIds{};
+    // Non-zero adds a RotationComp to each root.
+    float rootSpinRadiansPerSecond{ 0.0F };
+    // Index into GlbScene::animations looped by every instance; animated nodes get an AnimationComp.
+    uint32_t animation{ kNoGlbIndex };
+    std::array<float, 4> clearColor{ 0.01F, 0.01F, 0.01F, 1.0F };
+    // AssetRegistry key of the scene; when set, render entities get a MeshRefComp for hot reload.
+    std::optional<uint64_t> sceneKey{};
+};
+
+// Creates one entity per root and per scene node (plus one child entity for each extra primitive
+// of a multi-primitive mesh) with TransformComp, ParentComp and RenderComp, all through the World
+// bulk paths. Skinned primitives also get a SkinComp bound to their instance's joint entities.
+// Instances share the scene's mesh ranges. Returns the root entities.
+std::vector<Entity> spawnGlbScene(World& world, const GlbScene& scene, const GlbSpawnDesc& desc);
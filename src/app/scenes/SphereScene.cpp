@@ -1,5 +1,6 @@
 #include "SphereScene.h"
 
+#include "../ecs/components/MeshRefComp.h"
 #include "../ecs/components/PositionComp.h"
 #include "../ecs/components/RenderComp.h"
 #include "../ecs/components/RotationComp.h"
@@ -8,10 +9,7 @@
 namespace {
 void clearWorld(World& world)
 {
-    const auto alive = world.entities();
-    for (const Entity entity : alive) {
-        world.destroyEntity(entity);
-    }
+    world.destroyEntities(world.entities());
 }
 }
 
@@ -19,25 +17,44 @@ void SphereScene::onLoad(World& world)
 {
     clearWorld(world);
 
+    meshKey_ = assets_.acquireScene(meshPath_);
+    const GlbScene scene = assets_.scene(*meshKey_);
+    const GlbPrimitive& primitive = scene.primitives.at(0);
+    const LoadedMesh& mesh = primitive.mesh;
+
     const Entity sphere = world.createEntity();
     world.emplaceComponent<PositionComp>(sphere);
     world.emplaceComponent<ScaleComp>(sphere);
     world.emplaceComponent<RotationComp>(sphere, RotationComp{
         .angleRadians = 0.0F,
         .angularVelocityRadiansPerSecond = 0.8F });
+    world.emplaceComponent<MeshRefComp>(sphere, MeshRefComp{ .scene = *meshKey_, .primitive = 0 });
     world.emplaceComponent<RenderComp>(sphere, RenderComp{
         .viewId = 0,
         .materialId = 3,
-        .vertexCount = vertexCount_,
-        .firstVertex = firstVertex_,
+        .vertexCount = mesh.vertexCount,
+        .firstVertex = mesh.firstVertex,
+        .indexCount = mesh.indexCount,
+        .firstIndex = mesh.firstIndex,
+        .firstMeshlet = mesh.firstMeshlet,
+        .meshletCount = mesh.meshletCount,
+        .textureId = primitive.material < materialTextureIds_.size() ? materialTextureIds_[primitive.material] : kNoTexture,
         .visible = true,
         .overrideClearColor = true,
-        .clearColor = { 0.01F, 0.01F, 0.01F, 1.0F } });
+        .clearColor = { 0.01F, 0.01F, 0.01F, 1.0F },
+        .dequantScale = mesh.dequantScale,
+        .dequantOffset = mesh.dequantOffset,
+        .boundsCenter = mesh.boundsCenter,
+        .boundsRadius = mesh.boundsRadius });
 }
 
 void SphereScene::onUnload(World& world)
 {
     clearWorld(world);
+    if (meshKey_.has_value()) {
+        assets_.releaseScene(*meshKey_);
+        meshKey_.reset();
+    }
 }
 
 void SphereScene::onUpdate(World& world, const SimulationFrameInput& input)
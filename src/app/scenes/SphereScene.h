@@ -2,20 +2,31 @@
 
 #include "Scene.h"
 
+#include "../assets/AssetRegistry.h"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
 class SphereScene final : public Scene {
 public:
-    SphereScene(uint32_t firstVertex, uint32_t vertexCount)
-        : firstVertex_(firstVertex)
-        , vertexCount_(vertexCount)
+    SphereScene(AssetRegistry& assets, std::string meshPath, std::vector<uint32_t> materialTextureIds = {})
+        : assets_(assets)
+        , meshPath_(std::move(meshPath))
+        , materialTextureIds_(std::move(materialTextureIds))
     {
     }
 
-    [[nodiscard]] const char* name() const override { return "Sphere GLB"; }
+    [[nodiscard]] const char* name() const override { return "Textured Sphere"; }
     void onLoad(World& world) override;
     void onUnload(World& world) override;
     void onUpdate(World& world, const SimulationFrameInput& input) override;
 
 private:
-    uint32_t firstVertex_{ 0 };
-    uint32_t vertexCount_{ 0 };
+    AssetRegistry& assets_;
+    std::string meshPath_{};
+    std::vector<uint32_t> materialTextureIds_{};
+    std::optional<AssetRegistry::SceneKey> meshKey_{};
 };
@@ -8,10 +8,7 @@
 namespace {
 void clearWorld(World& world)
 {
-    const auto alive = world.entities();
-    for (const Entity entity : alive) {
-        world.destroyEntity(entity);
-    }
+    world.destroyEntities(world.entities());
 }
 }
 
@@ -1,5 +1,6 @@
 #include "TestScene.h"
 
+#include "../ecs/components/MeshRefComp.h"
 #include "../ecs/components/PositionComp.h"
 #include "../ecs/components/RenderComp.h"
 #include "../ecs/components/ScaleComp.h"
@@ -7,10 +8,7 @@
 namespace {
 void clearWorld(World& world)
 {
-    const auto alive = world.entities();
-    for (const Entity entity : alive) {
-        world.destroyEntity(entity);
-    }
+    world.destroyEntities(world.entities());
 }
 }
 
@@ -18,22 +16,40 @@ void TestScene::onLoad(World& world)
 {
     clearWorld(world);
 
+    meshKey_ = assets_.acquireScene(meshPath_);
+    const GlbScene scene = assets_.scene(*meshKey_);
+    const GlbPrimitive& primitive = scene.primitives.at(0);
+    const LoadedMesh& mesh = primitive.mesh;
+
     const Entity plane = world.createEntity();
     world.emplaceComponent<PositionComp>(plane);
     world.emplaceComponent<ScaleComp>(plane);
+    world.emplaceComponent<MeshRefComp>(plane, MeshRefComp{ .scene = *meshKey_, .primitive = 0 });
     world.emplaceComponent<RenderComp>(plane, RenderComp{
         .viewId = 0,
         .materialId = 3,
-        .vertexCount = vertexCount_,
-        .firstVertex = firstVertex_,
+        .vertexCount = mesh.vertexCount,
+        .firstVertex = mesh.firstVertex,
+        .indexCount = mesh.indexCount,
+        .firstIndex = mesh.firstIndex,
+        .firstMeshlet = mesh.firstMeshlet,
+        .meshletCount = mesh.meshletCount,
         .visible = true,
         .overrideClearColor = true,
-        .clearColor = { 0.01F, 0.01F, 0.01F, 1.0F } });
+        .clearColor = { 0.01F, 0.01F, 0.01F, 1.0F },
+        .dequantScale = mesh.dequantScale,
+        .dequantOffset = mesh.dequantOffset,
+        .boundsCenter = mesh.boundsCenter,
+        .boundsRadius = mesh.boundsRadius });
 }
 
 void TestScene::onUnload(World& world)
 {
     clearWorld(world);
+    if (meshKey_.has_value()) {
+        assets_.releaseScene(*meshKey_);
+        meshKey_.reset();
+    }
 }
 
 void TestScene::onUpdate(World& world, const SimulationFrameInput& input)
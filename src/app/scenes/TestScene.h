@@ -2,11 +2,17 @@
 
 #include "Scene.h"
 
+#include "../assets/AssetRegistry.h"
+
+#include <optional>
+#include <string>
+#include <utility>
+
 class TestScene final : public Scene {
 public:
-    TestScene(uint32_t firstVertex, uint32_t vertexCount)
-        : firstVertex_(firstVertex)
-        , vertexCount_(vertexCount)
+    TestScene(AssetRegistry& assets, std::string meshPath)
+        : assets_(assets)
+        , meshPath_(std::move(meshPath))
     {
     }
 
@@ -16,6 +22,7 @@ public:
     void onUpdate(World& world, const SimulationFrameInput& input) override;
 
 private:
-    uint32_t firstVertex_{ 0 };
-    uint32_t vertexCount_{ 0 };
+    AssetRegistry& assets_;
+    std::string meshPath_{};
+    std::optional<AssetRegistry::SceneKey> meshKey_{};
 };
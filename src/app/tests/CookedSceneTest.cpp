@@ -0,0 +1,103 @@
+// Cooks a one-triangle scene, reads it back, then flips single bytes of its index and meshlet
+// streams and expects readCookedScene to reject the result instead of handing out-of-range ranges
+// to the GPU.
+//
+//   cooked_scene_test
+#include "assets/CookedScene.h"
+#include "assets/GeometryCodec.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <iostream>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+namespace {
+const CookedSceneStamp kStamp{ .sourceSize = 1234, .sourceTime = 5678, .vertexFormat = VertexFormat::Float32 };
+
+AssetRegistry::ImportedFile makeTriangle()
+{
+    AssetRegistry::ImportedFile imported{ .path = "triangle.glb", .vertexFormat = VertexFormat::Float32 };
+    imported.vertices = {
+        VertexPacket{ .position = { 0.0F, 0.0F, 0.0F } },
+        VertexPacket{ .position = { 1.0F, 0.0F, 0.0F } },
+        VertexPacket{ .position = { 0.0F, 1.0F, 0.0F } }
+    };
+    // Reversed so every index is coded as an explicit varint rather than a "next vertex" code.
+    imported.indices = { 2, 1, 0 };
+    imported.meshlets = { MeshletPacket{ .boundingSphere = { 0.25F, 0.5F, 0.75F, 0.125F }, .firstIndex = 0, .indexCount = 3 } };
+
+    GlbScene& scene = imported.scene;
+    scene.nodes.push_back(GlbNode{ .name = "triangle", .mesh = 0 });
+    scene.meshes.push_back(GlbMesh{ .firstPrimitive = 0, .primitiveCount = 1 });
+    scene.primitives.push_back(GlbPrimitive{ .mesh = LoadedMesh{
+        .firstVertex = 0, .vertexCount = 3, .firstIndex = 0, .indexCount = 3, .firstMeshlet = 0, .meshletCount = 1 } });
+    return imported;
+}
+
+// Offset of the only occurrence of needle in haystack.
+size_t find(const std::vector<uint8_t>& haystack, std::span<const uint8_t> needle)
+{
+    const auto match = std::ranges::search(haystack, needle);
+    if (match.empty() || !std::ranges::search(match.end(), haystack.end(), needle.begin(), needle.end()).empty()) {
+        throw std::runtime_error("cooked_scene_test: stream not found exactly once");
+    }
+    return static_cast<size_t>(match.begin() - haystack.begin());
+}
+
+// True when reading throws the error the check under test raises, not some earlier one.
+bool rejects(const std::vector<uint8_t>& cooked, std::string_view expected)
+{
+    try {
+        (void)readCookedScene("triangle.glb", cooked.data(), cooked.size(), kStamp);
+    } catch (const std::runtime_error& error) {
+        std::cout << "  rejected: " << error.what() << '\n';
+        return std::string_view(error.what()).find(expected) != std::string_view::npos;
+    }
+    return false;
+}
+}
+
+int main()
+{
+    const AssetRegistry::ImportedFile source = makeTriangle();
+    const std::vector<uint8_t> cooked = writeCookedScene(source, kStamp);
+    int failures = 0;
+
+    const auto intact = readCookedScene("triangle.glb", cooked.data(), cooked.size(), kStamp);
+    if (!intact.has_value() || intact->indices != source.indices || intact->meshlets.size() != 1
+        || intact->meshlets[0].indexCount != 3) {
+        std::cout << "FAIL intact cook did not read back\n";
+        ++failures;
+    }
+
+    // The first index's varint, 2 zigzagged to 4; 0x44 decodes to 34, past the 3 vertices.
+    {
+        const std::vector<uint8_t> encoded = encodeIndexBuffer(source.indices.data(), source.indices.size());
+        std::vector<uint8_t> corrupt = cooked;
+        corrupt[find(cooked, encoded) + 2] ^= 0x40;
+        std::cout << "index stream byte flipped\n";
+        if (!rejects(corrupt, "primitive index out of range")) {
+            std::cout << "FAIL out-of-range index accepted\n";
+            ++failures;
+        }
+    }
+
+    // One meshlet codes larger than it is, so it is stored raw; flip a bit of its indexCount.
+    {
+        const MeshletPacket& meshlet = source.meshlets[0];
+        const auto bytes = std::as_bytes(std::span(source.meshlets));
+        std::vector<uint8_t> corrupt = cooked;
+        corrupt[find(cooked, { reinterpret_cast<const uint8_t*>(bytes.data()), bytes.size() }) + offsetof(MeshletPacket, indexCount)] ^= 0x40;
+        std::cout << "meshlet stream byte flipped (indexCount " << meshlet.indexCount << ")\n";
+        if (!rejects(corrupt, "meshlet index range out of bounds")) {
+            std::cout << "FAIL meshlet range outside its primitive accepted\n";
+            ++failures;
+        }
+    }
+
+    std::cout << (failures == 0 ? "PASS\n" : "FAIL\n");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,85 @@
+// Packs asset directories into one AssetArchive.
+//
+//   asset_packer <output.pak> <root> <directory>...
+//
+// Every regular file under each directory is stored under its path relative to root, which is
+// the path the app reads it by (e.g. root "." and directory "assets" gives "assets/models/Cone.glb").
+#include "assets/AssetArchive.h"
+
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+std::vector<uint8_t> readWholeFile(const std::filesystem::path& path)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        throw std::runtime_error("unable to open " + path.string());
+    }
+    std::vector<uint8_t> bytes(static_cast<size_t>(file.tellg()));
+    file.seekg(0, std::ios::beg);
+    if (!file.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()))) {
+        throw std::runtime_error("failed to read " + path.string());
+    }
+    return bytes;
+}
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 4) {
+        std::cerr << "usage: asset_packer <output.pak> <root> <directory>...\n";
+        return 2;
+    }
+
+    try {
+        const std::filesystem::path output = argv[1];
+        const std::filesystem::path root = argv[2];
+
+        std::vector<AssetArchive::Input> inputs{};
+        uint64_t sourceBytes = 0;
+        for (int arg = 3; arg < argc; ++arg) {
+            for (const auto& item : std::filesystem::recursive_directory_iterator(root / argv[arg])) {
+                if (!item.is_regular_file()) {
+                    continue;
+                }
+                AssetArchive::Input input{
+                    .path = std::filesystem::relative(item.path(), root).generic_string(),
+                    .bytes = readWholeFile(item.path()),
+                    .sourceTime = static_cast<int64_t>(item.last_write_time().time_since_epoch().count()) };
+                sourceBytes += input.bytes.size();
+                inputs.push_back(std::move(input));
+            }
+        }
+
+        const size_t entryCount = inputs.size();
+        const std::vector<uint8_t> archive = AssetArchive::build(std::move(inputs));
+
+        if (output.has_parent_path()) {
+            std::filesystem::create_directories(output.parent_path());
+        }
+        std::filesystem::path temporary = output;
+        temporary += ".tmp";
+        {
+            std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+            if (!file.write(reinterpret_cast<const char*>(archive.data()), static_cast<std::streamsize>(archive.size()))) {
+                throw std::runtime_error("failed to write " + temporary.string());
+            }
+        }
+        std::filesystem::rename(temporary, output);
+
+        std::cout << "[Assets] packed " << entryCount << " files, " << sourceBytes / 1024 << " KiB into "
+                  << output.string() << " (" << archive.size() / 1024 << " KiB)\n";
+    }
+    catch (const std::exception& e) {
+        std::cerr << "asset_packer: " << e.what() << '\n';
+        return 1;
+    }
+    return 0;
+}
@@ -9,6 +9,108 @@ struct VertexPacket {
     std::array<float, 3> color{ 1.0F, 1.0F, 1.0F };
 };
 
+enum class VertexFormat : uint8_t {
+    Float32,
+    CompactSnorm16,
+    CompactHalf
+};
+
+// 16-byte vertex: position is snorm16 or half (selected by VertexFormat) relative to the mesh
+// bounds, normal is octahedral snorm8, color is unorm8 and uv is half.
+struct CompactVertexPacket {
+    std::array<uint16_t, 3> position{ 0, 0, 0 };
+    std::array<int8_t, 2> normal{ 0, 0 };
+    std::array<uint8_t, 4> color{ 255, 255, 255, 255 };
+    std::array<uint16_t, 2> uv{ 0, 0 };
+};
+
+static_assert(sizeof(CompactVertexPacket) == 16, "CompactVertexPacket must stay 16 bytes");
+
+// Up to four joint influences of one skinned vertex, parallel to the mesh's vertex range. Joints
+// index the palette of the SkinningPacket skinning it; weights are unorm16 summing to 65535.
+struct SkinVertexPacket {
+    std::array<uint16_t, 4> joints{ 0, 0, 0, 0 };
+    std::array<uint16_t, 4> weights{ 65535, 0, 0, 0 };
+};
+
+static_assert(sizeof(SkinVertexPacket) == 16, "SkinVertexPacket must match the std430 layout in skinning.comp");
+
+// Skins one instance of a mesh range into the skinned vertex stream, once per frame. Source
+// positions are dequantized with dequantScale/Offset as in DrawPacket::mvp, and posed positions
+// are written normalized to outputDequantScale/Offset in every vertex format, so the box must
+// bound the posed mesh and the skinned draws' mvp folds it in.
+struct SkinningPacket {
+    uint32_t firstVertex{ 0 };
+    uint32_t vertexCount{ 0 };
+    uint32_t firstSkinVertex{ 0 };
+    // Into FrameGraphInput::jointMatrices; a vertex's joint j uses matrix firstJoint + j.
+    uint32_t firstJoint{ 0 };
+    uint32_t outputFirstVertex{ 0 };
+    std::array<float, 3> dequantScale{ 1.0F, 1.0F, 1.0F };
+    std::array<float, 3> dequantOffset{ 0.0F, 0.0F, 0.0F };
+    std::array<float, 3> outputDequantScale{ 1.0F, 1.0F, 1.0F };
+    std::array<float, 3> outputDequantOffset{ 0.0F, 0.0F, 0.0F };
+};
+
+// One cluster of a mesh's index stream with culling bounds, laid out for std430 upload.
+// Bounds are in the space of DrawPacket::cullMvp.
+struct MeshletPacket {
+    std::array<float, 4> boundingSphere{ 0.0F, 0.0F, 0.0F, 0.0F };
+    // xyz: normal cone axis, w: sine of the cone half-angle (>= 1 disables backface culling).
+    std::array<float, 4> cone{ 0.0F, 0.0F, 1.0F, 1.0F };
+    uint32_t firstIndex{ 0 };
+    uint32_t indexCount{ 0 };
+    uint32_t reserved0{ 0 };
+    uint32_t reserved1{ 0 };
+};
+
+static_assert(sizeof(MeshletPacket) == 48, "MeshletPacket must match the std430 layout in cluster_cull.comp");
+
+enum class TextureFormat : uint8_t {
+    Rgba8Srgb,
+    Bc1RgbSrgb,
+    Bc3Srgb
+};
+
+enum class TextureFilter : uint8_t {
+    Nearest,
+    Linear
+};
+
+enum class TextureAddressMode : uint8_t {
+    Repeat,
+    MirroredRepeat,
+    ClampToEdge
+};
+
+struct TextureSamplerDesc {
+    TextureFilter filter{ TextureFilter::Linear };
+    TextureAddressMode addressMode{ TextureAddressMode::Repeat };
+    bool anisotropic{ true };
+
+    bool operator==(const TextureSamplerDesc&) const = default;
+};
+
+struct TextureMipLevel {
+    uint32_t width{ 0 };
+    uint32_t height{ 0 };
+    uint64_t offset{ 0 };
+    uint64_t size{ 0 };
+};
+
+// Cooked texel data with every mip level packed into `data`. An Rgba8Srgb texture that ships only
+// its base level with generateMips set gets the rest of its chain blitted on the GPU.
+struct TextureAsset {
+    uint32_t textureId{ 0 };
+    TextureFormat format{ TextureFormat::Rgba8Srgb };
+    std::vector<TextureMipLevel> mips{};
+    std::vector<uint8_t> data{};
+    bool generateMips{ false };
+    TextureSamplerDesc sampler{};
+};
+
+inline constexpr uint32_t kNoTexture = 0xFFFFFFFFU;
+
 struct SimulationFrameInput {
     float deltaSeconds{ 0.0F };
     uint64_t frameIndex{ 0 };
@@ -30,7 +132,20 @@ struct DrawPacket {
     uint32_t materialId{ 0 };
     uint32_t vertexCount{ 3 };
     uint32_t firstVertex{ 0 };
+    // indexCount > 0 selects an indexed draw; firstVertex is then the base vertex for the indices.
+    uint32_t indexCount{ 0 };
+    uint32_t firstIndex{ 0 };
+    // meshletCount > 0 replaces the index range with GPU cluster culling over the meshlets.
+    uint32_t firstMeshlet{ 0 };
+    uint32_t meshletCount{ 0 };
+    // Draws without a texture (or with an id that failed to load) sample a 1x1 white texel.
+    uint32_t textureId{ kNoTexture };
+    // Projected bounding-sphere diameter over the viewport height; drives texture mip streaming.
+    float screenCoverage{ 1.0F };
+    // firstVertex indexes the skinned vertex stream written by FrameGraphInput::skinning this frame.
+    bool skinned{ false };
     std::array<float, 16> mvp{};
+    std::array<float, 16> cullMvp{};
 };
 
 struct FrameGraphInput {
@@ -38,6 +153,14 @@ struct FrameGraphInput {
     std::vector<MaterialBatchPacket> materialBatches{};
     std::vector<DrawPacket> drawPackets{};
     std::vector<VertexPacket> vertexPackets{};
+    VertexFormat vertexFormat{ VertexFormat::Float32 };
+    std::vector<CompactVertexPacket> compactVertexPackets{};
+    std::vector<uint32_t> indices{};
+    std::vector<MeshletPacket> meshlets{};
+    std::vector<SkinVertexPacket> skinVertices{};
+    // Column-major, mesh space of the bind pose to mesh space of the current pose.
+    std::vector<std::array<float, 16>> jointMatrices{};
+    std::vector<SkinningPacket> skinning{};
     bool runTransferStage{ true };
     bool runComputeStage{ true };
 };
@@ -47,6 +170,8 @@ public:
     virtual ~IGameSimulation() = default;
     virtual void tick(const SimulationFrameInput& input) = 0;
     virtual void drawMainMenuBar() {}
+    // Called once after device creation; the engine uploads the result and owns it from then on.
+    [[nodiscard]] virtual std::vector<TextureAsset> loadTextureAssets() { return {}; }
     [[nodiscard]] virtual FrameGraphInput buildFrameGraphInput() const = 0;
 };
 
@@ -60,6 +185,20 @@ public:
         bool enableValidation{ true };
         const char* vertexShaderPath{ nullptr };
         const char* fragmentShaderPath{ nullptr };
+        VertexFormat vertexFormat{ VertexFormat::Float32 };
+        // Cluster culling is disabled (meshlet draws fall back to their index range) when unset.
+        const char* clusterCullShaderPath{ nullptr };
+        // Required when FrameGraphInput::skinning is used.
+        const char* skinningShaderPath{ nullptr };
+        // 0 keeps every texture mip resident; otherwise mips above the tail stream within this budget.
+        uint64_t textureBudgetBytes{ 0 };
+        // When both are set, edits to <shaderSourceDir>/<shader name without .spv> are recompiled
+        // with this glslangValidator and swapped into the affected pipelines.
+        const char* shaderSourceDir{ nullptr };
+        const char* shaderCompilerPath{ nullptr };
+        // When set, every GpuAllocator allocate and free is written here for the allocation_replay
+        // benchmark; the file is complete once the device context has been torn down.
+        const char* allocationTracePath{ nullptr };
     };
 
     void run(IGameSimulation& game, const RunConfig& config = RunConfig{});
@@ -0,0 +1,39 @@
+// FileWatcher.h
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#ifndef __linux__
+#include <chrono>
+#include <filesystem>
+#endif
+
+// Reports files written or moved into watched directories (not recursive). Uses inotify on Linux
+// and modification-time polling elsewhere; poll() never blocks.
+class FileWatcher {
+public:
+    FileWatcher();
+    ~FileWatcher();
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+    FileWatcher(FileWatcher&&) = delete;
+    FileWatcher& operator=(FileWatcher&&) = delete;
+
+    // False when the directory does not exist or cannot be watched.
+    bool watch(const std::string& directory);
+
+    // Paths (directory + '/' + file name) changed since the last call, each listed once.
+    [[nodiscard]] std::vector<std::string> poll();
+
+private:
+#ifdef __linux__
+    int fd_{ -1 };
+    std::unordered_map<int, std::string> directories_{};
+#else
+    std::unordered_map<std::string, std::unordered_map<std::string, std::filesystem::file_time_type>> directories_{};
+    std::chrono::steady_clock::time_point nextScan_{};
+#endif
+};
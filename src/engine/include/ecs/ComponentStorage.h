@@ -2,14 +2,17 @@
 
 #include <ecs/Entity.h>
 
+#include <cstddef>
 #include <memory>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 class IComponentStorage {
 public:
     virtual ~IComponentStorage() = default;
     virtual void remove(Entity entity) = 0;
+    virtual void clear() = 0;
 };
 
 template <typename T>
@@ -21,11 +24,25 @@ public:
         return components_.insert_or_assign(entity.id, T{ std::forward<Args>(args)... }).first->second;
     }
 
+    // entities[i] receives components[i].
+    void insert(const std::vector<Entity>& entities, std::vector<T>&& components)
+    {
+        components_.reserve(components_.size() + entities.size());
+        for (size_t i = 0; i < entities.size(); ++i) {
+            components_.insert_or_assign(entities[i].id, std::move(components[i]));
+        }
+    }
+
     void remove(Entity entity) override
     {
         components_.erase(entity.id);
     }
 
+    void clear() override
+    {
+        components_.clear();
+    }
+
     [[nodiscard]] bool has(Entity entity) const
     {
         return components_.contains(entity.id);
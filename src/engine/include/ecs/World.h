@@ -3,6 +3,7 @@
 #include <ecs/ComponentStorage.h>
 #include <ecs/Entity.h>
 
+#include <cstddef>
 #include <cstdint>
 #include <memory>
 #include <stdexcept>
@@ -22,6 +23,11 @@ public:
     [[nodiscard]] Entity createEntity();
     void destroyEntity(Entity entity);
 
+    // Bulk variants for spawning and clearing large scenes. Created entities are appended to
+    // entities() in the returned order; destroyEntities() may be passed entities() itself.
+    [[nodiscard]] std::vector<Entity> createEntities(size_t count);
+    void destroyEntities(const std::vector<Entity>& entities);
+
     [[nodiscard]] bool isAlive(Entity entity) const;
     [[nodiscard]] const std::vector<Entity>& entities() const noexcept;
 
@@ -33,6 +39,19 @@ public:
         return storage.emplace(entity, std::forward<Args>(args)...);
     }
 
+    // entities[i] receives components[i]; every entity must be alive.
+    template <typename T>
+    void insertComponents(const std::vector<Entity>& entities, std::vector<T>&& components)
+    {
+        if (entities.size() != components.size()) {
+            throw std::runtime_error("insertComponents: entity and component counts differ");
+        }
+        for (const Entity entity : entities) {
+            validateAlive(entity);
+        }
+        storageFor<T>().insert(entities, std::move(components));
+    }
+
     template <typename T>
     bool hasComponent(Entity entity) const
     {
@@ -0,0 +1,107 @@
+// ClusterCulling.h
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+// parasoft-begin-suppress ALL "suppress all violations"
+#include <vulkan/vulkan.h>
+// parasoft-end-suppress ALL "suppress all violations"
+
+#include <Engine.h>
+
+#include "FrameLinearAllocator.h"
+#include "UniqueHandle.h"
+#include "VkBuffer.h"
+#include "VkPipeline.h"
+
+// GPU meshlet culling for DrawPackets with meshletCount > 0. record() runs on the graphics
+// queue ahead of the render pass: it clears the indirect command range, tests every meshlet
+// against the draw's frustum and normal cone, and packs survivors to the front of the draw's
+// range. drawIndirect() then issues the compacted VkDrawIndexedIndirectCommands.
+// Meshlets and cull draws change every frame, so, as in SkinningPass, they are bump-allocated
+// from the frame's FrameLinearAllocator and bound through one descriptor set per frame in flight.
+class ClusterCullPass {
+public:
+    struct Config {
+        VkDevice device{ VK_NULL_HANDLE };
+        GpuAllocator* allocator{ nullptr };
+        std::vector<char> shaderCode{};
+        // Must match the FrameLinearAllocator passed to prepare().
+        uint32_t framesInFlight{ 2 };
+        // Whether the device was created with multiDrawIndirect (VulkanDeviceCapabilities::
+        // enabledFeatures2), and its maxDrawIndirectCount limit. Without the feature every
+        // meshlet is drawn with its own drawCount == 1 call.
+        bool multiDrawIndirect{ false };
+        uint32_t maxDrawIndirectCount{ 1 };
+        uint32_t maxMeshlets{ 65536 };
+        uint32_t maxCullDraws{ 4096 };
+    };
+
+    ClusterCullPass() noexcept = default;
+    explicit ClusterCullPass(const Config& config);
+
+    ClusterCullPass(const ClusterCullPass&) = delete;
+    ClusterCullPass& operator=(const ClusterCullPass&) = delete;
+
+    ClusterCullPass(ClusterCullPass&&) noexcept = default;
+    ClusterCullPass& operator=(ClusterCullPass&&) noexcept = default;
+
+    ~ClusterCullPass() = default;
+
+    [[nodiscard]] bool valid() const noexcept { return pipeline_.valid(); }
+
+    // Rebuilds only the compute pipeline; buffers, descriptors and the layout are kept. The old
+    // pipeline is deferred-deleted, so this is safe between frames.
+    void reloadShader(VkDevice device, const std::vector<char>& shaderCode);
+
+    // Uploads meshlets and per-draw cull data; must run before record()/drawIndirect() for the
+    // frame, after frameMemory.beginFrame() has recycled the frame's slot.
+    void prepare(const FrameGraphInput& frameGraphInput, FrameLinearAllocator& frameMemory);
+    void record(VkCommandBuffer commandBuffer) const;
+
+    [[nodiscard]] bool culls(size_t drawIndex) const noexcept;
+    void drawIndirect(VkCommandBuffer commandBuffer, size_t drawIndex) const;
+
+    [[nodiscard]] uint32_t culledDrawCount() const noexcept { return cullDrawCount_; }
+    // One uint32_t per culled draw: how many of its meshlets survived. Written by record(); a
+    // transfer read of it must finish before the next record(), which the clear's barrier covers.
+    [[nodiscard]] VkBuffer counterBuffer() const noexcept { return counterBuffer_.get(); }
+    [[nodiscard]] VkDeviceSize counterBytes() const noexcept { return static_cast<VkDeviceSize>(cullDrawCount_) * sizeof(uint32_t); }
+
+private:
+    struct CullDrawGpu {
+        std::array<std::array<float, 4>, 6> planes{};
+        std::array<float, 4> viewer{};
+        uint32_t firstMeshlet{ 0 };
+        uint32_t meshletCount{ 0 };
+        uint32_t commandOffset{ 0 };
+        int32_t vertexOffset{ 0 };
+    };
+    static_assert(sizeof(CullDrawGpu) == 128, "CullDrawGpu must match the std430 layout in cluster_cull.comp");
+
+    static constexpr uint32_t kInvalidCullDraw = 0xFFFFFFFFU;
+    static constexpr uint32_t kWorkgroupSize = 64;
+
+    uint32_t maxMeshlets_{ 0 };
+    uint32_t maxCullDraws_{ 0 };
+    uint32_t maxDrawIndirectCount_{ 1 };
+
+    VulkanBuffer commandBuffer_{};
+    VulkanBuffer counterBuffer_{};
+
+    vkhandle::DeviceUniqueHandle<VkDescriptorSetLayout, PFN_vkDestroyDescriptorSetLayout> setLayout_{};
+    vkhandle::DeviceUniqueHandle<VkDescriptorPool, PFN_vkDestroyDescriptorPool> descriptorPool_{};
+    // Indexed by FrameLinearAllocator::frameIndex(); a set is only rewritten once its frame retired.
+    std::vector<VkDescriptorSet> descriptorSets_{};
+    uint32_t currentSet_{ 0 };
+    VulkanPipelineLayout pipelineLayout_{};
+    VulkanComputePipeline pipeline_{};
+
+    std::vector<CullDrawGpu> cullDraws_{};
+    std::vector<uint32_t> cullDrawByDrawPacket_{};
+    uint32_t cullDrawCount_{ 0 };
+    uint32_t commandCount_{ 0 };
+    uint32_t maxMeshletsPerDraw_{ 0 };
+};
@@ -209,11 +209,15 @@ struct DeviceContext
     [[nodiscard]] bool isFeatureEnabledDynamicRendering() const noexcept;
     [[nodiscard]] bool isFeatureSupportedDescriptorIndexing() const noexcept;
     [[nodiscard]] bool isFeatureEnabledDescriptorIndexing() const noexcept;
+    [[nodiscard]] bool isFeatureSupportedMultiDrawIndirect() const noexcept;
+    [[nodiscard]] bool isFeatureEnabledMultiDrawIndirect() const noexcept;
 
     [[nodiscard]] VkDevice         vkDevice() const;
     [[nodiscard]] VkPhysicalDevice vkPhysical() const;
     [[nodiscard]] VkInstance       vkInstance() const;
     [[nodiscard]] VkSurfaceKHR     vkSurface() const;
+    // The one GpuAllocator every buffer and image on this device sub-allocates from.
+    [[nodiscard]] GpuAllocator&    allocator() const;
 
     [[nodiscard]] uint32_t graphicsFamilyIndex() const;
     [[nodiscard]] uint32_t presentFamilyIndex() const;
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// parasoft-begin-suppress ALL "suppress all violations"
+#include <vulkan/vulkan.h>
+// parasoft-end-suppress ALL "suppress all violations"
+
+#include "GpuAllocator.h"
+#include "VkBuffer.h"
+#include "VkUtils.h"
+
+// Bump allocator for data that lives exactly one frame: joint palettes, per-draw constants,
+// indirect arguments. Each frame in flight owns a chain of persistently mapped, host-coherent
+// blocks from GpuAllocator's Transient pool. allocate() advances a cursor, and beginFrame()
+// rewinds the whole chain once the GPU has finished with the frame that last used it, so slices
+// are never freed individually.
+//
+// Not thread-safe: one thread (the render thread) allocates between beginFrame() calls.
+// Blocks are kept across frames, so after warm-up a frame allocates no Vulkan memory.
+class FrameLinearAllocator {
+public:
+    struct Config {
+        GpuAllocator* allocator{ nullptr };
+        uint32_t framesInFlight{ 0 };
+        // Requests larger than this get a block of their own size.
+        VkDeviceSize blockSize{ 4ull * 1024ull * 1024ull };
+        VkBufferUsageFlags usage{ VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT
+            | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT
+            | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT };
+    };
+
+    struct Slice {
+        VkBuffer buffer{ VK_NULL_HANDLE };
+        VkDeviceSize offset{ 0 };
+        VkDeviceSize size{ 0 };
+        void* data{ nullptr };
+
+        [[nodiscard]] bool valid() const noexcept { return buffer != VK_NULL_HANDLE; }
+        [[nodiscard]] VkDescriptorBufferInfo descriptorInfo() const noexcept { return { buffer, offset, size }; }
+    };
+
+    struct Stats {
+        uint32_t blockCount{ 0 };
+        VkDeviceSize reservedBytes{ 0 };
+        // The current frame's bytes, padding included.
+        VkDeviceSize frameBytes{ 0 };
+        VkDeviceSize peakFrameBytes{ 0 };
+    };
+
+    FrameLinearAllocator() noexcept = default;
+    explicit FrameLinearAllocator(const Config& config);
+
+    FrameLinearAllocator(const FrameLinearAllocator&) = delete;
+    FrameLinearAllocator& operator=(const FrameLinearAllocator&) = delete;
+
+    FrameLinearAllocator(FrameLinearAllocator&&) noexcept = default;
+    FrameLinearAllocator& operator=(FrameLinearAllocator&&) noexcept = default;
+
+    ~FrameLinearAllocator() = default;
+
+    [[nodiscard]] bool valid() const noexcept { return allocator_ != nullptr; }
+
+    // Same completion contract as VulkanCommandArena::beginFrame(): the fence overload expects
+    // the frame's fence to be signaled already, the timeline overload compares against the value
+    // recorded by markFrameSubmitted(). Both fail with a retryable VK_NOT_READY and leave the
+    // frame's blocks untouched while the GPU may still read them.
+    [[nodiscard]] vkutil::VkExpected<void> beginFrame(uint32_t frameIndex, VkFence frameFence);
+    [[nodiscard]] vkutil::VkExpected<void> beginFrame(uint32_t frameIndex, uint64_t completedValue);
+    void markFrameSubmitted(uint32_t frameIndex, uint64_t submissionValue) noexcept;
+
+    // alignment must be a power of two; see storageAlignment()/uniformAlignment() for descriptor
+    // offsets. Throws when no frame is open or the allocator cannot grow.
+    [[nodiscard]] Slice allocate(VkDeviceSize size, VkDeviceSize alignment = 16);
+    [[nodiscard]] Slice upload(const void* data, VkDeviceSize size, VkDeviceSize alignment = 16);
+
+    [[nodiscard]] uint32_t frameIndex() const noexcept { return currentFrame_; }
+    [[nodiscard]] uint32_t framesInFlight() const noexcept { return static_cast<uint32_t>(frames_.size()); }
+    [[nodiscard]] VkDeviceSize storageAlignment() const noexcept { return storageAlignment_; }
+    [[nodiscard]] VkDeviceSize uniformAlignment() const noexcept { return uniformAlignment_; }
+    [[nodiscard]] Stats stats() const noexcept;
+
+private:
+    struct Block {
+        VulkanBuffer buffer{};
+        std::byte* mapped{ nullptr };
+    };
+
+    struct Frame {
+        std::vector<Block> blocks{};
+        // Index of the block being bumped and the cursor within it.
+        uint32_t current{ 0 };
+        VkDeviceSize cursor{ 0 };
+        VkDeviceSize usedBytes{ 0 };
+        uint64_t submittedValue{ 0 };
+    };
+
+    static constexpr uint32_t kNoFrame = UINT32_MAX;
+
+    GpuAllocator* allocator_{ nullptr };
+    VkDeviceSize blockSize_{ 0 };
+    VkBufferUsageFlags usage_{ 0 };
+    VkDeviceSize storageAlignment_{ 1 };
+    VkDeviceSize uniformAlignment_{ 1 };
+    std::vector<Frame> frames_{};
+    uint32_t currentFrame_{ kNoFrame };
+    VkDeviceSize peakFrameBytes_{ 0 };
+
+    void resetFrame(uint32_t frameIndex) noexcept;
+    Block& appendBlock(Frame& frame, VkDeviceSize minSize);
+};
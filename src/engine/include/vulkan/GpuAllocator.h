@@ -3,14 +3,28 @@
 #include <atomic>
 #include <array>
 #include <cstdint>
+#include <functional>
+#include <memory>
 #include <mutex>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 // parasoft-begin-suppress ALL "suppress all violations"
 #include <vulkan/vulkan.h>
 // parasoft-end-suppress ALL "suppress all violations"
 
+#include "GpuAllocationTrace.h"
+#include "SlabCache.h"
+#include "TlsfAllocator.h"
+
+// Small pooled requests (up to SlabCache::kMaxSlotSize) are served from per-thread slab caches
+// without taking the allocator lock; only refilling or spilling a cache, and everything larger,
+// serialises on it. Slabs are carved from the same pooled blocks as everything else.
 class GpuAllocator {
 public:
     enum class ResourceClass : uint8_t {
@@ -23,6 +37,99 @@ public:
         Transient = 1
     };
 
+    // Blocks are never shared across pools. Callers pick the pool that matches the resource's
+    // access pattern, so per-frame staging does not fragment the blocks holding long-lived
+    // geometry.
+    enum class Pool : uint8_t {
+        General = 0,
+        Upload = 1,
+        Readback = 2,
+        Transient = 3
+    };
+
+    // Placement kind for bufferImageGranularity: buffers and linear images are Linear, images
+    // with optimal tiling Optimal. When the device's granularity is above 1 the two never share a
+    // block, so no allocation needs padding to the granularity; when it is 1 they share blocks.
+    enum class Tiling : uint8_t {
+        Linear = 0,
+        Optimal = 1
+    };
+
+    // Decides what happens when a new VkDeviceMemory would exceed its heap's budget. Low is
+    // refused on every attempt; no callback ranks below it, so nothing is evicted for it, and it
+    // never falls back to system memory. Normal is refused once, runs the Low eviction callbacks
+    // and is then allocated anyway (the budget is a soft limit). High skips the budget check and
+    // goes straight to vkAllocateMemory. Normal and High requests that the driver itself rejects
+    // run the callbacks below them, retry, and device-local ones then fall back to system memory.
+    enum class Priority : uint8_t {
+        Low = 0,
+        Normal = 1,
+        High = 2
+    };
+
+    // Thrown when an allocation cannot be satisfied even after eviction and, for device-local
+    // requests, a fallback to system memory. Callers that can do without the resource (streaming,
+    // caches) catch it and degrade; nothing is leaked.
+    class OutOfMemoryError : public std::runtime_error {
+    public:
+        OutOfMemoryError(const std::string& message, uint32_t heapIndex, VkDeviceSize bytes)
+            : std::runtime_error(message), heapIndex_(heapIndex), bytes_(bytes) {}
+
+        [[nodiscard]] uint32_t heapIndex() const noexcept { return heapIndex_; }
+        [[nodiscard]] VkDeviceSize bytes() const noexcept { return bytes_; }
+
+    private:
+        uint32_t heapIndex_{ 0 };
+        VkDeviceSize bytes_{ 0 };
+    };
+
+    struct HeapBudget {
+        VkDeviceSize size{ 0 };
+        // VK_EXT_memory_budget's heapBudget, or a fixed share of the heap without it.
+        VkDeviceSize budget{ 0 };
+        // Process-wide usage as of the last refreshBudget() plus this allocator's change since;
+        // only this allocator's bytes without the extension.
+        VkDeviceSize usage{ 0 };
+        VkDeviceSize allocatorBytes{ 0 };
+        bool deviceLocal{ false };
+    };
+
+    // Asked to release about `bytes` from heapIndex. Runs on whichever thread allocates or calls
+    // refreshBudget(), with no allocator lock held; it must be thread-safe and should only record
+    // the request, since freed memory typically has to outlive the frames in flight anyway.
+    using EvictionCallback = std::function<void(uint32_t heapIndex, VkDeviceSize bytes)>;
+
+    // Unregisters its callback on destruction; the allocator must outlive it.
+    class EvictionRegistration {
+    public:
+        EvictionRegistration() noexcept = default;
+        EvictionRegistration(GpuAllocator* allocator, uint32_t id) noexcept : allocator_(allocator), id_(id) {}
+
+        EvictionRegistration(const EvictionRegistration&) = delete;
+        EvictionRegistration& operator=(const EvictionRegistration&) = delete;
+
+        EvictionRegistration(EvictionRegistration&& other) noexcept;
+        EvictionRegistration& operator=(EvictionRegistration&& other) noexcept;
+
+        ~EvictionRegistration() noexcept { reset(); }
+
+        void reset() noexcept;
+
+    private:
+        GpuAllocator* allocator_{ nullptr };
+        uint32_t id_{ 0 };
+    };
+
+    // Where a slab carved from a pooled block lives.
+    struct SlabMemory {
+        VkDeviceMemory memory{ VK_NULL_HANDLE };
+        void* blockMapped{ nullptr };
+        VkDeviceSize blockSize{ 0 };
+        uint32_t blockIndex{ UINT32_MAX };
+        uint32_t blockNode{ TlsfAllocator::kInvalidNode };
+    };
+    using SmallSlabs = SlabCache<SlabMemory>;
+
     struct Allocation {
         VkDeviceMemory memory{ VK_NULL_HANDLE };
         VkDeviceSize offset{ 0 };
@@ -33,6 +140,32 @@ public:
         bool dedicated{ false };
         ResourceClass resourceClass{ ResourceClass::Buffer };
         LifetimeClass lifetimeClass{ LifetimeClass::Persistent };
+        Pool pool{ Pool::General };
+        Tiling tiling{ Tiling::Linear };
+        Priority priority{ Priority::Normal };
+        // Host-visible memory only: the allocation's first byte, valid for its whole lifetime.
+        void* mappedData{ nullptr };
+        // Size of the VkDeviceMemory holding it, which bounds atom-aligned flush ranges.
+        VkDeviceSize memorySize{ 0 };
+        // Pooled only: the owning block within the pool and its TLSF node, so free() is O(1).
+        uint32_t blockIndex{ UINT32_MAX };
+        uint32_t blockNode{ TlsfAllocator::kInvalidNode };
+        // Slab-served only: the slab the slot belongs to; blockNode is then the slab's node.
+        SmallSlabs::Slab* slab{ nullptr };
+    };
+
+    // One per pool key: memory type, allocate flags, pool and (with granularity above 1) tiling.
+    struct PoolStats {
+        uint32_t memoryTypeIndex{ UINT32_MAX };
+        VkMemoryAllocateFlags allocateFlags{ 0 };
+        Pool pool{ Pool::General };
+        Tiling tiling{ Tiling::Linear };
+        uint32_t blockCount{ 0 };
+        // A slab counts as one allocation.
+        uint32_t allocationCount{ 0 };
+        uint64_t totalBytes{ 0 };
+        uint64_t freeBytes{ 0 };
+        uint64_t largestFreeRange{ 0 };
     };
 
     struct Telemetry {
@@ -46,17 +179,37 @@ public:
         uint32_t poolCount{ 0 };
         uint64_t freeBytes{ 0 };
         uint64_t totalBytes{ 0 };
+        uint64_t largestFreeRange{ 0 };
+        uint32_t freeRangeCount{ 0 };
+        uint32_t evacuatingBlockCount{ 0 };
+        uint64_t releasedBlockCount{ 0 };
+        uint64_t evictionRequestCount{ 0 };
+        // Device-local requests that were placed in system memory instead.
+        uint64_t fallbackAllocationCount{ 0 };
+        uint64_t outOfMemoryCount{ 0 };
         double fragmentationRatio{ 0.0 };
         std::array<uint64_t, 2> bytesAllocatedByResourceClass{};
         std::array<uint64_t, 2> bytesFreedByResourceClass{};
         std::array<uint64_t, 2> allocationCountByResourceClass{};
         std::array<uint64_t, 2> bytesAllocatedByLifetimeClass{};
         std::array<uint64_t, 2> bytesFreedByLifetimeClass{};
+        VkDeviceSize bufferImageGranularity{ 1 };
+        std::vector<PoolStats> pools{};
+        // The lock-free path; its allocations are also part of the totals above.
+        uint64_t slabAllocationCount{ 0 };
+        uint32_t slabCount{ 0 };
+        uint64_t slabBytes{ 0 };
+        // Times a thread cache took the lock to refill or spill.
+        uint64_t slabLockCount{ 0 };
+        uint32_t slabThreadCount{ 0 };
     };
 
     GpuAllocator() noexcept = default;
+    // memoryBudgetEnabled: VK_EXT_memory_budget is enabled on the device; heap budgets fall back
+    // to a fixed share of each heap otherwise.
     GpuAllocator(VkDevice device, VkPhysicalDevice physicalDevice,
         bool bufferDeviceAddressEnabled = false,
+        bool memoryBudgetEnabled = false,
         VkDeviceSize defaultPoolBlockSize = 64ull * 1024ull * 1024ull,
         VkDeviceSize dedicatedThreshold = 16ull * 1024ull * 1024ull);
 
@@ -73,18 +226,24 @@ public:
     [[nodiscard]] VkPhysicalDevice physicalDevice() const noexcept { return physicalDevice_; }
     [[nodiscard]] VkDeviceSize nonCoherentAtomSize() const noexcept { return nonCoherentAtomSize_; }
     [[nodiscard]] bool bufferDeviceAddressEnabled() const noexcept { return bufferDeviceAddressEnabled_; }
+    [[nodiscard]] bool memoryBudgetEnabled() const noexcept { return memoryBudgetEnabled_; }
 
     [[nodiscard]] Allocation allocateForBuffer(const VkMemoryRequirements& req,
         VkMemoryPropertyFlags properties,
         VkMemoryAllocateFlags allocateFlags = 0,
         VkBuffer dedicatedBuffer = VK_NULL_HANDLE,
         bool forceDedicated = false,
-        LifetimeClass lifetimeClass = LifetimeClass::Persistent);
+        LifetimeClass lifetimeClass = LifetimeClass::Persistent,
+        Pool pool = Pool::General,
+        Priority priority = Priority::Normal);
     [[nodiscard]] Allocation allocateForImage(const VkMemoryRequirements& req,
         VkMemoryPropertyFlags properties,
         VkImage dedicatedImage = VK_NULL_HANDLE,
         bool forceDedicated = false,
-        LifetimeClass lifetimeClass = LifetimeClass::Persistent);
+        LifetimeClass lifetimeClass = LifetimeClass::Persistent,
+        Pool pool = Pool::General,
+        Priority priority = Priority::Normal,
+        VkImageTiling tiling = VK_IMAGE_TILING_OPTIMAL);
 
     [[nodiscard]] bool shouldUseDedicatedAllocation(const VkMemoryRequirements& req,
         const VkMemoryDedicatedRequirements& dedicatedReq,
@@ -95,16 +254,97 @@ public:
 
     void free(const Allocation& allocation) noexcept;
 
+    // Pooled allocations share their block's VkDeviceMemory, which Vulkan allows to be mapped
+    // only once, so every host-visible block (and dedicated allocation) is mapped whole when it
+    // is created and stays mapped until it is freed. map() just returns Allocation::mappedData,
+    // without locking; there is no unmap.
+    [[nodiscard]] VkResult map(const Allocation& allocation, void** outData) const noexcept;
+
+    // offset and size are relative to the allocation; size is clamped to its end.
+    struct MappedRange {
+        const Allocation* allocation{ nullptr };
+        VkDeviceSize offset{ 0 };
+        VkDeviceSize size{ VK_WHOLE_SIZE };
+    };
+    // Batched vkFlush/InvalidateMappedMemoryRanges: ranges are widened to nonCoherentAtomSize,
+    // merged per memory object and issued in one call. Host-coherent allocations are skipped.
+    [[nodiscard]] VkResult flush(std::span<const MappedRange> ranges) const;
+    [[nodiscard]] VkResult invalidate(std::span<const MappedRange> ranges) const;
+
     [[nodiscard]] uint32_t findMemoryType(uint32_t typeBits, VkMemoryPropertyFlags props) const;
 
     [[nodiscard]] Telemetry telemetry() const;
 
+    // Re-reads the heap budgets (once per frame is enough) and, for every heap above
+    // kEvictionThreshold of its budget, asks the Low and Normal eviction callbacks for the excess.
+    void refreshBudget();
+    [[nodiscard]] std::vector<HeapBudget> heapBudgets() const;
+    // priority is that of the memory the callback can release.
+    [[nodiscard]] EvictionRegistration addEvictionCallback(Priority priority, EvictionCallback callback);
+
+    // Defragmentation support for GpuDefragmenter. beginEvacuation() marks the sparsest non-empty
+    // blocks (live bytes below maxOccupancy of the block) as evacuating, but only as many as the
+    // rest of their pool can absorb, so moving their contents does not need a new block. New
+    // allocations skip evacuating blocks. Returns the number of blocks marked.
+    uint32_t beginEvacuation(double maxOccupancy);
+    // Clears every evacuating mark; blocks that still hold unmovable allocations serve again.
+    void endEvacuation() noexcept;
+    [[nodiscard]] bool isEvacuating(const Allocation& allocation) const;
+    // Returns empty blocks to the driver: evacuated ones, and any other whose pool
+    // keeps at least one live block. Returns the number released. Cheap enough for every frame.
+    uint32_t releaseEmptyBlocks() noexcept;
+    // Rebalances the slab caches: fully free slabs go back to their blocks, and every thread
+    // returns its cached slots on its next allocation or free, under the slab cache's lock. That
+    // is the traffic the caches exist to avoid, so this runs rarely: on GpuDefragmenter's plan
+    // interval and from refreshBudget() when a heap is under pressure.
+    void trimSlabCaches() noexcept;
+
+    // Records every allocate and free to path (see GpuAllocationTrace.h) until stopTrace(),
+    // reset() or a later startTrace(). Frees of allocations made before the trace started are not
+    // recorded. Tracing serialises every request, slab path included, on one lock. Throws
+    // std::runtime_error when the file cannot be created.
+    void startTrace(const std::string& path);
+    // Flushes and closes the trace; returns what it recorded.
+    GpuAllocationTraceWriter::Stats stopTrace() noexcept;
+    [[nodiscard]] bool tracing() const noexcept { return tracing_.load(std::memory_order_relaxed); }
+
     void reset() noexcept;
 
+    static constexpr double kEvictionThreshold = 0.9;
+
 private:
-    struct FreeRange {
-        VkDeviceSize offset{ 0 };
+    struct HeapState {
+        VkDeviceSize budget{ 0 };
+        VkDeviceSize usageAtRefresh{ 0 };
+        VkDeviceSize allocatorBytesAtRefresh{ 0 };
+        VkDeviceSize allocatorBytes{ 0 };
+    };
+
+    struct Evictor {
+        uint32_t id{ 0 };
+        Priority priority{ Priority::Low };
+        EvictionCallback callback{};
+    };
+
+    struct Request {
         VkDeviceSize size{ 0 };
+        VkDeviceSize alignment{ 1 };
+        VkMemoryAllocateFlags allocateFlags{ 0 };
+        bool dedicated{ false };
+        VkBuffer dedicatedBuffer{ VK_NULL_HANDLE };
+        VkImage dedicatedImage{ VK_NULL_HANDLE };
+        ResourceClass resourceClass{ ResourceClass::Buffer };
+        LifetimeClass lifetimeClass{ LifetimeClass::Persistent };
+        Pool pool{ Pool::General };
+        Tiling tiling{ Tiling::Linear };
+        Priority priority{ Priority::Normal };
+    };
+
+    // Why the last attempt needed new memory it could not get.
+    struct Shortfall {
+        uint32_t heapIndex{ 0 };
+        VkDeviceSize bytes{ 0 };
+        bool overBudget{ false };
     };
 
     struct MemoryBlock {
@@ -113,41 +353,89 @@ private:
         uint32_t memoryTypeIndex{ UINT32_MAX };
         uint64_t poolKey{ 0 };
         VkMemoryAllocateFlags allocateFlags{ 0 };
-        std::vector<FreeRange> freeRanges{};
+        TlsfAllocator ranges{};
+        // Persistent mapping of the whole block; null unless host-visible.
+        void* mapped{ nullptr };
+        bool evacuating{ false };
     };
 
     VkDevice device_{ VK_NULL_HANDLE };
     VkPhysicalDevice physicalDevice_{ VK_NULL_HANDLE };
     VkPhysicalDeviceMemoryProperties memProps_{};
     bool bufferDeviceAddressEnabled_{ false };
+    bool memoryBudgetEnabled_{ false };
     VkDeviceSize nonCoherentAtomSize_{ 1 };
+    VkDeviceSize bufferImageGranularity_{ 1 };
     VkDeviceSize defaultPoolBlockSize_{ 0 };
     VkDeviceSize dedicatedThreshold_{ 0 };
 
     mutable std::mutex mutex_{};
     std::unordered_map<uint64_t, std::vector<MemoryBlock>> pooledBlocks_{};
+    // Its lock is taken before mutex_ (slabs are acquired and released under it), so nothing
+    // here calls into it while holding mutex_.
+    SmallSlabs slabs_{};
     std::atomic<uint64_t> allocationCount_{ 0 };
     std::atomic<uint64_t> freeCount_{ 0 };
     std::atomic<uint64_t> bytesAllocated_{ 0 };
     std::atomic<uint64_t> bytesFreed_{ 0 };
     std::atomic<uint64_t> dedicatedAllocationCount_{ 0 };
     std::atomic<uint64_t> pooledAllocationCount_{ 0 };
+    std::atomic<uint64_t> releasedBlockCount_{ 0 };
+    std::atomic<uint64_t> evictionRequestCount_{ 0 };
+    std::atomic<uint64_t> fallbackAllocationCount_{ 0 };
+    std::atomic<uint64_t> outOfMemoryCount_{ 0 };
     std::array<std::atomic<uint64_t>, 2> bytesAllocatedByResourceClass_{};
     std::array<std::atomic<uint64_t>, 2> bytesFreedByResourceClass_{};
     std::array<std::atomic<uint64_t>, 2> allocationCountByResourceClass_{};
     std::array<std::atomic<uint64_t>, 2> bytesAllocatedByLifetimeClass_{};
     std::array<std::atomic<uint64_t>, 2> bytesFreedByLifetimeClass_{};
+    std::array<HeapState, VK_MAX_MEMORY_HEAPS> heaps_{};
 
-    static VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment) noexcept;
-    [[nodiscard]] static uint64_t makePoolKey(uint32_t memoryTypeIndex, VkMemoryAllocateFlags allocateFlags) noexcept;
-    MemoryBlock& createPooledBlock(uint32_t memoryTypeIndex, VkMemoryAllocateFlags allocateFlags, VkDeviceSize minSize);
-    static void mergeFreeRanges(std::vector<FreeRange>& ranges);
-    [[nodiscard]] Allocation allocateInternal(const VkMemoryRequirements& req,
-        VkMemoryPropertyFlags properties,
-        VkMemoryAllocateFlags allocateFlags,
-        bool forceDedicated,
-        VkBuffer dedicatedBuffer,
-        VkImage dedicatedImage,
-        ResourceClass resourceClass,
-        LifetimeClass lifetimeClass);
+    // Separate from mutex_ so callbacks can be copied out and run while allocations proceed.
+    mutable std::mutex evictionMutex_{};
+    std::vector<Evictor> evictors_{};
+    uint32_t nextEvictorId_{ 1 };
+
+    // Checked without the lock so untraced requests never take traceMutex_.
+    std::atomic<bool> tracing_{ false };
+    std::mutex traceMutex_{};
+    std::unique_ptr<GpuAllocationTraceWriter> trace_{};
+
+    [[nodiscard]] static uint64_t makePoolKey(uint32_t memoryTypeIndex, VkMemoryAllocateFlags allocateFlags,
+        Tiling tiling, Pool pool) noexcept;
+    [[nodiscard]] static PoolStats describePoolKey(uint64_t poolKey) noexcept;
+    // Returns the new block's index within pooledBlocks_[poolKey]; reuses a released slot first.
+    // nullopt when the memory could not be had, with the reason in shortfall.
+    [[nodiscard]] std::optional<uint32_t> createPooledBlockLocked(uint64_t poolKey, uint32_t memoryTypeIndex,
+        VkMemoryAllocateFlags allocateFlags, VkDeviceSize minSize, Priority priority, bool finalAttempt, Shortfall& shortfall);
+    [[nodiscard]] MemoryBlock* findBlockLocked(const Allocation& allocation) noexcept;
+    [[nodiscard]] Allocation allocateInternal(const Request& request, uint32_t memoryTypeBits, VkMemoryPropertyFlags properties);
+    [[nodiscard]] std::optional<Allocation> tryAllocateLocked(const Request& request, uint32_t memoryTypeIndex,
+        bool finalAttempt, Shortfall& shortfall);
+    // A range from the first non-evacuating block of the pool with room, creating a block if
+    // none has; returns the block index and the range.
+    [[nodiscard]] std::optional<std::pair<uint32_t, TlsfAllocator::Allocation>> allocateRangeLocked(uint64_t poolKey,
+        uint32_t memoryTypeIndex, VkMemoryAllocateFlags allocateFlags, VkDeviceSize size, VkDeviceSize alignment,
+        Priority priority, bool finalAttempt, Shortfall& shortfall);
+    // The lock-free path; nullopt when the request is not small or no slab could be had.
+    [[nodiscard]] std::optional<Allocation> tryAllocateSlab(const Request& request, uint32_t memoryTypeBits,
+        VkMemoryPropertyFlags properties);
+    [[nodiscard]] std::optional<SmallSlabs::AcquiredSlab> acquireSlab(uint64_t poolKey, VkDeviceSize size, VkDeviceSize alignment);
+    void releaseSlab(uint64_t poolKey, const SmallSlabs::Slab& slab) noexcept;
+    [[nodiscard]] static size_t slabStatSlot(ResourceClass resourceClass, LifetimeClass lifetimeClass) noexcept;
+    // Budget check plus vkAllocateMemory; false on refusal or out-of-memory.
+    [[nodiscard]] bool allocateMemoryLocked(const VkMemoryAllocateInfo& info, Priority priority, bool finalAttempt,
+        Shortfall& shortfall, VkDeviceMemory& outMemory);
+    void freeMemoryLocked(VkDeviceMemory memory, uint32_t memoryTypeIndex, VkDeviceSize size) noexcept;
+    // Maps host-visible memory whole; null for other types. Frees the memory and throws on failure.
+    [[nodiscard]] void* mapPersistentLocked(VkDeviceMemory memory, uint32_t memoryTypeIndex, VkDeviceSize size);
+    [[nodiscard]] std::vector<VkMappedMemoryRange> buildMappedRanges(std::span<const MappedRange> ranges) const;
+    [[nodiscard]] uint32_t findMemoryTypeLocked(uint32_t typeBits, VkMemoryPropertyFlags props) const noexcept;
+    [[nodiscard]] VkDeviceSize projectedUsageLocked(uint32_t heapIndex) const noexcept;
+    void refreshBudgetLocked();
+    // Runs the callbacks whose priority is below `requester`, lowest first.
+    void requestEviction(uint32_t heapIndex, VkDeviceSize bytes, Priority requester);
+    void removeEvictionCallback(uint32_t id) noexcept;
+    void traceAllocate(const Request& request, const Allocation& allocation);
+    void traceFree(const Allocation& allocation) noexcept;
 };
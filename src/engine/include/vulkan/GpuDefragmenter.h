@@ -0,0 +1,188 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+// parasoft-begin-suppress ALL "suppress all violations"
+#include <vulkan/vulkan.h>
+// parasoft-end-suppress ALL "suppress all violations"
+
+#include "GpuAllocator.h"
+#include "VkBuffer.h"
+#include "VkSwapchain.h"
+
+// Incremental compaction of GpuAllocator's pooled blocks. Owners register the VulkanBuffers and
+// VulkanImages that may move; each frame step() asks the allocator to mark its sparsest blocks as
+// evacuating, then relocates registered resources out of them within a byte budget. A relocated
+// resource is swapped in place for a fresh one (so get() returns the new handle) and the owner's
+// callback patches whatever cached the old handle, typically descriptor sets. The old resource
+// stays alive until every frame that could still reference it has retired; once an
+// evacuation has drained, the emptied blocks go back to the driver.
+//
+// Contents move in one of two ways:
+//  - host-visible buffers in the Upload pool (written only by the CPU) are memcpy'd at once;
+//  - anything else needs VK_BUFFER_USAGE_TRANSFER_SRC_BIT and is copied by the commands
+//    recordCopies() writes, which must execute before any of this frame's work touches the
+//    buffer. Queue family ownership is not transferred, so record them on a queue of the
+//    buffer's own family (or give the buffer concurrent sharing).
+// Buffers registered as Discard skip the copy. Buffers that are mapped at step() time, or that
+// fit neither path, are left where they are and keep their block alive.
+//
+// Images move the same way as GPU-copied buffers: every mip level and layer is copied by
+// recordCopies(), so they need VK_IMAGE_USAGE_TRANSFER_SRC_BIT and must be in the layout they
+// were registered with whenever a frame starts. Both the new image and the old one are left in
+// that layout, so draws recorded this frame may still sample the old image through descriptors
+// the owner has not patched yet. An image whose replacement the allocator refuses stays put.
+//
+// Not thread-safe: beginFrame(), step() and recordCopies() run on the render thread.
+class GpuDefragmenter {
+public:
+    struct Config {
+        GpuAllocator* allocator{ nullptr };
+        uint32_t framesInFlight{ 0 };
+        // Blocks whose live bytes are below this fraction of the block are evacuated.
+        double maxOccupancy{ 0.25 };
+        // Bytes moved per step(); a buffer larger than this still moves, alone.
+        VkDeviceSize bytesPerFrame{ 8ull * 1024ull * 1024ull };
+        // Frames between looks for sparse blocks while no evacuation is running.
+        uint32_t planInterval{ 120 };
+    };
+
+    enum class Contents : uint8_t {
+        Preserve,
+        // Fully rewritten before every use, so relocation only rebinds.
+        Discard
+    };
+
+    using RelocatedFn = std::function<void(VkBuffer oldBuffer, VkBuffer newBuffer)>;
+    using ImageRelocatedFn = std::function<void(VkImage oldImage, VkImage newImage)>;
+    using Handle = uint32_t;
+
+    // Unregisters its image when reset or destroyed. The defragmenter must outlive it.
+    class ImageRegistration {
+    public:
+        ImageRegistration() noexcept = default;
+        ImageRegistration(GpuDefragmenter* defragmenter, Handle handle) noexcept : defragmenter_(defragmenter), handle_(handle) {}
+
+        ImageRegistration(const ImageRegistration&) = delete;
+        ImageRegistration& operator=(const ImageRegistration&) = delete;
+
+        ImageRegistration(ImageRegistration&& other) noexcept;
+        ImageRegistration& operator=(ImageRegistration&& other) noexcept;
+
+        ~ImageRegistration() noexcept { reset(); }
+
+        void reset() noexcept;
+
+    private:
+        GpuDefragmenter* defragmenter_{ nullptr };
+        Handle handle_{ 0 };
+    };
+
+    struct Stats {
+        uint64_t relocatedBuffers{ 0 };
+        uint64_t relocatedImages{ 0 };
+        uint64_t relocatedBytes{ 0 };
+        uint64_t releasedBlocks{ 0 };
+        uint32_t evacuations{ 0 };
+        uint32_t pendingCopies{ 0 };
+        uint32_t retiringBuffers{ 0 };
+    };
+
+    GpuDefragmenter() noexcept = default;
+    explicit GpuDefragmenter(const Config& config);
+
+    GpuDefragmenter(const GpuDefragmenter&) = delete;
+    GpuDefragmenter& operator=(const GpuDefragmenter&) = delete;
+
+    GpuDefragmenter(GpuDefragmenter&&) noexcept = default;
+    GpuDefragmenter& operator=(GpuDefragmenter&&) noexcept = default;
+
+    ~GpuDefragmenter() = default;
+
+    [[nodiscard]] bool valid() const noexcept { return allocator_ != nullptr; }
+
+    // buffer must stay at the same address until unregisterBuffer(); it must not be moved from.
+    [[nodiscard]] Handle registerBuffer(VulkanBuffer& buffer, Contents contents, RelocatedFn onRelocated = {});
+    void unregisterBuffer(Handle handle) noexcept;
+
+    // image must stay at the same address while registered; layout is the one every subresource
+    // is in between frames. aspect selects what recordCopies() copies.
+    [[nodiscard]] ImageRegistration registerImage(VulkanImage& image, VkImageLayout layout,
+        ImageRelocatedFn onRelocated = {}, VkImageAspectFlags aspect = VK_IMAGE_ASPECT_COLOR_BIT);
+    void unregisterImage(Handle handle) noexcept;
+
+    // Call once per frame after the frame's fence wait: destroys buffers replaced
+    // framesInFlight frames ago and, when an evacuation has drained, releases the empty blocks.
+    void beginFrame();
+    // Plans or continues an evacuation; returns the number of buffers relocated.
+    uint32_t step();
+    // Records the GPU copies queued by step() and forgets them.
+    void recordCopies(VkCommandBuffer commandBuffer);
+
+    [[nodiscard]] const Stats& stats() const noexcept { return stats_; }
+
+private:
+    struct Entry {
+        VulkanBuffer* buffer{ nullptr };
+        Contents contents{ Contents::Preserve };
+        RelocatedFn onRelocated{};
+    };
+
+    struct ImageEntry {
+        VulkanImage* image{ nullptr };
+        VkImageLayout layout{ VK_IMAGE_LAYOUT_UNDEFINED };
+        VkImageAspectFlags aspect{ VK_IMAGE_ASPECT_COLOR_BIT };
+        ImageRelocatedFn onRelocated{};
+    };
+
+    // Holds either a buffer or an image.
+    struct Retired {
+        VulkanBuffer buffer{};
+        VulkanImage image{};
+        uint64_t retireFrame{ 0 };
+    };
+
+    struct PendingCopy {
+        VkBuffer source{ VK_NULL_HANDLE };
+        VkBuffer destination{ VK_NULL_HANDLE };
+        VkDeviceSize size{ 0 };
+    };
+
+    struct PendingImageCopy {
+        VkImage source{ VK_NULL_HANDLE };
+        VkImage destination{ VK_NULL_HANDLE };
+        VkImageLayout layout{ VK_IMAGE_LAYOUT_UNDEFINED };
+        VkImageAspectFlags aspect{ VK_IMAGE_ASPECT_COLOR_BIT };
+        VkExtent3D extent{};
+        uint32_t mipLevels{ 1 };
+        uint32_t arrayLayers{ 1 };
+    };
+
+    enum class MovePath : uint8_t { None, Rebind, HostCopy, GpuCopy };
+
+    GpuAllocator* allocator_{ nullptr };
+    uint32_t framesInFlight_{ 0 };
+    double maxOccupancy_{ 0.0 };
+    VkDeviceSize bytesPerFrame_{ 0 };
+    uint32_t planInterval_{ 0 };
+
+    std::unordered_map<Handle, Entry> entries_{};
+    std::unordered_map<Handle, ImageEntry> imageEntries_{};
+    Handle nextHandle_{ 1 };
+    std::vector<Retired> retired_{};
+    std::vector<PendingCopy> pendingCopies_{};
+    std::vector<PendingImageCopy> pendingImageCopies_{};
+    uint64_t frame_{ 0 };
+    uint64_t nextPlanFrame_{ 0 };
+    bool evacuating_{ false };
+    // Every movable buffer has left the evacuating blocks; waiting on retirement only.
+    bool drained_{ false };
+    Stats stats_{};
+
+    [[nodiscard]] static MovePath movePath(const Entry& entry) noexcept;
+    void relocate(Entry& entry, MovePath path);
+    [[nodiscard]] bool relocate(ImageEntry& entry);
+};
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <optional>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+// parasoft-begin-suppress ALL "suppress all violations"
+#include <vulkan/vulkan.h>
+// parasoft-end-suppress ALL "suppress all violations"
+
+#include "GpuAllocator.h"
+#include "VkBuffer.h"
+#include "VkCommands.h"
+#include "VkSync.h"
+#include "VkUtils.h"
+
+// Copies GPU buffers and images back to the host without stalling the frame. readBuffer() and
+// readImage() queue a request with a callback; once a frame, beginBatch() claims the next slot of
+// a host-cached ring and hands out a command buffer for the RenderTaskGraph pass that performs the
+// copies, together with the timeline value that pass must signal. collect() polls the timeline
+// with vkGetSemaphoreCounterValue and runs the callbacks of every batch it has passed, usually
+// framesInFlight frames after the request. Nothing here waits on a fence or the device.
+//
+// The ring has framesInFlight + 1 slots of frameBytes each, so one batch can still be on its way
+// while the frame fences already allow the next frame. If the slot beginBatch() would take is
+// still in flight, the requests stay queued for the next frame instead. Requests larger than a
+// slot are refused.
+//
+// The graph pass is responsible for the source side: it declares a transfer read of every source
+// (images in the layout named by their request) and records recordCopies() between its barrier
+// batches. The copies end in a host-read barrier, so callbacks see the data after invalidation.
+//
+// Not thread-safe: everything runs on the render thread. A claimed batch must be ended and
+// submitted before the next beginBatch().
+class ReadbackService {
+public:
+    struct Config {
+        VkDevice device{ VK_NULL_HANDLE };
+        GpuAllocator* allocator{ nullptr };
+        // Family of the queue the graph pass is submitted to.
+        uint32_t queueFamilyIndex{ VK_QUEUE_FAMILY_IGNORED };
+        uint32_t framesInFlight{ 0 };
+        VkDeviceSize frameBytes{ 4ull * 1024ull * 1024ull };
+    };
+
+    // Receives the bytes of one request; the span is only valid during the call.
+    using Callback = std::function<void(std::span<const uint8_t> data)>;
+
+    struct ImageSource {
+        VkImage image{ VK_NULL_HANDLE };
+        // Layout the graph pass leaves the image in: TRANSFER_SRC_OPTIMAL or GENERAL.
+        VkImageLayout layout{ VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL };
+        VkImageSubresourceLayers subresource{ VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+        VkOffset3D offset{};
+        VkExtent3D extent{};
+        // Tightly packed texels (or compressed blocks) of the region.
+        VkDeviceSize size{ 0 };
+    };
+
+    struct Batch {
+        // Already begun; recordCopies() records into it and endBatch() ends it.
+        VkCommandBuffer commandBuffer{ VK_NULL_HANDLE };
+        // The pass signals timeline at signalValue (SubmissionScheduler::JobRequest::signalValues).
+        VkSemaphore timeline{ VK_NULL_HANDLE };
+        uint64_t signalValue{ 0 };
+    };
+
+    struct Stats {
+        uint64_t requests{ 0 };
+        uint64_t delivered{ 0 };
+        uint64_t deliveredBytes{ 0 };
+        uint64_t batches{ 0 };
+        // vkCmdCopyBuffer / vkCmdCopyImageToBuffer calls and the regions they carried.
+        uint64_t copyCommands{ 0 };
+        uint64_t copyRegions{ 0 };
+        // Frames whose queued requests waited because the next slot was still in flight.
+        uint64_t slotStalls{ 0 };
+        // collect() calls between each request and its callback, summed and at most.
+        uint64_t totalLatencyFrames{ 0 };
+        uint64_t maxLatencyFrames{ 0 };
+        uint32_t pendingRequests{ 0 };
+        uint32_t inFlightBatches{ 0 };
+        VkDeviceSize ringBytes{ 0 };
+        bool hostCached{ false };
+    };
+
+    explicit ReadbackService(const Config& config);
+
+    ReadbackService(const ReadbackService&) = delete;
+    ReadbackService& operator=(const ReadbackService&) = delete;
+
+    // The ring and command pools are referenced by batches in flight.
+    ReadbackService(ReadbackService&&) = delete;
+    ReadbackService& operator=(ReadbackService&&) = delete;
+
+    // Waits for every batch in flight; their callbacks are dropped.
+    ~ReadbackService();
+
+    void readBuffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size, Callback callback);
+    void readImage(const ImageSource& source, Callback callback);
+
+    // Claims a slot for the queued requests that fit; nullopt when nothing is queued or the slot is
+    // still in flight.
+    [[nodiscard]] std::optional<Batch> beginBatch();
+    void recordCopies();
+    [[nodiscard]] vkutil::VkExpected<void> endBatch();
+
+    // Delivers every batch the timeline has passed; cheap, call once per frame.
+    void collect();
+
+    [[nodiscard]] VkSemaphore timeline() const noexcept { return timeline_.get(); }
+    [[nodiscard]] const Stats& stats() const noexcept { return stats_; }
+
+private:
+    struct Request {
+        VkBuffer buffer{ VK_NULL_HANDLE };
+        VkDeviceSize offset{ 0 };
+        ImageSource image{};
+        VkDeviceSize size{ 0 };
+        Callback callback{};
+        uint64_t frame{ 0 };
+        // Offset of the result within the slot; set when the request joins a batch.
+        VkDeviceSize slotOffset{ 0 };
+    };
+
+    struct BufferCopies {
+        VkBuffer buffer{ VK_NULL_HANDLE };
+        std::vector<VkBufferCopy> regions{};
+    };
+
+    struct ImageCopy {
+        VkImage image{ VK_NULL_HANDLE };
+        VkImageLayout layout{ VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL };
+        VkBufferImageCopy region{};
+    };
+
+    struct Slot {
+        // Timeline value of the batch using the slot; 0 while free.
+        uint64_t value{ 0 };
+        VkDeviceSize usedBytes{ 0 };
+        std::vector<Request> requests{};
+        VulkanCommandPool pool{};
+        VulkanCommandBuffer commandBuffer{};
+    };
+
+    void enqueue(Request request);
+    [[nodiscard]] uint64_t completedValue();
+    void deliver(Slot& slot);
+
+    VkDevice device_{ VK_NULL_HANDLE };
+    uint32_t queueFamilyIndex_{ VK_QUEUE_FAMILY_IGNORED };
+    VkDeviceSize frameBytes_{ 0 };
+
+    TimelineSemaphore timeline_{};
+    VulkanBuffer ring_{};
+    const uint8_t* ringData_{ nullptr };
+    std::vector<Slot> slots_{};
+    // Next slot to claim and oldest slot in flight; both advance round-robin.
+    uint32_t nextSlot_{ 0 };
+    uint32_t oldestSlot_{ 0 };
+    std::optional<uint32_t> openSlot_{};
+
+    std::deque<Request> pending_{};
+    // The open batch's copies.
+    std::vector<BufferCopies> bufferCopies_{};
+    std::unordered_map<VkBuffer, size_t> bufferIndex_{};
+    std::vector<ImageCopy> imageCopies_{};
+
+    uint64_t submittedValue_{ 0 };
+    uint64_t frame_{ 0 };
+    Stats stats_{};
+};
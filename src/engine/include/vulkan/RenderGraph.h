@@ -3,6 +3,7 @@
 #include <cstdint>
 #include <functional>
 #include <optional>
+#include <span>
 #include <unordered_map>
 #include <vector>
 
@@ -40,6 +41,7 @@ public:
         VkDeviceSize bufferSize{ VK_WHOLE_SIZE };
         VkDeviceSize transientBufferSize{ 0 };
         VkDeviceSize transientBufferAlignment{ 1 };
+        VkBufferUsageFlags transientBufferUsage{ 0 };
 
         VkImage image{ VK_NULL_HANDLE };
         VkImageSubresourceRange imageSubresourceRange{ VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
@@ -55,6 +57,10 @@ public:
         VkPipelineStageFlags2 initialStageMask{ VK_PIPELINE_STAGE_2_NONE };
         VkAccessFlags2 initialAccessMask{ VK_ACCESS_2_NONE };
         uint32_t initialQueueFamilyIndex{ VK_QUEUE_FAMILY_IGNORED };
+
+        // Transient resources that occupied this one's memory earlier in the frame; set by
+        // bindTransientResources(). Its first use waits for all their users and discards contents.
+        std::vector<ResourceId> aliasedAfter{};
     };
 
     struct ResourceUsage {
@@ -105,8 +111,12 @@ public:
         uint32_t aliasSlot{ 0 };
         ResourceType type{ ResourceType::Global };
         uint64_t aliasClass{ 0 };
+        // Schedule orders of the first use of the slot's first resource and the last use of its last.
+        size_t firstUseOrder{ 0 };
+        size_t lastUseOrder{ 0 };
         VkDeviceSize requiredBufferSize{ 0 };
         VkDeviceSize requiredBufferAlignment{ 1 };
+        VkBufferUsageFlags bufferUsage{ 0 };
         VkExtent3D requiredImageExtent{ 0, 0, 0 };
         VkFormat imageFormat{ VK_FORMAT_UNDEFINED };
         VkImageUsageFlags imageUsage{ 0 };
@@ -123,6 +133,14 @@ public:
         std::unordered_map<ResourceId, uint32_t> aliasSlotByResource{};
     };
 
+    // The object and placement backing one transient resource; see TransientResourcePool.
+    struct TransientBinding {
+        ResourceId resource{ 0 };
+        VkBuffer buffer{ VK_NULL_HANDLE };
+        VkImage image{ VK_NULL_HANDLE };
+        std::vector<ResourceId> aliasedAfter{};
+    };
+
     RenderTaskGraph() = default;
 
     void clear();
@@ -141,6 +159,7 @@ public:
         uint32_t initialQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED);
     [[nodiscard]] ResourceId createTransientBufferResource(
         VkDeviceSize size,
+        VkBufferUsageFlags usage,
         VkDeviceSize alignment = 1,
         uint64_t aliasClass = 0,
         VkPipelineStageFlags2 initialStageMask = VK_PIPELINE_STAGE_2_NONE,
@@ -166,6 +185,13 @@ public:
     [[nodiscard]] vkutil::VkExpected<CompiledTransientPlan> compileTransientPlan() const;
     [[nodiscard]] vkutil::VkExpected<SubmissionScheduler::FrameExecutionResult> execute(SubmissionScheduler& scheduler) const;
 
+    // Hashes everything compileTransientPlan() depends on (transient descriptors and every pass's
+    // usages, but no handles), so a graph rebuilt each frame can reuse last frame's placement.
+    [[nodiscard]] uint64_t transientShapeKey() const noexcept;
+    // Gives transient resources their objects. Bound resources get real buffer and image barriers,
+    // and execute() orders every user of a resource after every user of its aliasedAfter list.
+    [[nodiscard]] vkutil::VkExpected<void> bindTransientResources(std::span<const TransientBinding> bindings);
+
 private:
     struct Edge {
         PassId producer{ 0 };
@@ -216,6 +242,7 @@ private:
     [[nodiscard]] static BarrierBatch makeBarrierBatch(const ResourceDescriptor& descriptor, const ResourceUsage& src, const ResourceUsage& dst) noexcept;
     [[nodiscard]] static BarrierBatch makeReleaseBarrierBatch(const ResourceDescriptor& descriptor, const ResourceUsage& src, const ResourceUsage& dst) noexcept;
     [[nodiscard]] static BarrierBatch makeAcquireBarrierBatch(const ResourceDescriptor& descriptor, const ResourceUsage& src, const ResourceUsage& dst) noexcept;
+    [[nodiscard]] static BarrierBatch makeAliasingBarrierBatch(const ResourceDescriptor& descriptor, const ResourceUsage& src, const ResourceUsage& dst) noexcept;
     [[nodiscard]] static bool imageRangesOverlap(const VkImageSubresourceRange& lhs, const VkImageSubresourceRange& rhs) noexcept;
     [[nodiscard]] static bool usagesOverlap(const ResourceDescriptor& descriptor, const ResourceUsage& lhs, const ResourceUsage& rhs) noexcept;
 
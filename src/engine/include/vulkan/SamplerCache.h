@@ -0,0 +1,39 @@
+// SamplerCache.h
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+
+// parasoft-begin-suppress ALL "suppress all violations"
+#include <vulkan/vulkan.h>
+// parasoft-end-suppress ALL "suppress all violations"
+
+#include <Engine.h>
+
+#include "UniqueHandle.h"
+
+// Deduplicates VkSamplers by TextureSamplerDesc; every texture with the same desc shares one handle.
+class SamplerCache {
+public:
+    SamplerCache() noexcept = default;
+    // maxAnisotropy <= 1 disables anisotropic filtering for every sampler.
+    SamplerCache(VkDevice device, float maxAnisotropy);
+
+    SamplerCache(const SamplerCache&) = delete;
+    SamplerCache& operator=(const SamplerCache&) = delete;
+
+    SamplerCache(SamplerCache&&) noexcept = default;
+    SamplerCache& operator=(SamplerCache&&) noexcept = default;
+
+    ~SamplerCache() = default;
+
+    [[nodiscard]] VkSampler get(const TextureSamplerDesc& desc);
+    [[nodiscard]] size_t size() const noexcept { return samplers_.size(); }
+
+private:
+    [[nodiscard]] static uint32_t makeKey(const TextureSamplerDesc& desc) noexcept;
+
+    VkDevice device_{ VK_NULL_HANDLE };
+    float maxAnisotropy_{ 1.0F };
+    std::unordered_map<uint32_t, vkhandle::DeviceUniqueHandle<VkSampler, PFN_vkDestroySampler>> samplers_{};
+};
@@ -0,0 +1,45 @@
+// ShaderReloader.h
+#pragma once
+
+#include <FileWatcher.h>
+
+#include <future>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Watches GLSL sources and recompiles them to SPIR-V on worker threads. A served SPIR-V path maps to
+// sourceDir/<its file name without ".spv">, e.g. shaders/triangle.frag.spv to sourceDir/triangle.frag.
+// A failed compile logs and leaves the previous SPIR-V in place.
+class ShaderReloader {
+public:
+    struct Compiled {
+        std::string spvPath{};
+        std::vector<char> code{};
+    };
+
+    ShaderReloader() noexcept = default;
+    ShaderReloader(const std::string& sourceDir, std::string compilerPath, const std::vector<std::string>& spvPaths);
+
+    [[nodiscard]] bool active() const noexcept { return watcher_ != nullptr; }
+
+    // Starts compiles for changed sources and returns the ones that finished; never blocks.
+    [[nodiscard]] std::vector<Compiled> poll();
+
+private:
+    struct Job {
+        std::string sourcePath{};
+        std::string spvPath{};
+        std::future<std::vector<char>> result{};
+        // The source changed again while compiling; the result is stale.
+        bool rerun{ false };
+    };
+
+    void start(const std::string& sourcePath, const std::string& spvPath);
+
+    std::string compilerPath_{};
+    std::unordered_map<std::string, std::string> spvBySource_{};
+    std::unique_ptr<FileWatcher> watcher_{};
+    std::vector<Job> jobs_{};
+};
@@ -0,0 +1,111 @@
+// SkinningPass.h
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+// parasoft-begin-suppress ALL "suppress all violations"
+#include <vulkan/vulkan.h>
+// parasoft-end-suppress ALL "suppress all violations"
+
+#include <Engine.h>
+
+#include "FrameLinearAllocator.h"
+#include "UniqueHandle.h"
+#include "VkBuffer.h"
+#include "VkPipeline.h"
+
+// GPU linear blend skinning for FrameGraphInput::skinning. record() runs on the graphics queue
+// ahead of the render pass and writes every packet's posed vertices, in the pipeline's vertex
+// format, to a device-local stream. Skinned DrawPackets bind outputBuffer() instead of the
+// frame's vertex stream, so each instance is skinned once per frame however many draws read it.
+// The vertex stream, joint palettes and dispatch packets change every frame, so they live in the
+// frame's FrameLinearAllocator and are bound through one descriptor set per frame in flight.
+class SkinningPass {
+public:
+    struct Config {
+        VkDevice device{ VK_NULL_HANDLE };
+        GpuAllocator* allocator{ nullptr };
+        std::vector<char> shaderCode{};
+        VertexFormat vertexFormat{ VertexFormat::Float32 };
+        // Must match the FrameLinearAllocator passed to prepare().
+        uint32_t framesInFlight{ 2 };
+        uint32_t maxSkinVertices{ 262144 };
+        uint32_t maxJoints{ 65536 };
+        uint32_t maxDispatches{ 4096 };
+        uint32_t maxOutputVertices{ 1048576 };
+    };
+
+    SkinningPass() noexcept = default;
+    explicit SkinningPass(const Config& config);
+
+    SkinningPass(const SkinningPass&) = delete;
+    SkinningPass& operator=(const SkinningPass&) = delete;
+
+    SkinningPass(SkinningPass&&) noexcept = default;
+    SkinningPass& operator=(SkinningPass&&) noexcept = default;
+
+    ~SkinningPass() = default;
+
+    [[nodiscard]] bool valid() const noexcept { return pipeline_.valid(); }
+
+    // Rebuilds only the compute pipeline, as ClusterCullPass::reloadShader().
+    void reloadShader(VkDevice device, const std::vector<char>& shaderCode);
+
+    // Uploads skin weights, joint palettes and packets; must run before record() for the frame,
+    // after frameMemory.beginFrame() has recycled the frame's slot. sourceVertices is the frame's
+    // vertex stream, allocated from frameMemory at its storage alignment.
+    void prepare(const FrameGraphInput& frameGraphInput, FrameLinearAllocator& frameMemory,
+        const FrameLinearAllocator::Slice& sourceVertices);
+    void record(VkCommandBuffer commandBuffer) const;
+
+    [[nodiscard]] VkBuffer outputBuffer() const noexcept { return outputBuffer_.get(); }
+    [[nodiscard]] uint32_t dispatchCount() const noexcept { return dispatchCount_; }
+
+private:
+    struct SkinDispatchGpu {
+        std::array<float, 4> dequantScale{};
+        std::array<float, 4> dequantOffset{};
+        // Reciprocal of the output dequant scale, 0 for flat axes.
+        std::array<float, 4> outputScale{};
+        std::array<float, 4> outputOffset{};
+        uint32_t firstVertex{ 0 };
+        uint32_t vertexCount{ 0 };
+        uint32_t firstSkinVertex{ 0 };
+        uint32_t firstJoint{ 0 };
+        uint32_t outputFirstVertex{ 0 };
+        uint32_t reserved0{ 0 };
+        uint32_t reserved1{ 0 };
+        uint32_t reserved2{ 0 };
+    };
+    static_assert(sizeof(SkinDispatchGpu) == 96, "SkinDispatchGpu must match the std430 layout in skinning.comp");
+
+    struct PushConstants {
+        uint32_t dispatchCount{ 0 };
+        uint32_t vertexFormat{ 0 };
+    };
+
+    static constexpr uint32_t kWorkgroupSize = 64;
+
+    VertexFormat vertexFormat_{ VertexFormat::Float32 };
+    uint32_t maxSkinVertices_{ 0 };
+    uint32_t maxJoints_{ 0 };
+    uint32_t maxDispatches_{ 0 };
+    uint32_t maxOutputVertices_{ 0 };
+
+    VulkanBuffer skinVertexBuffer_{};
+    VulkanBuffer outputBuffer_{};
+
+    vkhandle::DeviceUniqueHandle<VkDescriptorSetLayout, PFN_vkDestroyDescriptorSetLayout> setLayout_{};
+    vkhandle::DeviceUniqueHandle<VkDescriptorPool, PFN_vkDestroyDescriptorPool> descriptorPool_{};
+    // Indexed by FrameLinearAllocator::frameIndex(); a set is only rewritten once its frame retired.
+    std::vector<VkDescriptorSet> descriptorSets_{};
+    uint32_t currentSet_{ 0 };
+    VulkanPipelineLayout pipelineLayout_{};
+    VulkanComputePipeline pipeline_{};
+
+    std::vector<SkinDispatchGpu> dispatches_{};
+    uint32_t dispatchCount_{ 0 };
+    uint32_t maxVerticesPerDispatch_{ 0 };
+};
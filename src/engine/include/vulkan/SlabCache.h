@@ -0,0 +1,517 @@
+// SlabCache.h
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Per-thread caches of fixed-size slots, so small sub-allocations are made and freed without a
+// lock. Knows nothing about Vulkan; GpuAllocator keys it by pool key and carves the slabs out of
+// its blocks, and Payload is whatever the backing allocator needs to find a slab again.
+//
+// Slots come in power-of-two size classes from kMinSlotSize to kMaxSlotSize, each aligned to its
+// size. A slab is one kSlabSize range from the backing allocator cut into slots of one class.
+// Every thread keeps a free list per (key, class): allocate() pops from it, free() pushes onto
+// it whichever thread made the allocation. A thread only locks the shared state when its list
+// runs dry or grows past two batches, and then moves kBatchSlots slots at once.
+//
+// The shared state gives a slab back to the backing allocator once all its slots have come home
+// and its class still has spares. trim() also makes every thread return its whole cache on its
+// next call; retire() stops a slab's slots from being handed out until revive(), which is how
+// blocks being evacuated drain. A thread that never calls again keeps its cache until it exits.
+template <typename Payload>
+class SlabCache {
+public:
+    static constexpr uint64_t kMinSlotSize = 256;
+    static constexpr uint64_t kMaxSlotSize = 64ull * 1024ull;
+    static constexpr uint64_t kSlabSize = 256ull * 1024ull;
+    static constexpr uint32_t kClassCount = static_cast<uint32_t>(std::countr_zero(kMaxSlotSize) - std::countr_zero(kMinSlotSize)) + 1;
+    static constexpr uint32_t kBatchSlots = 32;
+    // Caller-chosen buckets for the allocation counters.
+    static constexpr size_t kStatSlots = 4;
+
+    struct Slab {
+        uint64_t key{ 0 };
+        uint32_t sizeClass{ 0 };
+        uint32_t slotCount{ 0 };
+        uint64_t offset{ 0 };
+        Payload payload{};
+        // Guarded by the shared lock.
+        uint32_t sharedFree{ 0 };
+        bool released{ false };
+        // Written under the shared lock; free() reads it without, and retire() bumps the epoch
+        // after setting it, so a thread that has synced to that epoch sees it.
+        std::atomic<bool> retired{ false };
+    };
+
+    struct Slot {
+        Slab* slab{ nullptr };
+        // Absolute offset in the backing range, not relative to the slab.
+        uint64_t offset{ 0 };
+    };
+
+    struct AcquiredSlab {
+        uint64_t offset{ 0 };
+        Payload payload{};
+    };
+
+    // Both run under the shared lock, on whichever thread needed them.
+    using AcquireFn = std::function<std::optional<AcquiredSlab>(uint64_t key, uint64_t size, uint64_t alignment)>;
+    using ReleaseFn = std::function<void(uint64_t key, const Slab& slab)>;
+
+    struct Stats {
+        std::array<uint64_t, kStatSlots> allocations{};
+        std::array<uint64_t, kStatSlots> frees{};
+        std::array<uint64_t, kStatSlots> bytesAllocated{};
+        std::array<uint64_t, kStatSlots> bytesFreed{};
+        uint32_t slabCount{ 0 };
+        uint64_t slabBytes{ 0 };
+        // Slots parked in the shared state; those in thread caches are not counted.
+        uint64_t sharedFreeSlots{ 0 };
+        uint32_t threadCount{ 0 };
+        // Times a thread took the shared lock to refill or to spill.
+        uint64_t refills{ 0 };
+        uint64_t spills{ 0 };
+        uint64_t acquiredSlabs{ 0 };
+        uint64_t releasedSlabs{ 0 };
+    };
+
+    SlabCache() noexcept = default;
+    SlabCache(AcquireFn acquire, ReleaseFn release)
+        : shared_(std::make_shared<Shared>())
+        , id_(nextId().fetch_add(1, std::memory_order_relaxed))
+    {
+        shared_->acquire = std::move(acquire);
+        shared_->release = std::move(release);
+    }
+
+    SlabCache(const SlabCache&) = delete;
+    SlabCache& operator=(const SlabCache&) = delete;
+
+    SlabCache(SlabCache&& other) noexcept : shared_(std::move(other.shared_)), id_(other.id_) {}
+    SlabCache& operator=(SlabCache&& other) noexcept
+    {
+        if (this != &other) {
+            detach();
+            shared_ = std::move(other.shared_);
+            id_ = other.id_;
+        }
+        return *this;
+    }
+
+    // Threads still holding cached slots drop them without calling back.
+    ~SlabCache() { detach(); }
+
+    [[nodiscard]] bool valid() const noexcept { return shared_ != nullptr; }
+
+    // nullopt when the request is larger than kMaxSlotSize once rounded to its alignment.
+    [[nodiscard]] static std::optional<uint32_t> classFor(uint64_t size, uint64_t alignment) noexcept
+    {
+        const uint64_t bytes = std::max({ size, alignment, kMinSlotSize });
+        if (bytes > kMaxSlotSize) {
+            return std::nullopt;
+        }
+        return static_cast<uint32_t>(std::countr_zero(std::bit_ceil(bytes)) - std::countr_zero(kMinSlotSize));
+    }
+    [[nodiscard]] static constexpr uint64_t slotSize(uint32_t sizeClass) noexcept { return kMinSlotSize << sizeClass; }
+
+    // nullopt when the backing allocator has no room for a new slab.
+    [[nodiscard]] std::optional<Slot> allocate(uint64_t key, uint32_t sizeClass, size_t statSlot, uint64_t bytes)
+    {
+        ThreadCache& cache = threadCache();
+        syncEpoch(cache);
+        std::vector<Slot>& list = cache.lists[key][sizeClass];
+        Slot slot{};
+        do {
+            if (list.empty() && !refill(key, sizeClass, list)) {
+                return std::nullopt;
+            }
+            slot = list.back();
+            list.pop_back();
+            // A slot freed here while retire() ran concurrently may have missed the flag.
+        } while (slot.slab->retired.load(std::memory_order_relaxed) && parkSlot(slot));
+        bump(cache.counters.allocations[statSlot], 1);
+        bump(cache.counters.bytesAllocated[statSlot], bytes);
+        return slot;
+    }
+
+    void free(const Slot& slot, size_t statSlot, uint64_t bytes)
+    {
+        ThreadCache& cache = threadCache();
+        syncEpoch(cache);
+        bump(cache.counters.frees[statSlot], 1);
+        bump(cache.counters.bytesFreed[statSlot], bytes);
+        if (slot.slab->retired.load(std::memory_order_relaxed)) {
+            // Cached, the slot would be handed out again; it goes straight to the parked list.
+            (void)parkSlot(slot);
+            return;
+        }
+        std::vector<Slot>& list = cache.lists[slot.slab->key][slot.slab->sizeClass];
+        list.push_back(slot);
+        if (list.size() >= 2 * kBatchSlots) {
+            // The oldest half goes; the newest slots are the likeliest to be warm.
+            std::lock_guard<std::mutex> lock(shared_->mutex);
+            ++shared_->spills;
+            returnSlotsLocked(list.begin(), list.begin() + kBatchSlots);
+            list.erase(list.begin(), list.begin() + kBatchSlots);
+        }
+    }
+
+    // Releases every slab whose slots are all back, and asks each thread to return its cache on
+    // its next call so the rest can follow.
+    void trim()
+    {
+        if (!shared_) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(shared_->mutex);
+        shared_->epoch.fetch_add(1, std::memory_order_release);
+        for (Slab& slab : shared_->slabs) {
+            if (!slab.released && slab.sharedFree == slab.slotCount) {
+                releaseSlabLocked(slab);
+            }
+        }
+    }
+
+    // Slabs for which pred(key, payload) holds stop serving; their slots are parked as they come
+    // back and the slab is released once all have.
+    template <typename Pred>
+    void retire(Pred&& pred)
+    {
+        if (!shared_) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(shared_->mutex);
+        bool any = false;
+        for (Slab& slab : shared_->slabs) {
+            if (slab.released || slab.retired.load(std::memory_order_relaxed) || !pred(slab.key, std::as_const(slab.payload))) {
+                continue;
+            }
+            slab.retired.store(true, std::memory_order_relaxed);
+            any = true;
+            std::vector<Slot>& list = shared_->freeSlots[slab.key][slab.sizeClass];
+            std::vector<Slot>& parked = shared_->parked[&slab];
+            for (const Slot& slot : list) {
+                if (slot.slab == &slab) {
+                    parked.push_back(slot);
+                }
+            }
+            std::erase_if(list, [&slab](const Slot& slot) { return slot.slab == &slab; });
+            if (slab.sharedFree == slab.slotCount) {
+                releaseSlabLocked(slab);
+            }
+        }
+        // Slots pushed onto a thread's list before it saw the flag come back on its next call.
+        if (any) {
+            shared_->epoch.fetch_add(1, std::memory_order_release);
+        }
+    }
+
+    void revive()
+    {
+        if (!shared_) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(shared_->mutex);
+        for (auto& [slab, parked] : shared_->parked) {
+            slab->retired.store(false, std::memory_order_relaxed);
+            std::vector<Slot>& list = shared_->freeSlots[slab->key][slab->sizeClass];
+            list.insert(list.end(), parked.begin(), parked.end());
+        }
+        shared_->parked.clear();
+    }
+
+    [[nodiscard]] Stats stats() const
+    {
+        Stats stats{};
+        if (!shared_) {
+            return stats;
+        }
+        std::lock_guard<std::mutex> lock(shared_->mutex);
+        const auto add = [&stats](const Counters& counters) {
+            for (size_t i = 0; i < kStatSlots; ++i) {
+                stats.allocations[i] += counters.allocations[i].load(std::memory_order_relaxed);
+                stats.frees[i] += counters.frees[i].load(std::memory_order_relaxed);
+                stats.bytesAllocated[i] += counters.bytesAllocated[i].load(std::memory_order_relaxed);
+                stats.bytesFreed[i] += counters.bytesFreed[i].load(std::memory_order_relaxed);
+            }
+        };
+        add(shared_->exited);
+        for (const ThreadCache* cache : shared_->threads) {
+            add(cache->counters);
+        }
+        for (const Slab& slab : shared_->slabs) {
+            if (!slab.released) {
+                ++stats.slabCount;
+                stats.slabBytes += kSlabSize;
+                stats.sharedFreeSlots += slab.sharedFree;
+            }
+        }
+        stats.threadCount = static_cast<uint32_t>(shared_->threads.size());
+        stats.refills = shared_->refills;
+        stats.spills = shared_->spills;
+        stats.acquiredSlabs = shared_->acquiredSlabs;
+        stats.releasedSlabs = shared_->releasedSlabs;
+        return stats;
+    }
+
+private:
+    // Written only by the owning thread; read by stats() from any thread.
+    struct Counters {
+        std::array<std::atomic<uint64_t>, kStatSlots> allocations{};
+        std::array<std::atomic<uint64_t>, kStatSlots> frees{};
+        std::array<std::atomic<uint64_t>, kStatSlots> bytesAllocated{};
+        std::array<std::atomic<uint64_t>, kStatSlots> bytesFreed{};
+    };
+
+    using ClassLists = std::array<std::vector<Slot>, kClassCount>;
+    struct ThreadCache;
+
+    struct Shared {
+        std::mutex mutex{};
+        // Bumped to make threads return their caches.
+        std::atomic<uint64_t> epoch{ 0 };
+        bool alive{ true };
+        AcquireFn acquire{};
+        ReleaseFn release{};
+        // A deque so slots can point at their slab; released records are reused.
+        std::deque<Slab> slabs{};
+        std::vector<Slab*> releasedRecords{};
+        std::unordered_map<uint64_t, ClassLists> freeSlots{};
+        std::unordered_map<Slab*, std::vector<Slot>> parked{};
+        std::vector<ThreadCache*> threads{};
+        Counters exited{};
+        uint64_t refills{ 0 };
+        uint64_t spills{ 0 };
+        uint64_t acquiredSlabs{ 0 };
+        uint64_t releasedSlabs{ 0 };
+    };
+
+    struct ThreadCache {
+        uint64_t ownerId{ 0 };
+        std::weak_ptr<Shared> shared{};
+        uint64_t epoch{ 0 };
+        std::unordered_map<uint64_t, ClassLists> lists{};
+        Counters counters{};
+
+        ThreadCache() = default;
+        ThreadCache(const ThreadCache&) = delete;
+        ThreadCache& operator=(const ThreadCache&) = delete;
+
+        // Thread exit: everything cached goes back, unless the cache itself is gone.
+        ~ThreadCache()
+        {
+            const std::shared_ptr<Shared> owner = shared.lock();
+            if (!owner) {
+                return;
+            }
+            std::lock_guard<std::mutex> lock(owner->mutex);
+            if (!owner->alive) {
+                return;
+            }
+            for (auto& [_, classes] : lists) {
+                for (std::vector<Slot>& list : classes) {
+                    returnSlotsLocked(*owner, list.begin(), list.end());
+                }
+            }
+            for (size_t i = 0; i < kStatSlots; ++i) {
+                bump(owner->exited.allocations[i], counters.allocations[i].load(std::memory_order_relaxed));
+                bump(owner->exited.frees[i], counters.frees[i].load(std::memory_order_relaxed));
+                bump(owner->exited.bytesAllocated[i], counters.bytesAllocated[i].load(std::memory_order_relaxed));
+                bump(owner->exited.bytesFreed[i], counters.bytesFreed[i].load(std::memory_order_relaxed));
+            }
+            std::erase(owner->threads, this);
+        }
+    };
+
+    static std::atomic<uint64_t>& nextId() noexcept
+    {
+        static std::atomic<uint64_t> id{ 1 };
+        return id;
+    }
+
+    // Single writer, so no read-modify-write is needed.
+    static void bump(std::atomic<uint64_t>& counter, uint64_t amount) noexcept
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    ThreadCache& threadCache()
+    {
+        thread_local std::vector<std::unique_ptr<ThreadCache>> caches{};
+        for (const std::unique_ptr<ThreadCache>& cache : caches) {
+            if (cache->ownerId == id_) {
+                return *cache;
+            }
+        }
+        // Caches of destroyed SlabCaches only hold dangling slots.
+        std::erase_if(caches, [](const std::unique_ptr<ThreadCache>& cache) { return cache->shared.expired(); });
+
+        auto cache = std::make_unique<ThreadCache>();
+        cache->ownerId = id_;
+        cache->shared = shared_;
+        cache->epoch = shared_->epoch.load(std::memory_order_acquire);
+        {
+            std::lock_guard<std::mutex> lock(shared_->mutex);
+            shared_->threads.push_back(cache.get());
+        }
+        caches.push_back(std::move(cache));
+        return *caches.back();
+    }
+
+    void syncEpoch(ThreadCache& cache)
+    {
+        const uint64_t epoch = shared_->epoch.load(std::memory_order_acquire);
+        if (cache.epoch == epoch) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(shared_->mutex);
+        for (auto& [_, classes] : cache.lists) {
+            for (std::vector<Slot>& list : classes) {
+                returnSlotsLocked(list.begin(), list.end());
+                list.clear();
+            }
+        }
+        cache.epoch = epoch;
+    }
+
+    // Always true; shaped for allocate()'s retry loop.
+    bool parkSlot(const Slot& slot)
+    {
+        std::lock_guard<std::mutex> lock(shared_->mutex);
+        returnSlotsLocked(&slot, &slot + 1);
+        return true;
+    }
+
+    bool refill(uint64_t key, uint32_t sizeClass, std::vector<Slot>& out)
+    {
+        std::lock_guard<std::mutex> lock(shared_->mutex);
+        if (!shared_->alive) {
+            return false;
+        }
+        ++shared_->refills;
+        std::vector<Slot>& list = shared_->freeSlots[key][sizeClass];
+        if (list.empty() && !acquireSlabLocked(key, sizeClass, list)) {
+            return false;
+        }
+        const size_t count = std::min<size_t>(list.size(), kBatchSlots);
+        for (auto it = list.end() - static_cast<std::ptrdiff_t>(count); it != list.end(); ++it) {
+            --it->slab->sharedFree;
+            out.push_back(*it);
+        }
+        list.resize(list.size() - count);
+        return true;
+    }
+
+    bool acquireSlabLocked(uint64_t key, uint32_t sizeClass, std::vector<Slot>& list)
+    {
+        const uint64_t slot = slotSize(sizeClass);
+        std::optional<AcquiredSlab> acquired = shared_->acquire(key, kSlabSize, slot);
+        if (!acquired.has_value()) {
+            return false;
+        }
+
+        Slab* slab = nullptr;
+        if (!shared_->releasedRecords.empty()) {
+            slab = shared_->releasedRecords.back();
+            shared_->releasedRecords.pop_back();
+        }
+        else {
+            slab = &shared_->slabs.emplace_back();
+        }
+        // Reset field by field: the atomic flag makes Slab neither copyable nor movable.
+        slab->key = key;
+        slab->sizeClass = sizeClass;
+        slab->slotCount = static_cast<uint32_t>(kSlabSize / slot);
+        slab->offset = acquired->offset;
+        slab->payload = std::move(acquired->payload);
+        slab->sharedFree = slab->slotCount;
+        slab->released = false;
+        slab->retired.store(false, std::memory_order_relaxed);
+        ++shared_->acquiredSlabs;
+        // Highest offset first, so threads pop slots in address order.
+        for (uint32_t i = slab->slotCount; i-- > 0;) {
+            list.push_back(Slot{ slab, slab->offset + i * slot });
+        }
+        return true;
+    }
+
+    template <typename It>
+    void returnSlotsLocked(It first, It last)
+    {
+        returnSlotsLocked(*shared_, first, last);
+    }
+
+    template <typename It>
+    static void returnSlotsLocked(Shared& shared, It first, It last)
+    {
+        for (It it = first; it != last; ++it) {
+            Slab& slab = *it->slab;
+            ++slab.sharedFree;
+            const bool retired = slab.retired.load(std::memory_order_relaxed);
+            if (retired) {
+                shared.parked[&slab].push_back(*it);
+            }
+            else {
+                shared.freeSlots[slab.key][slab.sizeClass].push_back(*it);
+            }
+            if (slab.sharedFree != slab.slotCount) {
+                continue;
+            }
+            // Keep at least a batch of spares per class, so a thread churning on one class does
+            // not acquire and release the same slab over and over.
+            const size_t spares = shared.freeSlots[slab.key][slab.sizeClass].size();
+            if (retired || spares >= slab.slotCount + kBatchSlots) {
+                releaseSlabLocked(shared, slab);
+            }
+        }
+    }
+
+    void releaseSlabLocked(Slab& slab)
+    {
+        releaseSlabLocked(*shared_, slab);
+    }
+
+    static void releaseSlabLocked(Shared& shared, Slab& slab)
+    {
+        if (slab.retired.load(std::memory_order_relaxed)) {
+            shared.parked.erase(&slab);
+        }
+        else {
+            std::erase_if(shared.freeSlots[slab.key][slab.sizeClass], [&slab](const Slot& slot) { return slot.slab == &slab; });
+        }
+        shared.release(slab.key, slab);
+        slab.released = true;
+        slab.retired.store(false, std::memory_order_relaxed);
+        slab.sharedFree = 0;
+        shared.releasedRecords.push_back(&slab);
+        ++shared.releasedSlabs;
+    }
+
+    void detach() noexcept
+    {
+        if (!shared_) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(shared_->mutex);
+        shared_->alive = false;
+        shared_->acquire = {};
+        shared_->release = {};
+        shared_->freeSlots.clear();
+        shared_->parked.clear();
+        shared_->threads.clear();
+    }
+
+    std::shared_ptr<Shared> shared_{};
+    uint64_t id_{ 0 };
+};
@@ -33,6 +33,9 @@ public:
         std::vector<VkSemaphore> waitSemaphores{};
         std::vector<VkPipelineStageFlags2> waitStages{};
         std::vector<VkSemaphore> signalSemaphores{};
+        // Values to signal timeline semaphores in signalSemaphores with: empty when all are binary,
+        // otherwise one per semaphore with 0 for the binary ones.
+        std::vector<uint64_t> signalValues{};
         VkFence fence{ VK_NULL_HANDLE };
         const char* debugLabel{ "submission_scheduler_job" };
     };
@@ -98,6 +101,7 @@ private:
         std::vector<VkSemaphore> waitSemaphores{};
         std::vector<VkPipelineStageFlags2> waitStages{};
         std::vector<VkSemaphore> signalSemaphores{};
+        std::vector<uint64_t> signalValues{};
         VkFence fence{ VK_NULL_HANDLE };
         const char* debugLabel{ "submission_scheduler_job" };
     };
@@ -110,6 +114,9 @@ private:
     struct SubmitBatch {
         struct SubmitEntry {
             std::vector<VkPipelineStageFlags> waitStagesLegacy{};
+            // Chained into submitInfo only when the job signals a timeline semaphore.
+            VkTimelineSemaphoreSubmitInfo timelineInfo{ VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO };
+            bool signalsTimeline{ false };
             VkSubmitInfo submitInfo{ VK_STRUCTURE_TYPE_SUBMIT_INFO };
         };
 
@@ -0,0 +1,223 @@
+// TextureManager.h
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+// parasoft-begin-suppress ALL "suppress all violations"
+#include <vulkan/vulkan.h>
+// parasoft-end-suppress ALL "suppress all violations"
+
+#include <Engine.h>
+
+#include "GpuDefragmenter.h"
+#include "SamplerCache.h"
+#include "UniqueHandle.h"
+#include "UploadManager.h"
+#include "VkBuffer.h"
+#include "VkCommands.h"
+#include "VkCore.h"
+#include "VkSwapchain.h"
+#include "VkSync.h"
+
+// Owns sampled textures and their combined image sampler descriptor sets (set 0, binding 0,
+// fragment stage). Textures whose format the device cannot sample are skipped and draw with the
+// default 1x1 white texture.
+//
+// With budgetBytes == 0 upload() makes every mip resident. Otherwise upload() only makes the mip
+// tail (levels no larger than residentTailExtent) resident, and stream() pulls finer levels in
+// from the CPU copy of each asset based on per-draw screen coverage: one batch at a time through
+// the UploadManager, installed once its token is ready. When a finer level would not fit, streamed
+// levels of the least recently drawn textures are evicted back to their tail. All device memory
+// the manager holds (tails, streamed images, in-flight uploads and images waiting to retire) is
+// kept within the budget; textures with generateMips set cannot stream and stay fully resident.
+//
+// Streamed images are Low priority GpuAllocator allocations: when a device-local heap runs short
+// the allocator asks this manager to shrink, and stream() lowers its effective budget below what
+// it holds, evicting the least recently drawn levels; the budget then creeps back to the
+// configured value while the pressure stays away. A streamed image the allocator refuses is
+// dropped from its batch and the texture keeps drawing from its tail.
+//
+// With a GpuDefragmenter, every tail and streamed image is registered with it, so compaction can
+// move textures out of sparse blocks. The defragmenter copies a moved image during the frame it
+// moves; the next stream() gives the texture a view and descriptor set on the new image and
+// retires the old ones, which keep sampling the old image until then.
+class TextureManager {
+public:
+    struct Config {
+        VkDevice device{ VK_NULL_HANDLE };
+        GpuAllocator* allocator{ nullptr };
+        VulkanQueue queue{};
+        // Carries streaming uploads; required when budgetBytes > 0.
+        UploadManager* uploads{ nullptr };
+        float maxAnisotropy{ 1.0F };
+        uint32_t maxTextures{ 256 };
+        uint64_t budgetBytes{ 0 };
+        uint32_t residentTailExtent{ 64 };
+        // Replaced descriptor sets and images are destroyed this many stream() calls later.
+        uint32_t framesInFlight{ 2 };
+        // Optional; must outlive the manager.
+        GpuDefragmenter* defragmenter{ nullptr };
+    };
+
+    struct Stats {
+        uint32_t textureCount{ 0 };
+        uint32_t skipped{ 0 };
+        uint32_t samplerCount{ 0 };
+        // Cooked bytes of every mip level, resident or not; GPU-generated levels count at RGBA8 size.
+        uint64_t deviceBytes{ 0 };
+        // The same chains stored as uncompressed RGBA8.
+        uint64_t rgba8Bytes{ 0 };
+
+        uint64_t budgetBytes{ 0 };
+        // budgetBytes lowered by allocator memory pressure.
+        uint64_t effectiveBudgetBytes{ 0 };
+        // Device memory currently held, including in-flight uploads and images waiting to retire.
+        uint64_t allocatedBytes{ 0 };
+        uint64_t peakAllocatedBytes{ 0 };
+        uint32_t streamedTextures{ 0 };
+        uint64_t streamUploads{ 0 };
+        uint64_t evictions{ 0 };
+        uint64_t pressureEvents{ 0 };
+        // Streamed images the allocator refused.
+        uint64_t deferredUploads{ 0 };
+        // Images the defragmenter moved, and so descriptor sets replaced.
+        uint64_t relocations{ 0 };
+    };
+
+    TextureManager() noexcept = default;
+    explicit TextureManager(const Config& config);
+
+    TextureManager(const TextureManager&) = delete;
+    TextureManager& operator=(const TextureManager&) = delete;
+
+    TextureManager(TextureManager&&) noexcept = default;
+    TextureManager& operator=(TextureManager&&) noexcept = default;
+
+    ~TextureManager() = default;
+
+    // Blocking; meant for load time.
+    void upload(const std::vector<TextureAsset>& assets);
+
+    // Once per frame, after the frame's fence wait and before recording draws, even without a
+    // budget when textures can be relocated. frameIndex must increase monotonically; descriptor
+    // sets returned before the call stay valid for framesInFlight more calls.
+    void stream(uint64_t frameIndex, const std::vector<DrawPacket>& drawPackets, uint32_t viewportHeight);
+
+    [[nodiscard]] VkDescriptorSetLayout setLayout() const noexcept { return setLayout_.get(); }
+    // Unknown ids and kNoTexture resolve to the default white texture.
+    [[nodiscard]] VkDescriptorSet descriptorSet(uint32_t textureId) const noexcept;
+    [[nodiscard]] const Stats& stats() const noexcept { return stats_; }
+
+private:
+    // An image holding mip levels [baseMip, mipCount) of a texture.
+    struct Residency {
+        VulkanImage image{};
+        VulkanImageView view{};
+        VkDescriptorSet descriptorSet{ VK_NULL_HANDLE };
+        uint32_t baseMip{ 0 };
+        uint64_t bytes{ 0 };
+        // Set once the residency is in place in its texture; last, so it unregisters before the
+        // image goes.
+        GpuDefragmenter::ImageRegistration relocation{};
+
+        [[nodiscard]] bool valid() const noexcept { return descriptorSet != VK_NULL_HANDLE; }
+    };
+
+    struct Texture {
+        TextureAsset source{};
+        VkFormat format{ VK_FORMAT_UNDEFINED };
+        VkSampler sampler{ VK_NULL_HANDLE };
+        uint32_t mipCount{ 1 };
+        uint32_t tailMip{ 0 };
+        Residency tail{};
+        Residency streamed{};
+        uint32_t wantedMip{ 0 };
+        uint64_t lastUsedFrame{ 0 };
+        bool uploading{ false };
+
+        [[nodiscard]] uint32_t residentMip() const noexcept { return streamed.valid() ? streamed.baseMip : tail.baseMip; }
+    };
+
+    struct UploadRequest {
+        uint32_t textureId{ kNoTexture };
+        const TextureAsset* asset{ nullptr };
+        VkFormat format{ VK_FORMAT_UNDEFINED };
+        uint32_t baseMip{ 0 };
+        uint32_t mipLevels{ 1 };
+        VkDeviceSize stagingOffset{ 0 };
+        VulkanImage image{};
+        uint64_t bytes{ 0 };
+    };
+
+    struct StreamBatch {
+        UploadManager::Token token{};
+        std::vector<UploadRequest> requests{};
+    };
+
+    struct Retired {
+        uint64_t retireFrame{ 0 };
+        Residency residency{};
+    };
+
+    // An image the defragmenter moved; which residency it belongs to is checked again on install.
+    struct Relocated {
+        uint32_t textureId{ kNoTexture };
+        bool streamed{ false };
+        VkImage image{ VK_NULL_HANDLE };
+    };
+
+    [[nodiscard]] bool supportsFormat(VkFormat format, bool gpuMips) const;
+    [[nodiscard]] VkDescriptorSet allocateDescriptorSet(VkImageView view, VkSampler sampler);
+    [[nodiscard]] VulkanImage createImage(const UploadRequest& request, bool streaming);
+    [[nodiscard]] VulkanBuffer fillStaging(std::vector<UploadRequest>& requests) const;
+    void recordUploads(VkCommandBuffer cmd, VkBuffer staging, const std::vector<UploadRequest>& requests) const;
+    [[nodiscard]] Residency makeResidency(UploadRequest& request, const Texture& texture);
+
+    void installCompletedBatch(uint64_t frameIndex);
+    void registerRelocation(uint32_t textureId, Residency& residency, bool streamed);
+    void installRelocated(uint64_t frameIndex);
+    void retire(Residency&& residency, uint64_t frameIndex);
+    void collectRetired(uint64_t frameIndex);
+    void updateWantedMips(uint64_t frameIndex, const std::vector<DrawPacket>& drawPackets, uint32_t viewportHeight);
+    [[nodiscard]] static bool isEvictable(const Texture& texture, uint64_t frameIndex) noexcept;
+    [[nodiscard]] uint64_t retiringBytes() const noexcept;
+    [[nodiscard]] bool evictFor(uint64_t bytes, uint32_t protectedTextureId, uint64_t frameIndex);
+    void submitStreamBatch(uint64_t frameIndex);
+    void trackAllocation(int64_t delta) noexcept;
+    void applyMemoryPressure(uint64_t frameIndex);
+
+    VkDevice device_{ VK_NULL_HANDLE };
+    GpuAllocator* allocator_{ nullptr };
+    VulkanQueue queue_{};
+    UploadManager* uploads_{ nullptr };
+    uint32_t maxTextures_{ 0 };
+    uint64_t budgetBytes_{ 0 };
+    uint64_t effectiveBudgetBytes_{ 0 };
+    uint32_t residentTailExtent_{ 64 };
+    uint32_t framesInFlight_{ 2 };
+    GpuDefragmenter* defragmenter_{ nullptr };
+
+    SamplerCache samplers_{};
+    vkhandle::DeviceUniqueHandle<VkDescriptorSetLayout, PFN_vkDestroyDescriptorSetLayout> setLayout_{};
+    vkhandle::DeviceUniqueHandle<VkDescriptorPool, PFN_vkDestroyDescriptorPool> descriptorPool_{};
+
+    Residency defaultTexture_{};
+    std::unordered_map<uint32_t, Texture> textures_{};
+    std::optional<StreamBatch> streamBatch_{};
+    std::deque<Retired> retired_{};
+    Stats stats_{};
+
+    // Written by the allocator's eviction callback on any thread, consumed by stream(). Shared so
+    // the callback stays valid when the manager is moved.
+    std::shared_ptr<std::atomic<uint64_t>> memoryPressure_{};
+    GpuAllocator::EvictionRegistration evictionRegistration_{};
+    // Filled by the defragmenter's callbacks during step(), consumed by stream(). Shared for the
+    // same reason as memoryPressure_.
+    std::shared_ptr<std::vector<Relocated>> relocated_{};
+};
@@ -0,0 +1,96 @@
+// TlsfAllocator.h
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+// Two-level segregated fit over an abstract [0, capacity) range; knows nothing about Vulkan so
+// GpuAllocator can keep one per VkDeviceMemory block. Free ranges are bucketed by size class:
+// the first level is the size's most significant bit, the second splits each power of two into
+// kSecondLevelCount linear steps. Two bitmaps find the smallest non-empty bucket that is
+// guaranteed to fit, and physical neighbour links coalesce on free, so allocate() and free()
+// are O(1) whatever the number of live allocations. The price is a good fit rather than a best
+// fit: a request is served from the first bucket whose every range fits, so a range in a smaller
+// bucket that would have fitted stays free, and a trace can commit more blocks than first-fit.
+class TlsfAllocator {
+public:
+    static constexpr uint32_t kInvalidNode = UINT32_MAX;
+
+    struct Allocation {
+        uint64_t offset{ 0 };
+        uint64_t size{ 0 };
+        // Handle for free(); stable for the allocation's lifetime.
+        uint32_t node{ kInvalidNode };
+    };
+
+    TlsfAllocator() noexcept = default;
+    explicit TlsfAllocator(uint64_t capacity);
+
+    TlsfAllocator(const TlsfAllocator&) = delete;
+    TlsfAllocator& operator=(const TlsfAllocator&) = delete;
+
+    TlsfAllocator(TlsfAllocator&&) noexcept = default;
+    TlsfAllocator& operator=(TlsfAllocator&&) noexcept = default;
+
+    ~TlsfAllocator() = default;
+
+    // alignment must be a power of two (or 0/1 for none). Returns nullopt when neither the first
+    // range of the size's own bucket fits at its real offset nor any range fits the size plus
+    // worst-case alignment padding, even if some other range would fit at its real offset.
+    [[nodiscard]] std::optional<Allocation> allocate(uint64_t size, uint64_t alignment);
+    void free(uint32_t node) noexcept;
+
+    [[nodiscard]] uint64_t capacity() const noexcept { return capacity_; }
+    [[nodiscard]] uint64_t freeBytes() const noexcept { return freeBytes_; }
+    [[nodiscard]] uint32_t freeRangeCount() const noexcept { return freeRangeCount_; }
+    [[nodiscard]] uint32_t allocationCount() const noexcept { return allocationCount_; }
+    [[nodiscard]] bool empty() const noexcept { return allocationCount_ == 0; }
+    // Walks only the highest non-empty bucket, so it is cheap but not constant time.
+    [[nodiscard]] uint64_t largestFreeRange() const noexcept;
+
+private:
+    static constexpr uint32_t kSecondLevelLog2 = 5;
+    static constexpr uint32_t kSecondLevelCount = 1u << kSecondLevelLog2;
+    // Sizes below this share first level 0, split into kSecondLevelCount one-byte buckets.
+    static constexpr uint64_t kSmallSize = kSecondLevelCount;
+    static constexpr uint32_t kFirstLevelCount = 64 - kSecondLevelLog2 + 1;
+
+    struct Node {
+        uint64_t offset{ 0 };
+        uint64_t size{ 0 };
+        uint32_t prevPhysical{ kInvalidNode };
+        uint32_t nextPhysical{ kInvalidNode };
+        uint32_t prevFree{ kInvalidNode };
+        uint32_t nextFree{ kInvalidNode };
+        bool free{ false };
+    };
+
+    struct Bucket {
+        uint32_t firstLevel{ 0 };
+        uint32_t secondLevel{ 0 };
+    };
+
+    [[nodiscard]] static Bucket bucketFor(uint64_t size) noexcept;
+    // Rounds size up to the next bucket boundary so any range in the result fits it.
+    [[nodiscard]] static Bucket searchBucketFor(uint64_t size) noexcept;
+
+    [[nodiscard]] uint32_t findFreeNode(uint64_t size) const noexcept;
+    void insertFree(uint32_t node) noexcept;
+    void removeFree(uint32_t node) noexcept;
+    [[nodiscard]] uint32_t acquireNode();
+    void releaseNode(uint32_t node) noexcept;
+
+    uint64_t capacity_{ 0 };
+    uint64_t freeBytes_{ 0 };
+    uint32_t freeRangeCount_{ 0 };
+    uint32_t allocationCount_{ 0 };
+
+    uint64_t firstLevelBitmap_{ 0 };
+    std::array<uint32_t, kFirstLevelCount> secondLevelBitmaps_{};
+    std::array<std::array<uint32_t, kSecondLevelCount>, kFirstLevelCount> freeHeads_{};
+
+    std::vector<Node> nodes_{};
+    std::vector<uint32_t> unusedNodes_{};
+};
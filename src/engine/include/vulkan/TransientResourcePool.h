@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+// parasoft-begin-suppress ALL "suppress all violations"
+#include <vulkan/vulkan.h>
+// parasoft-end-suppress ALL "suppress all violations"
+
+#include "GpuAllocator.h"
+#include "RenderGraph.h"
+#include "VkUtils.h"
+
+// Backs a RenderTaskGraph's transient resources with aliased memory. realize() takes the graph's
+// transient plan, creates one image or buffer per alias slot (the resources the plan already lets
+// share an object) and places the slots in a few shared heaps, where slots that are never live at
+// the same time overlap. The objects go back to the graph together with the resources whose
+// memory each one reuses, from which the graph derives the aliasing barriers and orders every
+// user of the old occupant before every user of the new one.
+//
+// The placement is cached under RenderTaskGraph::transientShapeKey(), so a graph rebuilt every
+// frame with the same shape is only rebound. Each frame slot owns its own objects and heaps, as
+// the previous frame may still be using its set; a slot's set is rebuilt on its first realize()
+// after a shape change, once the frame's fence wait has made the old one idle.
+//
+// Buffers and images never share a heap, so nothing needs padding to bufferImageGranularity.
+// Heaps are dedicated allocations from GpuAllocator's Transient pool.
+//
+// Not thread-safe: realize() runs on the render thread, after the frame slot's fence wait and
+// before RenderTaskGraph::execute(). Destroy the pool only once the device is idle.
+class TransientResourcePool {
+public:
+    struct Config {
+        GpuAllocator* allocator{ nullptr };
+        uint32_t framesInFlight{ 0 };
+    };
+
+    struct Stats {
+        uint32_t resources{ 0 };
+        // One per alias slot.
+        uint32_t objects{ 0 };
+        uint32_t heaps{ 0 };
+        // Per frame slot: what the heaps take, and what the objects would take apart.
+        VkDeviceSize heapBytes{ 0 };
+        VkDeviceSize objectBytes{ 0 };
+        uint64_t placements{ 0 };
+        uint64_t frameBuilds{ 0 };
+        // realize() calls that only rebound an existing set.
+        uint64_t reuses{ 0 };
+    };
+
+    TransientResourcePool() noexcept = default;
+    explicit TransientResourcePool(const Config& config);
+
+    TransientResourcePool(const TransientResourcePool&) = delete;
+    TransientResourcePool& operator=(const TransientResourcePool&) = delete;
+
+    // Bindings handed to graphs point into the frame sets.
+    TransientResourcePool(TransientResourcePool&&) = delete;
+    TransientResourcePool& operator=(TransientResourcePool&&) = delete;
+
+    ~TransientResourcePool() noexcept;
+
+    [[nodiscard]] bool valid() const noexcept { return allocator_ != nullptr; }
+
+    // Binds every transient resource of graph to the objects of frameSlot (< framesInFlight).
+    [[nodiscard]] vkutil::VkExpected<void> realize(RenderTaskGraph& graph, uint32_t frameSlot);
+
+    [[nodiscard]] const Stats& stats() const noexcept { return stats_; }
+
+private:
+    struct Placement {
+        uint32_t heap{ 0 };
+        VkDeviceSize offset{ 0 };
+        VkDeviceSize size{ 0 };
+    };
+
+    struct HeapLayout {
+        RenderTaskGraph::ResourceType type{ RenderTaskGraph::ResourceType::Global };
+        uint32_t memoryTypeBits{ 0 };
+        VkDeviceSize size{ 0 };
+        VkDeviceSize alignment{ 1 };
+    };
+
+    struct Layout {
+        uint64_t shapeKey{ 0 };
+        RenderTaskGraph::CompiledTransientPlan plan{};
+        // Filled by the first frame set built for this shape, indexed like plan.aliasAllocations.
+        std::vector<Placement> placements{};
+        std::vector<HeapLayout> heaps{};
+        // Handles left null; each frame set fills in its own.
+        std::vector<RenderTaskGraph::TransientBinding> bindings{};
+        bool placed{ false };
+    };
+
+    struct Object {
+        VkImage image{ VK_NULL_HANDLE };
+        VkBuffer buffer{ VK_NULL_HANDLE };
+    };
+
+    struct FrameSet {
+        uint64_t shapeKey{ 0 };
+        bool built{ false };
+        std::vector<Object> objects{};
+        std::vector<GpuAllocator::Allocation> heaps{};
+        std::vector<RenderTaskGraph::TransientBinding> bindings{};
+    };
+
+    [[nodiscard]] static bool lifetimesOverlap(const RenderTaskGraph::TransientAliasAllocation& lhs,
+        const RenderTaskGraph::TransientAliasAllocation& rhs) noexcept;
+
+    void build(FrameSet& frame);
+    void place(const std::vector<VkMemoryRequirements>& requirements);
+    void destroy(FrameSet& frame) noexcept;
+
+    GpuAllocator* allocator_{ nullptr };
+    VkDevice device_{ VK_NULL_HANDLE };
+    std::vector<FrameSet> frames_{};
+    std::optional<Layout> layout_{};
+    Stats stats_{};
+};
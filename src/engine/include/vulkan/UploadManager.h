@@ -0,0 +1,173 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+// parasoft-begin-suppress ALL "suppress all violations"
+#include <vulkan/vulkan.h>
+// parasoft-end-suppress ALL "suppress all violations"
+
+#include "GpuAllocator.h"
+#include "VkBuffer.h"
+#include "VkCommands.h"
+#include "VkCore.h"
+#include "VkSync.h"
+
+// Streams CPU data into device-local buffers and images through one persistently mapped staging
+// ring. uploadBuffer() and uploadImage() copy the bytes into the ring at once and queue the copy;
+// flush() records everything queued since the last flush into a single transfer-queue submission
+// with one vkCmdCopyBuffer per destination buffer (adjacent ranges merged into one region) and
+// one vkCmdCopyBufferToImage per destination image, then signals the manager's timeline
+// semaphore. Ring space is reclaimed as the timeline passes each submission's value; when the
+// ring is full the open batch is submitted early and the caller waits for the oldest one.
+//
+// Every upload returns a Token naming the timeline value its batch signals. Consumers either poll
+// isReady() before touching the destination or wait on timeline() at token.value in their own
+// submission. A token stays pending until the batch it belongs to has been flushed.
+//
+// Queue family ownership is not transferred: destinations used on another family need
+// VK_SHARING_MODE_CONCURRENT including queueFamilyIndex(). Images are transitioned from UNDEFINED
+// over their whole range, so an image upload discards whatever the range held before.
+//
+// Not thread-safe: uploads and flush() run on the thread that submits to the transfer queue.
+class UploadManager {
+public:
+    struct Config {
+        VkDevice device{ VK_NULL_HANDLE };
+        GpuAllocator* allocator{ nullptr };
+        VulkanQueue queue{};
+        VkDeviceSize ringBytes{ 32ull * 1024ull * 1024ull };
+        // An open batch holding this many staged bytes is submitted without waiting for flush().
+        VkDeviceSize batchBytes{ 8ull * 1024ull * 1024ull };
+    };
+
+    struct Token {
+        // Timeline value signalled once the upload has landed; 0 is always ready.
+        uint64_t value{ 0 };
+    };
+
+    struct ImageRegion {
+        uint32_t mipLevel{ 0 };
+        uint32_t baseArrayLayer{ 0 };
+        uint32_t layerCount{ 1 };
+        VkOffset3D offset{};
+        VkExtent3D extent{};
+        // Tightly packed texels (or compressed blocks) of the region.
+        const void* data{ nullptr };
+        VkDeviceSize size{ 0 };
+    };
+
+    struct ImageTarget {
+        VkImage image{ VK_NULL_HANDLE };
+        VkImageSubresourceRange range{ VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+        // The transfer queue may not support the consuming stage, so the release barrier names no
+        // destination access; consumers order their reads with the timeline wait.
+        VkImageLayout finalLayout{ VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+    };
+
+    struct Stats {
+        uint64_t uploads{ 0 };
+        uint64_t uploadedBytes{ 0 };
+        uint64_t submissions{ 0 };
+        // vkCmdCopyBuffer / vkCmdCopyBufferToImage calls and the regions they carried.
+        uint64_t copyCommands{ 0 };
+        uint64_t copyRegions{ 0 };
+        // Buffer ranges folded into the previous region because both sides were contiguous.
+        uint64_t mergedRegions{ 0 };
+        // Times an upload had to wait for the GPU to free ring space.
+        uint64_t ringStalls{ 0 };
+        VkDeviceSize ringBytes{ 0 };
+        VkDeviceSize ringUsedBytes{ 0 };
+        VkDeviceSize peakRingUsedBytes{ 0 };
+        uint32_t inFlightSubmissions{ 0 };
+    };
+
+    explicit UploadManager(const Config& config);
+
+    UploadManager(const UploadManager&) = delete;
+    UploadManager& operator=(const UploadManager&) = delete;
+
+    // The ring and command pools are referenced by submissions in flight.
+    UploadManager(UploadManager&&) = delete;
+    UploadManager& operator=(UploadManager&&) = delete;
+
+    // Waits for every submission in flight.
+    ~UploadManager();
+
+    // Buffers larger than a quarter of the ring are split into several copies.
+    Token uploadBuffer(VkBuffer destination, VkDeviceSize destinationOffset, const void* data, VkDeviceSize size);
+    // All regions of one image go into the same batch; their total must fit in the ring.
+    Token uploadImage(const ImageTarget& target, std::span<const ImageRegion> regions);
+
+    // Submits the open batch, if any, and returns the token of the newest submission.
+    Token flush();
+    // Reclaims ring space and command buffers of finished submissions; cheap, call once per frame.
+    void collect();
+
+    [[nodiscard]] bool isReady(Token token);
+    void wait(Token token);
+    // Token of the batch the next upload joins.
+    [[nodiscard]] Token pendingToken() const noexcept { return Token{ submittedValue_ + 1 }; }
+
+    [[nodiscard]] VkSemaphore timeline() const noexcept { return timeline_.get(); }
+    [[nodiscard]] uint32_t queueFamilyIndex() const noexcept { return queue_.familyIndex(); }
+    [[nodiscard]] const Stats& stats() const noexcept { return stats_; }
+
+private:
+    struct BufferCopies {
+        VkBuffer buffer{ VK_NULL_HANDLE };
+        std::vector<VkBufferCopy> regions{};
+    };
+
+    struct ImageCopies {
+        ImageTarget target{};
+        std::vector<VkBufferImageCopy> regions{};
+    };
+
+    struct Commands {
+        VulkanCommandPool pool{};
+        VulkanCommandBuffer buffer{};
+    };
+
+    struct Submission {
+        uint64_t value{ 0 };
+        // Ring bytes the batch consumed, alignment padding and wrap-around included.
+        VkDeviceSize ringBytes{ 0 };
+        Commands commands{};
+    };
+
+    // Returns the ring offset of size bytes, submitting and waiting as needed.
+    [[nodiscard]] VkDeviceSize allocateRing(VkDeviceSize size, VkDeviceSize alignment);
+    [[nodiscard]] bool tryAllocateRing(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& offset) noexcept;
+    void waitOldest();
+    [[nodiscard]] uint64_t completedValue();
+    [[nodiscard]] Commands acquireCommands();
+    void recordBatch(VkCommandBuffer commandBuffer);
+    void submitBatch();
+    void maybeSubmit();
+
+    VkDevice device_{ VK_NULL_HANDLE };
+    VulkanQueue queue_{};
+    VkDeviceSize batchBytes_{ 0 };
+
+    TimelineSemaphore timeline_{};
+    VulkanBuffer ring_{};
+    uint8_t* ringData_{ nullptr };
+    VkDeviceSize ringHead_{ 0 };
+    VkDeviceSize ringUsed_{ 0 };
+
+    // The open batch.
+    std::vector<BufferCopies> bufferCopies_{};
+    std::unordered_map<VkBuffer, size_t> bufferIndex_{};
+    std::vector<ImageCopies> imageCopies_{};
+    VkDeviceSize batchRingBytes_{ 0 };
+
+    std::deque<Submission> inFlight_{};
+    std::vector<Commands> freeCommands_{};
+    uint64_t submittedValue_{ 0 };
+    uint64_t completedValue_{ 0 };
+    Stats stats_{};
+};
@@ -3,7 +3,6 @@
 #include <cstdint>
 #include <stdexcept>
 #include <vector>
-#include <memory>
 
 // parasoft-begin-suppress ALL "suppress all violations"
 #include <vulkan/vulkan.h>
@@ -24,23 +23,18 @@ public:
 
     VulkanBuffer() noexcept = default;
 
-    VulkanBuffer(VkDevice device,
-        VkPhysicalDevice physicalDevice,
-        VkDeviceSize size,
-        VkBufferUsageFlags usage,
-        VkMemoryPropertyFlags memoryProperties,
-        bool bufferDeviceAddressEnabled = false,
-        bool requiresDeviceAddress = false,
-        AllocationPolicy allocationPolicy = AllocationPolicy::Auto,
-        const std::vector<uint32_t>& queueFamilyIndices = {});
-
+    // allocator is the device-wide DeviceContext::allocator() and must outlive the buffer. The
+    // policy picks the GpuAllocator pool: Upload, Readback and Transient each get their own
+    // blocks, Auto and DeviceLocal share the general pool. priority decides what happens when the
+    // heap is over budget; Low buffers are refused with GpuAllocator::OutOfMemoryError.
     VulkanBuffer(GpuAllocator& allocator,
         VkDeviceSize size,
         VkBufferUsageFlags usage,
         VkMemoryPropertyFlags memoryProperties,
         bool requiresDeviceAddress = false,
         AllocationPolicy allocationPolicy = AllocationPolicy::Auto,
-        const std::vector<uint32_t>& queueFamilyIndices = {});
+        const std::vector<uint32_t>& queueFamilyIndices = {},
+        GpuAllocator::Priority priority = GpuAllocator::Priority::Normal);
 
     VulkanBuffer(const VulkanBuffer&) = delete;
     VulkanBuffer& operator=(const VulkanBuffer&) = delete;
@@ -59,7 +53,12 @@ public:
     [[nodiscard]] VkDevice        getDevice() const noexcept { return device; }
     [[nodiscard]] VkPhysicalDevice getPhysicalDevice() const noexcept { return physicalDevice; }
     [[nodiscard]] VkMemoryPropertyFlags memoryProperties() const noexcept { return memoryProps; }
+    [[nodiscard]] VkBufferUsageFlags usage() const noexcept { return usage_; }
+    [[nodiscard]] const GpuAllocator::Allocation& gpuAllocation() const noexcept { return allocation; }
 
+    // Host-visible memory is persistently mapped by the allocator, so map() and unmap() only open
+    // and close a CPU-access window (GpuDefragmenter does not move a buffer while it is open);
+    // neither calls into the driver.
     [[nodiscard]] vkutil::VkExpected<void*> mapResult(VkDeviceSize offset = 0, VkDeviceSize mapSize = VK_WHOLE_SIZE);
     [[nodiscard]] void* map(VkDeviceSize offset = 0, VkDeviceSize mapSize = VK_WHOLE_SIZE);
     void  unmap() noexcept;
@@ -75,6 +74,11 @@ public:
     [[nodiscard]] bool bufferDeviceAddressEnabled() const noexcept { return bufferDeviceAddressEnabled_; }
     [[nodiscard]] AllocationPolicy allocationPolicy() const noexcept { return allocationPolicy_; }
 
+    // A new, empty buffer with this one's size, usage, memory properties, policy, queue families
+    // and priority, placed by the allocator as a fresh buffer would be. usageExtra is ORed in, e.g.
+    // TRANSFER_DST for GpuDefragmenter's copy into it.
+    [[nodiscard]] VulkanBuffer makeRelocationTarget(VkBufferUsageFlags usageExtra = 0) const;
+
     void reset() noexcept;
 
 private:
@@ -83,8 +87,9 @@ private:
     VkBuffer              buffer{ VK_NULL_HANDLE };
     VkDeviceSize          size{ 0 };
     VkMemoryPropertyFlags memoryProps{ 0 };
+    VkBufferUsageFlags    usage_{ 0 };
+    std::vector<uint32_t> queueFamilyIndices_{};
 
-    std::unique_ptr<GpuAllocator> ownedAllocator{};
     GpuAllocator* allocator{ nullptr };
     GpuAllocator::Allocation allocation{};
 
@@ -92,16 +97,17 @@ private:
     VkDeviceSize mappedOffset{ 0 };
     VkDeviceSize mappedSize{ 0 };
 
-    VkDeviceSize nonCoherentAtomSize{ 1 };
     bool requiresDeviceAddress_{ false };
     bool bufferDeviceAddressEnabled_{ false };
     AllocationPolicy allocationPolicy_{ AllocationPolicy::Auto };
+    GpuAllocator::Priority priority_{ GpuAllocator::Priority::Normal };
 
     [[nodiscard]] static bool usageSupportsDeviceAddress(VkBufferUsageFlags usage) noexcept;
+    [[nodiscard]] static GpuAllocator::Pool poolForPolicy(AllocationPolicy policy) noexcept;
     void validateAllocationPolicy(VkMemoryPropertyFlags memoryProperties) const;
     void validateDeviceAddressRequirements(VkBufferUsageFlags usage) const;
 
-    [[nodiscard]] vkutil::VkExpected<VkMappedMemoryRange> prepareMappedRange(VkDeviceSize offset, VkDeviceSize size, const char* opName) const;
+    [[nodiscard]] vkutil::VkExpected<GpuAllocator::MappedRange> prepareMappedRange(VkDeviceSize offset, VkDeviceSize size, const char* opName) const;
     void createBuffer(VkDeviceSize size,
         VkBufferUsageFlags usage,
         VkMemoryPropertyFlags memoryProperties,
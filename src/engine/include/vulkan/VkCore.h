@@ -46,6 +46,8 @@ struct DeviceFeaturePolicy {
     Requirement synchronization2{ Requirement::Optional };
     Requirement descriptorIndexing{ Requirement::Optional };
     Requirement bufferDeviceAddress{ Requirement::Optional };
+    // Core VkPhysicalDeviceFeatures::multiDrawIndirect: drawCount > 1 in indirect draws.
+    Requirement multiDrawIndirect{ Requirement::Optional };
 
     std::vector<const char*> requiredExtensions{};
     std::vector<const char*> optionalExtensions{};
@@ -82,12 +84,14 @@ struct VulkanDeviceCapabilities {
     bool synchronization2Supported = false;
     bool descriptorIndexingSupported = false;
     bool bufferDeviceAddressSupported = false;
+    bool multiDrawIndirectSupported = false;
 
     bool timelineSemaphoreEnabled = false;
     bool dynamicRenderingEnabled = false;
     bool synchronization2Enabled = false;
     bool descriptorIndexingEnabled = false;
     bool bufferDeviceAddressEnabled = false;
+    bool multiDrawIndirectEnabled = false;
 
     VkPhysicalDeviceFeatures2 enabledFeatures2{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2 };
     VkPhysicalDeviceTimelineSemaphoreFeatures timelineFeatures{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES };
@@ -22,27 +22,20 @@ class VulkanImage {
 public:
     VulkanImage() = default;
 
-    VulkanImage(VkDevice device,
-        VkPhysicalDevice physicalDevice,
-        const VkImageCreateInfo& createInfo,
-        VkMemoryPropertyFlags memoryProps = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-        GpuAllocator::LifetimeClass lifetimeClass = GpuAllocator::LifetimeClass::Persistent);
-
+    // allocator is the device-wide DeviceContext::allocator() and must outlive the image.
+    // Transient images go to the allocator's Transient pool, the rest to General. Low priority
+    // images are refused with GpuAllocator::OutOfMemoryError when their heap is over budget.
     VulkanImage(GpuAllocator& allocator,
         const VkImageCreateInfo& createInfo,
         VkMemoryPropertyFlags memoryProps = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-        GpuAllocator::LifetimeClass lifetimeClass = GpuAllocator::LifetimeClass::Persistent);
-
-    [[nodiscard]] static vkutil::VkExpected<VulkanImage> createResult(VkDevice device,
-        VkPhysicalDevice physicalDevice,
-        const VkImageCreateInfo& createInfo,
-        VkMemoryPropertyFlags memoryProps = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-        GpuAllocator::LifetimeClass lifetimeClass = GpuAllocator::LifetimeClass::Persistent);
+        GpuAllocator::LifetimeClass lifetimeClass = GpuAllocator::LifetimeClass::Persistent,
+        GpuAllocator::Priority priority = GpuAllocator::Priority::Normal);
 
     [[nodiscard]] static vkutil::VkExpected<VulkanImage> createResult(GpuAllocator& allocator,
         const VkImageCreateInfo& createInfo,
         VkMemoryPropertyFlags memoryProps = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-        GpuAllocator::LifetimeClass lifetimeClass = GpuAllocator::LifetimeClass::Persistent);
+        GpuAllocator::LifetimeClass lifetimeClass = GpuAllocator::LifetimeClass::Persistent,
+        GpuAllocator::Priority priority = GpuAllocator::Priority::Normal);
 
     VulkanImage(const VulkanImage&) = delete;
     VulkanImage& operator=(const VulkanImage&) = delete;
@@ -55,6 +48,15 @@ public:
     [[nodiscard]] VkImage        get()       const noexcept { return image; }
     [[nodiscard]] VkDeviceMemory getMemory() const noexcept { return memory; }
     [[nodiscard]] bool           valid()     const noexcept { return image != VK_NULL_HANDLE; }
+    [[nodiscard]] const GpuAllocator::Allocation& gpuAllocation() const noexcept { return allocation; }
+    // As passed to the constructor, minus pNext; pQueueFamilyIndices points at this image's copy.
+    [[nodiscard]] const VkImageCreateInfo& createInfo() const noexcept { return createInfo_; }
+
+    // A new, uninitialised image with this one's create info, memory properties, lifetime class
+    // and priority, placed by the allocator as a fresh image would be. usageExtra is ORed in, e.g.
+    // TRANSFER_DST for GpuDefragmenter's copy into it. Extension structs chained to the original
+    // create info are not carried over.
+    [[nodiscard]] VulkanImage makeRelocationTarget(VkImageUsageFlags usageExtra = 0) const;
 
 private:
     VkDevice              device{ VK_NULL_HANDLE };
@@ -63,8 +65,11 @@ private:
     VkDeviceMemory        memory{ VK_NULL_HANDLE };
     VkMemoryPropertyFlags desiredProps{};
     GpuAllocator::LifetimeClass lifetimeClass_{ GpuAllocator::LifetimeClass::Persistent };
+    GpuAllocator::Priority priority_{ GpuAllocator::Priority::Normal };
+    VkImageTiling tiling_{ VK_IMAGE_TILING_OPTIMAL };
+    VkImageCreateInfo createInfo_{ VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO };
+    std::vector<uint32_t> queueFamilyIndices_{};
 
-    std::unique_ptr<GpuAllocator> ownedAllocator{};
     GpuAllocator* allocator{ nullptr };
     GpuAllocator::Allocation allocation{};
 
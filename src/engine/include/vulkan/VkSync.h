@@ -124,6 +124,8 @@ struct SyncSubmitInfo {
     std::vector<SyncDependencyClass> externalWaitDependencies;
     std::vector<VkCommandBuffer> commandBuffers;
     std::vector<VkSemaphore> externalSignalSemaphores;
+    // Empty when every external signal semaphore is binary, else one value each (0 for binary).
+    std::vector<uint64_t> externalSignalValues;
     const char* debugLabel{ nullptr };
     VkPipelineStageFlags2 timelineWaitStageMask{ 0 };
     VkPipelineStageFlags2 timelineSignalStageMask{ 0 };
@@ -1,9 +1,18 @@
 #include <Engine.h>
 
+#include <vulkan/ClusterCulling.h>
 #include <vulkan/DeviceContext.h>
+#include <vulkan/FrameLinearAllocator.h>
+#include <vulkan/GpuDefragmenter.h>
+#include <vulkan/ReadbackService.h>
 #include <vulkan/RenderGraph.h>
+#include <vulkan/ShaderReloader.h>
+#include <vulkan/SkinningPass.h>
 #include <vulkan/SubmissionScheduler.h>
 #include <vulkan/SwapchainResources.h>
+#include <vulkan/TextureManager.h>
+#include <vulkan/TransientResourcePool.h>
+#include <vulkan/UploadManager.h>
 #include <vulkan/VkCommands.h>
 #include <vulkan/VkBuffer.h>
 #include <vulkan/VkPipeline.h>
@@ -28,6 +37,7 @@
 #include <iostream>
 #include <mutex>
 #include <optional>
+#include <span>
 #include <stdexcept>
 #include <string>
 #include <thread>
@@ -249,8 +259,36 @@ const char* resolveFragmentShaderPath(const Engine::RunConfig& config)
 #endif
 }
 
-void validateFrameGraphInput(const FrameGraphInput& frameGraphInput)
+bool isCompactVertexFormat(VertexFormat format) noexcept
 {
+    return format != VertexFormat::Float32;
+}
+
+size_t vertexStride(VertexFormat format) noexcept
+{
+    return isCompactVertexFormat(format) ? sizeof(CompactVertexPacket) : sizeof(VertexPacket);
+}
+
+size_t activeVertexCount(const FrameGraphInput& frameGraphInput) noexcept
+{
+    return isCompactVertexFormat(frameGraphInput.vertexFormat)
+        ? frameGraphInput.compactVertexPackets.size()
+        : frameGraphInput.vertexPackets.size();
+}
+
+const void* activeVertexData(const FrameGraphInput& frameGraphInput) noexcept
+{
+    return isCompactVertexFormat(frameGraphInput.vertexFormat)
+        ? static_cast<const void*>(frameGraphInput.compactVertexPackets.data())
+        : static_cast<const void*>(frameGraphInput.vertexPackets.data());
+}
+
+void validateFrameGraphInput(const FrameGraphInput& frameGraphInput, VertexFormat pipelineVertexFormat)
+{
+    if (frameGraphInput.vertexFormat != pipelineVertexFormat) {
+        throw std::runtime_error("FrameGraphInput vertexFormat does not match RunConfig.vertexFormat");
+    }
+
     std::unordered_set<uint32_t> viewIds{};
     viewIds.reserve(frameGraphInput.views.size());
     for (const RenderViewPacket& view : frameGraphInput.views) {
@@ -271,6 +309,22 @@ void validateFrameGraphInput(const FrameGraphInput& frameGraphInput)
         }
     }
 
+    uint64_t skinnedVertexCount = 0;
+    for (const SkinningPacket& skin : frameGraphInput.skinning) {
+        const uint64_t vertexEnd = static_cast<uint64_t>(skin.firstVertex) + static_cast<uint64_t>(skin.vertexCount);
+        if (vertexEnd > activeVertexCount(frameGraphInput)) {
+            throw std::runtime_error("SkinningPacket vertex range exceeds active vertex stream size");
+        }
+        const uint64_t skinEnd = static_cast<uint64_t>(skin.firstSkinVertex) + static_cast<uint64_t>(skin.vertexCount);
+        if (skinEnd > frameGraphInput.skinVertices.size()) {
+            throw std::runtime_error("SkinningPacket skin range exceeds skinVertices size");
+        }
+        if (skin.firstJoint >= frameGraphInput.jointMatrices.size()) {
+            throw std::runtime_error("SkinningPacket joint palette exceeds jointMatrices size");
+        }
+        skinnedVertexCount = std::max(skinnedVertexCount, static_cast<uint64_t>(skin.outputFirstVertex) + skin.vertexCount);
+    }
+
     for (const DrawPacket& draw : frameGraphInput.drawPackets) {
         if (!viewIds.empty() && !viewIds.contains(draw.viewId)) {
             throw std::runtime_error("DrawPacket references unknown viewId");
@@ -279,8 +333,19 @@ void validateFrameGraphInput(const FrameGraphInput& frameGraphInput)
             throw std::runtime_error("DrawPacket references unknown materialId");
         }
         const uint64_t vertexEnd = static_cast<uint64_t>(draw.firstVertex) + static_cast<uint64_t>(draw.vertexCount);
-        if (vertexEnd > frameGraphInput.vertexPackets.size()) {
-            throw std::runtime_error("DrawPacket vertex range exceeds vertexPackets size");
+        if (draw.skinned ? vertexEnd > skinnedVertexCount : vertexEnd > activeVertexCount(frameGraphInput)) {
+            throw std::runtime_error("DrawPacket vertex range exceeds active vertex stream size");
+        }
+        if (draw.skinned && draw.meshletCount != 0) {
+            throw std::runtime_error("Skinned DrawPacket cannot use cluster culling");
+        }
+        const uint64_t indexEnd = static_cast<uint64_t>(draw.firstIndex) + static_cast<uint64_t>(draw.indexCount);
+        if (draw.indexCount != 0 && indexEnd > frameGraphInput.indices.size()) {
+            throw std::runtime_error("DrawPacket index range exceeds indices size");
+        }
+        const uint64_t meshletEnd = static_cast<uint64_t>(draw.firstMeshlet) + static_cast<uint64_t>(draw.meshletCount);
+        if (draw.meshletCount != 0 && meshletEnd > frameGraphInput.meshlets.size()) {
+            throw std::runtime_error("DrawPacket meshlet range exceeds meshlets size");
         }
     }
 }
@@ -414,7 +479,11 @@ struct RenderSubsystem {
         VkCommandBuffer secondary,
         VkPipeline pipeline,
         VkPipelineLayout pipelineLayout,
-        VkBuffer vertexBuffer,
+        const FrameLinearAllocator::Slice& vertexStream,
+        VkBuffer skinnedVertexBuffer,
+        const FrameLinearAllocator::Slice& indexStream,
+        const ClusterCullPass* clusterCull,
+        const TextureManager& textures,
         VkExtent2D extent,
         const std::vector<DrawPacket>& drawPackets,
         size_t beginIndex,
@@ -432,12 +501,40 @@ struct RenderSubsystem {
         vkCmdSetScissor(secondary, 0, 1, &scissor);
 
         vkCmdBindPipeline(secondary, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
-        const VkDeviceSize vertexOffset = 0;
-        vkCmdBindVertexBuffers(secondary, 0, 1, &vertexBuffer, &vertexOffset);
+        vkCmdBindVertexBuffers(secondary, 0, 1, &vertexStream.buffer, &vertexStream.offset);
+        const bool indexed = indexStream.valid();
+        if (indexed) {
+            vkCmdBindIndexBuffer(secondary, indexStream.buffer, indexStream.offset, VK_INDEX_TYPE_UINT32);
+        }
+        bool boundSkinned = false;
+        VkDescriptorSet boundTextureSet = VK_NULL_HANDLE;
         for (size_t i = beginIndex; i < endIndex; ++i) {
             const DrawPacket& draw = drawPackets[i];
+            if (draw.skinned != boundSkinned) {
+                const VkDeviceSize skinnedOffset = 0;
+                if (draw.skinned && skinnedVertexBuffer != VK_NULL_HANDLE) {
+                    vkCmdBindVertexBuffers(secondary, 0, 1, &skinnedVertexBuffer, &skinnedOffset);
+                }
+                else {
+                    vkCmdBindVertexBuffers(secondary, 0, 1, &vertexStream.buffer, &vertexStream.offset);
+                }
+                boundSkinned = draw.skinned;
+            }
+            const VkDescriptorSet textureSet = textures.descriptorSet(draw.textureId);
+            if (textureSet != boundTextureSet) {
+                vkCmdBindDescriptorSets(secondary, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &textureSet, 0, nullptr);
+                boundTextureSet = textureSet;
+            }
             vkCmdPushConstants(secondary, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(draw.mvp), draw.mvp.data());
-            vkCmdDraw(secondary, draw.vertexCount, 1, draw.firstVertex, 0);
+            if (clusterCull != nullptr && indexed && clusterCull->culls(i)) {
+                clusterCull->drawIndirect(secondary, i);
+            }
+            else if (draw.indexCount != 0 && indexed) {
+                vkCmdDrawIndexed(secondary, draw.indexCount, 1, draw.firstIndex, static_cast<int32_t>(draw.firstVertex), 0);
+            }
+            else {
+                vkCmdDraw(secondary, draw.vertexCount, 1, draw.firstVertex, 0);
+            }
         }
     }
 
@@ -573,6 +670,10 @@ private:
     void runMainLoop(IGameSimulation& game)
     {
         DeviceContext deviceContext(window_, config_.enableValidation);
+        if (config_.allocationTracePath != nullptr) {
+            // Stays open until the allocator goes, so the frees of the teardown below are included.
+            deviceContext.allocator().startTrace(config_.allocationTracePath);
+        }
         SwapchainResources swapchain{};
         swapchain.init(deviceContext, config_.windowWidth, config_.windowHeight);
 
@@ -615,9 +716,38 @@ private:
 
         ImGui_ImplVulkan_CreateFontsTexture();
 
+        // Textures are the long-lived relocatable resources; the vertex and index streams are
+        // rewritten every frame and live in frame memory instead. Declared before the texture
+        // manager so its image registrations are dropped first.
+        GpuDefragmenter defragmenter(GpuDefragmenter::Config{
+            .allocator = &deviceContext.allocator(),
+            .framesInFlight = kFramesInFlight });
+
+        UploadManager uploads(UploadManager::Config{
+            .device = deviceContext.vkDevice(),
+            .allocator = &deviceContext.allocator(),
+            .queue = deviceContext.transferQueue() });
+
+        TextureManager textureManager(TextureManager::Config{
+            .device = deviceContext.vkDevice(),
+            .allocator = &deviceContext.allocator(),
+            .queue = deviceContext.graphicsQueue(),
+            .uploads = &uploads,
+            .maxAnisotropy = deviceContext.samplerAnisotropyEnabled ? deviceContext.maxSamplerAnisotropy : 1.0F,
+            .budgetBytes = config_.textureBudgetBytes,
+            .framesInFlight = kFramesInFlight,
+            .defragmenter = &defragmenter });
+        textureManager.upload(game.loadTextureAssets());
+        if (textureManager.stats().textureCount > 0) {
+            const TextureManager::Stats& textureStats = textureManager.stats();
+            std::cout << "[Textures] " << textureStats.textureCount << " loaded, "
+                      << (textureStats.deviceBytes / 1024) << " KiB (" << (textureStats.rgba8Bytes / 1024)
+                      << " KiB as RGBA8), " << textureStats.samplerCount << " sampler(s)\n";
+        }
+
         VulkanPipelineLayout pipelineLayout(
             deviceContext.vkDevice(),
-            {},
+            { textureManager.setLayout() },
             { VkPushConstantRange{ VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(std::array<float, 16>) } });
 
         const std::vector<char> vertShaderCode = loadShaderCode(resolveVertexShaderPath(config_));
@@ -640,12 +770,25 @@ private:
 
         VkVertexInputBindingDescription vertexBinding{};
         vertexBinding.binding = 0;
-        vertexBinding.stride = sizeof(VertexPacket);
+        vertexBinding.stride = static_cast<uint32_t>(vertexStride(config_.vertexFormat));
         vertexBinding.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
 
-        std::array<VkVertexInputAttributeDescription, 2> vertexAttributes{};
-        vertexAttributes[0] = VkVertexInputAttributeDescription{ .location = 0, .binding = 0, .format = VK_FORMAT_R32G32B32_SFLOAT, .offset = offsetof(VertexPacket, position) };
-        vertexAttributes[1] = VkVertexInputAttributeDescription{ .location = 1, .binding = 0, .format = VK_FORMAT_R32G32B32_SFLOAT, .offset = offsetof(VertexPacket, color) };
+        std::vector<VkVertexInputAttributeDescription> vertexAttributes{};
+        if (isCompactVertexFormat(config_.vertexFormat)) {
+            // Position is fetched as a 4-component format because 3x16-bit formats are rarely
+            // supported for vertex input; the fourth lane overlaps the normal bytes and is unused.
+            const VkFormat positionFormat = config_.vertexFormat == VertexFormat::CompactHalf
+                ? VK_FORMAT_R16G16B16A16_SFLOAT
+                : VK_FORMAT_R16G16B16A16_SNORM;
+            vertexAttributes.push_back(VkVertexInputAttributeDescription{ .location = 0, .binding = 0, .format = positionFormat, .offset = offsetof(CompactVertexPacket, position) });
+            vertexAttributes.push_back(VkVertexInputAttributeDescription{ .location = 1, .binding = 0, .format = VK_FORMAT_R8G8B8A8_UNORM, .offset = offsetof(CompactVertexPacket, color) });
+            vertexAttributes.push_back(VkVertexInputAttributeDescription{ .location = 2, .binding = 0, .format = VK_FORMAT_R8G8_SNORM, .offset = offsetof(CompactVertexPacket, normal) });
+            vertexAttributes.push_back(VkVertexInputAttributeDescription{ .location = 3, .binding = 0, .format = VK_FORMAT_R16G16_SFLOAT, .offset = offsetof(CompactVertexPacket, uv) });
+        }
+        else {
+            vertexAttributes.push_back(VkVertexInputAttributeDescription{ .location = 0, .binding = 0, .format = VK_FORMAT_R32G32B32_SFLOAT, .offset = offsetof(VertexPacket, position) });
+            vertexAttributes.push_back(VkVertexInputAttributeDescription{ .location = 1, .binding = 0, .format = VK_FORMAT_R32G32B32_SFLOAT, .offset = offsetof(VertexPacket, color) });
+        }
 
         VkPipelineVertexInputStateCreateInfo vertexInput{};
         vertexInput.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
@@ -757,12 +900,59 @@ private:
         std::vector<VulkanSemaphore> presentFinishedByImage =
             createPerImagePresentSemaphores(deviceContext.vkDevice(), swapchain.imageCount());
 
-        VulkanBuffer vertexBuffer(
-            deviceContext.vkDevice(),
-            deviceContext.vkPhysical(),
-            static_cast<VkDeviceSize>(sizeof(VertexPacket) * 100000),
-            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        ClusterCullPass clusterCull{};
+        if (config_.clusterCullShaderPath != nullptr && config_.clusterCullShaderPath[0] != '\0') {
+            clusterCull = ClusterCullPass(ClusterCullPass::Config{
+                .device = deviceContext.vkDevice(),
+                .allocator = &deviceContext.allocator(),
+                .shaderCode = loadShaderCode(config_.clusterCullShaderPath),
+                .framesInFlight = kFramesInFlight,
+                .multiDrawIndirect = deviceContext.deviceCapabilities().enabledFeatures2.features.multiDrawIndirect == VK_TRUE,
+                .maxDrawIndirectCount = deviceContext.physicalProperties.limits.maxDrawIndirectCount });
+        }
+
+        SkinningPass skinning{};
+        if (config_.skinningShaderPath != nullptr && config_.skinningShaderPath[0] != '\0') {
+            skinning = SkinningPass(SkinningPass::Config{
+                .device = deviceContext.vkDevice(),
+                .allocator = &deviceContext.allocator(),
+                .shaderCode = loadShaderCode(config_.skinningShaderPath),
+                .vertexFormat = config_.vertexFormat,
+                .framesInFlight = kFramesInFlight });
+        }
+
+        FrameLinearAllocator frameMemory(FrameLinearAllocator::Config{
+            .allocator = &deviceContext.allocator(),
+            .framesInFlight = kFramesInFlight });
+
+        // Transient graph resources share aliased heaps, one set per frame in flight.
+        TransientResourcePool transientResources(TransientResourcePool::Config{
+            .allocator = &deviceContext.allocator(),
+            .framesInFlight = kFramesInFlight });
+
+        // Per-draw meshlet survivor counts come back through the readback ring, a few frames late.
+        uint64_t visibleMeshletsRead = 0;
+        uint64_t cullCounterReadbacks = 0;
+        ReadbackService readbacks(ReadbackService::Config{
+            .device = deviceContext.vkDevice(),
+            .allocator = &deviceContext.allocator(),
+            .queueFamilyIndex = deviceContext.graphicsFamilyIndex(),
+            .framesInFlight = kFramesInFlight,
+            .frameBytes = 64ull * 1024ull });
+
+        const std::string vertexShaderPath = resolveVertexShaderPath(config_);
+        const std::string fragmentShaderPath = resolveFragmentShaderPath(config_);
+        ShaderReloader shaderReloader{};
+        if (config_.shaderSourceDir != nullptr && config_.shaderCompilerPath != nullptr) {
+            std::vector<std::string> servedShaders{ vertexShaderPath, fragmentShaderPath };
+            if (clusterCull.valid()) {
+                servedShaders.emplace_back(config_.clusterCullShaderPath);
+            }
+            if (skinning.valid()) {
+                servedShaders.emplace_back(config_.skinningShaderPath);
+            }
+            shaderReloader = ShaderReloader(config_.shaderSourceDir, config_.shaderCompilerPath, servedShaders);
+        }
 
         uint32_t frameIndex = 0;
         auto previousTick = std::chrono::steady_clock::now();
@@ -786,20 +976,52 @@ private:
             ImGui::Render();
 
             const FrameGraphInput frameGraphInput = game.buildFrameGraphInput();
-            validateFrameGraphInput(frameGraphInput);
-
-            if (!frameGraphInput.vertexPackets.empty()) {
-                const VkDeviceSize uploadSize = static_cast<VkDeviceSize>(frameGraphInput.vertexPackets.size() * sizeof(VertexPacket));
-                if (uploadSize > vertexBuffer.getSize()) {
-                    throw std::runtime_error("Vertex packet stream exceeds fixed GPU buffer capacity");
-                }
-                std::memcpy(vertexBuffer.map(0, uploadSize), frameGraphInput.vertexPackets.data(), static_cast<size_t>(uploadSize));
-                vertexBuffer.unmap();
+            validateFrameGraphInput(frameGraphInput, config_.vertexFormat);
+            if (!frameGraphInput.skinning.empty() && !skinning.valid()) {
+                throw std::runtime_error("FrameGraphInput contains skinning packets but RunConfig.skinningShaderPath is unset");
             }
 
             const uint32_t frameSlot = frameIndex % kFramesInFlight;
             FrameData& frame = frames[frameSlot];
             ensure(frame.inFlight.waitResult(), "frameFence.wait");
+            // Before streaming, so texture eviction sees this frame's memory pressure.
+            deviceContext.allocator().refreshBudget();
+            uploads.collect();
+            readbacks.collect();
+
+            {
+                VkExtent2D extent{};
+                swapchain.extent(extent);
+                textureManager.stream(frameIndex, frameGraphInput.drawPackets, extent.height);
+            }
+
+            // Only pipelines built from a recompiled module are replaced; the old ones are
+            // deferred-deleted, so frames still in flight keep using them.
+            for (const ShaderReloader::Compiled& shader : shaderReloader.poll()) {
+                try {
+                    if (shader.spvPath == vertexShaderPath || shader.spvPath == fragmentShaderPath) {
+                        const bool vertex = shader.spvPath == vertexShaderPath;
+                        VulkanShaderModule module(deviceContext.vkDevice(), shader.code);
+                        VkPipelineShaderStageCreateInfo vertexReload = vertexStage;
+                        VkPipelineShaderStageCreateInfo fragmentReload = fragmentStage;
+                        (vertex ? vertexReload : fragmentReload).module = module.get();
+                        pipeline = VulkanPipeline(deviceContext.vkDevice(), { vertexReload, fragmentReload }, pipelineCi, buildInfo);
+                        vertexStage = vertexReload;
+                        fragmentStage = fragmentReload;
+                        (vertex ? vertShader : fragShader) = std::move(module);
+                    }
+                    else if (skinning.valid() && shader.spvPath == config_.skinningShaderPath) {
+                        skinning.reloadShader(deviceContext.vkDevice(), shader.code);
+                    }
+                    else {
+                        clusterCull.reloadShader(deviceContext.vkDevice(), shader.code);
+                    }
+                    std::cout << "[Shaders] reloaded " << shader.spvPath << '\n';
+                }
+                catch (const std::exception& e) {
+                    std::cerr << "[Shaders] " << shader.spvPath << ": " << e.what() << '\n';
+                }
+            }
 
             const auto transferToken = transferArena.beginFrame(frameSlot, frame.inFlight.get());
             if (!transferToken.hasValue()) {
@@ -813,6 +1035,33 @@ private:
             if (!graphicsToken.hasValue()) {
                 vkutil::throwVkError("graphicsArena.beginFrame", graphicsToken.error());
             }
+            const auto frameMemoryStatus = frameMemory.beginFrame(frameSlot, frame.inFlight.get());
+            if (!frameMemoryStatus.hasValue()) {
+                vkutil::throwVkError("frameMemory.beginFrame", frameMemoryStatus.error());
+            }
+            defragmenter.beginFrame();
+            defragmenter.step();
+
+            // Earlier frames may still fetch from their own copies of the streams, so each frame
+            // uploads into the slot its fence just released. A vertex-less frame still binds a
+            // valid range.
+            const size_t vertexBytes = activeVertexCount(frameGraphInput) * vertexStride(frameGraphInput.vertexFormat);
+            const FrameLinearAllocator::Slice vertexStream = frameMemory.allocate(
+                std::max<VkDeviceSize>(vertexBytes, vertexStride(frameGraphInput.vertexFormat)), frameMemory.storageAlignment());
+            if (vertexBytes != 0) {
+                std::memcpy(vertexStream.data, activeVertexData(frameGraphInput), vertexBytes);
+            }
+            FrameLinearAllocator::Slice indexStream{};
+            if (!frameGraphInput.indices.empty()) {
+                indexStream = frameMemory.upload(frameGraphInput.indices.data(), frameGraphInput.indices.size() * sizeof(uint32_t), sizeof(uint32_t));
+            }
+
+            if (skinning.valid()) {
+                skinning.prepare(frameGraphInput, frameMemory, vertexStream);
+            }
+            if (clusterCull.valid()) {
+                clusterCull.prepare(frameGraphInput, frameMemory);
+            }
 
             ensure(frame.inFlight.resetResult(), "frameFence.reset");
 
@@ -948,7 +1197,33 @@ private:
                 (void)computePassId;
             }
 
+            // Only one counter readback is queued at a time, so a slow GPU cannot pile them up.
+            if (clusterCull.valid() && clusterCull.counterBytes() > 0 && readbacks.stats().pendingRequests == 0) {
+                readbacks.readBuffer(clusterCull.counterBuffer(), 0, clusterCull.counterBytes(), [&](std::span<const uint8_t> data) {
+                    for (size_t offset = 0; offset + sizeof(uint32_t) <= data.size(); offset += sizeof(uint32_t)) {
+                        uint32_t count = 0;
+                        std::memcpy(&count, data.data() + offset, sizeof(count));
+                        visibleMeshletsRead += count;
+                    }
+                    ++cullCounterReadbacks;
+                });
+            }
+            const std::optional<ReadbackService::Batch> readbackBatch = readbacks.beginBatch();
+            std::optional<RenderTaskGraph::ResourceId> cullCounterResource{};
+            if (readbackBatch.has_value() && clusterCull.valid()) {
+                cullCounterResource = graph.createBufferResource(clusterCull.counterBuffer());
+            }
+
             std::vector<RenderTaskGraph::ResourceUsage> graphicsUsages{};
+            if (cullCounterResource.has_value()) {
+                graphicsUsages.push_back(RenderTaskGraph::ResourceUsage{
+                    .resource = *cullCounterResource,
+                    .access = RenderTaskGraph::ResourceAccessType::Write,
+                    .stageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                    .accessMask = VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+                    .queueFamilyIndex = deviceContext.graphicsFamilyIndex()
+                    });
+            }
             if (frameGraphInput.runComputeStage) {
                 graphicsUsages.push_back(RenderTaskGraph::ResourceUsage{
                     .resource = computeOutResource,
@@ -1029,7 +1304,11 @@ private:
                             borrowed.value().handle,
                             pipeline.get(),
                             pipelineLayout.get(),
-                            vertexBuffer.get(),
+                            vertexStream,
+                            skinning.valid() ? skinning.outputBuffer() : VK_NULL_HANDLE,
+                            indexStream,
+                            clusterCull.valid() ? &clusterCull : nullptr,
+                            textureManager,
                             extent,
                             frameGraphInput.drawPackets,
                             begin,
@@ -1072,6 +1351,14 @@ private:
                         secondaries.push_back(imguiSecondary.value().handle);
                     }
 
+                    defragmenter.recordCopies(graphicsPrimary->handle);
+                    if (skinning.valid()) {
+                        skinning.record(graphicsPrimary->handle);
+                    }
+                    if (clusterCull.valid()) {
+                        clusterCull.record(graphicsPrimary->handle);
+                    }
+
                     RenderSubsystem::recordPrimaryWithSecondaries(
                         graphicsPrimary->handle,
                         swapchain,
@@ -1089,12 +1376,49 @@ private:
                 });
             (void)graphicsPassId;
 
+            // Copies into the readback ring after the frame's work; collect() hands the results
+            // over once the pass's timeline value has passed.
+            if (readbackBatch.has_value()) {
+                std::vector<RenderTaskGraph::ResourceUsage> readbackUsages{};
+                if (cullCounterResource.has_value()) {
+                    readbackUsages.push_back(RenderTaskGraph::ResourceUsage{
+                        .resource = *cullCounterResource,
+                        .access = RenderTaskGraph::ResourceAccessType::Read,
+                        .stageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+                        .accessMask = VK_ACCESS_2_TRANSFER_READ_BIT,
+                        .queueFamilyIndex = deviceContext.graphicsFamilyIndex()
+                        });
+                }
+                const auto readbackPassId = graph.addPass(RenderTaskGraph::PassNode{
+                    .job = SubmissionScheduler::JobRequest{
+                        .queueClass = SubmissionScheduler::QueueClass::Graphics,
+                        .commandBuffers = { readbackBatch->commandBuffer },
+                        .signalSemaphores = { readbackBatch->timeline },
+                        .signalValues = { readbackBatch->signalValue },
+                        .debugLabel = "readback.copy"
+                    },
+                    .usages = std::move(readbackUsages),
+                    .record = [&](const RenderTaskGraph::BarrierBatch& incomingBarriers, const RenderTaskGraph::BarrierBatch& outgoingBarriers) {
+                        emitBarrierBatch(readbackBatch->commandBuffer, incomingBarriers, useSync2);
+                        readbacks.recordCopies();
+                        emitBarrierBatch(readbackBatch->commandBuffer, outgoingBarriers, useSync2);
+                        return readbacks.endBatch();
+                    }
+                    });
+                (void)readbackPassId;
+            }
+
             graph.setPresent(SubmissionScheduler::PresentRequest{
                 .swapchain = swapchain.swapchain().get(),
                 .imageIndex = imageIndex,
                 .waitSemaphores = { presentFinishedByImage[imageIndex].get() }
                 });
 
+            const auto transientStatus = transientResources.realize(graph, frameSlot);
+            if (!transientStatus.hasValue()) {
+                vkutil::throwVkError("TransientResourcePool::realize", transientStatus.error());
+            }
+
             const auto frameExecution = graph.execute(submissionScheduler);
             if (!frameExecution.hasValue()) {
                 vkutil::throwVkError("RenderTaskGraph::execute", frameExecution.error());
@@ -1130,6 +1454,40 @@ private:
             throw std::runtime_error("waitDeviceIdle failed");
         }
 
+        if (config_.textureBudgetBytes > 0) {
+            const TextureManager::Stats& textureStats = textureManager.stats();
+            std::cout << "[Textures] streaming: peak " << (textureStats.peakAllocatedBytes / 1024) << " KiB of "
+                      << (textureStats.budgetBytes / 1024) << " KiB budget, " << textureStats.streamUploads
+                      << " uploads, " << textureStats.evictions << " evictions\n";
+        }
+        if (uploads.stats().submissions > 0) {
+            const UploadManager::Stats& uploadStats = uploads.stats();
+            std::cout << "[Uploads] " << uploadStats.uploads << " uploads (" << (uploadStats.uploadedBytes / 1024) << " KiB) in "
+                      << uploadStats.submissions << " submissions, " << uploadStats.copyCommands << " copies, "
+                      << uploadStats.ringStalls << " ring stalls, peak " << (uploadStats.peakRingUsedBytes / 1024) << " KiB staged\n";
+        }
+
+        // The device is idle, so every readback still in flight can be delivered.
+        readbacks.collect();
+        if (readbacks.stats().batches > 0) {
+            const ReadbackService::Stats& readbackStats = readbacks.stats();
+            std::cout << "[Readback] " << readbackStats.delivered << "/" << readbackStats.requests << " requests ("
+                      << (readbackStats.deliveredBytes / 1024) << " KiB) in " << readbackStats.batches << " batches, "
+                      << (readbackStats.delivered > 0 ? static_cast<double>(readbackStats.totalLatencyFrames) / static_cast<double>(readbackStats.delivered) : 0.0)
+                      << " frames average latency (max " << readbackStats.maxLatencyFrames << "), " << readbackStats.slotStalls
+                      << " slot stalls" << (readbackStats.hostCached ? "" : ", uncached ring") << '\n';
+            if (cullCounterReadbacks > 0) {
+                std::cout << "[Readback] " << (visibleMeshletsRead / cullCounterReadbacks) << " visible meshlets per frame on average\n";
+            }
+        }
+
+        if (transientResources.stats().objects > 0) {
+            const TransientResourcePool::Stats& transientStats = transientResources.stats();
+            std::cout << "[Transients] " << transientStats.resources << " resources in " << transientStats.objects << " objects, "
+                      << (transientStats.heapBytes / 1024) << " KiB aliased in " << transientStats.heaps << " heaps (unaliased "
+                      << (transientStats.objectBytes / 1024) << " KiB), " << transientStats.placements << " placements\n";
+        }
+
         ImGui_ImplVulkan_Shutdown();
         ImGui_ImplGlfw_Shutdown();
         ImGui::DestroyContext();
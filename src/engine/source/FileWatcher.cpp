@@ -0,0 +1,133 @@
+#include <FileWatcher.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+#ifdef __linux__
+#include <cerrno>
+#include <sys/inotify.h>
+#include <unistd.h>
+#else
+#include <chrono>
+#include <system_error>
+#include <utility>
+#endif
+
+#ifdef __linux__
+
+FileWatcher::FileWatcher()
+    : fd_(inotify_init1(IN_NONBLOCK | IN_CLOEXEC))
+{
+}
+
+FileWatcher::~FileWatcher()
+{
+    if (fd_ >= 0) {
+        close(fd_);
+    }
+}
+
+bool FileWatcher::watch(const std::string& directory)
+{
+    if (fd_ < 0) {
+        return false;
+    }
+    // Editors and exporters commonly write a temporary file and rename it over the original.
+    const int wd = inotify_add_watch(fd_, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+    if (wd < 0) {
+        return false;
+    }
+    directories_[wd] = directory;
+    return true;
+}
+
+std::vector<std::string> FileWatcher::poll()
+{
+    std::vector<std::string> changed{};
+    if (fd_ < 0) {
+        return changed;
+    }
+
+    alignas(inotify_event) std::array<char, 4096> buffer{};
+    for (;;) {
+        const ssize_t length = read(fd_, buffer.data(), buffer.size());
+        if (length <= 0) {
+            break;
+        }
+        for (ssize_t offset = 0; offset < length;) {
+            inotify_event event{};
+            std::memcpy(&event, buffer.data() + offset, sizeof(event));
+            const char* name = buffer.data() + offset + sizeof(inotify_event);
+            offset += static_cast<ssize_t>(sizeof(inotify_event) + event.len);
+
+            const auto it = directories_.find(event.wd);
+            if (it == directories_.end() || event.len == 0 || (event.mask & IN_ISDIR) != 0) {
+                continue;
+            }
+            changed.push_back(it->second + '/' + name);
+        }
+    }
+
+    std::ranges::sort(changed);
+    const auto duplicates = std::ranges::unique(changed);
+    changed.erase(duplicates.begin(), duplicates.end());
+    return changed;
+}
+
+#else
+
+FileWatcher::FileWatcher() = default;
+FileWatcher::~FileWatcher() = default;
+
+namespace {
+constexpr auto kScanInterval = std::chrono::milliseconds(250);
+
+std::unordered_map<std::string, std::filesystem::file_time_type> scanDirectory(const std::string& directory)
+{
+    std::unordered_map<std::string, std::filesystem::file_time_type> stamps{};
+    std::error_code ec{};
+    for (const auto& entry : std::filesystem::directory_iterator(directory, ec)) {
+        if (entry.is_regular_file(ec)) {
+            stamps[entry.path().filename().string()] = entry.last_write_time(ec);
+        }
+    }
+    return stamps;
+}
+}
+
+bool FileWatcher::watch(const std::string& directory)
+{
+    std::error_code ec{};
+    if (!std::filesystem::is_directory(directory, ec)) {
+        return false;
+    }
+    directories_[directory] = scanDirectory(directory);
+    return true;
+}
+
+// Directory scans are throttled so per-frame polling stays cheap.
+std::vector<std::string> FileWatcher::poll()
+{
+    std::vector<std::string> changed{};
+    const auto now = std::chrono::steady_clock::now();
+    if (now < nextScan_) {
+        return changed;
+    }
+    nextScan_ = now + kScanInterval;
+
+    for (auto& [directory, stamps] : directories_) {
+        auto current = scanDirectory(directory);
+        for (const auto& [name, stamp] : current) {
+            const auto it = stamps.find(name);
+            if (it == stamps.end() || it->second != stamp) {
+                changed.push_back(directory + '/' + name);
+            }
+        }
+        stamps = std::move(current);
+    }
+    std::ranges::sort(changed);
+    return changed;
+}
+
+#endif
@@ -43,6 +43,67 @@ void World::destroyEntity(Entity entity)
     }
 }
 
+std::vector<Entity> World::createEntities(size_t count)
+{
+    std::vector<Entity> created{};
+    created.reserve(count);
+    aliveEntities_.reserve(aliveEntities_.size() + count);
+
+    const size_t reused = std::min(count, freeList_.size());
+    records_.reserve(records_.size() + (count - reused));
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t id = 0;
+        if (i < reused) {
+            id = freeList_.back();
+            freeList_.pop_back();
+        }
+        else {
+            id = static_cast<uint32_t>(records_.size());
+            records_.push_back(EntityRecord{});
+        }
+
+        EntityRecord& record = records_[id];
+        record.alive = true;
+        created.push_back(Entity{ .id = id, .generation = record.generation });
+    }
+
+    aliveEntities_.insert(aliveEntities_.end(), created.begin(), created.end());
+    return created;
+}
+
+void World::destroyEntities(const std::vector<Entity>& entities)
+{
+    // Copy what dies first: entities may alias aliveEntities_.
+    std::vector<Entity> destroyed{};
+    destroyed.reserve(entities.size());
+    for (const Entity entity : entities) {
+        if (!isAlive(entity)) {
+            continue;
+        }
+        records_[entity.id].alive = false;
+        records_[entity.id].generation += 1;
+        freeList_.push_back(entity.id);
+        destroyed.push_back(entity);
+    }
+    if (destroyed.empty()) {
+        return;
+    }
+
+    std::erase_if(aliveEntities_, [&](const Entity alive) {
+        return !records_[alive.id].alive;
+    });
+
+    for (auto& [_, storage] : storages_) {
+        if (aliveEntities_.empty()) {
+            storage->clear();
+            continue;
+        }
+        for (const Entity entity : destroyed) {
+            storage->remove(entity);
+        }
+    }
+}
+
 bool World::isAlive(Entity entity) const
 {
     if (entity.id >= records_.size()) {
@@ -0,0 +1,308 @@
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "ClusterCulling.h"
+#include "DeferredDeletionService.h"
+#include "VkShaderModule.h"
+#include "VkUtils.h"
+
+namespace {
+using Mat4 = std::array<float, 16>;
+
+// DrawPacket matrices are column-major (glm layout).
+float at(const Mat4& m, size_t row, size_t column) noexcept
+{
+    return m[column * 4 + row];
+}
+
+std::array<float, 4> row(const Mat4& m, size_t r) noexcept
+{
+    return { at(m, r, 0), at(m, r, 1), at(m, r, 2), at(m, r, 3) };
+}
+
+std::array<float, 4> normalizePlane(const std::array<float, 4>& plane) noexcept
+{
+    const float length = std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+    if (length <= 0.0F) {
+        return { 0.0F, 0.0F, 0.0F, 1.0F };
+    }
+    return { plane[0] / length, plane[1] / length, plane[2] / length, plane[3] / length };
+}
+
+// Gribb-Hartmann planes in the matrix's source space. The near plane uses w + z >= 0, which is
+// conservative for both [0, 1] and [-1, 1] depth conventions.
+std::array<std::array<float, 4>, 6> extractFrustumPlanes(const Mat4& clipFromObject) noexcept
+{
+    const std::array<float, 4> r0 = row(clipFromObject, 0);
+    const std::array<float, 4> r1 = row(clipFromObject, 1);
+    const std::array<float, 4> r2 = row(clipFromObject, 2);
+    const std::array<float, 4> r3 = row(clipFromObject, 3);
+
+    std::array<std::array<float, 4>, 6> planes{};
+    for (size_t i = 0; i < 4; ++i) {
+        planes[0][i] = r3[i] + r0[i];
+        planes[1][i] = r3[i] - r0[i];
+        planes[2][i] = r3[i] + r1[i];
+        planes[3][i] = r3[i] - r1[i];
+        planes[4][i] = r3[i] + r2[i];
+        planes[5][i] = r3[i] - r2[i];
+    }
+    for (std::array<float, 4>& plane : planes) {
+        plane = normalizePlane(plane);
+    }
+    return planes;
+}
+
+float det3(float a, float b, float c, float d, float e, float f, float g, float h, float i) noexcept
+{
+    return a * (e * i - f * h) - b * (d * i - f * g) + c * (d * h - e * g);
+}
+
+// The eye is the only point with clip x == y == w == 0, i.e. the null vector of rows 0, 1 and 3.
+// Returns w == 0 for projections without a finite eye (orthographic), which disables cone culling.
+std::array<float, 4> extractViewerPosition(const Mat4& clipFromObject) noexcept
+{
+    const std::array<float, 4> a = row(clipFromObject, 0);
+    const std::array<float, 4> b = row(clipFromObject, 1);
+    const std::array<float, 4> c = row(clipFromObject, 3);
+
+    const float x = det3(a[1], a[2], a[3], b[1], b[2], b[3], c[1], c[2], c[3]);
+    const float y = -det3(a[0], a[2], a[3], b[0], b[2], b[3], c[0], c[2], c[3]);
+    const float z = det3(a[0], a[1], a[3], b[0], b[1], b[3], c[0], c[1], c[3]);
+    const float w = -det3(a[0], a[1], a[2], b[0], b[1], b[2], c[0], c[1], c[2]);
+
+    if (std::abs(w) <= 1e-12F) {
+        return { 0.0F, 0.0F, 0.0F, 0.0F };
+    }
+    return { x / w, y / w, z / w, 1.0F };
+}
+}
+
+ClusterCullPass::ClusterCullPass(const Config& config)
+    : maxMeshlets_(config.maxMeshlets)
+    , maxCullDraws_(config.maxCullDraws)
+{
+    if (config.device == VK_NULL_HANDLE || config.allocator == nullptr) {
+        throw std::runtime_error("ClusterCullPass: device/allocator is null");
+    }
+    if (maxMeshlets_ == 0 || maxCullDraws_ == 0) {
+        throw std::runtime_error("ClusterCullPass: capacities must be > 0");
+    }
+    if (config.framesInFlight == 0) {
+        throw std::runtime_error("ClusterCullPass: framesInFlight must be > 0");
+    }
+
+    maxDrawIndirectCount_ = config.multiDrawIndirect ? std::max(config.maxDrawIndirectCount, 1u) : 1;
+
+    commandBuffer_ = VulkanBuffer(*config.allocator,
+        static_cast<VkDeviceSize>(sizeof(VkDrawIndexedIndirectCommand)) * maxMeshlets_,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    counterBuffer_ = VulkanBuffer(*config.allocator,
+        static_cast<VkDeviceSize>(sizeof(uint32_t)) * maxCullDraws_,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    std::array<VkDescriptorSetLayoutBinding, 4> bindings{};
+    for (uint32_t i = 0; i < bindings.size(); ++i) {
+        bindings[i].binding = i;
+        bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[i].descriptorCount = 1;
+        bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    }
+
+    VkDescriptorSetLayoutCreateInfo layoutCi{ VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO };
+    layoutCi.bindingCount = static_cast<uint32_t>(bindings.size());
+    layoutCi.pBindings = bindings.data();
+    VkDescriptorSetLayout layout = VK_NULL_HANDLE;
+    const VkResult layoutRes = vkCreateDescriptorSetLayout(config.device, &layoutCi, nullptr, &layout);
+    if (layoutRes != VK_SUCCESS) {
+        vkutil::throwVkError("vkCreateDescriptorSetLayout", layoutRes);
+    }
+    setLayout_ = DeferredDeletionService::instance().makeDeferredHandle<VkDescriptorSetLayout, PFN_vkDestroyDescriptorSetLayout>(
+        config.device, layout, vkDestroyDescriptorSetLayout);
+
+    const VkDescriptorPoolSize poolSize{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, static_cast<uint32_t>(bindings.size()) * config.framesInFlight };
+    VkDescriptorPoolCreateInfo poolCi{ VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO };
+    poolCi.maxSets = config.framesInFlight;
+    poolCi.poolSizeCount = 1;
+    poolCi.pPoolSizes = &poolSize;
+    VkDescriptorPool pool = VK_NULL_HANDLE;
+    const VkResult poolRes = vkCreateDescriptorPool(config.device, &poolCi, nullptr, &pool);
+    if (poolRes != VK_SUCCESS) {
+        vkutil::throwVkError("vkCreateDescriptorPool", poolRes);
+    }
+    descriptorPool_ = DeferredDeletionService::instance().makeDeferredHandle<VkDescriptorPool, PFN_vkDestroyDescriptorPool>(
+        config.device, pool, vkDestroyDescriptorPool);
+
+    const std::vector<VkDescriptorSetLayout> setLayouts(config.framesInFlight, setLayout_.get());
+    descriptorSets_.resize(config.framesInFlight);
+    VkDescriptorSetAllocateInfo allocInfo{ VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
+    allocInfo.descriptorPool = descriptorPool_.get();
+    allocInfo.descriptorSetCount = config.framesInFlight;
+    allocInfo.pSetLayouts = setLayouts.data();
+    const VkResult allocRes = vkAllocateDescriptorSets(config.device, &allocInfo, descriptorSets_.data());
+    if (allocRes != VK_SUCCESS) {
+        vkutil::throwVkError("vkAllocateDescriptorSets", allocRes);
+    }
+
+    // Bindings 0 (meshlets) and 1 (cull draws) point into frame memory and are written by prepare().
+    const std::array<VkDescriptorBufferInfo, 2> bufferInfos{
+        VkDescriptorBufferInfo{ commandBuffer_.get(), 0, VK_WHOLE_SIZE },
+        VkDescriptorBufferInfo{ counterBuffer_.get(), 0, VK_WHOLE_SIZE }
+    };
+    constexpr std::array<uint32_t, 2> staticBindings{ 2, 3 };
+    std::vector<VkWriteDescriptorSet> writes{};
+    writes.reserve(descriptorSets_.size() * staticBindings.size());
+    for (const VkDescriptorSet set : descriptorSets_) {
+        for (uint32_t i = 0; i < staticBindings.size(); ++i) {
+            VkWriteDescriptorSet write{ VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+            write.dstSet = set;
+            write.dstBinding = staticBindings[i];
+            write.descriptorCount = 1;
+            write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            write.pBufferInfo = &bufferInfos[i];
+            writes.push_back(write);
+        }
+    }
+    vkUpdateDescriptorSets(config.device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+
+    pipelineLayout_ = VulkanPipelineLayout(
+        config.device,
+        { setLayout_.get() },
+        { VkPushConstantRange{ VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(uint32_t) } });
+
+    reloadShader(config.device, config.shaderCode);
+}
+
+void ClusterCullPass::reloadShader(VkDevice device, const std::vector<char>& shaderCode)
+{
+    VulkanShaderModule shader(device, shaderCode);
+    VkComputePipelineCreateInfo pipelineCi{ VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO };
+    pipelineCi.stage = VkPipelineShaderStageCreateInfo{ VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO };
+    pipelineCi.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    pipelineCi.stage.module = shader.get();
+    pipelineCi.stage.pName = "main";
+    pipelineCi.layout = pipelineLayout_.get();
+    pipeline_ = ComputePipelineBuilder{}.setCreateInfo(pipelineCi).build(device);
+}
+
+void ClusterCullPass::prepare(const FrameGraphInput& frameGraphInput, FrameLinearAllocator& frameMemory)
+{
+    cullDraws_.clear();
+    cullDrawByDrawPacket_.assign(frameGraphInput.drawPackets.size(), kInvalidCullDraw);
+    commandCount_ = 0;
+    maxMeshletsPerDraw_ = 0;
+
+    for (size_t i = 0; i < frameGraphInput.drawPackets.size(); ++i) {
+        const DrawPacket& draw = frameGraphInput.drawPackets[i];
+        if (draw.meshletCount == 0) {
+            continue;
+        }
+        if (cullDraws_.size() >= maxCullDraws_ || commandCount_ + draw.meshletCount > maxMeshlets_) {
+            throw std::runtime_error("ClusterCullPass: cluster draw stream exceeds fixed GPU capacity");
+        }
+
+        CullDrawGpu cullDraw{};
+        cullDraw.planes = extractFrustumPlanes(draw.cullMvp);
+        cullDraw.viewer = extractViewerPosition(draw.cullMvp);
+        cullDraw.firstMeshlet = draw.firstMeshlet;
+        cullDraw.meshletCount = draw.meshletCount;
+        cullDraw.commandOffset = commandCount_;
+        cullDraw.vertexOffset = static_cast<int32_t>(draw.firstVertex);
+
+        cullDrawByDrawPacket_[i] = static_cast<uint32_t>(cullDraws_.size());
+        cullDraws_.push_back(cullDraw);
+        commandCount_ += draw.meshletCount;
+        maxMeshletsPerDraw_ = std::max(maxMeshletsPerDraw_, draw.meshletCount);
+    }
+    cullDrawCount_ = static_cast<uint32_t>(cullDraws_.size());
+
+    if (cullDrawCount_ == 0) {
+        return;
+    }
+    if (frameGraphInput.meshlets.size() > maxMeshlets_) {
+        throw std::runtime_error("ClusterCullPass: meshlet stream exceeds fixed GPU capacity");
+    }
+    if (frameMemory.frameIndex() >= descriptorSets_.size()) {
+        throw std::runtime_error("ClusterCullPass: frame memory has more frames in flight than descriptor sets");
+    }
+
+    const FrameLinearAllocator::Slice meshlets = frameMemory.upload(
+        frameGraphInput.meshlets.data(), frameGraphInput.meshlets.size() * sizeof(MeshletPacket), frameMemory.storageAlignment());
+    const FrameLinearAllocator::Slice cullDraws = frameMemory.upload(
+        cullDraws_.data(), cullDraws_.size() * sizeof(CullDrawGpu), frameMemory.storageAlignment());
+
+    currentSet_ = frameMemory.frameIndex();
+    const std::array<VkDescriptorBufferInfo, 2> bufferInfos{ meshlets.descriptorInfo(), cullDraws.descriptorInfo() };
+    std::array<VkWriteDescriptorSet, 2> writes{};
+    for (uint32_t i = 0; i < writes.size(); ++i) {
+        writes[i] = VkWriteDescriptorSet{ VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+        writes[i].dstSet = descriptorSets_[currentSet_];
+        writes[i].dstBinding = i;
+        writes[i].descriptorCount = 1;
+        writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        writes[i].pBufferInfo = &bufferInfos[i];
+    }
+    vkUpdateDescriptorSets(commandBuffer_.getDevice(), static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+}
+
+void ClusterCullPass::record(VkCommandBuffer commandBuffer) const
+{
+    if (cullDrawCount_ == 0) {
+        return;
+    }
+
+    const VkDeviceSize commandBytes = static_cast<VkDeviceSize>(commandCount_) * sizeof(VkDrawIndexedIndirectCommand);
+    const VkDeviceSize counterBytes = static_cast<VkDeviceSize>(cullDrawCount_) * sizeof(uint32_t);
+
+    // The previous frame's indirect reads, and any readback copy of the counters, must finish
+    // before the clear overwrites them.
+    VkMemoryBarrier readToClear{ VK_STRUCTURE_TYPE_MEMORY_BARRIER };
+    readToClear.srcAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT;
+    readToClear.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+        0, 1, &readToClear, 0, nullptr, 0, nullptr);
+
+    vkCmdFillBuffer(commandBuffer, commandBuffer_.get(), 0, commandBytes, 0);
+    vkCmdFillBuffer(commandBuffer, counterBuffer_.get(), 0, counterBytes, 0);
+
+    VkMemoryBarrier clearToCompute{ VK_STRUCTURE_TYPE_MEMORY_BARRIER };
+    clearToCompute.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    clearToCompute.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        0, 1, &clearToCompute, 0, nullptr, 0, nullptr);
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline_.get());
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout_.get(), 0, 1, &descriptorSets_[currentSet_], 0, nullptr);
+    vkCmdPushConstants(commandBuffer, pipelineLayout_.get(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(uint32_t), &cullDrawCount_);
+    vkCmdDispatch(commandBuffer, (maxMeshletsPerDraw_ + kWorkgroupSize - 1) / kWorkgroupSize, cullDrawCount_, 1);
+
+    VkMemoryBarrier computeToIndirect{ VK_STRUCTURE_TYPE_MEMORY_BARRIER };
+    computeToIndirect.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    computeToIndirect.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+        0, 1, &computeToIndirect, 0, nullptr, 0, nullptr);
+}
+
+bool ClusterCullPass::culls(size_t drawIndex) const noexcept
+{
+    return drawIndex < cullDrawByDrawPacket_.size() && cullDrawByDrawPacket_[drawIndex] != kInvalidCullDraw;
+}
+
+void ClusterCullPass::drawIndirect(VkCommandBuffer commandBuffer, size_t drawIndex) const
+{
+    const CullDrawGpu& cullDraw = cullDraws_[cullDrawByDrawPacket_[drawIndex]];
+    constexpr uint32_t stride = sizeof(VkDrawIndexedIndirectCommand);
+    const VkDeviceSize offset = static_cast<VkDeviceSize>(cullDraw.commandOffset) * stride;
+
+    // Culled slots past the compacted prefix are zero-instance draws.
+    if (cullDraw.meshletCount <= maxDrawIndirectCount_) {
+        vkCmdDrawIndexedIndirect(commandBuffer, commandBuffer_.get(), offset, cullDraw.meshletCount, stride);
+        return;
+    }
+    for (uint32_t i = 0; i < cullDraw.meshletCount; ++i) {
+        vkCmdDrawIndexedIndirect(commandBuffer, commandBuffer_.get(), offset + static_cast<VkDeviceSize>(i) * stride, 1, stride);
+    }
+}
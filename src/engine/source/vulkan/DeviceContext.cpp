@@ -1,4 +1,6 @@
 // DeviceContext.cpp
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <stdexcept>
 #include <utility>
@@ -251,6 +253,9 @@ DeviceContext::DeviceContext(GLFWwindow* window, bool enableValidation_)
     featurePolicy.experimentalExtensions = {
         VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME
     };
+    featurePolicy.optionalExtensions = {
+        VK_EXT_MEMORY_BUDGET_EXTENSION_NAME
+    };
 
     physical = std::make_unique<VulkanPhysicalDevice>(
         instance->get(),
@@ -295,7 +300,9 @@ DeviceContext::DeviceContext(GLFWwindow* window, bool enableValidation_)
         vkutil::initDebugUtils(instance->get(), device->get());
     }
 
-    gpuAllocator = std::make_unique<GpuAllocator>(device->get(), physical->get(), capabilities.bufferDeviceAddressEnabled);
+    const bool memoryBudgetEnabled = std::any_of(capabilities.enabledExtensions.begin(), capabilities.enabledExtensions.end(),
+        [](const char* enabled) { return std::strcmp(enabled, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) == 0; });
+    gpuAllocator = std::make_unique<GpuAllocator>(device->get(), physical->get(), capabilities.bufferDeviceAddressEnabled, memoryBudgetEnabled);
     syncContext = std::make_unique<SyncContext>(
         device->get(),
         2u,
@@ -435,7 +442,7 @@ void DeviceContext::becomeMovedFrom() noexcept
 
 bool DeviceContext::hasLiveRuntimeLocked() const noexcept
 {
-    return instance && surface && physical && device && graphicsQ && presentQ && transferQ && computeQ;
+    return instance && surface && physical && device && graphicsQ && presentQ && transferQ && computeQ && gpuAllocator;
 }
 
 std::shared_ptr<const DeviceRuntimeSnapshot> DeviceContext::buildRuntimeSnapshotLocked() const
@@ -730,6 +737,8 @@ bool DeviceContext::isFeatureSupportedDynamicRendering() const noexcept { return
 bool DeviceContext::isFeatureEnabledDynamicRendering() const noexcept { return capabilities.dynamicRenderingEnabled; }
 bool DeviceContext::isFeatureSupportedDescriptorIndexing() const noexcept { return capabilities.descriptorIndexingSupported; }
 bool DeviceContext::isFeatureEnabledDescriptorIndexing() const noexcept { return capabilities.descriptorIndexingEnabled; }
+bool DeviceContext::isFeatureSupportedMultiDrawIndirect() const noexcept { return capabilities.multiDrawIndirectSupported; }
+bool DeviceContext::isFeatureEnabledMultiDrawIndirect() const noexcept { return capabilities.multiDrawIndirectEnabled; }
 
 VkDevice DeviceContext::vkDevice() const
 {
@@ -745,6 +754,13 @@ VkPhysicalDevice DeviceContext::vkPhysical() const
     return physical->get();
 }
 
+GpuAllocator& DeviceContext::allocator() const
+{
+    std::shared_lock lock(runtimeMutex_);
+    requireAliveLocked("allocator");
+    return *gpuAllocator;
+}
+
 VkInstance DeviceContext::vkInstance() const
 {
     std::shared_lock lock(runtimeMutex_);
@@ -0,0 +1,151 @@
+#include "FrameLinearAllocator.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+constexpr VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment) noexcept
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+}
+
+FrameLinearAllocator::FrameLinearAllocator(const Config& config)
+    : allocator_(config.allocator)
+    , blockSize_(config.blockSize)
+    , usage_(config.usage)
+{
+    if (allocator_ == nullptr || !allocator_->valid()) {
+        throw std::runtime_error("FrameLinearAllocator: allocator is null");
+    }
+    if (config.framesInFlight == 0 || blockSize_ == 0) {
+        throw std::runtime_error("FrameLinearAllocator: framesInFlight and blockSize must be > 0");
+    }
+
+    VkPhysicalDeviceProperties props{};
+    vkGetPhysicalDeviceProperties(allocator_->physicalDevice(), &props);
+    storageAlignment_ = std::max<VkDeviceSize>(props.limits.minStorageBufferOffsetAlignment, 1);
+    uniformAlignment_ = std::max<VkDeviceSize>(props.limits.minUniformBufferOffsetAlignment, 1);
+
+    frames_.resize(config.framesInFlight);
+    // One block per frame up front, so the first frames do not stall on vkAllocateMemory.
+    for (Frame& frame : frames_) {
+        appendBlock(frame, blockSize_);
+    }
+}
+
+vkutil::VkExpected<void> FrameLinearAllocator::beginFrame(uint32_t frameIndex, VkFence frameFence)
+{
+    if (frameIndex >= frames_.size() || frameFence == VK_NULL_HANDLE) {
+        return vkutil::makeError("FrameLinearAllocator::beginFrame(fence)", VK_ERROR_INITIALIZATION_FAILED, "frame_linear_allocator");
+    }
+
+    const VkResult fenceStatus = vkGetFenceStatus(allocator_->device(), frameFence);
+    if (fenceStatus == VK_NOT_READY) {
+        return vkutil::makeError("FrameLinearAllocator::beginFrame(fence)", VK_NOT_READY, "frame_linear_allocator", nullptr, 0, true);
+    }
+    if (fenceStatus != VK_SUCCESS) {
+        return vkutil::checkResult(fenceStatus, "vkGetFenceStatus", "frame_linear_allocator");
+    }
+
+    resetFrame(frameIndex);
+    return {};
+}
+
+vkutil::VkExpected<void> FrameLinearAllocator::beginFrame(uint32_t frameIndex, uint64_t completedValue)
+{
+    if (frameIndex >= frames_.size()) {
+        return vkutil::makeError("FrameLinearAllocator::beginFrame(timeline)", VK_ERROR_INITIALIZATION_FAILED, "frame_linear_allocator", "invalid_frame_index");
+    }
+    if (completedValue < frames_[frameIndex].submittedValue) {
+        return vkutil::makeError("FrameLinearAllocator::beginFrame(timeline)", VK_NOT_READY, "frame_linear_allocator", nullptr, 0, true);
+    }
+
+    resetFrame(frameIndex);
+    return {};
+}
+
+void FrameLinearAllocator::markFrameSubmitted(uint32_t frameIndex, uint64_t submissionValue) noexcept
+{
+    if (frameIndex < frames_.size()) {
+        frames_[frameIndex].submittedValue = submissionValue;
+    }
+}
+
+void FrameLinearAllocator::resetFrame(uint32_t frameIndex) noexcept
+{
+    Frame& frame = frames_[frameIndex];
+    frame.current = 0;
+    frame.cursor = 0;
+    frame.usedBytes = 0;
+    currentFrame_ = frameIndex;
+}
+
+FrameLinearAllocator::Slice FrameLinearAllocator::allocate(VkDeviceSize size, VkDeviceSize alignment)
+{
+    if (currentFrame_ == kNoFrame) {
+        throw std::runtime_error("FrameLinearAllocator: allocate() before beginFrame()");
+    }
+    if (size == 0 || alignment == 0 || (alignment & (alignment - 1)) != 0) {
+        throw std::runtime_error("FrameLinearAllocator: size must be > 0 and alignment a power of two");
+    }
+
+    Frame& frame = frames_[currentFrame_];
+    // Blocks left over from a larger frame are reused in order; a request that does not fit in
+    // what remains of one moves on to the next rather than searching back.
+    while (frame.current < frame.blocks.size()) {
+        const Block& block = frame.blocks[frame.current];
+        const VkDeviceSize offset = alignUp(frame.cursor, alignment);
+        if (offset + size <= block.buffer.getSize()) {
+            frame.usedBytes += offset + size - frame.cursor;
+            frame.cursor = offset + size;
+            peakFrameBytes_ = std::max(peakFrameBytes_, frame.usedBytes);
+            return Slice{ block.buffer.get(), offset, size, block.mapped + offset };
+        }
+        ++frame.current;
+        frame.cursor = 0;
+    }
+
+    const Block& block = appendBlock(frame, size);
+    frame.current = static_cast<uint32_t>(frame.blocks.size() - 1);
+    frame.cursor = size;
+    frame.usedBytes += size;
+    peakFrameBytes_ = std::max(peakFrameBytes_, frame.usedBytes);
+    return Slice{ block.buffer.get(), 0, size, block.mapped };
+}
+
+FrameLinearAllocator::Slice FrameLinearAllocator::upload(const void* data, VkDeviceSize size, VkDeviceSize alignment)
+{
+    const Slice slice = allocate(size, alignment);
+    std::memcpy(slice.data, data, static_cast<size_t>(size));
+    return slice;
+}
+
+FrameLinearAllocator::Block& FrameLinearAllocator::appendBlock(Frame& frame, VkDeviceSize minSize)
+{
+    // Host-coherent, so slices need no flush before submit.
+    Block block{};
+    block.buffer = VulkanBuffer(*allocator_, std::max(blockSize_, minSize), usage_,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        false, VulkanBuffer::AllocationPolicy::Transient);
+    block.mapped = static_cast<std::byte*>(block.buffer.map());
+    frame.blocks.push_back(std::move(block));
+    return frame.blocks.back();
+}
+
+FrameLinearAllocator::Stats FrameLinearAllocator::stats() const noexcept
+{
+    Stats out{};
+    for (const Frame& frame : frames_) {
+        out.blockCount += static_cast<uint32_t>(frame.blocks.size());
+        for (const Block& block : frame.blocks) {
+            out.reservedBytes += block.buffer.getSize();
+        }
+    }
+    if (currentFrame_ != kNoFrame) {
+        out.frameBytes = frames_[currentFrame_].usedBytes;
+    }
+    out.peakFrameBytes = peakFrameBytes_;
+    return out;
+}
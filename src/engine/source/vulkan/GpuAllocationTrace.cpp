@@ -0,0 +1,205 @@
+#include "GpuAllocationTrace.h"
+
+#include <algorithm>
+#include <bit>
+#include <iterator>
+#include <stdexcept>
+
+namespace {
+constexpr uint32_t kMagic = 0x52544147u; // "GATR"
+constexpr uint32_t kVersion = 1;
+constexpr size_t kHeaderBytes = 16;
+constexpr size_t kBufferBytes = 64 * 1024;
+
+void putU32(std::vector<uint8_t>& out, uint32_t value)
+{
+    for (int i = 0; i < 4; ++i) {
+        out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
+
+class TraceCursor {
+public:
+    explicit TraceCursor(const std::vector<uint8_t>& bytes) : bytes_(bytes) {}
+
+    [[nodiscard]] bool done() const noexcept { return position_ == bytes_.size(); }
+
+    uint8_t byte()
+    {
+        if (position_ >= bytes_.size()) {
+            throw std::runtime_error("GpuAllocationTrace: truncated record");
+        }
+        return bytes_[position_++];
+    }
+
+    uint32_t u32()
+    {
+        uint32_t value = 0;
+        for (int i = 0; i < 4; ++i) {
+            value |= static_cast<uint32_t>(byte()) << (8 * i);
+        }
+        return value;
+    }
+
+    uint64_t varint()
+    {
+        uint64_t value = 0;
+        for (uint32_t shift = 0; shift < 64; shift += 7) {
+            const uint8_t b = byte();
+            value |= static_cast<uint64_t>(b & 0x7Fu) << shift;
+            if ((b & 0x80u) == 0) {
+                return value;
+            }
+        }
+        throw std::runtime_error("GpuAllocationTrace: malformed varint");
+    }
+
+    void skip(size_t count)
+    {
+        for (size_t i = 0; i < count; ++i) {
+            (void)byte();
+        }
+    }
+
+private:
+    const std::vector<uint8_t>& bytes_;
+    size_t position_{ 0 };
+};
+}
+
+GpuAllocationTraceWriter::GpuAllocationTraceWriter(const std::string& path)
+    : file_(path, std::ios::binary | std::ios::trunc)
+    , start_(std::chrono::steady_clock::now())
+{
+    if (!file_) {
+        throw std::runtime_error("GpuAllocationTrace: cannot create " + path);
+    }
+    buffer_.reserve(kBufferBytes);
+    putU32(buffer_, kMagic);
+    putU32(buffer_, kVersion);
+    buffer_.resize(kHeaderBytes, 0);
+}
+
+GpuAllocationTraceWriter::~GpuAllocationTraceWriter() noexcept
+{
+    try {
+        flush();
+    }
+    catch (...) {
+        // The trace is a diagnostic; losing its tail must not take the allocator down with it.
+    }
+}
+
+void GpuAllocationTraceWriter::recordAllocate(uint64_t memory, uint64_t offset, GpuAllocationEvent event)
+{
+    liveIds_[Key{ memory, offset }] = nextId_++;
+    beginRecord(GpuAllocationEvent::Op::Allocate);
+    putVarint(event.size);
+    // Vulkan alignments are powers of two.
+    buffer_.push_back(static_cast<uint8_t>(std::countr_zero(std::max<uint64_t>(1, event.alignment))));
+    buffer_.push_back(event.memoryTypeIndex);
+    buffer_.push_back(event.pool);
+    buffer_.push_back(event.flags);
+    ++stats_.allocations;
+}
+
+void GpuAllocationTraceWriter::recordFree(uint64_t memory, uint64_t offset)
+{
+    const auto it = liveIds_.find(Key{ memory, offset });
+    if (it == liveIds_.end()) {
+        ++stats_.untrackedFrees;
+        return;
+    }
+    const uint64_t id = it->second;
+    liveIds_.erase(it);
+    beginRecord(GpuAllocationEvent::Op::Free);
+    putVarint(id);
+    ++stats_.frees;
+}
+
+void GpuAllocationTraceWriter::flush()
+{
+    if (buffer_.empty()) {
+        return;
+    }
+    file_.write(reinterpret_cast<const char*>(buffer_.data()), static_cast<std::streamsize>(buffer_.size()));
+    file_.flush();
+    if (!file_) {
+        throw std::runtime_error("GpuAllocationTrace: write failed");
+    }
+    stats_.bytesWritten += buffer_.size();
+    buffer_.clear();
+}
+
+void GpuAllocationTraceWriter::beginRecord(GpuAllocationEvent::Op op)
+{
+    // The largest record is 1 + 10 + 10 + 4 bytes.
+    if (buffer_.size() + 32 > kBufferBytes) {
+        flush();
+    }
+    const uint64_t now = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_).count());
+    buffer_.push_back(static_cast<uint8_t>(op));
+    putVarint(now - lastTimestampNs_);
+    lastTimestampNs_ = now;
+}
+
+void GpuAllocationTraceWriter::putVarint(uint64_t value)
+{
+    while (value >= 0x80u) {
+        buffer_.push_back(static_cast<uint8_t>(value | 0x80u));
+        value >>= 7;
+    }
+    buffer_.push_back(static_cast<uint8_t>(value));
+}
+
+std::vector<GpuAllocationEvent> readGpuAllocationTrace(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("GpuAllocationTrace: cannot open " + path);
+    }
+    const std::vector<uint8_t> bytes{ std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+
+    TraceCursor cursor(bytes);
+    if (bytes.size() < kHeaderBytes || cursor.u32() != kMagic) {
+        throw std::runtime_error("GpuAllocationTrace: " + path + " is not an allocation trace");
+    }
+    if (const uint32_t version = cursor.u32(); version != kVersion) {
+        throw std::runtime_error("GpuAllocationTrace: unsupported version " + std::to_string(version));
+    }
+    cursor.skip(kHeaderBytes - 8);
+
+    std::vector<GpuAllocationEvent> events{};
+    uint64_t timestamp = 0;
+    uint64_t nextId = 0;
+    while (!cursor.done()) {
+        GpuAllocationEvent event{};
+        event.op = static_cast<GpuAllocationEvent::Op>(cursor.byte());
+        timestamp += cursor.varint();
+        event.timestampNs = timestamp;
+        if (event.op == GpuAllocationEvent::Op::Allocate) {
+            event.id = nextId++;
+            event.size = cursor.varint();
+            const uint8_t alignmentLog2 = cursor.byte();
+            if (alignmentLog2 >= 64) {
+                throw std::runtime_error("GpuAllocationTrace: malformed alignment");
+            }
+            event.alignment = 1ull << alignmentLog2;
+            event.memoryTypeIndex = cursor.byte();
+            event.pool = cursor.byte();
+            event.flags = cursor.byte();
+        }
+        else if (event.op == GpuAllocationEvent::Op::Free) {
+            event.id = cursor.varint();
+            if (event.id >= nextId) {
+                throw std::runtime_error("GpuAllocationTrace: free of an allocation not yet made");
+            }
+        }
+        else {
+            throw std::runtime_error("GpuAllocationTrace: unknown record type");
+        }
+        events.push_back(event);
+    }
+    return events;
+}
@@ -1,7 +1,11 @@
 #include "GpuAllocator.h"
+#include "VkUtils.h"
 
 #include <algorithm>
+#include <cstddef>
+#include <optional>
 #include <stdexcept>
+#include <utility>
 
 namespace {
 constexpr VkDeviceSize kMinBlockSize = 4ull * 1024ull * 1024ull;
@@ -19,11 +23,13 @@ constexpr VkDeviceSize kMinBlockSize = 4ull * 1024ull * 1024ull;
 
 GpuAllocator::GpuAllocator(VkDevice device, VkPhysicalDevice physicalDevice,
     bool bufferDeviceAddressEnabled,
+    bool memoryBudgetEnabled,
     VkDeviceSize defaultPoolBlockSize,
     VkDeviceSize dedicatedThreshold)
     : device_(device)
     , physicalDevice_(physicalDevice)
     , bufferDeviceAddressEnabled_(bufferDeviceAddressEnabled)
+    , memoryBudgetEnabled_(memoryBudgetEnabled)
     , defaultPoolBlockSize_(std::max(defaultPoolBlockSize, kMinBlockSize))
     , dedicatedThreshold_(std::max(dedicatedThreshold, kMinBlockSize))
 {
@@ -34,7 +40,13 @@ GpuAllocator::GpuAllocator(VkDevice device, VkPhysicalDevice physicalDevice,
     VkPhysicalDeviceProperties props{};
     vkGetPhysicalDeviceProperties(physicalDevice_, &props);
     nonCoherentAtomSize_ = std::max<VkDeviceSize>(1, props.limits.nonCoherentAtomSize);
+    bufferImageGranularity_ = std::max<VkDeviceSize>(1, props.limits.bufferImageGranularity);
     vkGetPhysicalDeviceMemoryProperties(physicalDevice_, &memProps_);
+    refreshBudgetLocked();
+
+    slabs_ = SmallSlabs(
+        [this](uint64_t poolKey, uint64_t size, uint64_t alignment) { return acquireSlab(poolKey, size, alignment); },
+        [this](uint64_t poolKey, const SmallSlabs::Slab& slab) { releaseSlab(poolKey, slab); });
 }
 
 GpuAllocator::~GpuAllocator() noexcept
@@ -42,17 +54,18 @@ GpuAllocator::~GpuAllocator() noexcept
     reset();
 }
 
-VkDeviceSize GpuAllocator::alignUp(VkDeviceSize value, VkDeviceSize alignment) noexcept
+uint32_t GpuAllocator::findMemoryType(uint32_t typeBits, VkMemoryPropertyFlags props) const
 {
-    if (alignment <= 1) {
-        return value;
+    std::lock_guard<std::mutex> lock(mutex_);
+    const uint32_t memoryTypeIndex = findMemoryTypeLocked(typeBits, props);
+    if (memoryTypeIndex == UINT32_MAX) {
+        throw std::runtime_error("GpuAllocator: no suitable memory type found");
     }
-    return ((value + alignment - 1) / alignment) * alignment;
+    return memoryTypeIndex;
 }
 
-uint32_t GpuAllocator::findMemoryType(uint32_t typeBits, VkMemoryPropertyFlags props) const
+uint32_t GpuAllocator::findMemoryTypeLocked(uint32_t typeBits, VkMemoryPropertyFlags props) const noexcept
 {
-    std::lock_guard<std::mutex> lock(mutex_);
     for (uint32_t i = 0; i < memProps_.memoryTypeCount; ++i) {
         const bool typeOk = (typeBits & (1u << i)) != 0;
         const bool flagsOk = (memProps_.memoryTypes[i].propertyFlags & props) == props;
@@ -60,15 +73,31 @@ uint32_t GpuAllocator::findMemoryType(uint32_t typeBits, VkMemoryPropertyFlags p
             return i;
         }
     }
-    throw std::runtime_error("GpuAllocator: no suitable memory type found");
+    return UINT32_MAX;
+}
+
+uint64_t GpuAllocator::makePoolKey(uint32_t memoryTypeIndex, VkMemoryAllocateFlags allocateFlags,
+    Tiling tiling, Pool pool) noexcept
+{
+    // VkMemoryAllocateFlagBits only use the low bits, leaving the top two bytes for the pool.
+    return static_cast<uint64_t>(memoryTypeIndex)
+        | (static_cast<uint64_t>(allocateFlags & 0xFFFFu) << 32)
+        | (static_cast<uint64_t>(tiling) << 48)
+        | (static_cast<uint64_t>(pool) << 56);
 }
 
-uint64_t GpuAllocator::makePoolKey(uint32_t memoryTypeIndex, VkMemoryAllocateFlags allocateFlags) noexcept
+GpuAllocator::PoolStats GpuAllocator::describePoolKey(uint64_t poolKey) noexcept
 {
-    return (static_cast<uint64_t>(allocateFlags) << 32) | static_cast<uint64_t>(memoryTypeIndex);
+    return PoolStats{
+        .memoryTypeIndex = static_cast<uint32_t>(poolKey & 0xFFFFFFFFu),
+        .allocateFlags = static_cast<VkMemoryAllocateFlags>((poolKey >> 32) & 0xFFFFu),
+        .pool = static_cast<Pool>((poolKey >> 56) & 0xFFu),
+        .tiling = static_cast<Tiling>((poolKey >> 48) & 0xFFu)
+    };
 }
 
-GpuAllocator::MemoryBlock& GpuAllocator::createPooledBlock(uint32_t memoryTypeIndex, VkMemoryAllocateFlags allocateFlags, VkDeviceSize minSize)
+std::optional<uint32_t> GpuAllocator::createPooledBlockLocked(uint64_t poolKey, uint32_t memoryTypeIndex,
+    VkMemoryAllocateFlags allocateFlags, VkDeviceSize minSize, Priority priority, bool finalAttempt, Shortfall& shortfall)
 {
     const VkDeviceSize blockSize = std::max(defaultPoolBlockSize_, minSize);
 
@@ -81,48 +110,75 @@ GpuAllocator::MemoryBlock& GpuAllocator::createPooledBlock(uint32_t memoryTypeIn
     ai.pNext = (allocateFlags != 0) ? &allocFlagsInfo : nullptr;
 
     VkDeviceMemory memory = VK_NULL_HANDLE;
-    const VkResult allocRes = vkAllocateMemory(device_, &ai, nullptr, &memory);
-    if (allocRes != VK_SUCCESS) {
-        throw std::runtime_error("GpuAllocator: vkAllocateMemory failed while creating pooled block");
+    if (!allocateMemoryLocked(ai, priority, finalAttempt, shortfall, memory)) {
+        return std::nullopt;
     }
 
-    const uint64_t poolKey = makePoolKey(memoryTypeIndex, allocateFlags);
-    auto& blocks = pooledBlocks_[poolKey];
-    blocks.push_back(MemoryBlock{
+    MemoryBlock block{
         .memory = memory,
         .size = blockSize,
         .memoryTypeIndex = memoryTypeIndex,
         .poolKey = poolKey,
         .allocateFlags = allocateFlags,
-        .freeRanges = { FreeRange{ 0, blockSize } }
-        });
+        .ranges = TlsfAllocator(blockSize),
+        .mapped = mapPersistentLocked(memory, memoryTypeIndex, blockSize)
+    };
 
-    return blocks.back();
+    // Released slots keep their index so live allocations' blockIndex stays valid.
+    auto& blocks = pooledBlocks_[poolKey];
+    const auto released = std::ranges::find(blocks, VkDeviceMemory{ VK_NULL_HANDLE }, &MemoryBlock::memory);
+    if (released != blocks.end()) {
+        *released = std::move(block);
+        return static_cast<uint32_t>(released - blocks.begin());
+    }
+    blocks.push_back(std::move(block));
+    return static_cast<uint32_t>(blocks.size() - 1);
 }
 
-void GpuAllocator::mergeFreeRanges(std::vector<FreeRange>& ranges)
+bool GpuAllocator::allocateMemoryLocked(const VkMemoryAllocateInfo& info, Priority priority, bool finalAttempt,
+    Shortfall& shortfall, VkDeviceMemory& outMemory)
 {
-    if (ranges.empty()) {
-        return;
+    const uint32_t heapIndex = memProps_.memoryTypes[info.memoryTypeIndex].heapIndex;
+    shortfall = Shortfall{ .heapIndex = heapIndex, .bytes = info.allocationSize };
+
+    const bool overBudget = projectedUsageLocked(heapIndex) + info.allocationSize > heaps_[heapIndex].budget;
+    if (overBudget && priority != Priority::High && (!finalAttempt || priority == Priority::Low)) {
+        shortfall.overBudget = true;
+        return false;
     }
 
-    std::sort(ranges.begin(), ranges.end(), [](const FreeRange& a, const FreeRange& b) {
-        return a.offset < b.offset;
-        });
+    const VkResult allocRes = vkAllocateMemory(device_, &info, nullptr, &outMemory);
+    if (allocRes == VK_ERROR_OUT_OF_DEVICE_MEMORY || allocRes == VK_ERROR_OUT_OF_HOST_MEMORY) {
+        outMemory = VK_NULL_HANDLE;
+        return false;
+    }
+    if (allocRes != VK_SUCCESS) {
+        vkutil::throwVkError("vkAllocateMemory", allocRes);
+    }
+    heaps_[heapIndex].allocatorBytes += info.allocationSize;
+    return true;
+}
 
-    size_t out = 0;
-    for (size_t i = 1; i < ranges.size(); ++i) {
-        FreeRange& curr = ranges[out];
-        const FreeRange& next = ranges[i];
-        if (curr.offset + curr.size == next.offset) {
-            curr.size += next.size;
-        }
-        else {
-            ++out;
-            ranges[out] = next;
-        }
+void* GpuAllocator::mapPersistentLocked(VkDeviceMemory memory, uint32_t memoryTypeIndex, VkDeviceSize size)
+{
+    if ((memProps_.memoryTypes[memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) == 0) {
+        return nullptr;
+    }
+    // Unmapped implicitly by vkFreeMemory.
+    void* mapped = nullptr;
+    const VkResult mapRes = vkMapMemory(device_, memory, 0, VK_WHOLE_SIZE, 0, &mapped);
+    if (mapRes != VK_SUCCESS) {
+        freeMemoryLocked(memory, memoryTypeIndex, size);
+        vkutil::throwVkError("vkMapMemory", mapRes);
     }
-    ranges.resize(out + 1);
+    return mapped;
+}
+
+void GpuAllocator::freeMemoryLocked(VkDeviceMemory memory, uint32_t memoryTypeIndex, VkDeviceSize size) noexcept
+{
+    vkFreeMemory(device_, memory, nullptr);
+    HeapState& heap = heaps_[memProps_.memoryTypes[memoryTypeIndex].heapIndex];
+    heap.allocatorBytes -= std::min(heap.allocatorBytes, size);
 }
 
 bool GpuAllocator::shouldUseDedicatedAllocation(const VkMemoryRequirements& req,
@@ -160,9 +216,24 @@ GpuAllocator::Allocation GpuAllocator::allocateForBuffer(
     VkMemoryAllocateFlags allocateFlags,
     VkBuffer dedicatedBuffer,
     bool forceDedicated,
-    LifetimeClass lifetimeClass)
+    LifetimeClass lifetimeClass,
+    Pool pool,
+    Priority priority)
 {
-    return allocateInternal(req, properties, allocateFlags, forceDedicated, dedicatedBuffer, VK_NULL_HANDLE, ResourceClass::Buffer, lifetimeClass);
+    const Request request{
+        .size = req.size,
+        .alignment = std::max<VkDeviceSize>(1, req.alignment),
+        .allocateFlags = allocateFlags,
+        .dedicated = forceDedicated || req.size >= dedicatedThreshold_,
+        .dedicatedBuffer = dedicatedBuffer,
+        .resourceClass = ResourceClass::Buffer,
+        .lifetimeClass = lifetimeClass,
+        .pool = pool,
+        .priority = priority
+    };
+    Allocation allocation = allocateInternal(request, req.memoryTypeBits, properties);
+    traceAllocate(request, allocation);
+    return allocation;
 }
 
 GpuAllocator::Allocation GpuAllocator::allocateForImage(
@@ -170,167 +241,298 @@ GpuAllocator::Allocation GpuAllocator::allocateForImage(
     VkMemoryPropertyFlags properties,
     VkImage dedicatedImage,
     bool forceDedicated,
-    LifetimeClass lifetimeClass)
+    LifetimeClass lifetimeClass,
+    Pool pool,
+    Priority priority,
+    VkImageTiling tiling)
 {
-    return allocateInternal(req, properties, 0, forceDedicated, VK_NULL_HANDLE, dedicatedImage, ResourceClass::Image, lifetimeClass);
+    const Request request{
+        .size = req.size,
+        .alignment = std::max<VkDeviceSize>(1, req.alignment),
+        .dedicated = forceDedicated || req.size >= dedicatedThreshold_,
+        .dedicatedImage = dedicatedImage,
+        .resourceClass = ResourceClass::Image,
+        .lifetimeClass = lifetimeClass,
+        .pool = pool,
+        .tiling = tiling == VK_IMAGE_TILING_LINEAR ? Tiling::Linear : Tiling::Optimal,
+        .priority = priority
+    };
+    Allocation allocation = allocateInternal(request, req.memoryTypeBits, properties);
+    traceAllocate(request, allocation);
+    return allocation;
 }
 
-GpuAllocator::Allocation GpuAllocator::allocateInternal(const VkMemoryRequirements& req,
-    VkMemoryPropertyFlags properties,
-    VkMemoryAllocateFlags allocateFlags,
-    bool forceDedicated,
-    VkBuffer dedicatedBuffer,
-    VkImage dedicatedImage,
-    ResourceClass resourceClass,
-    LifetimeClass lifetimeClass)
+GpuAllocator::Allocation GpuAllocator::allocateInternal(const Request& request, uint32_t memoryTypeBits, VkMemoryPropertyFlags properties)
 {
+    if (auto allocation = tryAllocateSlab(request, memoryTypeBits, properties)) {
+        return *allocation;
+    }
+
+    uint32_t memoryTypeIndex = UINT32_MAX;
+    Shortfall shortfall{};
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!valid()) {
+            throw std::runtime_error("GpuAllocator::allocateInternal called on invalid allocator");
+        }
+        if ((request.allocateFlags & VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT) != 0 && !bufferDeviceAddressEnabled_) {
+            throw std::runtime_error("GpuAllocator::allocateInternal: device address allocation requested but feature is disabled");
+        }
+        memoryTypeIndex = findMemoryTypeLocked(memoryTypeBits, properties);
+        if (memoryTypeIndex == UINT32_MAX) {
+            throw std::runtime_error("GpuAllocator: no suitable memory type found");
+        }
+        if (auto allocation = tryAllocateLocked(request, memoryTypeIndex, false, shortfall)) {
+            return *allocation;
+        }
+    }
+
+    // Callbacks may free through this allocator, so they run unlocked.
+    evictionRequestCount_.fetch_add(1, std::memory_order_relaxed);
+    requestEviction(shortfall.heapIndex, shortfall.bytes, request.priority);
+
     std::lock_guard<std::mutex> lock(mutex_);
     if (!valid()) {
         throw std::runtime_error("GpuAllocator::allocateInternal called on invalid allocator");
     }
-
-    if ((allocateFlags & VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT) != 0 && !bufferDeviceAddressEnabled_) {
-        throw std::runtime_error("GpuAllocator::allocateInternal: device address allocation requested but feature is disabled");
+    if (auto allocation = tryAllocateLocked(request, memoryTypeIndex, true, shortfall)) {
+        return *allocation;
     }
 
-    uint32_t memoryTypeIndex = UINT32_MAX;
-    for (uint32_t i = 0; i < memProps_.memoryTypeCount; ++i) {
-        const bool typeOk = (req.memoryTypeBits & (1u << i)) != 0;
-        const bool flagsOk = (memProps_.memoryTypes[i].propertyFlags & properties) == properties;
-        if (typeOk && flagsOk) {
-            memoryTypeIndex = i;
-            break;
+    // A device-local resource still works from system memory, only slower, which beats losing
+    // it; Low requests are expected to do without instead.
+    const bool deviceOnly = request.priority != Priority::Low
+        && (properties & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) != 0
+        && (properties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) == 0;
+    if (deviceOnly) {
+        const uint32_t fallbackType = findMemoryTypeLocked(memoryTypeBits, properties & ~VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        const bool differentHeap = fallbackType != UINT32_MAX
+            && memProps_.memoryTypes[fallbackType].heapIndex != memProps_.memoryTypes[memoryTypeIndex].heapIndex;
+        if (differentHeap) {
+            Shortfall fallbackShortfall{};
+            if (auto allocation = tryAllocateLocked(request, fallbackType, true, fallbackShortfall)) {
+                fallbackAllocationCount_.fetch_add(1, std::memory_order_relaxed);
+                return *allocation;
+            }
         }
     }
-    if (memoryTypeIndex == UINT32_MAX) {
-        throw std::runtime_error("GpuAllocator: no suitable memory type found");
-    }
 
-    const uint64_t poolKey = makePoolKey(memoryTypeIndex, allocateFlags);
-    const VkDeviceSize requestSize = req.size;
-    const VkDeviceSize requestAlign = std::max<VkDeviceSize>(1, req.alignment);
+    outOfMemoryCount_.fetch_add(1, std::memory_order_relaxed);
+    throw OutOfMemoryError(shortfall.overBudget
+            ? "GpuAllocator: allocation refused, heap over budget"
+            : "GpuAllocator: out of device memory",
+        shortfall.heapIndex, shortfall.bytes);
+}
 
-    const bool useDedicatedAllocation = forceDedicated || requestSize >= dedicatedThreshold_;
-    if (useDedicatedAllocation) {
+std::optional<GpuAllocator::Allocation> GpuAllocator::tryAllocateLocked(const Request& request, uint32_t memoryTypeIndex,
+    bool finalAttempt, Shortfall& shortfall)
+{
+    // With a granularity of 1 linear and optimal resources may be neighbours, so they share
+    // blocks; otherwise each kind gets its own, which is cheaper than padding every allocation.
+    const Tiling placement = bufferImageGranularity_ > 1 ? request.tiling : Tiling::Linear;
+    const uint64_t poolKey = makePoolKey(memoryTypeIndex, request.allocateFlags, placement, request.pool);
+    Allocation out{
+        .size = request.size,
+        .memoryTypeIndex = memoryTypeIndex,
+        .poolKey = poolKey,
+        .allocateFlags = request.allocateFlags,
+        .dedicated = request.dedicated,
+        .resourceClass = request.resourceClass,
+        .lifetimeClass = request.lifetimeClass,
+        .pool = request.pool,
+        .tiling = request.tiling,
+        .priority = request.priority
+    };
+
+    if (request.dedicated) {
         VkMemoryAllocateFlagsInfo allocFlagsInfo{ VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO };
-        allocFlagsInfo.flags = allocateFlags;
+        allocFlagsInfo.flags = request.allocateFlags;
 
         VkMemoryDedicatedAllocateInfo dedicatedInfo{ VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO };
-        dedicatedInfo.buffer = dedicatedBuffer;
-        dedicatedInfo.image = dedicatedImage;
+        dedicatedInfo.buffer = request.dedicatedBuffer;
+        dedicatedInfo.image = request.dedicatedImage;
 
         VkMemoryAllocateInfo ai{ VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO };
-        ai.allocationSize = requestSize;
+        ai.allocationSize = request.size;
         ai.memoryTypeIndex = memoryTypeIndex;
 
-        if (dedicatedBuffer != VK_NULL_HANDLE || dedicatedImage != VK_NULL_HANDLE) {
+        if (request.dedicatedBuffer != VK_NULL_HANDLE || request.dedicatedImage != VK_NULL_HANDLE) {
             ai.pNext = &dedicatedInfo;
-            if (allocateFlags != 0) {
+            if (request.allocateFlags != 0) {
                 dedicatedInfo.pNext = &allocFlagsInfo;
             }
         }
-        else if (allocateFlags != 0) {
+        else if (request.allocateFlags != 0) {
             ai.pNext = &allocFlagsInfo;
         }
 
-        Allocation out{};
-        out.memoryTypeIndex = memoryTypeIndex;
-        out.poolKey = poolKey;
-        out.allocateFlags = allocateFlags;
-        out.size = requestSize;
-        out.offset = 0;
-        out.dedicated = true;
-        out.resourceClass = resourceClass;
-        out.lifetimeClass = lifetimeClass;
-
-        const VkResult allocRes = vkAllocateMemory(device_, &ai, nullptr, &out.memory);
-        if (allocRes != VK_SUCCESS) {
-            throw std::runtime_error("GpuAllocator: dedicated vkAllocateMemory failed");
+        if (!allocateMemoryLocked(ai, request.priority, finalAttempt, shortfall, out.memory)) {
+            return std::nullopt;
         }
-        allocationCount_.fetch_add(1, std::memory_order_relaxed);
+        out.memorySize = request.size;
+        out.mappedData = mapPersistentLocked(out.memory, memoryTypeIndex, request.size);
         dedicatedAllocationCount_.fetch_add(1, std::memory_order_relaxed);
-        bytesAllocated_.fetch_add(requestSize, std::memory_order_relaxed);
-        allocationCountByResourceClass_[resourceClassIndex(resourceClass)].fetch_add(1, std::memory_order_relaxed);
-        bytesAllocatedByResourceClass_[resourceClassIndex(resourceClass)].fetch_add(requestSize, std::memory_order_relaxed);
-        bytesAllocatedByLifetimeClass_[lifetimeClassIndex(lifetimeClass)].fetch_add(requestSize, std::memory_order_relaxed);
-        return out;
+    }
+    else {
+        const auto range = allocateRangeLocked(poolKey, memoryTypeIndex, request.allocateFlags, request.size,
+            request.alignment, request.priority, finalAttempt, shortfall);
+        if (!range.has_value()) {
+            return std::nullopt;
+        }
+        const auto& [blockIndex, blockRange] = *range;
+        const MemoryBlock& block = pooledBlocks_[poolKey][blockIndex];
+        out.memory = block.memory;
+        out.offset = blockRange.offset;
+        out.memorySize = block.size;
+        out.mappedData = block.mapped != nullptr ? static_cast<std::byte*>(block.mapped) + blockRange.offset : nullptr;
+        out.blockIndex = blockIndex;
+        out.blockNode = blockRange.node;
+        pooledAllocationCount_.fetch_add(1, std::memory_order_relaxed);
     }
 
-    auto& blocks = pooledBlocks_[poolKey];
-    for (auto& block : blocks) {
-        for (size_t i = 0; i < block.freeRanges.size(); ++i) {
-            auto range = block.freeRanges[i];
-            const VkDeviceSize alignedOffset = alignUp(range.offset, requestAlign);
-            const VkDeviceSize endOffset = alignedOffset + requestSize;
-            if (endOffset > (range.offset + range.size)) {
-                continue;
-            }
+    allocationCount_.fetch_add(1, std::memory_order_relaxed);
+    bytesAllocated_.fetch_add(request.size, std::memory_order_relaxed);
+    allocationCountByResourceClass_[resourceClassIndex(request.resourceClass)].fetch_add(1, std::memory_order_relaxed);
+    bytesAllocatedByResourceClass_[resourceClassIndex(request.resourceClass)].fetch_add(request.size, std::memory_order_relaxed);
+    bytesAllocatedByLifetimeClass_[lifetimeClassIndex(request.lifetimeClass)].fetch_add(request.size, std::memory_order_relaxed);
+    return out;
+}
 
-            block.freeRanges.erase(block.freeRanges.begin() + static_cast<std::ptrdiff_t>(i));
-            if (alignedOffset > range.offset) {
-                block.freeRanges.push_back({ range.offset, alignedOffset - range.offset });
-            }
-            if (endOffset < (range.offset + range.size)) {
-                block.freeRanges.push_back({ endOffset, (range.offset + range.size) - endOffset });
-            }
-            mergeFreeRanges(block.freeRanges);
-
-            allocationCount_.fetch_add(1, std::memory_order_relaxed);
-            pooledAllocationCount_.fetch_add(1, std::memory_order_relaxed);
-            bytesAllocated_.fetch_add(requestSize, std::memory_order_relaxed);
-            allocationCountByResourceClass_[resourceClassIndex(resourceClass)].fetch_add(1, std::memory_order_relaxed);
-            bytesAllocatedByResourceClass_[resourceClassIndex(resourceClass)].fetch_add(requestSize, std::memory_order_relaxed);
-            bytesAllocatedByLifetimeClass_[lifetimeClassIndex(lifetimeClass)].fetch_add(requestSize, std::memory_order_relaxed);
-            return Allocation{
-                .memory = block.memory,
-                .offset = alignedOffset,
-                .size = requestSize,
-                .memoryTypeIndex = memoryTypeIndex,
-                .poolKey = poolKey,
-                .allocateFlags = allocateFlags,
-                .dedicated = false,
-                .resourceClass = resourceClass,
-                .lifetimeClass = lifetimeClass
-            };
+std::optional<std::pair<uint32_t, TlsfAllocator::Allocation>> GpuAllocator::allocateRangeLocked(uint64_t poolKey,
+    uint32_t memoryTypeIndex, VkMemoryAllocateFlags allocateFlags, VkDeviceSize size, VkDeviceSize alignment,
+    Priority priority, bool finalAttempt, Shortfall& shortfall)
+{
+    // Blocks are never erased before reset(), only released in place, so an index stays valid
+    // for the allocation's lifetime.
+    auto& blocks = pooledBlocks_[poolKey];
+    for (uint32_t blockIndex = 0; blockIndex < blocks.size(); ++blockIndex) {
+        if (blocks[blockIndex].memory == VK_NULL_HANDLE || blocks[blockIndex].evacuating) {
+            continue;
+        }
+        if (auto range = blocks[blockIndex].ranges.allocate(size, alignment)) {
+            return std::pair{ blockIndex, *range };
         }
     }
 
-    MemoryBlock& newBlock = createPooledBlock(memoryTypeIndex, allocateFlags, std::max(defaultPoolBlockSize_, requestSize + requestAlign));
-    const VkDeviceSize alignedOffset = alignUp(0, requestAlign);
-    const VkDeviceSize endOffset = alignedOffset + requestSize;
-    newBlock.freeRanges.clear();
-    if (endOffset < newBlock.size) {
-        newBlock.freeRanges.push_back({ endOffset, newBlock.size - endOffset });
+    const std::optional<uint32_t> created = createPooledBlockLocked(poolKey, memoryTypeIndex, allocateFlags,
+        size + alignment, priority, finalAttempt, shortfall);
+    if (!created.has_value()) {
+        return std::nullopt;
+    }
+    auto range = pooledBlocks_[poolKey][*created].ranges.allocate(size, alignment);
+    if (!range.has_value()) {
+        throw std::runtime_error("GpuAllocator: fresh pooled block cannot fit the request");
     }
+    return std::pair{ *created, *range };
+}
 
-    allocationCount_.fetch_add(1, std::memory_order_relaxed);
-    pooledAllocationCount_.fetch_add(1, std::memory_order_relaxed);
-    bytesAllocated_.fetch_add(requestSize, std::memory_order_relaxed);
-    allocationCountByResourceClass_[resourceClassIndex(resourceClass)].fetch_add(1, std::memory_order_relaxed);
-    bytesAllocatedByResourceClass_[resourceClassIndex(resourceClass)].fetch_add(requestSize, std::memory_order_relaxed);
-    bytesAllocatedByLifetimeClass_[lifetimeClassIndex(lifetimeClass)].fetch_add(requestSize, std::memory_order_relaxed);
+size_t GpuAllocator::slabStatSlot(ResourceClass resourceClass, LifetimeClass lifetimeClass) noexcept
+{
+    return resourceClassIndex(resourceClass) * 2 + lifetimeClassIndex(lifetimeClass);
+}
+
+std::optional<GpuAllocator::Allocation> GpuAllocator::tryAllocateSlab(const Request& request, uint32_t memoryTypeBits,
+    VkMemoryPropertyFlags properties)
+{
+    const std::optional<uint32_t> sizeClass = SmallSlabs::classFor(request.size, request.alignment);
+    if (request.dedicated || !sizeClass.has_value() || !slabs_.valid()) {
+        return std::nullopt;
+    }
+    // The locked path reports these.
+    if ((request.allocateFlags & VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT) != 0 && !bufferDeviceAddressEnabled_) {
+        return std::nullopt;
+    }
+    // memProps_ only changes in reset(), so the lookup needs no lock.
+    const uint32_t memoryTypeIndex = findMemoryTypeLocked(memoryTypeBits, properties);
+    if (memoryTypeIndex == UINT32_MAX) {
+        return std::nullopt;
+    }
+
+    const Tiling placement = bufferImageGranularity_ > 1 ? request.tiling : Tiling::Linear;
+    const uint64_t poolKey = makePoolKey(memoryTypeIndex, request.allocateFlags, placement, request.pool);
+    const auto slot = slabs_.allocate(poolKey, *sizeClass, slabStatSlot(request.resourceClass, request.lifetimeClass), request.size);
+    if (!slot.has_value()) {
+        return std::nullopt;
+    }
+    const SlabMemory& memory = slot->slab->payload;
     return Allocation{
-        .memory = newBlock.memory,
-        .offset = alignedOffset,
-        .size = requestSize,
+        .memory = memory.memory,
+        .offset = slot->offset,
+        .size = request.size,
         .memoryTypeIndex = memoryTypeIndex,
         .poolKey = poolKey,
-        .allocateFlags = allocateFlags,
-        .dedicated = false,
-        .resourceClass = resourceClass,
-        .lifetimeClass = lifetimeClass
+        .allocateFlags = request.allocateFlags,
+        .resourceClass = request.resourceClass,
+        .lifetimeClass = request.lifetimeClass,
+        .pool = request.pool,
+        .tiling = request.tiling,
+        .priority = request.priority,
+        .mappedData = memory.blockMapped != nullptr ? static_cast<std::byte*>(memory.blockMapped) + slot->offset : nullptr,
+        .memorySize = memory.blockSize,
+        .blockIndex = memory.blockIndex,
+        .blockNode = memory.blockNode,
+        .slab = slot->slab
+    };
+}
+
+std::optional<GpuAllocator::SmallSlabs::AcquiredSlab> GpuAllocator::acquireSlab(uint64_t poolKey, VkDeviceSize size, VkDeviceSize alignment)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!valid()) {
+        return std::nullopt;
+    }
+    // Slabs never push a heap over budget; the locked path retries with eviction instead.
+    const PoolStats pool = describePoolKey(poolKey);
+    Shortfall shortfall{};
+    const auto range = allocateRangeLocked(poolKey, pool.memoryTypeIndex, pool.allocateFlags, size, alignment,
+        Priority::Normal, false, shortfall);
+    if (!range.has_value()) {
+        return std::nullopt;
+    }
+    const auto& [blockIndex, blockRange] = *range;
+    const MemoryBlock& block = pooledBlocks_[poolKey][blockIndex];
+    return SmallSlabs::AcquiredSlab{
+        .offset = blockRange.offset,
+        .payload = SlabMemory{
+            .memory = block.memory,
+            .blockMapped = block.mapped,
+            .blockSize = block.size,
+            .blockIndex = blockIndex,
+            .blockNode = blockRange.node }
     };
 }
 
+void GpuAllocator::releaseSlab(uint64_t poolKey, const SmallSlabs::Slab& slab) noexcept
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto it = pooledBlocks_.find(poolKey);
+    if (it == pooledBlocks_.end() || slab.payload.blockIndex >= it->second.size()) {
+        return;
+    }
+    MemoryBlock& block = it->second[slab.payload.blockIndex];
+    if (block.memory == slab.payload.memory) {
+        block.ranges.free(slab.payload.blockNode);
+    }
+}
+
 void GpuAllocator::free(const Allocation& allocation) noexcept
 {
+    traceFree(allocation);
+    if (allocation.slab != nullptr) {
+        if (slabs_.valid()) {
+            slabs_.free(SmallSlabs::Slot{ allocation.slab, allocation.offset },
+                slabStatSlot(allocation.resourceClass, allocation.lifetimeClass), allocation.size);
+        }
+        return;
+    }
+
     std::lock_guard<std::mutex> lock(mutex_);
     if (!valid() || allocation.memory == VK_NULL_HANDLE) {
         return;
     }
 
     if (allocation.dedicated) {
-        vkFreeMemory(device_, allocation.memory, nullptr);
+        freeMemoryLocked(allocation.memory, allocation.memoryTypeIndex, allocation.size);
         freeCount_.fetch_add(1, std::memory_order_relaxed);
         bytesFreed_.fetch_add(allocation.size, std::memory_order_relaxed);
         bytesFreedByResourceClass_[resourceClassIndex(allocation.resourceClass)].fetch_add(allocation.size, std::memory_order_relaxed);
@@ -338,27 +540,297 @@ void GpuAllocator::free(const Allocation& allocation) noexcept
         return;
     }
 
-    auto it = pooledBlocks_.find(allocation.poolKey);
-    if (it == pooledBlocks_.end()) {
+    MemoryBlock* block = findBlockLocked(allocation);
+    if (block == nullptr) {
         return;
     }
+    block->ranges.free(allocation.blockNode);
+    freeCount_.fetch_add(1, std::memory_order_relaxed);
+    bytesFreed_.fetch_add(allocation.size, std::memory_order_relaxed);
+    bytesFreedByResourceClass_[resourceClassIndex(allocation.resourceClass)].fetch_add(allocation.size, std::memory_order_relaxed);
+    bytesFreedByLifetimeClass_[lifetimeClassIndex(allocation.lifetimeClass)].fetch_add(allocation.size, std::memory_order_relaxed);
+}
+
+GpuAllocator::MemoryBlock* GpuAllocator::findBlockLocked(const Allocation& allocation) noexcept
+{
+    auto it = pooledBlocks_.find(allocation.poolKey);
+    if (it == pooledBlocks_.end() || allocation.blockIndex >= it->second.size()) {
+        return nullptr;
+    }
+    MemoryBlock& block = it->second[allocation.blockIndex];
+    return block.memory == allocation.memory ? &block : nullptr;
+}
 
-    for (auto& block : it->second) {
-        if (block.memory != allocation.memory) {
+VkResult GpuAllocator::map(const Allocation& allocation, void** outData) const noexcept
+{
+    // Host-visible memory is mapped for as long as it exists, so there is nothing to call here.
+    *outData = allocation.mappedData;
+    return allocation.mappedData != nullptr ? VK_SUCCESS : VK_ERROR_MEMORY_MAP_FAILED;
+}
+
+VkResult GpuAllocator::flush(std::span<const MappedRange> ranges) const
+{
+    std::vector<VkMappedMemoryRange> vkRanges = buildMappedRanges(ranges);
+    if (vkRanges.empty()) {
+        return VK_SUCCESS;
+    }
+    return vkFlushMappedMemoryRanges(device_, static_cast<uint32_t>(vkRanges.size()), vkRanges.data());
+}
+
+VkResult GpuAllocator::invalidate(std::span<const MappedRange> ranges) const
+{
+    std::vector<VkMappedMemoryRange> vkRanges = buildMappedRanges(ranges);
+    if (vkRanges.empty()) {
+        return VK_SUCCESS;
+    }
+    return vkInvalidateMappedMemoryRanges(device_, static_cast<uint32_t>(vkRanges.size()), vkRanges.data());
+}
+
+std::vector<VkMappedMemoryRange> GpuAllocator::buildMappedRanges(std::span<const MappedRange> ranges) const
+{
+    const VkDeviceSize atom = nonCoherentAtomSize_;
+    std::vector<VkMappedMemoryRange> out{};
+    out.reserve(ranges.size());
+    for (const MappedRange& range : ranges) {
+        const Allocation* allocation = range.allocation;
+        if (allocation == nullptr || allocation->mappedData == nullptr || range.offset >= allocation->size) {
             continue;
         }
-        block.freeRanges.push_back({ allocation.offset, allocation.size });
-        mergeFreeRanges(block.freeRanges);
-        freeCount_.fetch_add(1, std::memory_order_relaxed);
-        bytesFreed_.fetch_add(allocation.size, std::memory_order_relaxed);
-        bytesFreedByResourceClass_[resourceClassIndex(allocation.resourceClass)].fetch_add(allocation.size, std::memory_order_relaxed);
-        bytesFreedByLifetimeClass_[lifetimeClassIndex(allocation.lifetimeClass)].fetch_add(allocation.size, std::memory_order_relaxed);
+        if ((memProps_.memoryTypes[allocation->memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0) {
+            continue;
+        }
+        const VkDeviceSize size = std::min(range.size, allocation->size - range.offset);
+        const VkDeviceSize begin = allocation->offset + range.offset;
+        // Widening to whole atoms may reach into a neighbouring sub-allocation, which is harmless
+        // for flushes and invalidates of memory nobody else writes from the host concurrently.
+        const VkDeviceSize alignedBegin = begin - begin % atom;
+        const VkDeviceSize alignedEnd = std::min(allocation->memorySize, (begin + size + atom - 1) / atom * atom);
+
+        VkMappedMemoryRange vkRange{ VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE };
+        vkRange.memory = allocation->memory;
+        vkRange.offset = alignedBegin;
+        // The end of the memory object is the one place a range may end off an atom boundary.
+        vkRange.size = alignedEnd == allocation->memorySize ? VK_WHOLE_SIZE : alignedEnd - alignedBegin;
+        out.push_back(vkRange);
+    }
+
+    // One call per batch, with ranges in the same memory merged where they touch.
+    std::ranges::sort(out, [](const VkMappedMemoryRange& a, const VkMappedMemoryRange& b) {
+        return a.memory != b.memory ? a.memory < b.memory : a.offset < b.offset;
+    });
+    std::vector<VkMappedMemoryRange> merged{};
+    merged.reserve(out.size());
+    for (const VkMappedMemoryRange& range : out) {
+        if (!merged.empty() && merged.back().memory == range.memory) {
+            VkMappedMemoryRange& last = merged.back();
+            if (last.size == VK_WHOLE_SIZE) {
+                continue;
+            }
+            if (range.offset <= last.offset + last.size) {
+                last.size = range.size == VK_WHOLE_SIZE
+                    ? VK_WHOLE_SIZE
+                    : std::max(last.offset + last.size, range.offset + range.size) - last.offset;
+                continue;
+            }
+        }
+        merged.push_back(range);
+    }
+    return merged;
+}
+
+uint32_t GpuAllocator::beginEvacuation(double maxOccupancy)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    uint32_t marked = 0;
+    std::vector<std::pair<uint64_t, VkDeviceMemory>> evacuating{};
+    for (auto& [poolKey, blocks] : pooledBlocks_) {
+        std::vector<MemoryBlock*> sparse{};
+        VkDeviceSize spareBytes = 0;
+        for (MemoryBlock& block : blocks) {
+            if (block.memory == VK_NULL_HANDLE || block.evacuating) {
+                continue;
+            }
+            const VkDeviceSize liveBytes = block.size - block.ranges.freeBytes();
+            if (!block.ranges.empty() && static_cast<double>(liveBytes) < maxOccupancy * static_cast<double>(block.size)) {
+                sparse.push_back(&block);
+            }
+            else {
+                spareBytes += block.ranges.freeBytes();
+            }
+        }
+
+        // Emptiest first; a block is only evacuated if what is left can take its contents.
+        // Free bytes are not contiguous, so this is an estimate and moves may still fall back to
+        // a new block.
+        std::ranges::sort(sparse, {}, [](const MemoryBlock* block) { return block->size - block->ranges.freeBytes(); });
+        for (MemoryBlock* block : sparse) {
+            const VkDeviceSize liveBytes = block->size - block->ranges.freeBytes();
+            if (liveBytes <= spareBytes) {
+                block->evacuating = true;
+                spareBytes -= liveBytes;
+                ++marked;
+                evacuating.emplace_back(poolKey, block->memory);
+            }
+            else {
+                spareBytes += block->ranges.freeBytes();
+            }
+        }
+    }
+    lock.unlock();
+
+    // Slabs in those blocks stop serving, so their slots drain with everything else.
+    if (!evacuating.empty()) {
+        slabs_.retire([&evacuating](uint64_t poolKey, const SlabMemory& memory) {
+            return std::ranges::find(evacuating, std::pair{ poolKey, memory.memory }) != evacuating.end();
+        });
+    }
+    return marked;
+}
+
+void GpuAllocator::endEvacuation() noexcept
+{
+    slabs_.revive();
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& [_, blocks] : pooledBlocks_) {
+        for (MemoryBlock& block : blocks) {
+            block.evacuating = false;
+        }
+    }
+}
+
+bool GpuAllocator::isEvacuating(const Allocation& allocation) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (allocation.dedicated || allocation.memory == VK_NULL_HANDLE) {
+        return false;
+    }
+    const auto it = pooledBlocks_.find(allocation.poolKey);
+    if (it == pooledBlocks_.end() || allocation.blockIndex >= it->second.size()) {
+        return false;
+    }
+    const MemoryBlock& block = it->second[allocation.blockIndex];
+    return block.memory == allocation.memory && block.evacuating;
+}
+
+void GpuAllocator::trimSlabCaches() noexcept
+{
+    slabs_.trim();
+}
+
+uint32_t GpuAllocator::releaseEmptyBlocks() noexcept
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint32_t released = 0;
+    for (auto& [_, blocks] : pooledBlocks_) {
+        uint32_t liveBlocks = 0;
+        for (const MemoryBlock& block : blocks) {
+            liveBlocks += (block.memory != VK_NULL_HANDLE) ? 1u : 0u;
+        }
+        for (MemoryBlock& block : blocks) {
+            if (block.memory == VK_NULL_HANDLE || !block.ranges.empty()) {
+                continue;
+            }
+            if (!block.evacuating && liveBlocks <= 1) {
+                continue;
+            }
+            freeMemoryLocked(block.memory, block.memoryTypeIndex, block.size);
+            block = MemoryBlock{};
+            --liveBlocks;
+            ++released;
+        }
+    }
+    releasedBlockCount_.fetch_add(released, std::memory_order_relaxed);
+    return released;
+}
+
+void GpuAllocator::startTrace(const std::string& path)
+{
+    auto writer = std::make_unique<GpuAllocationTraceWriter>(path);
+    std::lock_guard<std::mutex> lock(traceMutex_);
+    trace_ = std::move(writer);
+    tracing_.store(true, std::memory_order_relaxed);
+}
+
+GpuAllocationTraceWriter::Stats GpuAllocator::stopTrace() noexcept
+{
+    std::unique_ptr<GpuAllocationTraceWriter> writer{};
+    {
+        std::lock_guard<std::mutex> lock(traceMutex_);
+        tracing_.store(false, std::memory_order_relaxed);
+        writer = std::move(trace_);
+    }
+    if (writer == nullptr) {
+        return {};
+    }
+    try {
+        writer->flush();
+    }
+    catch (const std::exception&) {
+        // Reported through bytesWritten falling short; the allocator itself is unaffected.
+    }
+    return writer->stats();
+}
+
+void GpuAllocator::traceAllocate(const Request& request, const Allocation& allocation)
+{
+    if (!tracing_.load(std::memory_order_relaxed)) {
+        return;
+    }
+    GpuAllocationEvent event{};
+    event.size = request.size;
+    event.alignment = request.alignment;
+    event.memoryTypeIndex = static_cast<uint8_t>(allocation.memoryTypeIndex);
+    event.pool = static_cast<uint8_t>(allocation.pool);
+    if (request.resourceClass == ResourceClass::Image) {
+        event.flags |= GpuAllocationEvent::Image;
+    }
+    if (allocation.dedicated) {
+        event.flags |= GpuAllocationEvent::Dedicated;
+    }
+    if (request.lifetimeClass == LifetimeClass::Transient) {
+        event.flags |= GpuAllocationEvent::Transient;
+    }
+    if (request.tiling == Tiling::Optimal) {
+        event.flags |= GpuAllocationEvent::OptimalTiling;
+    }
+
+    std::lock_guard<std::mutex> lock(traceMutex_);
+    if (trace_ == nullptr) {
+        return;
+    }
+    try {
+        trace_->recordAllocate(reinterpret_cast<uint64_t>(allocation.memory), allocation.offset, event);
+    }
+    catch (const std::exception&) {
+        // A failing trace file stops the trace, not the allocation.
+        tracing_.store(false, std::memory_order_relaxed);
+        trace_.reset();
+    }
+}
+
+void GpuAllocator::traceFree(const Allocation& allocation) noexcept
+{
+    if (!tracing_.load(std::memory_order_relaxed) || allocation.memory == VK_NULL_HANDLE) {
         return;
     }
+    std::lock_guard<std::mutex> lock(traceMutex_);
+    if (trace_ == nullptr) {
+        return;
+    }
+    try {
+        trace_->recordFree(reinterpret_cast<uint64_t>(allocation.memory), allocation.offset);
+    }
+    catch (const std::exception&) {
+        tracing_.store(false, std::memory_order_relaxed);
+        trace_.reset();
+    }
 }
 
 void GpuAllocator::reset() noexcept
 {
+    (void)stopTrace();
+    // Outstanding slab allocations die with their blocks; their free() becomes a no-op.
+    slabs_ = SmallSlabs{};
     std::lock_guard<std::mutex> lock(mutex_);
     for (auto& [_, blocks] : pooledBlocks_) {
         for (auto& block : blocks) {
@@ -374,7 +846,10 @@ void GpuAllocator::reset() noexcept
     physicalDevice_ = VK_NULL_HANDLE;
     memProps_ = VkPhysicalDeviceMemoryProperties{};
     bufferDeviceAddressEnabled_ = false;
+    memoryBudgetEnabled_ = false;
     nonCoherentAtomSize_ = 1;
+    bufferImageGranularity_ = 1;
+    heaps_ = {};
 
     allocationCount_.store(0, std::memory_order_relaxed);
     freeCount_.store(0, std::memory_order_relaxed);
@@ -382,6 +857,10 @@ void GpuAllocator::reset() noexcept
     bytesFreed_.store(0, std::memory_order_relaxed);
     dedicatedAllocationCount_.store(0, std::memory_order_relaxed);
     pooledAllocationCount_.store(0, std::memory_order_relaxed);
+    releasedBlockCount_.store(0, std::memory_order_relaxed);
+    evictionRequestCount_.store(0, std::memory_order_relaxed);
+    fallbackAllocationCount_.store(0, std::memory_order_relaxed);
+    outOfMemoryCount_.store(0, std::memory_order_relaxed);
     for (size_t i = 0; i < bytesAllocatedByResourceClass_.size(); ++i) {
         bytesAllocatedByResourceClass_[i].store(0, std::memory_order_relaxed);
         bytesFreedByResourceClass_[i].store(0, std::memory_order_relaxed);
@@ -393,38 +872,82 @@ void GpuAllocator::reset() noexcept
 
 GpuAllocator::Telemetry GpuAllocator::telemetry() const
 {
+    // Before mutex_, which the slab cache's lock must not nest inside.
+    const SmallSlabs::Stats slabStats = slabs_.stats();
     std::lock_guard<std::mutex> lock(mutex_);
 
     uint32_t poolCount = 0;
     uint64_t freeBytes = 0;
     uint64_t totalBytes = 0;
-    for (const auto& [_, blocks] : pooledBlocks_) {
-        poolCount += static_cast<uint32_t>(blocks.size());
+    uint64_t largestFreeRange = 0;
+    uint32_t freeRangeCount = 0;
+    uint32_t evacuatingBlockCount = 0;
+    std::vector<PoolStats> pools{};
+    pools.reserve(pooledBlocks_.size());
+    for (const auto& [poolKey, blocks] : pooledBlocks_) {
+        PoolStats stats = describePoolKey(poolKey);
         for (const auto& block : blocks) {
-            totalBytes += block.size;
-            for (const auto& range : block.freeRanges) {
-                freeBytes += range.size;
+            if (block.memory == VK_NULL_HANDLE) {
+                continue;
             }
+            ++stats.blockCount;
+            stats.allocationCount += block.ranges.allocationCount();
+            stats.totalBytes += block.size;
+            stats.freeBytes += block.ranges.freeBytes();
+            stats.largestFreeRange = std::max(stats.largestFreeRange, block.ranges.largestFreeRange());
+            ++poolCount;
+            evacuatingBlockCount += block.evacuating ? 1u : 0u;
+            totalBytes += block.size;
+            freeBytes += block.ranges.freeBytes();
+            freeRangeCount += block.ranges.freeRangeCount();
+            largestFreeRange = std::max(largestFreeRange, block.ranges.largestFreeRange());
+        }
+        if (stats.blockCount > 0) {
+            pools.push_back(stats);
         }
     }
 
-    const uint64_t allocated = bytesAllocated_.load(std::memory_order_relaxed);
-    const uint64_t freed = bytesFreed_.load(std::memory_order_relaxed);
+    uint64_t slabAllocations = 0;
+    uint64_t slabFrees = 0;
+    uint64_t slabBytesAllocated = 0;
+    uint64_t slabBytesFreed = 0;
+    for (size_t i = 0; i < SmallSlabs::kStatSlots; ++i) {
+        slabAllocations += slabStats.allocations[i];
+        slabFrees += slabStats.frees[i];
+        slabBytesAllocated += slabStats.bytesAllocated[i];
+        slabBytesFreed += slabStats.bytesFreed[i];
+    }
+    const uint64_t allocated = bytesAllocated_.load(std::memory_order_relaxed) + slabBytesAllocated;
+    const uint64_t freed = bytesFreed_.load(std::memory_order_relaxed) + slabBytesFreed;
     const uint64_t inUse = (allocated >= freed) ? (allocated - freed) : 0;
     const double fragmentationRatio = totalBytes == 0 ? 0.0 : static_cast<double>(freeBytes) / static_cast<double>(totalBytes);
 
     Telemetry telemetry{};
-    telemetry.allocationCount = allocationCount_.load(std::memory_order_relaxed);
-    telemetry.freeCount = freeCount_.load(std::memory_order_relaxed);
+    telemetry.allocationCount = allocationCount_.load(std::memory_order_relaxed) + slabAllocations;
+    telemetry.freeCount = freeCount_.load(std::memory_order_relaxed) + slabFrees;
     telemetry.bytesAllocated = allocated;
     telemetry.bytesFreed = freed;
     telemetry.bytesInUse = inUse;
     telemetry.dedicatedAllocationCount = dedicatedAllocationCount_.load(std::memory_order_relaxed);
-    telemetry.pooledAllocationCount = pooledAllocationCount_.load(std::memory_order_relaxed);
+    telemetry.pooledAllocationCount = pooledAllocationCount_.load(std::memory_order_relaxed) + slabAllocations;
     telemetry.poolCount = poolCount;
     telemetry.freeBytes = freeBytes;
     telemetry.totalBytes = totalBytes;
+    telemetry.largestFreeRange = largestFreeRange;
+    telemetry.freeRangeCount = freeRangeCount;
+    telemetry.evacuatingBlockCount = evacuatingBlockCount;
+    telemetry.releasedBlockCount = releasedBlockCount_.load(std::memory_order_relaxed);
+    telemetry.evictionRequestCount = evictionRequestCount_.load(std::memory_order_relaxed);
+    telemetry.fallbackAllocationCount = fallbackAllocationCount_.load(std::memory_order_relaxed);
+    telemetry.outOfMemoryCount = outOfMemoryCount_.load(std::memory_order_relaxed);
     telemetry.fragmentationRatio = fragmentationRatio;
+    telemetry.bufferImageGranularity = bufferImageGranularity_;
+    telemetry.pools = std::move(pools);
+    telemetry.slabAllocationCount = slabAllocations;
+    telemetry.slabCount = slabStats.slabCount;
+    telemetry.slabBytes = slabStats.slabBytes;
+    telemetry.slabLockCount = slabStats.refills + slabStats.spills;
+    telemetry.slabThreadCount = slabStats.threadCount;
 
     for (size_t i = 0; i < telemetry.bytesAllocatedByResourceClass.size(); ++i) {
         telemetry.bytesAllocatedByResourceClass[i] = bytesAllocatedByResourceClass_[i].load(std::memory_order_relaxed);
@@ -433,6 +956,153 @@ GpuAllocator::Telemetry GpuAllocator::telemetry() const
         telemetry.bytesAllocatedByLifetimeClass[i] = bytesAllocatedByLifetimeClass_[i].load(std::memory_order_relaxed);
         telemetry.bytesFreedByLifetimeClass[i] = bytesFreedByLifetimeClass_[i].load(std::memory_order_relaxed);
     }
+    // Stat slots are resource class * 2 + lifetime class.
+    for (size_t slot = 0; slot < SmallSlabs::kStatSlots; ++slot) {
+        telemetry.allocationCountByResourceClass[slot / 2] += slabStats.allocations[slot];
+        telemetry.bytesAllocatedByResourceClass[slot / 2] += slabStats.bytesAllocated[slot];
+        telemetry.bytesFreedByResourceClass[slot / 2] += slabStats.bytesFreed[slot];
+        telemetry.bytesAllocatedByLifetimeClass[slot % 2] += slabStats.bytesAllocated[slot];
+        telemetry.bytesFreedByLifetimeClass[slot % 2] += slabStats.bytesFreed[slot];
+    }
 
     return telemetry;
 }
+
+VkDeviceSize GpuAllocator::projectedUsageLocked(uint32_t heapIndex) const noexcept
+{
+    // The driver's usage only changes on refresh; this allocator's own traffic since is added on top.
+    const HeapState& heap = heaps_[heapIndex];
+    const VkDeviceSize projected = heap.usageAtRefresh + heap.allocatorBytes;
+    return projected > heap.allocatorBytesAtRefresh ? projected - heap.allocatorBytesAtRefresh : 0;
+}
+
+void GpuAllocator::refreshBudgetLocked()
+{
+    VkPhysicalDeviceMemoryBudgetPropertiesEXT budgetProps{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT };
+    if (memoryBudgetEnabled_) {
+        VkPhysicalDeviceMemoryProperties2 props2{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2 };
+        props2.pNext = &budgetProps;
+        vkGetPhysicalDeviceMemoryProperties2(physicalDevice_, &props2);
+    }
+
+    for (uint32_t i = 0; i < memProps_.memoryHeapCount; ++i) {
+        HeapState& heap = heaps_[i];
+        heap.allocatorBytesAtRefresh = heap.allocatorBytes;
+        if (memoryBudgetEnabled_ && budgetProps.heapBudget[i] != 0) {
+            heap.budget = budgetProps.heapBudget[i];
+            heap.usageAtRefresh = budgetProps.heapUsage[i];
+            continue;
+        }
+        // Without the extension other processes are invisible; leave them headroom, more of it
+        // in system memory, which the OS shares with everything else.
+        const VkMemoryHeap& memoryHeap = memProps_.memoryHeaps[i];
+        const bool deviceLocal = (memoryHeap.flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+        heap.budget = deviceLocal ? memoryHeap.size / 5 * 4 : memoryHeap.size / 2;
+        heap.usageAtRefresh = heap.allocatorBytes;
+    }
+}
+
+void GpuAllocator::refreshBudget()
+{
+    std::vector<std::pair<uint32_t, VkDeviceSize>> pressure{};
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!valid()) {
+            return;
+        }
+        refreshBudgetLocked();
+        for (uint32_t i = 0; i < memProps_.memoryHeapCount; ++i) {
+            const VkDeviceSize usage = projectedUsageLocked(i);
+            const auto threshold = static_cast<VkDeviceSize>(static_cast<double>(heaps_[i].budget) * kEvictionThreshold);
+            if (usage > threshold) {
+                pressure.emplace_back(i, usage - threshold);
+            }
+        }
+    }
+
+    // Slabs whose slots all came back are free block space the next releaseEmptyBlocks() can
+    // hand to the driver. Outside mutex_, which the slab cache's lock must not nest inside.
+    if (!pressure.empty()) {
+        slabs_.trim();
+    }
+    for (const auto& [heapIndex, bytes] : pressure) {
+        evictionRequestCount_.fetch_add(1, std::memory_order_relaxed);
+        requestEviction(heapIndex, bytes, Priority::High);
+    }
+}
+
+std::vector<GpuAllocator::HeapBudget> GpuAllocator::heapBudgets() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<HeapBudget> out{};
+    out.reserve(memProps_.memoryHeapCount);
+    for (uint32_t i = 0; i < memProps_.memoryHeapCount; ++i) {
+        out.push_back(HeapBudget{
+            .size = memProps_.memoryHeaps[i].size,
+            .budget = heaps_[i].budget,
+            .usage = projectedUsageLocked(i),
+            .allocatorBytes = heaps_[i].allocatorBytes,
+            .deviceLocal = (memProps_.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0
+        });
+    }
+    return out;
+}
+
+GpuAllocator::EvictionRegistration GpuAllocator::addEvictionCallback(Priority priority, EvictionCallback callback)
+{
+    if (!callback) {
+        throw std::runtime_error("GpuAllocator::addEvictionCallback: callback is empty");
+    }
+    std::lock_guard<std::mutex> lock(evictionMutex_);
+    const uint32_t id = nextEvictorId_++;
+    evictors_.push_back(Evictor{ .id = id, .priority = priority, .callback = std::move(callback) });
+    return EvictionRegistration(this, id);
+}
+
+void GpuAllocator::removeEvictionCallback(uint32_t id) noexcept
+{
+    std::lock_guard<std::mutex> lock(evictionMutex_);
+    std::erase_if(evictors_, [id](const Evictor& evictor) { return evictor.id == id; });
+}
+
+void GpuAllocator::requestEviction(uint32_t heapIndex, VkDeviceSize bytes, Priority requester)
+{
+    std::vector<Evictor> eligible{};
+    {
+        std::lock_guard<std::mutex> lock(evictionMutex_);
+        for (const Evictor& evictor : evictors_) {
+            if (evictor.priority < requester) {
+                eligible.push_back(evictor);
+            }
+        }
+    }
+    std::ranges::stable_sort(eligible, {}, &Evictor::priority);
+    for (const Evictor& evictor : eligible) {
+        evictor.callback(heapIndex, bytes);
+    }
+}
+
+GpuAllocator::EvictionRegistration::EvictionRegistration(EvictionRegistration&& other) noexcept
+    : allocator_(std::exchange(other.allocator_, nullptr))
+    , id_(std::exchange(other.id_, 0))
+{
+}
+
+GpuAllocator::EvictionRegistration& GpuAllocator::EvictionRegistration::operator=(EvictionRegistration&& other) noexcept
+{
+    if (this != &other) {
+        reset();
+        allocator_ = std::exchange(other.allocator_, nullptr);
+        id_ = std::exchange(other.id_, 0);
+    }
+    return *this;
+}
+
+void GpuAllocator::EvictionRegistration::reset() noexcept
+{
+    if (allocator_ != nullptr) {
+        allocator_->removeEvictionCallback(id_);
+        allocator_ = nullptr;
+        id_ = 0;
+    }
+}
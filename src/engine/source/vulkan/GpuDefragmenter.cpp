@@ -0,0 +1,318 @@
+#include "GpuDefragmenter.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+VkImageMemoryBarrier makeImageBarrier(VkImage image, VkImageAspectFlags aspect, uint32_t mipLevels, uint32_t arrayLayers,
+    VkImageLayout oldLayout, VkImageLayout newLayout, VkAccessFlags srcAccess, VkAccessFlags dstAccess)
+{
+    VkImageMemoryBarrier barrier{ VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
+    barrier.srcAccessMask = srcAccess;
+    barrier.dstAccessMask = dstAccess;
+    barrier.oldLayout = oldLayout;
+    barrier.newLayout = newLayout;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = image;
+    barrier.subresourceRange = { aspect, 0, mipLevels, 0, arrayLayers };
+    return barrier;
+}
+}
+
+GpuDefragmenter::ImageRegistration::ImageRegistration(ImageRegistration&& other) noexcept
+    : defragmenter_(std::exchange(other.defragmenter_, nullptr))
+    , handle_(std::exchange(other.handle_, 0))
+{
+}
+
+GpuDefragmenter::ImageRegistration& GpuDefragmenter::ImageRegistration::operator=(ImageRegistration&& other) noexcept
+{
+    if (this != &other) {
+        reset();
+        defragmenter_ = std::exchange(other.defragmenter_, nullptr);
+        handle_ = std::exchange(other.handle_, 0);
+    }
+    return *this;
+}
+
+void GpuDefragmenter::ImageRegistration::reset() noexcept
+{
+    if (defragmenter_ != nullptr) {
+        defragmenter_->unregisterImage(handle_);
+        defragmenter_ = nullptr;
+        handle_ = 0;
+    }
+}
+
+GpuDefragmenter::GpuDefragmenter(const Config& config)
+    : allocator_(config.allocator)
+    , framesInFlight_(config.framesInFlight)
+    , maxOccupancy_(config.maxOccupancy)
+    , bytesPerFrame_(config.bytesPerFrame)
+    , planInterval_(config.planInterval)
+{
+    if (allocator_ == nullptr || !allocator_->valid()) {
+        throw std::runtime_error("GpuDefragmenter: allocator is null");
+    }
+    if (framesInFlight_ == 0) {
+        throw std::runtime_error("GpuDefragmenter: framesInFlight must be > 0");
+    }
+    if (maxOccupancy_ <= 0.0 || maxOccupancy_ > 1.0) {
+        throw std::runtime_error("GpuDefragmenter: maxOccupancy must be in (0, 1]");
+    }
+}
+
+GpuDefragmenter::Handle GpuDefragmenter::registerBuffer(VulkanBuffer& buffer, Contents contents, RelocatedFn onRelocated)
+{
+    const Handle handle = nextHandle_++;
+    entries_.emplace(handle, Entry{ .buffer = &buffer, .contents = contents, .onRelocated = std::move(onRelocated) });
+    return handle;
+}
+
+void GpuDefragmenter::unregisterBuffer(Handle handle) noexcept
+{
+    entries_.erase(handle);
+}
+
+GpuDefragmenter::ImageRegistration GpuDefragmenter::registerImage(VulkanImage& image, VkImageLayout layout,
+    ImageRelocatedFn onRelocated, VkImageAspectFlags aspect)
+{
+    const Handle handle = nextHandle_++;
+    imageEntries_.emplace(handle, ImageEntry{ .image = &image, .layout = layout, .aspect = aspect, .onRelocated = std::move(onRelocated) });
+    return ImageRegistration(this, handle);
+}
+
+void GpuDefragmenter::unregisterImage(Handle handle) noexcept
+{
+    imageEntries_.erase(handle);
+}
+
+void GpuDefragmenter::beginFrame()
+{
+    ++frame_;
+    std::erase_if(retired_, [this](const Retired& retired) { return retired.retireFrame <= frame_; });
+    stats_.retiringBuffers = static_cast<uint32_t>(retired_.size());
+
+    if (evacuating_ && !(drained_ && retired_.empty())) {
+        return;
+    }
+    // Also picks up blocks that emptied on their own, e.g. after a scene was unloaded.
+    stats_.releasedBlocks += allocator_->releaseEmptyBlocks();
+    if (evacuating_) {
+        allocator_->endEvacuation();
+        evacuating_ = false;
+        drained_ = false;
+    }
+}
+
+uint32_t GpuDefragmenter::step()
+{
+    if (drained_) {
+        return 0;
+    }
+    if (!evacuating_) {
+        if (frame_ < nextPlanFrame_) {
+            return 0;
+        }
+        nextPlanFrame_ = frame_ + planInterval_;
+        // Slabs that drained since the last plan go back to their blocks, so the occupancy
+        // below, and the next beginFrame()'s release of empty blocks, see them as free.
+        allocator_->trimSlabCaches();
+        if (allocator_->beginEvacuation(maxOccupancy_) == 0) {
+            return 0;
+        }
+        evacuating_ = true;
+        ++stats_.evacuations;
+    }
+
+    uint32_t moves = 0;
+    VkDeviceSize movedBytes = 0;
+    bool remaining = false;
+    for (auto& [_, entry] : entries_) {
+        if (!entry.buffer->valid() || !allocator_->isEvacuating(entry.buffer->gpuAllocation())) {
+            continue;
+        }
+        const MovePath path = movePath(entry);
+        if (path == MovePath::None) {
+            continue;
+        }
+        const VkDeviceSize size = entry.buffer->getSize();
+        if (moves > 0 && movedBytes + size > bytesPerFrame_) {
+            remaining = true;
+            break;
+        }
+        relocate(entry, path);
+        ++moves;
+        movedBytes += size;
+    }
+    for (auto& [_, entry] : imageEntries_) {
+        if (remaining) {
+            break;
+        }
+        const VulkanImage& image = *entry.image;
+        if (!image.valid() || !allocator_->isEvacuating(image.gpuAllocation())
+            || (image.createInfo().usage & VK_IMAGE_USAGE_TRANSFER_SRC_BIT) == 0) {
+            continue;
+        }
+        const VkDeviceSize size = image.gpuAllocation().size;
+        if (moves > 0 && movedBytes + size > bytesPerFrame_) {
+            remaining = true;
+            break;
+        }
+        if (!relocate(entry)) {
+            continue;
+        }
+        ++moves;
+        movedBytes += size;
+    }
+
+    // Mapped buffers may become movable later, but waiting for them would pin the blocks as
+    // evacuating indefinitely; they are retried by the next evacuation instead.
+    drained_ = !remaining;
+    return moves;
+}
+
+void GpuDefragmenter::recordCopies(VkCommandBuffer commandBuffer)
+{
+    if (pendingCopies_.empty() && pendingImageCopies_.empty()) {
+        return;
+    }
+
+    // Earlier submissions on this queue may still be writing the sources. Images also move into
+    // transfer layouts; the new ones have no contents to keep.
+    std::vector<VkImageMemoryBarrier> imageBarriers{};
+    imageBarriers.reserve(pendingImageCopies_.size() * 2);
+    for (const PendingImageCopy& copy : pendingImageCopies_) {
+        imageBarriers.push_back(makeImageBarrier(copy.source, copy.aspect, copy.mipLevels, copy.arrayLayers,
+            copy.layout, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_ACCESS_MEMORY_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT));
+        imageBarriers.push_back(makeImageBarrier(copy.destination, copy.aspect, copy.mipLevels, copy.arrayLayers,
+            VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 0, VK_ACCESS_TRANSFER_WRITE_BIT));
+    }
+    VkMemoryBarrier writeToCopy{ VK_STRUCTURE_TYPE_MEMORY_BARRIER };
+    writeToCopy.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
+    writeToCopy.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+        0, 1, &writeToCopy, 0, nullptr, static_cast<uint32_t>(imageBarriers.size()), imageBarriers.data());
+
+    for (const PendingCopy& copy : pendingCopies_) {
+        const VkBufferCopy region{ 0, 0, copy.size };
+        vkCmdCopyBuffer(commandBuffer, copy.source, copy.destination, 1, &region);
+    }
+    std::vector<VkImageCopy> regions{};
+    for (const PendingImageCopy& copy : pendingImageCopies_) {
+        regions.clear();
+        for (uint32_t level = 0; level < copy.mipLevels; ++level) {
+            VkImageCopy region{};
+            region.srcSubresource = { copy.aspect, level, 0, copy.arrayLayers };
+            region.dstSubresource = region.srcSubresource;
+            region.extent = { std::max(1U, copy.extent.width >> level), std::max(1U, copy.extent.height >> level),
+                std::max(1U, copy.extent.depth >> level) };
+            regions.push_back(region);
+        }
+        vkCmdCopyImage(commandBuffer, copy.source, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, copy.destination,
+            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, static_cast<uint32_t>(regions.size()), regions.data());
+    }
+
+    // Both images go back to the registered layout: the new one for the patched descriptors, the
+    // old one for anything recorded this frame before the owner's patch.
+    imageBarriers.clear();
+    for (const PendingImageCopy& copy : pendingImageCopies_) {
+        imageBarriers.push_back(makeImageBarrier(copy.source, copy.aspect, copy.mipLevels, copy.arrayLayers,
+            VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, copy.layout, 0, VK_ACCESS_MEMORY_READ_BIT));
+        imageBarriers.push_back(makeImageBarrier(copy.destination, copy.aspect, copy.mipLevels, copy.arrayLayers,
+            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, copy.layout, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_MEMORY_READ_BIT));
+    }
+    VkMemoryBarrier copyToUse{ VK_STRUCTURE_TYPE_MEMORY_BARRIER };
+    copyToUse.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    copyToUse.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+        0, 1, &copyToUse, 0, nullptr, static_cast<uint32_t>(imageBarriers.size()), imageBarriers.data());
+
+    pendingCopies_.clear();
+    pendingImageCopies_.clear();
+    stats_.pendingCopies = 0;
+}
+
+GpuDefragmenter::MovePath GpuDefragmenter::movePath(const Entry& entry) noexcept
+{
+    const VulkanBuffer& buffer = *entry.buffer;
+    if (buffer.mapped() != nullptr) {
+        return MovePath::None;
+    }
+    if (entry.contents == Contents::Discard) {
+        return MovePath::Rebind;
+    }
+    constexpr VkMemoryPropertyFlags hostCoherent = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+    if (buffer.gpuAllocation().pool == GpuAllocator::Pool::Upload && (buffer.memoryProperties() & hostCoherent) == hostCoherent) {
+        return MovePath::HostCopy;
+    }
+    if ((buffer.usage() & VK_BUFFER_USAGE_TRANSFER_SRC_BIT) != 0) {
+        return MovePath::GpuCopy;
+    }
+    return MovePath::None;
+}
+
+void GpuDefragmenter::relocate(Entry& entry, MovePath path)
+{
+    VulkanBuffer& source = *entry.buffer;
+    VulkanBuffer target = source.makeRelocationTarget(path == MovePath::GpuCopy ? VK_BUFFER_USAGE_TRANSFER_DST_BIT : 0);
+
+    if (path == MovePath::HostCopy) {
+        std::memcpy(target.map(), source.map(), static_cast<size_t>(source.getSize()));
+        target.unmap();
+        source.unmap();
+    }
+    else if (path == MovePath::GpuCopy) {
+        pendingCopies_.push_back(PendingCopy{ source.get(), target.get(), source.getSize() });
+        stats_.pendingCopies = static_cast<uint32_t>(pendingCopies_.size() + pendingImageCopies_.size());
+    }
+
+    const VkBuffer oldHandle = source.get();
+    stats_.relocatedBytes += source.getSize();
+    ++stats_.relocatedBuffers;
+    // The GPU may still read the old buffer from earlier frames, and a queued copy reads it
+    // this frame, so it outlives every frame in flight.
+    retired_.push_back(Retired{ .buffer = std::move(source), .retireFrame = frame_ + framesInFlight_ });
+    stats_.retiringBuffers = static_cast<uint32_t>(retired_.size());
+    source = std::move(target);
+
+    if (entry.onRelocated) {
+        entry.onRelocated(oldHandle, source.get());
+    }
+}
+
+bool GpuDefragmenter::relocate(ImageEntry& entry)
+{
+    VulkanImage& source = *entry.image;
+    VulkanImage target{};
+    try {
+        target = source.makeRelocationTarget(VK_IMAGE_USAGE_TRANSFER_DST_BIT);
+    }
+    catch (const GpuAllocator::OutOfMemoryError&) {
+        // Low priority images are refused while their heap is over budget; this one keeps its
+        // block alive until a later evacuation.
+        return false;
+    }
+
+    const VkImageCreateInfo& info = source.createInfo();
+    pendingImageCopies_.push_back(PendingImageCopy{ .source = source.get(), .destination = target.get(),
+        .layout = entry.layout, .aspect = entry.aspect, .extent = info.extent, .mipLevels = info.mipLevels,
+        .arrayLayers = info.arrayLayers });
+    stats_.pendingCopies = static_cast<uint32_t>(pendingCopies_.size() + pendingImageCopies_.size());
+
+    const VkImage oldHandle = source.get();
+    stats_.relocatedBytes += source.gpuAllocation().size;
+    ++stats_.relocatedImages;
+    // Read by the queued copy, and possibly by this frame's draws, so it outlives every frame in flight.
+    retired_.push_back(Retired{ .image = std::move(source), .retireFrame = frame_ + framesInFlight_ });
+    stats_.retiringBuffers = static_cast<uint32_t>(retired_.size());
+    source = std::move(target);
+
+    if (entry.onRelocated) {
+        entry.onRelocated(oldHandle, source.get());
+    }
+    return true;
+}
@@ -0,0 +1,252 @@
+#include "ReadbackService.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+// A multiple of every texel block size and of vkCmdCopyImageToBuffer's 4-byte offset rule.
+constexpr VkDeviceSize kSlotAlignment = 16;
+
+VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment) noexcept
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+}
+
+ReadbackService::ReadbackService(const Config& config)
+    : device_(config.device)
+    , queueFamilyIndex_(config.queueFamilyIndex)
+    , frameBytes_(alignUp(config.frameBytes, kSlotAlignment))
+{
+    if (device_ == VK_NULL_HANDLE || config.allocator == nullptr) {
+        throw std::runtime_error("ReadbackService: device/allocator is null");
+    }
+    if (queueFamilyIndex_ == VK_QUEUE_FAMILY_IGNORED) {
+        throw std::runtime_error("ReadbackService: queueFamilyIndex is not set");
+    }
+    if (config.framesInFlight == 0 || frameBytes_ == 0) {
+        throw std::runtime_error("ReadbackService: framesInFlight and frameBytes must be non-zero");
+    }
+
+    timeline_ = TimelineSemaphore(device_, 0);
+
+    const uint32_t slotCount = config.framesInFlight + 1;
+    const VkDeviceSize ringBytes = frameBytes_ * slotCount;
+    // Host reads of write-combined memory are uncached and slow; take HOST_CACHED where the device
+    // has it and pay for the explicit invalidation instead.
+    try {
+        ring_ = VulkanBuffer(*config.allocator, ringBytes, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT, false, VulkanBuffer::AllocationPolicy::Readback);
+        stats_.hostCached = true;
+    }
+    catch (const std::runtime_error&) {
+        ring_ = VulkanBuffer(*config.allocator, ringBytes, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, false, VulkanBuffer::AllocationPolicy::Readback);
+    }
+    ringData_ = static_cast<const uint8_t*>(ring_.map());
+    stats_.ringBytes = ring_.getSize();
+
+    slots_.resize(slotCount);
+    for (Slot& slot : slots_) {
+        auto pool = VulkanCommandPool::create(device_, queueFamilyIndex_);
+        if (!pool) {
+            vkutil::throwVkError("VulkanCommandPool::create", pool.error());
+        }
+        slot.pool = std::move(pool.value());
+        auto buffer = VulkanCommandBuffer::create(device_, slot.pool.get());
+        if (!buffer) {
+            vkutil::throwVkError("VulkanCommandBuffer::create", buffer.error());
+        }
+        slot.commandBuffer = std::move(buffer.value());
+    }
+}
+
+ReadbackService::~ReadbackService()
+{
+    if (submittedValue_ > 0) {
+        // Nothing useful can be done about a lost device here; the handles go away regardless.
+        (void)timeline_.wait(submittedValue_);
+    }
+}
+
+void ReadbackService::readBuffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size, Callback callback)
+{
+    if (buffer == VK_NULL_HANDLE || size == 0 || !callback) {
+        throw std::runtime_error("ReadbackService: readBuffer needs a buffer, a size and a callback");
+    }
+    enqueue(Request{ .buffer = buffer, .offset = offset, .size = size, .callback = std::move(callback) });
+}
+
+void ReadbackService::readImage(const ImageSource& source, Callback callback)
+{
+    if (source.image == VK_NULL_HANDLE || source.size == 0 || !callback) {
+        throw std::runtime_error("ReadbackService: readImage needs an image, a size and a callback");
+    }
+    if (source.layout != VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL && source.layout != VK_IMAGE_LAYOUT_GENERAL) {
+        throw std::runtime_error("ReadbackService: image sources must be in TRANSFER_SRC_OPTIMAL or GENERAL layout");
+    }
+    enqueue(Request{ .image = source, .size = source.size, .callback = std::move(callback) });
+}
+
+void ReadbackService::enqueue(Request request)
+{
+    if (request.size > frameBytes_) {
+        throw std::runtime_error("ReadbackService: request is larger than a ring slot");
+    }
+    request.frame = frame_;
+    pending_.push_back(std::move(request));
+    ++stats_.requests;
+    stats_.pendingRequests = static_cast<uint32_t>(pending_.size());
+}
+
+std::optional<ReadbackService::Batch> ReadbackService::beginBatch()
+{
+    if (openSlot_.has_value()) {
+        throw std::runtime_error("ReadbackService: the previous batch was not ended");
+    }
+    if (pending_.empty()) {
+        return std::nullopt;
+    }
+    Slot& slot = slots_[nextSlot_];
+    if (slot.value != 0) {
+        ++stats_.slotStalls;
+        return std::nullopt;
+    }
+
+    // The slot's previous batch has been delivered, so its command buffer is idle.
+    if (const VkResult res = vkResetCommandPool(device_, slot.pool.get(), 0); res != VK_SUCCESS) {
+        vkutil::throwVkError("vkResetCommandPool", res);
+    }
+    if (const auto begun = slot.commandBuffer.begin(); !begun) {
+        vkutil::throwVkError("vkBeginCommandBuffer", begun.error());
+    }
+
+    const VkDeviceSize slotBase = static_cast<VkDeviceSize>(nextSlot_) * frameBytes_;
+    slot.usedBytes = 0;
+    while (!pending_.empty() && alignUp(slot.usedBytes, kSlotAlignment) + pending_.front().size <= frameBytes_) {
+        Request request = std::move(pending_.front());
+        pending_.pop_front();
+        request.slotOffset = alignUp(slot.usedBytes, kSlotAlignment);
+        slot.usedBytes = request.slotOffset + request.size;
+
+        if (request.buffer != VK_NULL_HANDLE) {
+            const auto [it, inserted] = bufferIndex_.try_emplace(request.buffer, bufferCopies_.size());
+            if (inserted) {
+                bufferCopies_.push_back(BufferCopies{ .buffer = request.buffer });
+            }
+            bufferCopies_[it->second].regions.push_back(VkBufferCopy{ request.offset, slotBase + request.slotOffset, request.size });
+        }
+        else {
+            VkBufferImageCopy region{};
+            region.bufferOffset = slotBase + request.slotOffset;
+            region.imageSubresource = request.image.subresource;
+            region.imageOffset = request.image.offset;
+            region.imageExtent = request.image.extent;
+            imageCopies_.push_back(ImageCopy{ request.image.image, request.image.layout, region });
+        }
+        slot.requests.push_back(std::move(request));
+    }
+    stats_.pendingRequests = static_cast<uint32_t>(pending_.size());
+
+    openSlot_ = nextSlot_;
+    slot.value = submittedValue_ + 1;
+    return Batch{ slot.commandBuffer.get(), timeline_.get(), slot.value };
+}
+
+void ReadbackService::recordCopies()
+{
+    if (!openSlot_.has_value()) {
+        throw std::runtime_error("ReadbackService: recordCopies without an open batch");
+    }
+    const VkCommandBuffer commandBuffer = slots_[*openSlot_].commandBuffer.get();
+
+    for (const BufferCopies& copies : bufferCopies_) {
+        vkCmdCopyBuffer(commandBuffer, copies.buffer, ring_.get(), static_cast<uint32_t>(copies.regions.size()), copies.regions.data());
+        ++stats_.copyCommands;
+        stats_.copyRegions += copies.regions.size();
+    }
+    for (const ImageCopy& copy : imageCopies_) {
+        vkCmdCopyImageToBuffer(commandBuffer, copy.image, copy.layout, ring_.get(), 1, &copy.region);
+        ++stats_.copyCommands;
+        ++stats_.copyRegions;
+    }
+
+    // The timeline signal alone does not make transfer writes visible to host reads.
+    VkMemoryBarrier toHost{ VK_STRUCTURE_TYPE_MEMORY_BARRIER };
+    toHost.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    toHost.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0,
+        1, &toHost, 0, nullptr, 0, nullptr);
+
+    bufferCopies_.clear();
+    bufferIndex_.clear();
+    imageCopies_.clear();
+}
+
+vkutil::VkExpected<void> ReadbackService::endBatch()
+{
+    if (!openSlot_.has_value()) {
+        return vkutil::makeError("ReadbackService::endBatch", VK_ERROR_INITIALIZATION_FAILED, "readback", "no_open_batch");
+    }
+    Slot& slot = slots_[*openSlot_];
+    if (const auto ended = slot.commandBuffer.end(); !ended) {
+        return ended;
+    }
+
+    submittedValue_ = slot.value;
+    nextSlot_ = (*openSlot_ + 1) % static_cast<uint32_t>(slots_.size());
+    openSlot_.reset();
+    ++stats_.batches;
+    ++stats_.inFlightBatches;
+    return {};
+}
+
+void ReadbackService::collect()
+{
+    ++frame_;
+    if (stats_.inFlightBatches == 0) {
+        return;
+    }
+
+    const uint64_t completed = completedValue();
+    while (stats_.inFlightBatches > 0) {
+        Slot& slot = slots_[oldestSlot_];
+        if (slot.value > completed) {
+            break;
+        }
+        deliver(slot);
+        oldestSlot_ = (oldestSlot_ + 1) % static_cast<uint32_t>(slots_.size());
+        --stats_.inFlightBatches;
+    }
+}
+
+uint64_t ReadbackService::completedValue()
+{
+    const auto value = timeline_.value();
+    if (!value) {
+        vkutil::throwVkError("vkGetSemaphoreCounterValue", value.error());
+    }
+    return value.value();
+}
+
+void ReadbackService::deliver(Slot& slot)
+{
+    const size_t slotIndex = static_cast<size_t>(&slot - slots_.data());
+    const VkDeviceSize slotBase = static_cast<VkDeviceSize>(slotIndex) * frameBytes_;
+    ring_.invalidate(slotBase, slot.usedBytes);
+
+    // Callbacks may queue new requests, and the slot is free again once they are out of it.
+    std::vector<Request> requests = std::move(slot.requests);
+    slot.requests.clear();
+    slot.value = 0;
+    slot.usedBytes = 0;
+    for (Request& request : requests) {
+        const uint64_t latency = frame_ - request.frame;
+        stats_.totalLatencyFrames += latency;
+        stats_.maxLatencyFrames = std::max(stats_.maxLatencyFrames, latency);
+        ++stats_.delivered;
+        stats_.deliveredBytes += request.size;
+        request.callback(std::span<const uint8_t>(ringData_ + slotBase + request.slotOffset, static_cast<size_t>(request.size)));
+    }
+}
@@ -16,6 +16,13 @@ struct EdgeHash {
     }
 };
 
+uint64_t hashCombine(uint64_t seed, uint64_t value)
+{
+    constexpr uint64_t kMul = 0x9E3779B97F4A7C15ULL;
+    seed ^= value + kMul + (seed << 6) + (seed >> 2);
+    return seed;
+}
+
 void appendBarrierBatch(RenderTaskGraph::BarrierBatch& dst, const RenderTaskGraph::BarrierBatch& src)
 {
     dst.memoryBarriers.insert(dst.memoryBarriers.end(), src.memoryBarriers.begin(), src.memoryBarriers.end());
@@ -199,6 +206,7 @@ RenderTaskGraph::ResourceId RenderTaskGraph::createImageResource(
 
 RenderTaskGraph::ResourceId RenderTaskGraph::createTransientBufferResource(
     VkDeviceSize size,
+    VkBufferUsageFlags usage,
     VkDeviceSize alignment,
     uint64_t aliasClass,
     VkPipelineStageFlags2 initialStageMask,
@@ -215,6 +223,7 @@ RenderTaskGraph::ResourceId RenderTaskGraph::createTransientBufferResource(
     descriptor.bufferSize = VK_WHOLE_SIZE;
     descriptor.transientBufferSize = size;
     descriptor.transientBufferAlignment = std::max<VkDeviceSize>(1, alignment);
+    descriptor.transientBufferUsage = usage;
     descriptor.initialStageMask = initialStageMask;
     descriptor.initialAccessMask = initialAccessMask;
     descriptor.initialQueueFamilyIndex = initialQueueFamilyIndex;
@@ -270,6 +279,82 @@ void RenderTaskGraph::setPresent(const SubmissionScheduler::PresentRequest& requ
     presentRequest_ = request;
 }
 
+uint64_t RenderTaskGraph::transientShapeKey() const noexcept
+{
+    uint64_t seed = hashCombine(0, static_cast<uint64_t>(passes_.size()));
+
+    // resources_ is unordered; ids are dense, so walk them in order instead.
+    for (ResourceId id = 1; id < nextResourceId_; ++id) {
+        const auto it = resources_.find(id);
+        if (it == resources_.end() || !it->second.transient) {
+            continue;
+        }
+        const ResourceDescriptor& descriptor = it->second;
+        seed = hashCombine(seed, id);
+        seed = hashCombine(seed, static_cast<uint64_t>(descriptor.type));
+        seed = hashCombine(seed, descriptor.aliasClass);
+        seed = hashCombine(seed, descriptor.transientBufferSize);
+        seed = hashCombine(seed, descriptor.transientBufferAlignment);
+        seed = hashCombine(seed, descriptor.transientBufferUsage);
+        seed = hashCombine(seed, descriptor.transientImageExtent.width);
+        seed = hashCombine(seed, descriptor.transientImageExtent.height);
+        seed = hashCombine(seed, descriptor.transientImageExtent.depth);
+        seed = hashCombine(seed, static_cast<uint64_t>(descriptor.transientImageFormat));
+        seed = hashCombine(seed, descriptor.transientImageUsage);
+        seed = hashCombine(seed, static_cast<uint64_t>(descriptor.transientImageType));
+        seed = hashCombine(seed, descriptor.transientImageMipLevels);
+        seed = hashCombine(seed, descriptor.transientImageArrayLayers);
+        seed = hashCombine(seed, static_cast<uint64_t>(descriptor.transientImageSamples));
+    }
+
+    // The schedule, and so every lifetime, follows from the usages alone.
+    for (const PassNode& pass : passes_) {
+        seed = hashCombine(seed, static_cast<uint64_t>(pass.job.queueClass));
+        seed = hashCombine(seed, static_cast<uint64_t>(pass.usages.size()));
+        for (const ResourceUsage& usage : pass.usages) {
+            seed = hashCombine(seed, usage.resource);
+            seed = hashCombine(seed, static_cast<uint64_t>(usage.access));
+            seed = hashCombine(seed, usage.stageMask);
+            seed = hashCombine(seed, usage.accessMask);
+            seed = hashCombine(seed, static_cast<uint64_t>(usage.imageLayout));
+            seed = hashCombine(seed, usage.imageSubresourceRange.aspectMask);
+            seed = hashCombine(seed, usage.imageSubresourceRange.baseMipLevel);
+            seed = hashCombine(seed, usage.imageSubresourceRange.levelCount);
+            seed = hashCombine(seed, usage.imageSubresourceRange.baseArrayLayer);
+            seed = hashCombine(seed, usage.imageSubresourceRange.layerCount);
+            seed = hashCombine(seed, usage.bufferOffset);
+            seed = hashCombine(seed, usage.bufferSize);
+            seed = hashCombine(seed, usage.queueFamilyIndex);
+        }
+    }
+    return seed;
+}
+
+vkutil::VkExpected<void> RenderTaskGraph::bindTransientResources(std::span<const TransientBinding> bindings)
+{
+    for (const TransientBinding& binding : bindings) {
+        auto it = resources_.find(binding.resource);
+        if (it == resources_.end()) {
+            return vkutil::makeError("RenderTaskGraph::bindTransientResources", VK_ERROR_INITIALIZATION_FAILED, "render_graph", "resource_not_registered");
+        }
+        ResourceDescriptor& descriptor = it->second;
+        if (!descriptor.transient) {
+            return vkutil::makeError("RenderTaskGraph::bindTransientResources", VK_ERROR_INITIALIZATION_FAILED, "render_graph", "resource_not_transient");
+        }
+        const bool matchesType = descriptor.type == ResourceType::Buffer
+            ? binding.buffer != VK_NULL_HANDLE && binding.image == VK_NULL_HANDLE
+            : binding.image != VK_NULL_HANDLE && binding.buffer == VK_NULL_HANDLE;
+        if (!matchesType) {
+            return vkutil::makeError("RenderTaskGraph::bindTransientResources", VK_ERROR_INITIALIZATION_FAILED, "render_graph", "transient_binding_type_mismatch");
+        }
+
+        descriptor.buffer = binding.buffer;
+        descriptor.image = binding.image;
+        descriptor.aliasedAfter = binding.aliasedAfter;
+    }
+    return {};
+}
+
 bool RenderTaskGraph::isWriteAccess(ResourceAccessType access) noexcept
 {
     return access == ResourceAccessType::Write || access == ResourceAccessType::ReadWrite;
@@ -491,6 +576,17 @@ RenderTaskGraph::BarrierBatch RenderTaskGraph::makeAcquireBarrierBatch(const Res
     return batch;
 }
 
+RenderTaskGraph::BarrierBatch RenderTaskGraph::makeAliasingBarrierBatch(const ResourceDescriptor& descriptor, const ResourceUsage& src, const ResourceUsage& dst) noexcept
+{
+    // Whatever was in the memory before (an earlier occupant, or this resource last frame) is
+    // discarded, so the image starts undefined.
+    BarrierBatch batch = makeBarrierBatch(descriptor, src, dst);
+    for (VkImageMemoryBarrier2& barrier : batch.imageBarriers) {
+        barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    }
+    return batch;
+}
+
 vkutil::VkExpected<void> RenderTaskGraph::buildDependenciesAndBarriers(
     std::vector<Edge>& outEdges,
     std::vector<BarrierBatch>& outIncomingBarriers,
@@ -510,6 +606,56 @@ vkutil::VkExpected<void> RenderTaskGraph::buildDependenciesAndBarriers(
 
     std::unordered_set<std::pair<PassId, PassId>, EdgeHash> edgeDedup{};
 
+    // What each resource that others alias after was used for, and by whom.
+    struct AliasSource {
+        VkPipelineStageFlags2 stageMask{ VK_PIPELINE_STAGE_2_NONE };
+        VkAccessFlags2 writeAccessMask{ VK_ACCESS_2_NONE };
+        std::vector<PassId> passes{};
+    };
+    std::unordered_map<ResourceId, AliasSource> aliasSources{};
+    for (const auto& [id, descriptor] : resources_) {
+        for (const ResourceId predecessor : descriptor.aliasedAfter) {
+            aliasSources.try_emplace(predecessor);
+        }
+    }
+    if (!aliasSources.empty()) {
+        for (PassId passId = 0; passId < passes_.size(); ++passId) {
+            for (const ResourceUsage& usage : passes_[passId].usages) {
+                auto sourceIt = aliasSources.find(usage.resource);
+                if (sourceIt == aliasSources.end()) {
+                    continue;
+                }
+                AliasSource& source = sourceIt->second;
+                source.stageMask |= usage.stageMask != 0 ? usage.stageMask : VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+                if (isWriteAccess(usage.access)) {
+                    source.writeAccessMask |= usage.accessMask;
+                }
+                if (source.passes.empty() || source.passes.back() != passId) {
+                    source.passes.push_back(passId);
+                }
+            }
+        }
+    }
+
+    // A resource sharing memory with earlier ones starts from a write covering all their uses.
+    auto aliasingUsage = [&](const ResourceDescriptor& descriptor) -> std::optional<ResourceUsage> {
+        ResourceUsage usage{};
+        usage.access = ResourceAccessType::Write;
+        usage.stageMask = VK_PIPELINE_STAGE_2_NONE;
+        usage.imageLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        for (const ResourceId predecessor : descriptor.aliasedAfter) {
+            auto sourceIt = aliasSources.find(predecessor);
+            if (sourceIt != aliasSources.end()) {
+                usage.stageMask |= sourceIt->second.stageMask;
+                usage.accessMask |= sourceIt->second.writeAccessMask;
+            }
+        }
+        if (usage.stageMask == VK_PIPELINE_STAGE_2_NONE) {
+            return std::nullopt;
+        }
+        return usage;
+    };
+
     auto addEdge = [&](PassId producer, PassId consumer, VkPipelineStageFlags2 consumerStage) {
         if (producer == consumer) {
             return;
@@ -544,6 +690,16 @@ vkutil::VkExpected<void> RenderTaskGraph::buildDependenciesAndBarriers(
 
             const bool writes = isWriteAccess(usage.access);
 
+            for (const ResourceId predecessor : state.descriptor.aliasedAfter) {
+                auto sourceIt = aliasSources.find(predecessor);
+                if (sourceIt == aliasSources.end()) {
+                    continue;
+                }
+                for (const PassId sourcePass : sourceIt->second.passes) {
+                    addEdge(sourcePass, passId, usage.stageMask);
+                }
+            }
+
             if (state.lastWriter.has_value() && usagesOverlap(state.descriptor, state.lastWriter->usage, usage)) {
                 const ResourceUsage& srcUsage = state.lastWriter->usage;
                 const auto syncContract = buildSyncContractDecision(state.descriptor, srcUsage, usage);
@@ -561,13 +717,17 @@ vkutil::VkExpected<void> RenderTaskGraph::buildDependenciesAndBarriers(
                 }
             }
             else {
-                const ResourceUsage initialUsage = makeInitialUsage(state.descriptor);
+                const std::optional<ResourceUsage> aliased = aliasingUsage(state.descriptor);
+                const ResourceUsage initialUsage = aliased.has_value() ? *aliased : makeInitialUsage(state.descriptor);
                 const auto syncContract = buildSyncContractDecision(state.descriptor, initialUsage, usage);
                 if (!syncContract.hasValue()) {
                     return vkutil::VkExpected<void>(syncContract.context());
                 }
                 if (syncContract.value().requiresExecutionDependency) {
-                    appendBarrierBatch(outIncomingBarriers[passId], makeBarrierBatch(state.descriptor, initialUsage, usage));
+                    // Transient contents never survive between uses, so they start undefined.
+                    appendBarrierBatch(outIncomingBarriers[passId], state.descriptor.transient
+                        ? makeAliasingBarrierBatch(state.descriptor, initialUsage, usage)
+                        : makeBarrierBatch(state.descriptor, initialUsage, usage));
                 }
             }
 
@@ -833,8 +993,11 @@ vkutil::VkExpected<RenderTaskGraph::CompiledTransientPlan> RenderTaskGraph::buil
                 .aliasSlot = chosenSlot->slotId,
                 .type = descriptor.type,
                 .aliasClass = descriptor.aliasClass,
+                .firstUseOrder = lifetime.firstUseOrder,
+                .lastUseOrder = lifetime.lastUseOrder,
                 .requiredBufferSize = descriptor.transientBufferSize,
                 .requiredBufferAlignment = std::max<VkDeviceSize>(1, descriptor.transientBufferAlignment),
+                .bufferUsage = descriptor.transientBufferUsage,
                 .requiredImageExtent = descriptor.transientImageExtent,
                 .imageFormat = descriptor.transientImageFormat,
                 .imageUsage = descriptor.transientImageUsage,
@@ -859,6 +1022,8 @@ vkutil::VkExpected<RenderTaskGraph::CompiledTransientPlan> RenderTaskGraph::buil
         }
 
         allocIt->resources.push_back(lifetime.resource);
+        allocIt->lastUseOrder = std::max(allocIt->lastUseOrder, lifetime.lastUseOrder);
+        allocIt->bufferUsage |= descriptor.transientBufferUsage;
         allocIt->requiredBufferSize = std::max(allocIt->requiredBufferSize, descriptor.transientBufferSize);
         allocIt->requiredBufferAlignment = std::max(allocIt->requiredBufferAlignment, std::max<VkDeviceSize>(1, descriptor.transientBufferAlignment));
         allocIt->requiredImageExtent.width = std::max(allocIt->requiredImageExtent.width, descriptor.transientImageExtent.width);
@@ -0,0 +1,68 @@
+#include <stdexcept>
+
+#include "SamplerCache.h"
+#include "DeferredDeletionService.h"
+#include "VkUtils.h"
+
+namespace {
+VkSamplerAddressMode toVkAddressMode(TextureAddressMode mode) noexcept
+{
+    switch (mode) {
+    case TextureAddressMode::MirroredRepeat: return VK_SAMPLER_ADDRESS_MODE_MIRRORED_REPEAT;
+    case TextureAddressMode::ClampToEdge: return VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    default: return VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    }
+}
+}
+
+SamplerCache::SamplerCache(VkDevice device, float maxAnisotropy)
+    : device_(device)
+    , maxAnisotropy_(maxAnisotropy)
+{
+    if (device_ == VK_NULL_HANDLE) {
+        throw std::runtime_error("SamplerCache: device is VK_NULL_HANDLE");
+    }
+}
+
+uint32_t SamplerCache::makeKey(const TextureSamplerDesc& desc) noexcept
+{
+    return static_cast<uint32_t>(desc.filter)
+        | (static_cast<uint32_t>(desc.addressMode) << 8)
+        | (static_cast<uint32_t>(desc.anisotropic ? 1U : 0U) << 16);
+}
+
+VkSampler SamplerCache::get(const TextureSamplerDesc& desc)
+{
+    const uint32_t key = makeKey(desc);
+    if (const auto it = samplers_.find(key); it != samplers_.end()) {
+        return it->second.get();
+    }
+
+    const VkFilter filter = desc.filter == TextureFilter::Nearest ? VK_FILTER_NEAREST : VK_FILTER_LINEAR;
+    const VkSamplerAddressMode addressMode = toVkAddressMode(desc.addressMode);
+    const bool anisotropic = desc.anisotropic && desc.filter == TextureFilter::Linear && maxAnisotropy_ > 1.0F;
+
+    VkSamplerCreateInfo ci{ VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO };
+    ci.magFilter = filter;
+    ci.minFilter = filter;
+    ci.mipmapMode = desc.filter == TextureFilter::Nearest ? VK_SAMPLER_MIPMAP_MODE_NEAREST : VK_SAMPLER_MIPMAP_MODE_LINEAR;
+    ci.addressModeU = addressMode;
+    ci.addressModeV = addressMode;
+    ci.addressModeW = addressMode;
+    ci.anisotropyEnable = anisotropic ? VK_TRUE : VK_FALSE;
+    ci.maxAnisotropy = anisotropic ? maxAnisotropy_ : 1.0F;
+    ci.minLod = 0.0F;
+    ci.maxLod = VK_LOD_CLAMP_NONE;
+    ci.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+
+    VkSampler sampler = VK_NULL_HANDLE;
+    const VkResult res = vkCreateSampler(device_, &ci, nullptr, &sampler);
+    if (res != VK_SUCCESS) {
+        vkutil::throwVkError("vkCreateSampler", res);
+    }
+
+    auto [it, inserted] = samplers_.emplace(key,
+        DeferredDeletionService::instance().makeDeferredHandle<VkSampler, PFN_vkDestroySampler>(device_, sampler, vkDestroySampler));
+    (void)inserted;
+    return it->second.get();
+}
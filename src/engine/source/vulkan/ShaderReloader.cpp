@@ -0,0 +1,120 @@
+#include "ShaderReloader.h"
+
+#include "VkUtils.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+
+namespace {
+// Empty on failure. The compiler writes next to the target and the result is renamed over it, so
+// a failed or interrupted compile never leaves a truncated module behind.
+std::vector<char> compileShader(const std::string& compilerPath, const std::string& sourcePath, const std::string& spvPath)
+{
+    const std::string tempPath = spvPath + ".tmp";
+    std::string command = '"' + compilerPath + "\" -V \"" + sourcePath + "\" -o \"" + tempPath + '"';
+#ifdef _WIN32
+    // cmd.exe strips the outer quote pair when the command starts with one.
+    command = '"' + command + '"';
+#endif
+    std::error_code ec{};
+    if (std::system(command.c_str()) != 0) {
+        std::filesystem::remove(tempPath, ec);
+        std::cerr << "[Shaders] " << sourcePath << ": compile failed, keeping the previous pipeline\n";
+        return {};
+    }
+
+    std::filesystem::rename(tempPath, spvPath, ec);
+    if (ec) {
+        std::cerr << "[Shaders] " << spvPath << ": " << ec.message() << '\n';
+        return {};
+    }
+
+    std::vector<char> code{};
+    vkutil::readFile(spvPath, code);
+    return code;
+}
+}
+
+ShaderReloader::ShaderReloader(const std::string& sourceDir, std::string compilerPath, const std::vector<std::string>& spvPaths)
+    : compilerPath_(std::move(compilerPath))
+{
+    if (sourceDir.empty() || compilerPath_.empty()) {
+        throw std::runtime_error("ShaderReloader: source directory and compiler path must be set");
+    }
+
+    for (const std::string& spvPath : spvPaths) {
+        const std::string name = std::filesystem::path(spvPath).filename().string();
+        if (!name.ends_with(".spv")) {
+            throw std::runtime_error("ShaderReloader: expected a .spv path: " + spvPath);
+        }
+        spvBySource_[sourceDir + '/' + name.substr(0, name.size() - 4)] = spvPath;
+    }
+
+    auto watcher = std::make_unique<FileWatcher>();
+    if (!watcher->watch(sourceDir)) {
+        std::cerr << "[Shaders] cannot watch " << sourceDir << ", hot reload disabled\n";
+        return;
+    }
+    watcher_ = std::move(watcher);
+}
+
+void ShaderReloader::start(const std::string& sourcePath, const std::string& spvPath)
+{
+    for (Job& job : jobs_) {
+        if (job.spvPath == spvPath) {
+            job.rerun = true;
+            return;
+        }
+    }
+    jobs_.push_back(Job{
+        .sourcePath = sourcePath,
+        .spvPath = spvPath,
+        .result = std::async(std::launch::async, compileShader, compilerPath_, sourcePath, spvPath) });
+}
+
+std::vector<ShaderReloader::Compiled> ShaderReloader::poll()
+{
+    std::vector<Compiled> compiled{};
+    if (!active()) {
+        return compiled;
+    }
+
+    for (const std::string& path : watcher_->poll()) {
+        const auto it = spvBySource_.find(path);
+        if (it != spvBySource_.end()) {
+            start(it->first, it->second);
+        }
+    }
+
+    for (auto it = jobs_.begin(); it != jobs_.end();) {
+        if (it->result.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            ++it;
+            continue;
+        }
+
+        std::vector<char> code{};
+        try {
+            code = it->result.get();
+        }
+        catch (const std::exception& e) {
+            std::cerr << "[Shaders] " << it->sourcePath << ": " << e.what() << '\n';
+        }
+
+        if (it->rerun) {
+            it->rerun = false;
+            it->result = std::async(std::launch::async, compileShader, compilerPath_, it->sourcePath, it->spvPath);
+            ++it;
+            continue;
+        }
+        if (!code.empty()) {
+            compiled.push_back(Compiled{ .spvPath = it->spvPath, .code = std::move(code) });
+        }
+        it = jobs_.erase(it);
+    }
+    return compiled;
+}
@@ -0,0 +1,244 @@
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "DeferredDeletionService.h"
+#include "SkinningPass.h"
+#include "VkShaderModule.h"
+#include "VkUtils.h"
+
+namespace {
+VkDeviceSize vertexStride(VertexFormat format) noexcept
+{
+    return format == VertexFormat::Float32 ? sizeof(VertexPacket) : sizeof(CompactVertexPacket);
+}
+
+float reciprocalOrZero(float value) noexcept
+{
+    return value != 0.0F ? 1.0F / value : 0.0F;
+}
+
+void uploadBuffer(VulkanBuffer& buffer, const void* data, size_t bytes)
+{
+    if (bytes == 0) {
+        return;
+    }
+    std::memcpy(buffer.map(0, static_cast<VkDeviceSize>(bytes)), data, bytes);
+    buffer.unmap();
+}
+}
+
+SkinningPass::SkinningPass(const Config& config)
+    : vertexFormat_(config.vertexFormat)
+    , maxSkinVertices_(config.maxSkinVertices)
+    , maxJoints_(config.maxJoints)
+    , maxDispatches_(config.maxDispatches)
+    , maxOutputVertices_(config.maxOutputVertices)
+{
+    if (config.device == VK_NULL_HANDLE || config.allocator == nullptr) {
+        throw std::runtime_error("SkinningPass: device/allocator is null");
+    }
+    if (maxSkinVertices_ == 0 || maxJoints_ == 0 || maxDispatches_ == 0 || maxOutputVertices_ == 0) {
+        throw std::runtime_error("SkinningPass: capacities must be > 0");
+    }
+    if (config.framesInFlight == 0) {
+        throw std::runtime_error("SkinningPass: framesInFlight must be > 0");
+    }
+
+    constexpr VkMemoryPropertyFlags hostVisible = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+    skinVertexBuffer_ = VulkanBuffer(*config.allocator,
+        static_cast<VkDeviceSize>(sizeof(SkinVertexPacket)) * maxSkinVertices_,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, hostVisible, false, VulkanBuffer::AllocationPolicy::Upload);
+    outputBuffer_ = VulkanBuffer(*config.allocator,
+        vertexStride(vertexFormat_) * maxOutputVertices_,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    std::array<VkDescriptorSetLayoutBinding, 5> bindings{};
+    for (uint32_t i = 0; i < bindings.size(); ++i) {
+        bindings[i].binding = i;
+        bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[i].descriptorCount = 1;
+        bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    }
+
+    VkDescriptorSetLayoutCreateInfo layoutCi{ VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO };
+    layoutCi.bindingCount = static_cast<uint32_t>(bindings.size());
+    layoutCi.pBindings = bindings.data();
+    VkDescriptorSetLayout layout = VK_NULL_HANDLE;
+    const VkResult layoutRes = vkCreateDescriptorSetLayout(config.device, &layoutCi, nullptr, &layout);
+    if (layoutRes != VK_SUCCESS) {
+        vkutil::throwVkError("vkCreateDescriptorSetLayout", layoutRes);
+    }
+    setLayout_ = DeferredDeletionService::instance().makeDeferredHandle<VkDescriptorSetLayout, PFN_vkDestroyDescriptorSetLayout>(
+        config.device, layout, vkDestroyDescriptorSetLayout);
+
+    const VkDescriptorPoolSize poolSize{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, static_cast<uint32_t>(bindings.size()) * config.framesInFlight };
+    VkDescriptorPoolCreateInfo poolCi{ VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO };
+    poolCi.maxSets = config.framesInFlight;
+    poolCi.poolSizeCount = 1;
+    poolCi.pPoolSizes = &poolSize;
+    VkDescriptorPool pool = VK_NULL_HANDLE;
+    const VkResult poolRes = vkCreateDescriptorPool(config.device, &poolCi, nullptr, &pool);
+    if (poolRes != VK_SUCCESS) {
+        vkutil::throwVkError("vkCreateDescriptorPool", poolRes);
+    }
+    descriptorPool_ = DeferredDeletionService::instance().makeDeferredHandle<VkDescriptorPool, PFN_vkDestroyDescriptorPool>(
+        config.device, pool, vkDestroyDescriptorPool);
+
+    const std::vector<VkDescriptorSetLayout> setLayouts(config.framesInFlight, setLayout_.get());
+    descriptorSets_.resize(config.framesInFlight);
+    VkDescriptorSetAllocateInfo allocInfo{ VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
+    allocInfo.descriptorPool = descriptorPool_.get();
+    allocInfo.descriptorSetCount = config.framesInFlight;
+    allocInfo.pSetLayouts = setLayouts.data();
+    const VkResult allocRes = vkAllocateDescriptorSets(config.device, &allocInfo, descriptorSets_.data());
+    if (allocRes != VK_SUCCESS) {
+        vkutil::throwVkError("vkAllocateDescriptorSets", allocRes);
+    }
+
+    // Bindings 0 (source vertices), 2 (joints) and 3 (dispatches) point into frame memory and are
+    // written by prepare().
+    const std::array<VkDescriptorBufferInfo, 2> bufferInfos{
+        VkDescriptorBufferInfo{ skinVertexBuffer_.get(), 0, VK_WHOLE_SIZE },
+        VkDescriptorBufferInfo{ outputBuffer_.get(), 0, VK_WHOLE_SIZE }
+    };
+    constexpr std::array<uint32_t, 2> staticBindings{ 1, 4 };
+    std::vector<VkWriteDescriptorSet> writes{};
+    writes.reserve(descriptorSets_.size() * staticBindings.size());
+    for (const VkDescriptorSet set : descriptorSets_) {
+        for (uint32_t i = 0; i < staticBindings.size(); ++i) {
+            VkWriteDescriptorSet write{ VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+            write.dstSet = set;
+            write.dstBinding = staticBindings[i];
+            write.descriptorCount = 1;
+            write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            write.pBufferInfo = &bufferInfos[i];
+            writes.push_back(write);
+        }
+    }
+    vkUpdateDescriptorSets(config.device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+
+    pipelineLayout_ = VulkanPipelineLayout(
+        config.device,
+        { setLayout_.get() },
+        { VkPushConstantRange{ VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PushConstants) } });
+
+    reloadShader(config.device, config.shaderCode);
+}
+
+void SkinningPass::reloadShader(VkDevice device, const std::vector<char>& shaderCode)
+{
+    VulkanShaderModule shader(device, shaderCode);
+    VkComputePipelineCreateInfo pipelineCi{ VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO };
+    pipelineCi.stage = VkPipelineShaderStageCreateInfo{ VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO };
+    pipelineCi.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    pipelineCi.stage.module = shader.get();
+    pipelineCi.stage.pName = "main";
+    pipelineCi.layout = pipelineLayout_.get();
+    pipeline_ = ComputePipelineBuilder{}.setCreateInfo(pipelineCi).build(device);
+}
+
+void SkinningPass::prepare(const FrameGraphInput& frameGraphInput, FrameLinearAllocator& frameMemory,
+    const FrameLinearAllocator::Slice& sourceVertices)
+{
+    dispatches_.clear();
+    maxVerticesPerDispatch_ = 0;
+
+    if (frameGraphInput.skinning.size() > maxDispatches_
+        || frameGraphInput.skinVertices.size() > maxSkinVertices_
+        || frameGraphInput.jointMatrices.size() > maxJoints_) {
+        throw std::runtime_error("SkinningPass: skinning stream exceeds fixed GPU capacity");
+    }
+
+    for (const SkinningPacket& packet : frameGraphInput.skinning) {
+        if (packet.vertexCount == 0) {
+            continue;
+        }
+        if (static_cast<uint64_t>(packet.outputFirstVertex) + packet.vertexCount > maxOutputVertices_) {
+            throw std::runtime_error("SkinningPass: skinned vertex output exceeds fixed GPU capacity");
+        }
+
+        SkinDispatchGpu dispatch{};
+        for (size_t axis = 0; axis < 3; ++axis) {
+            dispatch.dequantScale[axis] = packet.dequantScale[axis];
+            dispatch.dequantOffset[axis] = packet.dequantOffset[axis];
+            dispatch.outputScale[axis] = reciprocalOrZero(packet.outputDequantScale[axis]);
+            dispatch.outputOffset[axis] = packet.outputDequantOffset[axis];
+        }
+        dispatch.firstVertex = packet.firstVertex;
+        dispatch.vertexCount = packet.vertexCount;
+        dispatch.firstSkinVertex = packet.firstSkinVertex;
+        dispatch.firstJoint = packet.firstJoint;
+        dispatch.outputFirstVertex = packet.outputFirstVertex;
+
+        dispatches_.push_back(dispatch);
+        maxVerticesPerDispatch_ = std::max(maxVerticesPerDispatch_, packet.vertexCount);
+    }
+    dispatchCount_ = static_cast<uint32_t>(dispatches_.size());
+
+    if (dispatchCount_ == 0) {
+        return;
+    }
+    uploadBuffer(skinVertexBuffer_, frameGraphInput.skinVertices.data(), frameGraphInput.skinVertices.size() * sizeof(SkinVertexPacket));
+    if (frameMemory.frameIndex() >= descriptorSets_.size()) {
+        throw std::runtime_error("SkinningPass: frame memory has more frames in flight than descriptor sets");
+    }
+    if (!sourceVertices.valid()) {
+        throw std::runtime_error("SkinningPass: source vertex stream is null");
+    }
+
+    // A palette-less frame still needs a valid range behind binding 2.
+    const VkDeviceSize jointBytes = std::max<VkDeviceSize>(
+        frameGraphInput.jointMatrices.size() * sizeof(std::array<float, 16>), sizeof(std::array<float, 16>));
+    const FrameLinearAllocator::Slice joints = frameMemory.allocate(jointBytes, frameMemory.storageAlignment());
+    if (!frameGraphInput.jointMatrices.empty()) {
+        std::memcpy(joints.data, frameGraphInput.jointMatrices.data(), frameGraphInput.jointMatrices.size() * sizeof(std::array<float, 16>));
+    }
+    const FrameLinearAllocator::Slice dispatches = frameMemory.upload(
+        dispatches_.data(), dispatches_.size() * sizeof(SkinDispatchGpu), frameMemory.storageAlignment());
+
+    currentSet_ = frameMemory.frameIndex();
+    const std::array<VkDescriptorBufferInfo, 3> bufferInfos{
+        joints.descriptorInfo(),
+        dispatches.descriptorInfo(),
+        sourceVertices.descriptorInfo()
+    };
+    std::array<VkWriteDescriptorSet, 3> writes{};
+    constexpr std::array<uint32_t, 3> bindings{ 2, 3, 0 };
+    for (uint32_t i = 0; i < writes.size(); ++i) {
+        writes[i] = VkWriteDescriptorSet{ VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+        writes[i].dstSet = descriptorSets_[currentSet_];
+        writes[i].dstBinding = bindings[i];
+        writes[i].descriptorCount = 1;
+        writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        writes[i].pBufferInfo = &bufferInfos[i];
+    }
+    vkUpdateDescriptorSets(skinVertexBuffer_.getDevice(), static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+}
+
+void SkinningPass::record(VkCommandBuffer commandBuffer) const
+{
+    if (dispatchCount_ == 0) {
+        return;
+    }
+
+    // The previous frame's vertex fetches must finish before the output is overwritten.
+    VkMemoryBarrier readToWrite{ VK_STRUCTURE_TYPE_MEMORY_BARRIER };
+    readToWrite.srcAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
+    readToWrite.dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        0, 1, &readToWrite, 0, nullptr, 0, nullptr);
+
+    const PushConstants push{ dispatchCount_, static_cast<uint32_t>(vertexFormat_) };
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline_.get());
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout_.get(), 0, 1, &descriptorSets_[currentSet_], 0, nullptr);
+    vkCmdPushConstants(commandBuffer, pipelineLayout_.get(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PushConstants), &push);
+    vkCmdDispatch(commandBuffer, (maxVerticesPerDispatch_ + kWorkgroupSize - 1) / kWorkgroupSize, dispatchCount_, 1);
+
+    VkMemoryBarrier computeToVertex{ VK_STRUCTURE_TYPE_MEMORY_BARRIER };
+    computeToVertex.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    computeToVertex.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+        0, 1, &computeToVertex, 0, nullptr, 0, nullptr);
+}
@@ -135,6 +135,9 @@ vkutil::VkExpected<void> SubmissionScheduler::validateJobRequest(const JobReques
             return vkutil::makeError("SubmissionScheduler::validateJobRequest", VK_ERROR_INITIALIZATION_FAILED, "submission_scheduler", "null_signal_semaphore");
         }
     }
+    if (!request.signalValues.empty() && request.signalValues.size() != request.signalSemaphores.size()) {
+        return vkutil::makeError("SubmissionScheduler::validateJobRequest", VK_ERROR_INITIALIZATION_FAILED, "submission_scheduler", "signal_value_mismatch");
+    }
 
     return {};
 }
@@ -344,6 +347,7 @@ vkutil::VkExpected<std::vector<SubmissionScheduler::PreparedJob>> SubmissionSche
             .waitSemaphores = source.request.waitSemaphores,
             .waitStages = source.request.waitStages,
             .signalSemaphores = source.request.signalSemaphores,
+            .signalValues = source.request.signalValues,
             .fence = source.request.fence,
             .debugLabel = source.request.debugLabel
             });
@@ -390,6 +394,9 @@ vkutil::VkExpected<std::vector<SubmissionScheduler::PreparedJob>> SubmissionSche
         }
 
         producer.signalSemaphores.push_back(dependencySemaphore);
+        if (!producer.signalValues.empty()) {
+            producer.signalValues.push_back(0);
+        }
         consumer.waitSemaphores.push_back(dependencySemaphore);
         consumer.waitStages.push_back(edge.consumerWaitStage);
     }
@@ -423,6 +430,11 @@ std::vector<SubmissionScheduler::SubmitBatch> SubmissionScheduler::buildBatches(
         entry.submitInfo.pCommandBuffers = job.commandBuffers.data();
         entry.submitInfo.signalSemaphoreCount = static_cast<uint32_t>(job.signalSemaphores.size());
         entry.submitInfo.pSignalSemaphores = job.signalSemaphores.empty() ? nullptr : job.signalSemaphores.data();
+        entry.signalsTimeline = std::any_of(job.signalValues.begin(), job.signalValues.end(), [](uint64_t value) { return value != 0; });
+        if (entry.signalsTimeline) {
+            entry.timelineInfo.signalSemaphoreValueCount = static_cast<uint32_t>(job.signalValues.size());
+            entry.timelineInfo.pSignalSemaphoreValues = job.signalValues.data();
+        }
 
         const bool canAppendToPrevious = !batches.empty()
             && batches.back().queueClass == job.queueClass
@@ -448,6 +460,8 @@ std::vector<SubmissionScheduler::SubmitBatch> SubmissionScheduler::buildBatches(
         batch.submitInfos.clear();
         batch.submitInfos.reserve(batch.entries.size());
         for (SubmitBatch::SubmitEntry& entry : batch.entries) {
+            // Entries moved since timelineInfo was filled, so it is chained only now.
+            entry.submitInfo.pNext = entry.signalsTimeline ? &entry.timelineInfo : nullptr;
             batch.submitInfos.push_back(entry.submitInfo);
         }
     }
@@ -476,10 +490,10 @@ vkutil::VkExpected<std::vector<SubmissionScheduler::SubmitBatch2>> SubmissionSch
         }
 
         entry.signalInfos.reserve(job.signalSemaphores.size());
-        for (const VkSemaphore semaphore : job.signalSemaphores) {
+        for (size_t i = 0; i < job.signalSemaphores.size(); ++i) {
             VkSemaphoreSubmitInfo signalInfo{ VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO };
-            signalInfo.semaphore = semaphore;
-            signalInfo.value = 0;
+            signalInfo.semaphore = job.signalSemaphores[i];
+            signalInfo.value = job.signalValues.empty() ? 0 : job.signalValues[i];
             signalInfo.stageMask = signalStageMask2(job.queueClass);
             signalInfo.deviceIndex = 0;
             entry.signalInfos.push_back(signalInfo);
@@ -612,6 +626,7 @@ vkutil::VkExpected<SubmissionScheduler::FrameExecutionResult> SubmissionSchedule
         submitInfo.commandBuffers = job.commandBuffers;
         submitInfo.externalWaitSemaphores = job.waitSemaphores;
         submitInfo.externalSignalSemaphores = job.signalSemaphores;
+        submitInfo.externalSignalValues = job.signalValues;
         submitInfo.debugLabel = job.debugLabel;
 
         submitInfo.externalWaitStages.reserve(job.waitStages.size());
@@ -405,7 +405,7 @@ void SwapchainResources::createBaseInternal(const DeviceContext& devCtx,
     {
         VkImageCreateInfo ci{};
         makeDepthImageCI(swap->getExtent(), depthFmt, ci);
-        depthImage = std::make_unique<VulkanImage>(dev, pd, ci, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        depthImage = std::make_unique<VulkanImage>(devCtx.allocator(), ci, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
         depthView = std::make_unique<VulkanImageView>(
             dev,
             depthImage->get(),
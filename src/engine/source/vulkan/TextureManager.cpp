@@ -0,0 +1,851 @@
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include "TextureManager.h"
+#include "DeferredDeletionService.h"
+#include "VkUtils.h"
+
+namespace {
+constexpr VkDeviceSize kStagingAlignment = 16;
+
+VkFormat toVkFormat(TextureFormat format) noexcept
+{
+    switch (format) {
+    case TextureFormat::Bc1RgbSrgb: return VK_FORMAT_BC1_RGB_SRGB_BLOCK;
+    case TextureFormat::Bc3Srgb: return VK_FORMAT_BC3_SRGB_BLOCK;
+    default: return VK_FORMAT_R8G8B8A8_SRGB;
+    }
+}
+
+const char* formatName(TextureFormat format) noexcept
+{
+    switch (format) {
+    case TextureFormat::Bc1RgbSrgb: return "BC1";
+    case TextureFormat::Bc3Srgb: return "BC3";
+    default: return "RGBA8";
+    }
+}
+
+VkDeviceSize alignStaging(VkDeviceSize bytes) noexcept
+{
+    return (bytes + kStagingAlignment - 1) & ~(kStagingAlignment - 1);
+}
+
+uint64_t expectedLevelBytes(TextureFormat format, uint32_t width, uint32_t height) noexcept
+{
+    if (format == TextureFormat::Rgba8Srgb) {
+        return static_cast<uint64_t>(width) * height * 4U;
+    }
+    const uint64_t blocks = static_cast<uint64_t>((width + 3U) / 4U) * ((height + 3U) / 4U);
+    return blocks * (format == TextureFormat::Bc1RgbSrgb ? 8U : 16U);
+}
+
+uint32_t fullMipCount(uint32_t width, uint32_t height) noexcept
+{
+    return static_cast<uint32_t>(std::bit_width(std::max(width, height)));
+}
+
+uint32_t levelExtent(uint32_t baseExtent, uint32_t level) noexcept
+{
+    return std::max(1U, baseExtent >> level);
+}
+
+void validateAsset(const TextureAsset& asset)
+{
+    const std::string prefix = "TextureManager: texture " + std::to_string(asset.textureId);
+    if (asset.textureId == kNoTexture) {
+        throw std::runtime_error(prefix + " uses the reserved kNoTexture id");
+    }
+    if (asset.mips.empty()) {
+        throw std::runtime_error(prefix + " has no mip levels");
+    }
+    if (asset.generateMips && (asset.format != TextureFormat::Rgba8Srgb || asset.mips.size() != 1)) {
+        throw std::runtime_error(prefix + " requests GPU mips but is not a single-level RGBA8 image");
+    }
+    const uint32_t width = asset.mips.front().width;
+    const uint32_t height = asset.mips.front().height;
+    if (width == 0 || height == 0) {
+        throw std::runtime_error(prefix + " has a zero-sized base level");
+    }
+    if (asset.mips.size() > fullMipCount(width, height)) {
+        throw std::runtime_error(prefix + " has more mip levels than its extent allows");
+    }
+    for (uint32_t level = 0; level < asset.mips.size(); ++level) {
+        const TextureMipLevel& mip = asset.mips[level];
+        if (mip.width != levelExtent(width, level) || mip.height != levelExtent(height, level)) {
+            throw std::runtime_error(prefix + " has a mip level with an unexpected extent");
+        }
+        if (mip.size != expectedLevelBytes(asset.format, mip.width, mip.height)
+            || mip.offset > asset.data.size() || mip.size > asset.data.size() - mip.offset) {
+            throw std::runtime_error(prefix + " has a mip level outside its data");
+        }
+    }
+}
+
+VkImageMemoryBarrier makeBarrier(VkImage image,
+    uint32_t baseMip,
+    uint32_t mipCount,
+    VkImageLayout oldLayout,
+    VkImageLayout newLayout,
+    VkAccessFlags srcAccess,
+    VkAccessFlags dstAccess) noexcept
+{
+    VkImageMemoryBarrier barrier{ VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
+    barrier.srcAccessMask = srcAccess;
+    barrier.dstAccessMask = dstAccess;
+    barrier.oldLayout = oldLayout;
+    barrier.newLayout = newLayout;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = image;
+    barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, baseMip, mipCount, 0, 1 };
+    return barrier;
+}
+
+void recordBlitChain(VkCommandBuffer cmd, VkImage image, uint32_t width, uint32_t height, uint32_t mipLevels)
+{
+    for (uint32_t level = 1; level < mipLevels; ++level) {
+        const VkImageMemoryBarrier toSrc = makeBarrier(image, level - 1, 1,
+            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+            VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT);
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+            0, 0, nullptr, 0, nullptr, 1, &toSrc);
+
+        const uint32_t nextWidth = std::max(1U, width / 2U);
+        const uint32_t nextHeight = std::max(1U, height / 2U);
+        VkImageBlit blit{};
+        blit.srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, level - 1, 0, 1 };
+        blit.srcOffsets[1] = { static_cast<int32_t>(width), static_cast<int32_t>(height), 1 };
+        blit.dstSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, level, 0, 1 };
+        blit.dstOffsets[1] = { static_cast<int32_t>(nextWidth), static_cast<int32_t>(nextHeight), 1 };
+        vkCmdBlitImage(cmd,
+            image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+            image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            1, &blit, VK_FILTER_LINEAR);
+
+        width = nextWidth;
+        height = nextHeight;
+    }
+
+    // Every level but the last now sits in TRANSFER_SRC; the last is still TRANSFER_DST.
+    std::array<VkImageMemoryBarrier, 2> toRead{
+        makeBarrier(image, 0, mipLevels - 1,
+            VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+            VK_ACCESS_TRANSFER_READ_BIT, VK_ACCESS_SHADER_READ_BIT),
+        makeBarrier(image, mipLevels - 1, 1,
+            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+            VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT)
+    };
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+        0, 0, nullptr, 0, nullptr, static_cast<uint32_t>(toRead.size()), toRead.data());
+}
+
+TextureAsset makeWhiteTexture()
+{
+    TextureAsset asset{};
+    asset.textureId = kNoTexture;
+    asset.mips.push_back(TextureMipLevel{ 1, 1, 0, 4 });
+    asset.data = { 255, 255, 255, 255 };
+    asset.sampler.filter = TextureFilter::Nearest;
+    return asset;
+}
+
+uint64_t imageBytes(VkDevice device, VkImage image) noexcept
+{
+    VkMemoryRequirements requirements{};
+    vkGetImageMemoryRequirements(device, image, &requirements);
+    return requirements.size;
+}
+
+// Estimate used to decide whether a streaming request fits before its image exists.
+uint64_t estimatedBytes(const TextureAsset& asset, uint32_t baseMip) noexcept
+{
+    uint64_t bytes = 0;
+    for (size_t level = baseMip; level < asset.mips.size(); ++level) {
+        bytes += asset.mips[level].size;
+    }
+    return bytes + bytes / 8U;
+}
+}
+
+TextureManager::TextureManager(const Config& config)
+    : device_(config.device)
+    , allocator_(config.allocator)
+    , queue_(config.queue)
+    , uploads_(config.uploads)
+    , maxTextures_(config.maxTextures)
+    , budgetBytes_(config.budgetBytes)
+    , effectiveBudgetBytes_(config.budgetBytes)
+    , residentTailExtent_(std::max(1U, config.residentTailExtent))
+    , framesInFlight_(config.framesInFlight)
+    , defragmenter_(config.defragmenter)
+{
+    if (device_ == VK_NULL_HANDLE || allocator_ == nullptr) {
+        throw std::runtime_error("TextureManager: device/allocator is null");
+    }
+    if (!queue_.valid()) {
+        throw std::runtime_error("TextureManager: queue is invalid");
+    }
+    if (maxTextures_ == 0) {
+        throw std::runtime_error("TextureManager: maxTextures must be > 0");
+    }
+    if (budgetBytes_ > 0 && uploads_ == nullptr) {
+        throw std::runtime_error("TextureManager: streaming needs an upload manager");
+    }
+    stats_.budgetBytes = budgetBytes_;
+    stats_.effectiveBudgetBytes = effectiveBudgetBytes_;
+
+    if (budgetBytes_ > 0) {
+        VkPhysicalDeviceMemoryProperties memProps{};
+        vkGetPhysicalDeviceMemoryProperties(allocator_->physicalDevice(), &memProps);
+        uint32_t deviceLocalHeaps = 0;
+        for (uint32_t i = 0; i < memProps.memoryHeapCount; ++i) {
+            if ((memProps.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0) {
+                deviceLocalHeaps |= 1U << i;
+            }
+        }
+        memoryPressure_ = std::make_shared<std::atomic<uint64_t>>(0);
+        evictionRegistration_ = allocator_->addEvictionCallback(GpuAllocator::Priority::Low,
+            [pressure = memoryPressure_, deviceLocalHeaps](uint32_t heapIndex, VkDeviceSize bytes) {
+                if ((deviceLocalHeaps & (1U << heapIndex)) == 0) {
+                    return;
+                }
+                uint64_t current = pressure->load(std::memory_order_relaxed);
+                while (current < bytes && !pressure->compare_exchange_weak(current, bytes, std::memory_order_relaxed)) {
+                }
+            });
+    }
+
+    if (defragmenter_ != nullptr) {
+        relocated_ = std::make_shared<std::vector<Relocated>>();
+    }
+
+    samplers_ = SamplerCache(device_, config.maxAnisotropy);
+
+    VkDescriptorSetLayoutBinding binding{};
+    binding.binding = 0;
+    binding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    binding.descriptorCount = 1;
+    binding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+    VkDescriptorSetLayoutCreateInfo layoutCi{ VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO };
+    layoutCi.bindingCount = 1;
+    layoutCi.pBindings = &binding;
+    VkDescriptorSetLayout layout = VK_NULL_HANDLE;
+    const VkResult layoutRes = vkCreateDescriptorSetLayout(device_, &layoutCi, nullptr, &layout);
+    if (layoutRes != VK_SUCCESS) {
+        vkutil::throwVkError("vkCreateDescriptorSetLayout", layoutRes);
+    }
+    setLayout_ = DeferredDeletionService::instance().makeDeferredHandle<VkDescriptorSetLayout, PFN_vkDestroyDescriptorSetLayout>(
+        device_, layout, vkDestroyDescriptorSetLayout);
+
+    // Per texture: the tail and a streamed set, a streamed set being replaced by finer levels,
+    // and one being replaced after each of the two images is relocated; plus the default texture.
+    const uint32_t maxSets = maxTextures_ * 5 + 1;
+    const VkDescriptorPoolSize poolSize{ VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, maxSets };
+    VkDescriptorPoolCreateInfo poolCi{ VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO };
+    poolCi.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+    poolCi.maxSets = maxSets;
+    poolCi.poolSizeCount = 1;
+    poolCi.pPoolSizes = &poolSize;
+    VkDescriptorPool pool = VK_NULL_HANDLE;
+    const VkResult poolRes = vkCreateDescriptorPool(device_, &poolCi, nullptr, &pool);
+    if (poolRes != VK_SUCCESS) {
+        vkutil::throwVkError("vkCreateDescriptorPool", poolRes);
+    }
+    descriptorPool_ = DeferredDeletionService::instance().makeDeferredHandle<VkDescriptorPool, PFN_vkDestroyDescriptorPool>(
+        device_, pool, vkDestroyDescriptorPool);
+
+    upload({ makeWhiteTexture() });
+}
+
+bool TextureManager::supportsFormat(VkFormat format, bool gpuMips) const
+{
+    VkFormatProperties properties{};
+    vkGetPhysicalDeviceFormatProperties(allocator_->physicalDevice(), format, &properties);
+    VkFormatFeatureFlags required = VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_TRANSFER_DST_BIT;
+    if (gpuMips) {
+        required |= VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT
+            | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+    }
+    return (properties.optimalTilingFeatures & required) == required;
+}
+
+VkDescriptorSet TextureManager::allocateDescriptorSet(VkImageView view, VkSampler sampler)
+{
+    VkDescriptorSetAllocateInfo allocInfo{ VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
+    allocInfo.descriptorPool = descriptorPool_.get();
+    allocInfo.descriptorSetCount = 1;
+    const VkDescriptorSetLayout layout = setLayout_.get();
+    allocInfo.pSetLayouts = &layout;
+    VkDescriptorSet set = VK_NULL_HANDLE;
+    const VkResult allocRes = vkAllocateDescriptorSets(device_, &allocInfo, &set);
+    if (allocRes != VK_SUCCESS) {
+        vkutil::throwVkError("vkAllocateDescriptorSets", allocRes);
+    }
+
+    const VkDescriptorImageInfo imageInfo{ sampler, view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+    VkWriteDescriptorSet write{ VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+    write.dstSet = set;
+    write.dstBinding = 0;
+    write.descriptorCount = 1;
+    write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    write.pImageInfo = &imageInfo;
+    vkUpdateDescriptorSets(device_, 1, &write, 0, nullptr);
+    return set;
+}
+
+VulkanImage TextureManager::createImage(const UploadRequest& request, bool streaming)
+{
+    const TextureMipLevel& base = request.asset->mips.front();
+    VkImageCreateInfo imageCi{ VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO };
+    imageCi.imageType = VK_IMAGE_TYPE_2D;
+    imageCi.format = request.format;
+    imageCi.extent = { levelExtent(base.width, request.baseMip), levelExtent(base.height, request.baseMip), 1 };
+    imageCi.mipLevels = request.mipLevels;
+    imageCi.arrayLayers = 1;
+    imageCi.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageCi.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageCi.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT
+        | (request.asset->generateMips ? VK_IMAGE_USAGE_TRANSFER_SRC_BIT : 0U);
+    // The defragmenter copies an image out to move it; formats that cannot be copied from stay put.
+    if (defragmenter_ != nullptr) {
+        VkFormatProperties properties{};
+        vkGetPhysicalDeviceFormatProperties(allocator_->physicalDevice(), request.format, &properties);
+        if ((properties.optimalTilingFeatures & VK_FORMAT_FEATURE_TRANSFER_SRC_BIT) != 0) {
+            imageCi.usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+        }
+    }
+    imageCi.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    imageCi.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    // Streamed images are written on the upload manager's queue and sampled on the graphics queue.
+    const std::array<uint32_t, 2> families{ queue_.familyIndex(), streaming ? uploads_->queueFamilyIndex() : queue_.familyIndex() };
+    if (streaming && families[0] != families[1]) {
+        imageCi.sharingMode = VK_SHARING_MODE_CONCURRENT;
+        imageCi.queueFamilyIndexCount = static_cast<uint32_t>(families.size());
+        imageCi.pQueueFamilyIndices = families.data();
+    }
+    // Streamed levels can always be dropped back to the tail, so they give way under pressure.
+    return VulkanImage(*allocator_, imageCi, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, GpuAllocator::LifetimeClass::Persistent,
+        streaming ? GpuAllocator::Priority::Low : GpuAllocator::Priority::Normal);
+}
+
+VulkanBuffer TextureManager::fillStaging(std::vector<UploadRequest>& requests) const
+{
+    VkDeviceSize stagingBytes = 0;
+    for (UploadRequest& request : requests) {
+        request.stagingOffset = stagingBytes;
+        const uint32_t cpuLevels = std::min<uint32_t>(request.mipLevels, static_cast<uint32_t>(request.asset->mips.size()) - request.baseMip);
+        for (uint32_t level = 0; level < cpuLevels; ++level) {
+            stagingBytes += alignStaging(request.asset->mips[request.baseMip + level].size);
+        }
+    }
+
+    VulkanBuffer staging(*allocator_, stagingBytes, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, false, VulkanBuffer::AllocationPolicy::Upload);
+    auto* mapped = static_cast<uint8_t*>(staging.map(0, stagingBytes));
+    for (const UploadRequest& request : requests) {
+        VkDeviceSize offset = request.stagingOffset;
+        const uint32_t cpuLevels = std::min<uint32_t>(request.mipLevels, static_cast<uint32_t>(request.asset->mips.size()) - request.baseMip);
+        for (uint32_t level = 0; level < cpuLevels; ++level) {
+            const TextureMipLevel& mip = request.asset->mips[request.baseMip + level];
+            std::memcpy(mapped + offset, request.asset->data.data() + mip.offset, static_cast<size_t>(mip.size));
+            offset += alignStaging(mip.size);
+        }
+    }
+    staging.unmap();
+    return staging;
+}
+
+void TextureManager::recordUploads(VkCommandBuffer cmd, VkBuffer staging, const std::vector<UploadRequest>& requests) const
+{
+    for (const UploadRequest& request : requests) {
+        const VkImage image = request.image.get();
+        const VkImageMemoryBarrier toDst = makeBarrier(image, 0, request.mipLevels,
+            VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 0, VK_ACCESS_TRANSFER_WRITE_BIT);
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+            0, 0, nullptr, 0, nullptr, 1, &toDst);
+
+        const uint32_t cpuLevels = std::min<uint32_t>(request.mipLevels, static_cast<uint32_t>(request.asset->mips.size()) - request.baseMip);
+        std::vector<VkBufferImageCopy> copies{};
+        copies.reserve(cpuLevels);
+        VkDeviceSize offset = request.stagingOffset;
+        for (uint32_t level = 0; level < cpuLevels; ++level) {
+            const TextureMipLevel& mip = request.asset->mips[request.baseMip + level];
+            VkBufferImageCopy copy{};
+            copy.bufferOffset = offset;
+            copy.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, level, 0, 1 };
+            copy.imageExtent = { mip.width, mip.height, 1 };
+            copies.push_back(copy);
+            offset += alignStaging(mip.size);
+        }
+        vkCmdCopyBufferToImage(cmd, staging, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            static_cast<uint32_t>(copies.size()), copies.data());
+
+        if (request.asset->generateMips && request.mipLevels > 1) {
+            const TextureMipLevel& base = request.asset->mips.front();
+            recordBlitChain(cmd, image, base.width, base.height, request.mipLevels);
+            continue;
+        }
+
+        const VkImageMemoryBarrier toRead = makeBarrier(image, 0, request.mipLevels,
+            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+            VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT);
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+            0, 0, nullptr, 0, nullptr, 1, &toRead);
+    }
+}
+
+TextureManager::Residency TextureManager::makeResidency(UploadRequest& request, const Texture& texture)
+{
+    Residency residency{};
+    residency.view = VulkanImageView(device_, request.image.get(), request.format, VK_IMAGE_ASPECT_COLOR_BIT, request.mipLevels);
+    residency.descriptorSet = allocateDescriptorSet(residency.view.get(), texture.sampler);
+    residency.image = std::move(request.image);
+    residency.baseMip = request.baseMip;
+    residency.bytes = request.bytes;
+    return residency;
+}
+
+void TextureManager::trackAllocation(int64_t delta) noexcept
+{
+    stats_.allocatedBytes = static_cast<uint64_t>(static_cast<int64_t>(stats_.allocatedBytes) + delta);
+    stats_.peakAllocatedBytes = std::max(stats_.peakAllocatedBytes, stats_.allocatedBytes);
+}
+
+void TextureManager::upload(const std::vector<TextureAsset>& assets)
+{
+    std::vector<UploadRequest> requests{};
+    requests.reserve(assets.size());
+    for (const TextureAsset& asset : assets) {
+        const bool isDefault = asset.textureId == kNoTexture && !defaultTexture_.valid();
+        if (!isDefault) {
+            validateAsset(asset);
+            const bool duplicate = textures_.contains(asset.textureId)
+                || std::any_of(requests.begin(), requests.end(), [&](const UploadRequest& r) { return r.textureId == asset.textureId; });
+            if (duplicate) {
+                throw std::runtime_error("TextureManager: duplicate texture id " + std::to_string(asset.textureId));
+            }
+            if (textures_.size() + requests.size() >= maxTextures_) {
+                throw std::runtime_error("TextureManager: more than maxTextures textures");
+            }
+        }
+
+        const VkFormat format = toVkFormat(asset.format);
+        if (!supportsFormat(format, asset.generateMips)) {
+            std::cerr << "[Textures] Skipping texture " << asset.textureId << ": " << formatName(asset.format)
+                      << (asset.generateMips ? " with blit mips" : "") << " is not supported by this device\n";
+            ++stats_.skipped;
+            continue;
+        }
+
+        const TextureMipLevel& base = asset.mips.front();
+        const uint32_t mipCount = asset.generateMips ? fullMipCount(base.width, base.height) : static_cast<uint32_t>(asset.mips.size());
+        uint32_t tailMip = 0;
+        if (budgetBytes_ > 0 && !asset.generateMips && !isDefault) {
+            while (tailMip + 1 < mipCount
+                && std::max(levelExtent(base.width, tailMip), levelExtent(base.height, tailMip)) > residentTailExtent_) {
+                ++tailMip;
+            }
+        }
+
+        UploadRequest request{};
+        request.textureId = asset.textureId;
+        request.asset = &asset;
+        request.format = format;
+        request.baseMip = tailMip;
+        request.mipLevels = mipCount - tailMip;
+        requests.push_back(std::move(request));
+    }
+    if (requests.empty()) {
+        return;
+    }
+
+    VulkanBuffer staging = fillStaging(requests);
+    for (UploadRequest& request : requests) {
+        request.image = createImage(request, false);
+        request.bytes = imageBytes(device_, request.image.get());
+        trackAllocation(static_cast<int64_t>(request.bytes));
+    }
+
+    auto pool = VulkanCommandPool::create(device_, queue_.familyIndex());
+    if (!pool) {
+        vkutil::throwVkError("VulkanCommandPool::create", pool.error());
+    }
+    auto commandBuffer = VulkanCommandBuffer::create(device_, pool.value().get());
+    if (!commandBuffer) {
+        vkutil::throwVkError("VulkanCommandBuffer::create", commandBuffer.error());
+    }
+    if (const auto begun = commandBuffer.value().begin(); !begun) {
+        vkutil::throwVkError("vkBeginCommandBuffer", begun.error());
+    }
+    const VkCommandBuffer cmd = commandBuffer.value().get();
+    recordUploads(cmd, staging.get(), requests);
+    if (const auto ended = commandBuffer.value().end(); !ended) {
+        vkutil::throwVkError("vkEndCommandBuffer", ended.error());
+    }
+
+    VulkanFence fence(device_);
+    VkSubmitInfo submitInfo{ VK_STRUCTURE_TYPE_SUBMIT_INFO };
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &cmd;
+    if (const auto submitted = queue_.submit({ submitInfo }, fence.get(), "textures"); !submitted) {
+        vkutil::throwVkError("vkQueueSubmit", submitted.error());
+    }
+    if (const VkResult waited = fence.wait(); waited != VK_SUCCESS) {
+        vkutil::throwVkError("vkWaitForFences", waited);
+    }
+
+    for (UploadRequest& request : requests) {
+        const TextureAsset& asset = *request.asset;
+        Texture texture{};
+        texture.format = request.format;
+        texture.sampler = samplers_.get(asset.sampler);
+        texture.mipCount = request.baseMip + request.mipLevels;
+        texture.tailMip = request.baseMip;
+        texture.wantedMip = request.baseMip;
+        texture.tail = makeResidency(request, texture);
+
+        if (asset.textureId == kNoTexture) {
+            defaultTexture_ = std::move(texture.tail);
+            continue;
+        }
+
+        uint32_t width = asset.mips.front().width;
+        uint32_t height = asset.mips.front().height;
+        for (uint32_t level = 0; level < texture.mipCount; ++level) {
+            const uint64_t rgba8 = expectedLevelBytes(TextureFormat::Rgba8Srgb, width, height);
+            stats_.rgba8Bytes += rgba8;
+            stats_.deviceBytes += level < asset.mips.size() ? asset.mips[level].size : rgba8;
+            width = std::max(1U, width / 2U);
+            height = std::max(1U, height / 2U);
+        }
+        // Only textures with levels above their tail need the CPU copy for streaming.
+        if (texture.tailMip > 0) {
+            texture.source = asset;
+        }
+        Texture& installed = textures_.emplace(asset.textureId, std::move(texture)).first->second;
+        registerRelocation(asset.textureId, installed.tail, false);
+        ++stats_.textureCount;
+    }
+    stats_.samplerCount = static_cast<uint32_t>(samplers_.size());
+
+    if (budgetBytes_ > 0 && stats_.allocatedBytes > budgetBytes_) {
+        std::cerr << "[Textures] Resident mip tails use " << stats_.allocatedBytes / 1024 << " KiB, over the "
+                  << budgetBytes_ / 1024 << " KiB budget\n";
+    }
+}
+
+void TextureManager::registerRelocation(uint32_t textureId, Residency& residency, bool streamed)
+{
+    if (defragmenter_ == nullptr) {
+        return;
+    }
+    residency.relocation = defragmenter_->registerImage(residency.image, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+        [relocated = relocated_, textureId, streamed](VkImage, VkImage newImage) {
+            relocated->push_back(Relocated{ .textureId = textureId, .streamed = streamed, .image = newImage });
+        });
+}
+
+void TextureManager::installRelocated(uint64_t frameIndex)
+{
+    if (!relocated_) {
+        return;
+    }
+    for (const Relocated& moved : *relocated_) {
+        const auto it = textures_.find(moved.textureId);
+        if (it == textures_.end()) {
+            continue;
+        }
+        Texture& texture = it->second;
+        Residency& residency = moved.streamed ? texture.streamed : texture.tail;
+        // Replaced or evicted since it moved; its successor has its own descriptor set.
+        if (residency.image.get() != moved.image) {
+            continue;
+        }
+
+        // The old view and set were last drawn with in the frame the image moved; they retire like
+        // those of any replaced residency, and the defragmenter retires the old image itself.
+        Residency stale{};
+        stale.view = std::move(residency.view);
+        stale.descriptorSet = residency.descriptorSet;
+        retire(std::move(stale), frameIndex);
+
+        residency.view = VulkanImageView(device_, moved.image, texture.format, VK_IMAGE_ASPECT_COLOR_BIT,
+            texture.mipCount - residency.baseMip);
+        residency.descriptorSet = allocateDescriptorSet(residency.view.get(), texture.sampler);
+        ++stats_.relocations;
+    }
+    relocated_->clear();
+}
+
+void TextureManager::retire(Residency&& residency, uint64_t frameIndex)
+{
+    // Only residencies in place in a texture may move.
+    residency.relocation.reset();
+    if (!residency.valid()) {
+        return;
+    }
+    retired_.push_back(Retired{ .retireFrame = frameIndex + framesInFlight_, .residency = std::move(residency) });
+}
+
+void TextureManager::collectRetired(uint64_t frameIndex)
+{
+    while (!retired_.empty() && retired_.front().retireFrame <= frameIndex) {
+        Residency& residency = retired_.front().residency;
+        const VkDescriptorSet set = residency.descriptorSet;
+        const VkResult freeRes = vkFreeDescriptorSets(device_, descriptorPool_.get(), 1, &set);
+        if (freeRes != VK_SUCCESS) {
+            vkutil::throwVkError("vkFreeDescriptorSets", freeRes);
+        }
+        trackAllocation(-static_cast<int64_t>(residency.bytes));
+        retired_.pop_front();
+    }
+}
+
+void TextureManager::installCompletedBatch(uint64_t frameIndex)
+{
+    if (!streamBatch_.has_value()) {
+        return;
+    }
+    // The timeline wait before the batch is installed orders the graphics queue's reads after
+    // the upload queue's writes.
+    if (!uploads_->isReady(streamBatch_->token)) {
+        return;
+    }
+
+    for (UploadRequest& request : streamBatch_->requests) {
+        Texture& texture = textures_.at(request.textureId);
+        retire(std::move(texture.streamed), frameIndex);
+        texture.streamed = makeResidency(request, texture);
+        registerRelocation(request.textureId, texture.streamed, true);
+        texture.uploading = false;
+        ++stats_.streamUploads;
+    }
+    streamBatch_.reset();
+}
+
+void TextureManager::updateWantedMips(uint64_t frameIndex, const std::vector<DrawPacket>& drawPackets, uint32_t viewportHeight)
+{
+    for (auto& [id, texture] : textures_) {
+        (void)id;
+        texture.wantedMip = texture.tailMip;
+    }
+    for (const DrawPacket& draw : drawPackets) {
+        const auto it = textures_.find(draw.textureId);
+        if (it == textures_.end()) {
+            continue;
+        }
+        Texture& texture = it->second;
+        texture.lastUsedFrame = frameIndex;
+        if (texture.tailMip == 0) {
+            texture.wantedMip = 0;
+            continue;
+        }
+
+        // One texel per covered pixel across the projected bounds picks the level.
+        const TextureMipLevel& base = texture.source.mips.front();
+        const float pixels = std::max(1.0F, draw.screenCoverage * static_cast<float>(viewportHeight));
+        const float texelsPerPixel = static_cast<float>(std::max(base.width, base.height)) / pixels;
+        const uint32_t mip = texelsPerPixel <= 1.0F ? 0U : static_cast<uint32_t>(std::floor(std::log2(texelsPerPixel)));
+        texture.wantedMip = std::min({ texture.wantedMip, mip, texture.tailMip });
+    }
+}
+
+bool TextureManager::isEvictable(const Texture& texture, uint64_t frameIndex) noexcept
+{
+    // Anything drawn this frame that still wants its streamed levels is off limits.
+    return texture.streamed.valid()
+        && !(texture.lastUsedFrame == frameIndex && texture.wantedMip <= texture.streamed.baseMip);
+}
+
+uint64_t TextureManager::retiringBytes() const noexcept
+{
+    uint64_t bytes = 0;
+    for (const Retired& retired : retired_) {
+        bytes += retired.residency.bytes;
+    }
+    return bytes;
+}
+
+bool TextureManager::evictFor(uint64_t bytes, uint32_t protectedTextureId, uint64_t frameIndex)
+{
+    // Memory only comes back once retired images are collected, so it stays counted against the
+    // budget until then; eviction here just starts that countdown.
+    uint64_t pendingFree = retiringBytes();
+    while (stats_.allocatedBytes - pendingFree + bytes > effectiveBudgetBytes_) {
+        Texture* victim = nullptr;
+        for (auto& [id, texture] : textures_) {
+            if (id == protectedTextureId || !isEvictable(texture, frameIndex)) {
+                continue;
+            }
+            if (victim == nullptr || texture.lastUsedFrame < victim->lastUsedFrame) {
+                victim = &texture;
+            }
+        }
+        if (victim == nullptr) {
+            return false;
+        }
+        pendingFree += victim->streamed.bytes;
+        retire(std::move(victim->streamed), frameIndex);
+        victim->streamed = Residency{};
+        ++stats_.evictions;
+    }
+    return stats_.allocatedBytes + bytes <= effectiveBudgetBytes_;
+}
+
+void TextureManager::submitStreamBatch(uint64_t frameIndex)
+{
+    // Most recently drawn first, then the largest shortfall.
+    std::vector<std::pair<uint32_t, Texture*>> candidates{};
+    for (auto& [id, texture] : textures_) {
+        if (!texture.uploading && texture.wantedMip < texture.residentMip()) {
+            candidates.emplace_back(id, &texture);
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(), [](const auto& a, const auto& b) {
+        if (a.second->lastUsedFrame != b.second->lastUsedFrame) {
+            return a.second->lastUsedFrame > b.second->lastUsedFrame;
+        }
+        return a.second->residentMip() - a.second->wantedMip > b.second->residentMip() - b.second->wantedMip;
+    });
+
+    std::vector<UploadRequest> requests{};
+    uint64_t batchBytes = 0;
+    for (const auto& [id, texture] : candidates) {
+        // The finest level that could fit if every other streamed level were evicted; a wanted
+        // level that can never fit would otherwise evict everything each frame.
+        uint64_t reclaimable = retiringBytes();
+        for (const auto& [otherId, other] : textures_) {
+            if (otherId != id && isEvictable(other, frameIndex)) {
+                reclaimable += other.streamed.bytes;
+            }
+        }
+        const uint64_t floorBytes = stats_.allocatedBytes + batchBytes - reclaimable;
+        // Levels must also fit the staging ring in one piece.
+        uint32_t baseMip = texture->wantedMip;
+        while (baseMip < texture->residentMip()
+            && (floorBytes + estimatedBytes(texture->source, baseMip) > effectiveBudgetBytes_
+                || estimatedBytes(texture->source, baseMip) > uploads_->stats().ringBytes)) {
+            ++baseMip;
+        }
+        if (baseMip == texture->residentMip()) {
+            continue;
+        }
+
+        const uint64_t bytes = estimatedBytes(texture->source, baseMip);
+        if (!evictFor(batchBytes + bytes, id, frameIndex)) {
+            // Evicted memory is still retiring; try again once it has been collected.
+            break;
+        }
+        UploadRequest request{};
+        request.textureId = id;
+        request.asset = &texture->source;
+        request.format = texture->format;
+        request.baseMip = baseMip;
+        request.mipLevels = texture->mipCount - baseMip;
+        requests.push_back(std::move(request));
+        batchBytes += bytes;
+    }
+    if (requests.empty()) {
+        return;
+    }
+
+    // The estimate only approximates alignment and padding; drop whatever really does not fit.
+    std::vector<UploadRequest> fitting{};
+    for (UploadRequest& request : requests) {
+        try {
+            request.image = createImage(request, true);
+        }
+        catch (const GpuAllocator::OutOfMemoryError&) {
+            // The heap is over budget; the texture keeps its current levels and is asked for again.
+            ++stats_.deferredUploads;
+            continue;
+        }
+        request.bytes = imageBytes(device_, request.image.get());
+        if (stats_.allocatedBytes + request.bytes > effectiveBudgetBytes_) {
+            continue;
+        }
+        trackAllocation(static_cast<int64_t>(request.bytes));
+        textures_.at(request.textureId).uploading = true;
+        fitting.push_back(std::move(request));
+    }
+    requests = std::move(fitting);
+    if (requests.empty()) {
+        return;
+    }
+
+    StreamBatch batch{};
+    std::vector<UploadManager::ImageRegion> regions{};
+    for (const UploadRequest& request : requests) {
+        regions.clear();
+        for (uint32_t level = 0; level < request.mipLevels; ++level) {
+            const TextureMipLevel& mip = request.asset->mips[request.baseMip + level];
+            regions.push_back(UploadManager::ImageRegion{
+                .mipLevel = level,
+                .extent = { mip.width, mip.height, 1 },
+                .data = request.asset->data.data() + mip.offset,
+                .size = mip.size });
+        }
+        // Tokens only grow, so the last one covers the whole batch.
+        batch.token = uploads_->uploadImage(
+            UploadManager::ImageTarget{
+                .image = request.image.get(),
+                .range = { VK_IMAGE_ASPECT_COLOR_BIT, 0, request.mipLevels, 0, 1 } },
+            regions);
+    }
+    uploads_->flush();
+    batch.requests = std::move(requests);
+    streamBatch_ = std::move(batch);
+}
+
+void TextureManager::stream(uint64_t frameIndex, const std::vector<DrawPacket>& drawPackets, uint32_t viewportHeight)
+{
+    installRelocated(frameIndex);
+    installCompletedBatch(frameIndex);
+    collectRetired(frameIndex);
+    if (budgetBytes_ == 0) {
+        return;
+    }
+
+    updateWantedMips(frameIndex, drawPackets, viewportHeight);
+    applyMemoryPressure(frameIndex);
+    if (!streamBatch_.has_value()) {
+        submitStreamBatch(frameIndex);
+    }
+
+    stats_.streamedTextures = static_cast<uint32_t>(std::count_if(textures_.begin(), textures_.end(),
+        [](const auto& entry) { return entry.second.streamed.valid(); }));
+}
+
+void TextureManager::applyMemoryPressure(uint64_t frameIndex)
+{
+    const uint64_t pressure = memoryPressure_ ? memoryPressure_->exchange(0, std::memory_order_relaxed) : 0;
+    if (pressure > 0) {
+        // Retiring levels are already on their way out, so only what stays counts toward the cut.
+        const uint64_t held = stats_.allocatedBytes - std::min(stats_.allocatedBytes, retiringBytes());
+        effectiveBudgetBytes_ = std::min(effectiveBudgetBytes_, held - std::min(held, pressure));
+        ++stats_.pressureEvents;
+        (void)evictFor(0, kNoTexture, frameIndex);
+    }
+    else if (effectiveBudgetBytes_ < budgetBytes_) {
+        // Grow back slowly so a heap hovering at its limit is not refilled every frame.
+        effectiveBudgetBytes_ = std::min(budgetBytes_, effectiveBudgetBytes_ + std::max<uint64_t>(1, budgetBytes_ / 256));
+    }
+    stats_.effectiveBudgetBytes = effectiveBudgetBytes_;
+}
+
+VkDescriptorSet TextureManager::descriptorSet(uint32_t textureId) const noexcept
+{
+    if (const auto it = textures_.find(textureId); it != textures_.end()) {
+        return it->second.streamed.valid() ? it->second.streamed.descriptorSet : it->second.tail.descriptorSet;
+    }
+    return defaultTexture_.descriptorSet;
+}
@@ -0,0 +1,266 @@
+#include "TlsfAllocator.h"
+
+#include <algorithm>
+#include <bit>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+[[nodiscard]] uint32_t mostSignificantBit(uint64_t value) noexcept
+{
+    return 63u - static_cast<uint32_t>(std::countl_zero(value));
+}
+}
+
+TlsfAllocator::TlsfAllocator(uint64_t capacity)
+    : capacity_(capacity)
+{
+    if (capacity_ == 0) {
+        throw std::runtime_error("TlsfAllocator: capacity must be non-zero");
+    }
+    for (auto& heads : freeHeads_) {
+        heads.fill(kInvalidNode);
+    }
+
+    const uint32_t node = acquireNode();
+    nodes_[node].offset = 0;
+    nodes_[node].size = capacity_;
+    insertFree(node);
+}
+
+TlsfAllocator::Bucket TlsfAllocator::bucketFor(uint64_t size) noexcept
+{
+    if (size < kSmallSize) {
+        return Bucket{ 0, static_cast<uint32_t>(size) };
+    }
+    const uint32_t msb = mostSignificantBit(size);
+    return Bucket{
+        msb - kSecondLevelLog2 + 1,
+        static_cast<uint32_t>(size >> (msb - kSecondLevelLog2)) ^ kSecondLevelCount
+    };
+}
+
+TlsfAllocator::Bucket TlsfAllocator::searchBucketFor(uint64_t size) noexcept
+{
+    if (size >= kSmallSize) {
+        const uint64_t round = (1ull << (mostSignificantBit(size) - kSecondLevelLog2)) - 1;
+        if (size > std::numeric_limits<uint64_t>::max() - round) {
+            return Bucket{ kFirstLevelCount, 0 };
+        }
+        size += round;
+    }
+    return bucketFor(size);
+}
+
+uint32_t TlsfAllocator::findFreeNode(uint64_t size) const noexcept
+{
+    Bucket bucket = searchBucketFor(size);
+    if (bucket.firstLevel >= kFirstLevelCount) {
+        return kInvalidNode;
+    }
+
+    uint32_t secondLevelMap = secondLevelBitmaps_[bucket.firstLevel] & (~0u << bucket.secondLevel);
+    if (secondLevelMap == 0) {
+        const uint32_t nextLevel = bucket.firstLevel + 1;
+        const uint64_t firstLevelMap = nextLevel < 64 ? (firstLevelBitmap_ & (~0ull << nextLevel)) : 0;
+        if (firstLevelMap == 0) {
+            return kInvalidNode;
+        }
+        bucket.firstLevel = static_cast<uint32_t>(std::countr_zero(firstLevelMap));
+        secondLevelMap = secondLevelBitmaps_[bucket.firstLevel];
+    }
+    bucket.secondLevel = static_cast<uint32_t>(std::countr_zero(secondLevelMap));
+    return freeHeads_[bucket.firstLevel][bucket.secondLevel];
+}
+
+void TlsfAllocator::insertFree(uint32_t node) noexcept
+{
+    const Bucket bucket = bucketFor(nodes_[node].size);
+    uint32_t& head = freeHeads_[bucket.firstLevel][bucket.secondLevel];
+
+    nodes_[node].free = true;
+    nodes_[node].prevFree = kInvalidNode;
+    nodes_[node].nextFree = head;
+    if (head != kInvalidNode) {
+        nodes_[head].prevFree = node;
+    }
+    head = node;
+
+    secondLevelBitmaps_[bucket.firstLevel] |= 1u << bucket.secondLevel;
+    firstLevelBitmap_ |= 1ull << bucket.firstLevel;
+    freeBytes_ += nodes_[node].size;
+    ++freeRangeCount_;
+}
+
+void TlsfAllocator::removeFree(uint32_t node) noexcept
+{
+    const Bucket bucket = bucketFor(nodes_[node].size);
+    uint32_t& head = freeHeads_[bucket.firstLevel][bucket.secondLevel];
+
+    Node& entry = nodes_[node];
+    if (entry.prevFree != kInvalidNode) {
+        nodes_[entry.prevFree].nextFree = entry.nextFree;
+    }
+    if (entry.nextFree != kInvalidNode) {
+        nodes_[entry.nextFree].prevFree = entry.prevFree;
+    }
+    if (head == node) {
+        head = entry.nextFree;
+        if (head == kInvalidNode) {
+            secondLevelBitmaps_[bucket.firstLevel] &= ~(1u << bucket.secondLevel);
+            if (secondLevelBitmaps_[bucket.firstLevel] == 0) {
+                firstLevelBitmap_ &= ~(1ull << bucket.firstLevel);
+            }
+        }
+    }
+
+    entry.free = false;
+    entry.prevFree = kInvalidNode;
+    entry.nextFree = kInvalidNode;
+    freeBytes_ -= entry.size;
+    --freeRangeCount_;
+}
+
+uint32_t TlsfAllocator::acquireNode()
+{
+    if (!unusedNodes_.empty()) {
+        const uint32_t node = unusedNodes_.back();
+        unusedNodes_.pop_back();
+        return node;
+    }
+    if (nodes_.size() >= kInvalidNode) {
+        throw std::runtime_error("TlsfAllocator: node pool exhausted");
+    }
+    nodes_.emplace_back();
+    return static_cast<uint32_t>(nodes_.size() - 1);
+}
+
+void TlsfAllocator::releaseNode(uint32_t node) noexcept
+{
+    // Size 0 marks the slot unused, so a stale handle passed to free() is ignored.
+    nodes_[node] = Node{};
+    unusedNodes_.push_back(node);
+}
+
+std::optional<TlsfAllocator::Allocation> TlsfAllocator::allocate(uint64_t size, uint64_t alignment)
+{
+    size = std::max<uint64_t>(size, 1);
+    alignment = std::max<uint64_t>(alignment, 1);
+    if (!std::has_single_bit(alignment)) {
+        throw std::runtime_error("TlsfAllocator: alignment must be a power of two");
+    }
+    if (size > capacity_ || alignment - 1 > capacity_ - size) {
+        return std::nullopt;
+    }
+
+    // Searching for the worst-case padded size keeps the lookup O(1): any range in the found
+    // bucket fits the request wherever its offset lands relative to the alignment. That search
+    // alone passes over holes that fit once aligned, such as a freed 64 KiB image's range when
+    // another 64 KiB image asks for 64 KiB alignment, so the head of the unpadded size's bucket
+    // is tried at its real offset first.
+    uint32_t node = kInvalidNode;
+    if (alignment > 1) {
+        const uint32_t candidate = findFreeNode(size);
+        if (candidate != kInvalidNode) {
+            const uint64_t candidateOffset = (nodes_[candidate].offset + alignment - 1) & ~(alignment - 1);
+            if (candidateOffset + size <= nodes_[candidate].offset + nodes_[candidate].size) {
+                node = candidate;
+            }
+        }
+    }
+    if (node == kInvalidNode) {
+        node = findFreeNode(size + alignment - 1);
+    }
+    if (node == kInvalidNode) {
+        return std::nullopt;
+    }
+
+    // Reserve the split nodes up front so a throwing acquire leaves the free lists intact.
+    const uint64_t alignedOffset = (nodes_[node].offset + alignment - 1) & ~(alignment - 1);
+    const uint64_t padding = alignedOffset - nodes_[node].offset;
+    const uint64_t tail = nodes_[node].size - padding - size;
+    const uint32_t paddingNode = padding > 0 ? acquireNode() : kInvalidNode;
+    const uint32_t tailNode = tail > 0 ? acquireNode() : kInvalidNode;
+
+    removeFree(node);
+
+    if (paddingNode != kInvalidNode) {
+        Node& pad = nodes_[paddingNode];
+        pad.offset = nodes_[node].offset;
+        pad.size = padding;
+        pad.prevPhysical = nodes_[node].prevPhysical;
+        pad.nextPhysical = node;
+        if (pad.prevPhysical != kInvalidNode) {
+            nodes_[pad.prevPhysical].nextPhysical = paddingNode;
+        }
+        nodes_[node].prevPhysical = paddingNode;
+        nodes_[node].offset = alignedOffset;
+        nodes_[node].size -= padding;
+        insertFree(paddingNode);
+    }
+
+    if (tailNode != kInvalidNode) {
+        Node& rest = nodes_[tailNode];
+        rest.offset = alignedOffset + size;
+        rest.size = tail;
+        rest.prevPhysical = node;
+        rest.nextPhysical = nodes_[node].nextPhysical;
+        if (rest.nextPhysical != kInvalidNode) {
+            nodes_[rest.nextPhysical].prevPhysical = tailNode;
+        }
+        nodes_[node].nextPhysical = tailNode;
+        nodes_[node].size = size;
+        insertFree(tailNode);
+    }
+
+    ++allocationCount_;
+    return Allocation{ .offset = alignedOffset, .size = size, .node = node };
+}
+
+void TlsfAllocator::free(uint32_t node) noexcept
+{
+    if (node >= nodes_.size() || nodes_[node].free || nodes_[node].size == 0) {
+        return;
+    }
+    --allocationCount_;
+
+    const uint32_t prev = nodes_[node].prevPhysical;
+    if (prev != kInvalidNode && nodes_[prev].free) {
+        removeFree(prev);
+        nodes_[prev].size += nodes_[node].size;
+        nodes_[prev].nextPhysical = nodes_[node].nextPhysical;
+        if (nodes_[prev].nextPhysical != kInvalidNode) {
+            nodes_[nodes_[prev].nextPhysical].prevPhysical = prev;
+        }
+        releaseNode(node);
+        node = prev;
+    }
+
+    const uint32_t next = nodes_[node].nextPhysical;
+    if (next != kInvalidNode && nodes_[next].free) {
+        removeFree(next);
+        nodes_[node].size += nodes_[next].size;
+        nodes_[node].nextPhysical = nodes_[next].nextPhysical;
+        if (nodes_[node].nextPhysical != kInvalidNode) {
+            nodes_[nodes_[node].nextPhysical].prevPhysical = node;
+        }
+        releaseNode(next);
+    }
+
+    insertFree(node);
+}
+
+uint64_t TlsfAllocator::largestFreeRange() const noexcept
+{
+    if (firstLevelBitmap_ == 0) {
+        return 0;
+    }
+    const uint32_t firstLevel = mostSignificantBit(firstLevelBitmap_);
+    const uint32_t secondLevel = 31u - static_cast<uint32_t>(std::countl_zero(secondLevelBitmaps_[firstLevel]));
+
+    uint64_t largest = 0;
+    for (uint32_t node = freeHeads_[firstLevel][secondLevel]; node != kInvalidNode; node = nodes_[node].nextFree) {
+        largest = std::max(largest, nodes_[node].size);
+    }
+    return largest;
+}
@@ -0,0 +1,278 @@
+#include "TransientResourcePool.h"
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+namespace {
+constexpr VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment) noexcept
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+}
+
+TransientResourcePool::TransientResourcePool(const Config& config)
+    : allocator_(config.allocator)
+{
+    if (allocator_ == nullptr || !allocator_->valid()) {
+        throw std::runtime_error("TransientResourcePool: allocator is null");
+    }
+    if (config.framesInFlight == 0) {
+        throw std::runtime_error("TransientResourcePool: framesInFlight must be > 0");
+    }
+    device_ = allocator_->device();
+    frames_.resize(config.framesInFlight);
+}
+
+TransientResourcePool::~TransientResourcePool() noexcept
+{
+    for (FrameSet& frame : frames_) {
+        destroy(frame);
+    }
+}
+
+vkutil::VkExpected<void> TransientResourcePool::realize(RenderTaskGraph& graph, uint32_t frameSlot)
+{
+    if (!valid() || frameSlot >= frames_.size()) {
+        return vkutil::makeError("TransientResourcePool::realize", VK_ERROR_INITIALIZATION_FAILED, "transient_pool", "invalid_frame_slot");
+    }
+
+    const uint64_t shapeKey = graph.transientShapeKey();
+    if (!layout_.has_value() || layout_->shapeKey != shapeKey) {
+        auto plan = graph.compileTransientPlan();
+        if (!plan.hasValue()) {
+            return vkutil::VkExpected<void>(plan.context());
+        }
+        for (const RenderTaskGraph::TransientAliasAllocation& allocation : plan.value().aliasAllocations) {
+            if (allocation.type == RenderTaskGraph::ResourceType::Buffer && allocation.bufferUsage == 0) {
+                return vkutil::makeError("TransientResourcePool::realize", VK_ERROR_INITIALIZATION_FAILED, "transient_pool", "transient_buffer_usage_missing");
+            }
+        }
+        layout_ = Layout{ .shapeKey = shapeKey, .plan = std::move(plan.value()) };
+    }
+
+    FrameSet& frame = frames_[frameSlot];
+    if (!frame.built || frame.shapeKey != shapeKey) {
+        // The fence wait for this slot has retired every frame that used the old set.
+        destroy(frame);
+        try {
+            build(frame);
+        } catch (const vkutil::VkException& ex) {
+            destroy(frame);
+            return vkutil::VkExpected<void>(ex.result());
+        } catch (...) {
+            destroy(frame);
+            return vkutil::VkExpected<void>(vkutil::exceptionToVkResult());
+        }
+        frame.shapeKey = shapeKey;
+        frame.built = true;
+        ++stats_.frameBuilds;
+    }
+    else {
+        ++stats_.reuses;
+    }
+
+    return graph.bindTransientResources(frame.bindings);
+}
+
+bool TransientResourcePool::lifetimesOverlap(const RenderTaskGraph::TransientAliasAllocation& lhs,
+    const RenderTaskGraph::TransientAliasAllocation& rhs) noexcept
+{
+    return lhs.firstUseOrder <= rhs.lastUseOrder && rhs.firstUseOrder <= lhs.lastUseOrder;
+}
+
+void TransientResourcePool::build(FrameSet& frame)
+{
+    const std::vector<RenderTaskGraph::TransientAliasAllocation>& slots = layout_->plan.aliasAllocations;
+
+    std::vector<VkMemoryRequirements> requirements(slots.size());
+    frame.objects.resize(slots.size());
+    for (size_t i = 0; i < slots.size(); ++i) {
+        const RenderTaskGraph::TransientAliasAllocation& slot = slots[i];
+        Object& object = frame.objects[i];
+        if (slot.type == RenderTaskGraph::ResourceType::Image) {
+            VkImageCreateInfo ci{ VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO };
+            ci.imageType = slot.imageType;
+            ci.format = slot.imageFormat;
+            ci.extent = slot.requiredImageExtent;
+            ci.mipLevels = slot.imageMipLevels;
+            ci.arrayLayers = slot.imageArrayLayers;
+            ci.samples = slot.imageSamples;
+            ci.tiling = VK_IMAGE_TILING_OPTIMAL;
+            ci.usage = slot.imageUsage;
+            ci.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+            ci.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            const VkResult res = vkCreateImage(device_, &ci, nullptr, &object.image);
+            if (res != VK_SUCCESS) {
+                vkutil::throwVkError("vkCreateImage", res);
+            }
+            vkGetImageMemoryRequirements(device_, object.image, &requirements[i]);
+        }
+        else {
+            VkBufferCreateInfo ci{ VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
+            ci.size = std::max<VkDeviceSize>(slot.requiredBufferSize, 1);
+            ci.usage = slot.bufferUsage;
+            ci.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+            const VkResult res = vkCreateBuffer(device_, &ci, nullptr, &object.buffer);
+            if (res != VK_SUCCESS) {
+                vkutil::throwVkError("vkCreateBuffer", res);
+            }
+            vkGetBufferMemoryRequirements(device_, object.buffer, &requirements[i]);
+            requirements[i].alignment = std::max(requirements[i].alignment, slot.requiredBufferAlignment);
+        }
+    }
+
+    if (!layout_->placed) {
+        place(requirements);
+    }
+    // Identical create infos give identical requirements, so the cached offsets still hold.
+    for (size_t i = 0; i < slots.size(); ++i) {
+        const Placement& placement = layout_->placements[i];
+        const HeapLayout& heap = layout_->heaps[placement.heap];
+        if (requirements[i].size > placement.size || placement.offset % requirements[i].alignment != 0
+            || (requirements[i].memoryTypeBits & heap.memoryTypeBits) != heap.memoryTypeBits) {
+            throw std::runtime_error("TransientResourcePool: memory requirements changed under an unchanged shape");
+        }
+    }
+
+    frame.heaps.reserve(layout_->heaps.size());
+    for (const HeapLayout& heap : layout_->heaps) {
+        const VkMemoryRequirements req{ heap.size, heap.alignment, heap.memoryTypeBits };
+        frame.heaps.push_back(heap.type == RenderTaskGraph::ResourceType::Image
+            ? allocator_->allocateForImage(req, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_NULL_HANDLE, true,
+                  GpuAllocator::LifetimeClass::Transient, GpuAllocator::Pool::Transient)
+            : allocator_->allocateForBuffer(req, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0, VK_NULL_HANDLE, true,
+                  GpuAllocator::LifetimeClass::Transient, GpuAllocator::Pool::Transient));
+    }
+
+    for (size_t i = 0; i < slots.size(); ++i) {
+        const Placement& placement = layout_->placements[i];
+        const GpuAllocator::Allocation& heap = frame.heaps[placement.heap];
+        const Object& object = frame.objects[i];
+        const VkResult res = object.image != VK_NULL_HANDLE
+            ? vkBindImageMemory(device_, object.image, heap.memory, heap.offset + placement.offset)
+            : vkBindBufferMemory(device_, object.buffer, heap.memory, heap.offset + placement.offset);
+        if (res != VK_SUCCESS) {
+            vkutil::throwVkError(object.image != VK_NULL_HANDLE ? "vkBindImageMemory" : "vkBindBufferMemory", res);
+        }
+    }
+
+    frame.bindings = layout_->bindings;
+    for (RenderTaskGraph::TransientBinding& binding : frame.bindings) {
+        const Object& object = frame.objects[layout_->plan.aliasSlotByResource.at(binding.resource) - 1];
+        binding.image = object.image;
+        binding.buffer = object.buffer;
+    }
+}
+
+void TransientResourcePool::place(const std::vector<VkMemoryRequirements>& requirements)
+{
+    const std::vector<RenderTaskGraph::TransientAliasAllocation>& slots = layout_->plan.aliasAllocations;
+    std::vector<Placement>& placements = layout_->placements;
+    std::vector<HeapLayout>& heaps = layout_->heaps;
+    placements.assign(slots.size(), Placement{});
+    heaps.clear();
+
+    // Largest first, so small slots fill the gaps the large ones leave.
+    std::vector<size_t> order(slots.size());
+    std::iota(order.begin(), order.end(), size_t{ 0 });
+    std::ranges::stable_sort(order, [&](size_t lhs, size_t rhs) { return requirements[lhs].size > requirements[rhs].size; });
+
+    std::vector<bool> isPlaced(slots.size(), false);
+    for (const size_t index : order) {
+        const VkMemoryRequirements& req = requirements[index];
+        const VkDeviceSize alignment = std::max<VkDeviceSize>(req.alignment, 1);
+
+        uint32_t heapIndex = 0;
+        while (heapIndex < heaps.size()
+            && (heaps[heapIndex].type != slots[index].type || (heaps[heapIndex].memoryTypeBits & req.memoryTypeBits) == 0)) {
+            ++heapIndex;
+        }
+        if (heapIndex == heaps.size()) {
+            heaps.push_back(HeapLayout{ .type = slots[index].type, .memoryTypeBits = req.memoryTypeBits });
+        }
+        HeapLayout& heap = heaps[heapIndex];
+
+        // Lowest offset clear of every slot in the heap that is live at the same time.
+        std::vector<const Placement*> conflicts{};
+        for (size_t other = 0; other < slots.size(); ++other) {
+            if (isPlaced[other] && placements[other].heap == heapIndex && lifetimesOverlap(slots[index], slots[other])) {
+                conflicts.push_back(&placements[other]);
+            }
+        }
+        std::ranges::sort(conflicts, {}, &Placement::offset);
+        VkDeviceSize offset = 0;
+        for (const Placement* conflict : conflicts) {
+            if (alignUp(offset, alignment) + req.size <= conflict->offset) {
+                break;
+            }
+            offset = std::max(offset, conflict->offset + conflict->size);
+        }
+        offset = alignUp(offset, alignment);
+
+        placements[index] = Placement{ .heap = heapIndex, .offset = offset, .size = req.size };
+        isPlaced[index] = true;
+        heap.memoryTypeBits &= req.memoryTypeBits;
+        heap.alignment = std::max(heap.alignment, alignment);
+        heap.size = std::max(heap.size, offset + req.size);
+    }
+
+    // A resource reuses the memory of the resource before it in its own slot, and the first
+    // resource of a slot that of the last resource of every earlier slot it overlaps.
+    layout_->bindings.clear();
+    for (size_t index = 0; index < slots.size(); ++index) {
+        const RenderTaskGraph::TransientAliasAllocation& slot = slots[index];
+        const Placement& placement = placements[index];
+        std::vector<RenderTaskGraph::ResourceId> previousOccupants{};
+        for (size_t other = 0; other < slots.size(); ++other) {
+            const Placement& otherPlacement = placements[other];
+            const bool sharesMemory = otherPlacement.heap == placement.heap
+                && otherPlacement.offset < placement.offset + placement.size
+                && placement.offset < otherPlacement.offset + otherPlacement.size;
+            if (other != index && sharesMemory && slots[other].lastUseOrder < slot.firstUseOrder && !slots[other].resources.empty()) {
+                previousOccupants.push_back(slots[other].resources.back());
+            }
+        }
+
+        for (size_t i = 0; i < slot.resources.size(); ++i) {
+            RenderTaskGraph::TransientBinding binding{ .resource = slot.resources[i] };
+            if (i == 0) {
+                binding.aliasedAfter = previousOccupants;
+            }
+            else {
+                binding.aliasedAfter.push_back(slot.resources[i - 1]);
+            }
+            layout_->bindings.push_back(std::move(binding));
+        }
+    }
+    layout_->placed = true;
+
+    ++stats_.placements;
+    stats_.resources = static_cast<uint32_t>(layout_->bindings.size());
+    stats_.objects = static_cast<uint32_t>(slots.size());
+    stats_.heaps = static_cast<uint32_t>(heaps.size());
+    stats_.heapBytes = 0;
+    for (const HeapLayout& heap : heaps) {
+        stats_.heapBytes += heap.size;
+    }
+    stats_.objectBytes = 0;
+    for (const VkMemoryRequirements& req : requirements) {
+        stats_.objectBytes += req.size;
+    }
+}
+
+void TransientResourcePool::destroy(FrameSet& frame) noexcept
+{
+    for (const Object& object : frame.objects) {
+        if (object.image != VK_NULL_HANDLE) {
+            vkDestroyImage(device_, object.image, nullptr);
+        }
+        if (object.buffer != VK_NULL_HANDLE) {
+            vkDestroyBuffer(device_, object.buffer, nullptr);
+        }
+    }
+    for (const GpuAllocator::Allocation& heap : frame.heaps) {
+        allocator_->free(heap);
+    }
+    frame = FrameSet{};
+}
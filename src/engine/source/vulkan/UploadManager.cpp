@@ -0,0 +1,406 @@
+#include "UploadManager.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+#include "VkUtils.h"
+
+namespace {
+// vkCmdCopyBuffer has no offset requirement; 4 keeps dword-sized uploads contiguous so they merge.
+constexpr VkDeviceSize kBufferAlignment = 4;
+// A multiple of every texel block size the engine uploads and of the transfer queue's 4 bytes.
+constexpr VkDeviceSize kImageAlignment = 16;
+
+VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment) noexcept
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+bool sameTarget(const UploadManager::ImageTarget& a, const UploadManager::ImageTarget& b) noexcept
+{
+    return a.image == b.image && a.finalLayout == b.finalLayout
+        && a.range.aspectMask == b.range.aspectMask
+        && a.range.baseMipLevel == b.range.baseMipLevel && a.range.levelCount == b.range.levelCount
+        && a.range.baseArrayLayer == b.range.baseArrayLayer && a.range.layerCount == b.range.layerCount;
+}
+}
+
+UploadManager::UploadManager(const Config& config)
+    : device_(config.device)
+    , queue_(config.queue)
+    , batchBytes_(config.batchBytes)
+{
+    if (device_ == VK_NULL_HANDLE || config.allocator == nullptr) {
+        throw std::runtime_error("UploadManager: device/allocator is null");
+    }
+    if (!queue_.valid()) {
+        throw std::runtime_error("UploadManager: queue is invalid");
+    }
+    if (config.ringBytes < 4 * kImageAlignment) {
+        throw std::runtime_error("UploadManager: ringBytes is too small");
+    }
+
+    timeline_ = TimelineSemaphore(device_, 0);
+    ring_ = VulkanBuffer(*config.allocator, alignUp(config.ringBytes, kImageAlignment), VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, false, VulkanBuffer::AllocationPolicy::Upload);
+    ringData_ = static_cast<uint8_t*>(ring_.map());
+    stats_.ringBytes = ring_.getSize();
+}
+
+UploadManager::~UploadManager()
+{
+    if (!inFlight_.empty()) {
+        // Nothing useful can be done about a lost device here; the handles go away regardless.
+        (void)timeline_.wait(inFlight_.back().value);
+    }
+}
+
+UploadManager::Token UploadManager::uploadBuffer(VkBuffer destination, VkDeviceSize destinationOffset, const void* data, VkDeviceSize size)
+{
+    if (destination == VK_NULL_HANDLE || (data == nullptr && size > 0)) {
+        throw std::runtime_error("UploadManager: uploadBuffer needs a destination and data");
+    }
+
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    const VkDeviceSize maxChunk = ring_.getSize() / 4;
+    VkDeviceSize done = 0;
+    while (done < size) {
+        const VkDeviceSize chunk = std::min(size - done, maxChunk);
+        const VkDeviceSize dstOffset = destinationOffset + done;
+
+        // Regions of one vkCmdCopyBuffer must not overlap; a rewrite of a queued range starts a
+        // new batch so the copies stay in order.
+        if (const auto it = bufferIndex_.find(destination); it != bufferIndex_.end()) {
+            const auto& regions = bufferCopies_[it->second].regions;
+            const bool overlaps = std::any_of(regions.begin(), regions.end(), [&](const VkBufferCopy& region) {
+                return dstOffset < region.dstOffset + region.size && region.dstOffset < dstOffset + chunk;
+            });
+            if (overlaps) {
+                submitBatch();
+            }
+        }
+
+        const VkDeviceSize srcOffset = allocateRing(chunk, kBufferAlignment);
+        std::memcpy(ringData_ + srcOffset, bytes + done, static_cast<size_t>(chunk));
+
+        const auto [it, inserted] = bufferIndex_.try_emplace(destination, bufferCopies_.size());
+        if (inserted) {
+            bufferCopies_.push_back(BufferCopies{ .buffer = destination });
+        }
+        std::vector<VkBufferCopy>& regions = bufferCopies_[it->second].regions;
+        if (!regions.empty() && regions.back().srcOffset + regions.back().size == srcOffset
+            && regions.back().dstOffset + regions.back().size == dstOffset) {
+            regions.back().size += chunk;
+            ++stats_.mergedRegions;
+        }
+        else {
+            regions.push_back(VkBufferCopy{ srcOffset, dstOffset, chunk });
+        }
+        done += chunk;
+    }
+
+    ++stats_.uploads;
+    stats_.uploadedBytes += size;
+    const Token token = pendingToken();
+    maybeSubmit();
+    return token;
+}
+
+UploadManager::Token UploadManager::uploadImage(const ImageTarget& target, std::span<const ImageRegion> regions)
+{
+    if (target.image == VK_NULL_HANDLE || regions.empty()) {
+        throw std::runtime_error("UploadManager: uploadImage needs an image and regions");
+    }
+    VkDeviceSize total = 0;
+    for (const ImageRegion& region : regions) {
+        if (region.data == nullptr || region.size == 0) {
+            throw std::runtime_error("UploadManager: image region without data");
+        }
+        total += alignUp(region.size, kImageAlignment);
+    }
+    if (total > ring_.getSize()) {
+        throw std::runtime_error("UploadManager: image upload is larger than the staging ring");
+    }
+
+    // The image is transitioned once per batch; a second upload into a different range of it
+    // would need its own transition, so it goes into the next batch.
+    const auto findQueued = [&] {
+        return std::find_if(imageCopies_.begin(), imageCopies_.end(),
+            [&](const ImageCopies& copies) { return copies.target.image == target.image; });
+    };
+    if (const auto queued = findQueued(); queued != imageCopies_.end() && !sameTarget(queued->target, target)) {
+        submitBatch();
+    }
+
+    // One ring allocation for every region, so a stall cannot split the image across batches.
+    VkDeviceSize srcOffset = allocateRing(total, kImageAlignment);
+    std::vector<VkBufferImageCopy> copies{};
+    copies.reserve(regions.size());
+    for (const ImageRegion& region : regions) {
+        std::memcpy(ringData_ + srcOffset, region.data, static_cast<size_t>(region.size));
+
+        VkBufferImageCopy copy{};
+        copy.bufferOffset = srcOffset;
+        copy.imageSubresource = { target.range.aspectMask, region.mipLevel, region.baseArrayLayer, region.layerCount };
+        copy.imageOffset = region.offset;
+        copy.imageExtent = region.extent;
+        copies.push_back(copy);
+        srcOffset += alignUp(region.size, kImageAlignment);
+        stats_.uploadedBytes += region.size;
+    }
+    // allocateRing() may have submitted the open batch, so look the image up again.
+    if (const auto queued = findQueued(); queued != imageCopies_.end()) {
+        queued->regions.insert(queued->regions.end(), copies.begin(), copies.end());
+    }
+    else {
+        imageCopies_.push_back(ImageCopies{ .target = target, .regions = std::move(copies) });
+    }
+
+    ++stats_.uploads;
+    const Token token = pendingToken();
+    maybeSubmit();
+    return token;
+}
+
+UploadManager::Token UploadManager::flush()
+{
+    if (!bufferCopies_.empty() || !imageCopies_.empty()) {
+        submitBatch();
+    }
+    return Token{ submittedValue_ };
+}
+
+void UploadManager::collect()
+{
+    const uint64_t completed = completedValue();
+    while (!inFlight_.empty() && inFlight_.front().value <= completed) {
+        Submission& submission = inFlight_.front();
+        ringUsed_ -= submission.ringBytes;
+        freeCommands_.push_back(std::move(submission.commands));
+        inFlight_.pop_front();
+    }
+    if (ringUsed_ == 0) {
+        // An empty ring can start over at 0, so the next allocation never wraps.
+        ringHead_ = 0;
+    }
+    stats_.ringUsedBytes = ringUsed_;
+    stats_.inFlightSubmissions = static_cast<uint32_t>(inFlight_.size());
+}
+
+bool UploadManager::isReady(Token token)
+{
+    return token.value <= completedValue_ || token.value <= completedValue();
+}
+
+void UploadManager::wait(Token token)
+{
+    if (token.value > submittedValue_) {
+        submitBatch();
+    }
+    if (const auto waited = timeline_.wait(token.value); !waited) {
+        vkutil::throwVkError("vkWaitSemaphores", waited.error());
+    }
+    collect();
+}
+
+VkDeviceSize UploadManager::allocateRing(VkDeviceSize size, VkDeviceSize alignment)
+{
+    VkDeviceSize offset = 0;
+    if (tryAllocateRing(size, alignment, offset)) {
+        return offset;
+    }
+
+    ++stats_.ringStalls;
+    // The open batch holds ring space only the GPU can give back, so it has to go first.
+    if (batchRingBytes_ > 0) {
+        submitBatch();
+    }
+    collect();
+    while (!tryAllocateRing(size, alignment, offset)) {
+        if (inFlight_.empty()) {
+            throw std::runtime_error("UploadManager: upload does not fit in the staging ring");
+        }
+        waitOldest();
+    }
+    return offset;
+}
+
+bool UploadManager::tryAllocateRing(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& offset) noexcept
+{
+    const VkDeviceSize capacity = ring_.getSize();
+    const VkDeviceSize aligned = alignUp(ringHead_, alignment);
+    VkDeviceSize cost = 0;
+    if (aligned + size <= capacity) {
+        offset = aligned;
+        cost = aligned - ringHead_ + size;
+    }
+    else {
+        // Skip the tail end of the ring; the wasted bytes are released with this batch.
+        offset = 0;
+        cost = capacity - ringHead_ + size;
+    }
+    if (ringUsed_ + cost > capacity) {
+        return false;
+    }
+
+    ringHead_ = offset + size;
+    ringUsed_ += cost;
+    batchRingBytes_ += cost;
+    stats_.ringUsedBytes = ringUsed_;
+    stats_.peakRingUsedBytes = std::max(stats_.peakRingUsedBytes, ringUsed_);
+    return true;
+}
+
+void UploadManager::waitOldest()
+{
+    if (const auto waited = timeline_.wait(inFlight_.front().value); !waited) {
+        vkutil::throwVkError("vkWaitSemaphores", waited.error());
+    }
+    collect();
+}
+
+uint64_t UploadManager::completedValue()
+{
+    const auto value = timeline_.value();
+    if (!value) {
+        vkutil::throwVkError("vkGetSemaphoreCounterValue", value.error());
+    }
+    completedValue_ = value.value();
+    return completedValue_;
+}
+
+UploadManager::Commands UploadManager::acquireCommands()
+{
+    if (!freeCommands_.empty()) {
+        Commands commands = std::move(freeCommands_.back());
+        freeCommands_.pop_back();
+        const VkResult res = vkResetCommandPool(device_, commands.pool.get(), 0);
+        if (res != VK_SUCCESS) {
+            vkutil::throwVkError("vkResetCommandPool", res);
+        }
+        return commands;
+    }
+
+    Commands commands{};
+    auto pool = VulkanCommandPool::create(device_, queue_.familyIndex());
+    if (!pool) {
+        vkutil::throwVkError("VulkanCommandPool::create", pool.error());
+    }
+    commands.pool = std::move(pool.value());
+    auto buffer = VulkanCommandBuffer::create(device_, commands.pool.get());
+    if (!buffer) {
+        vkutil::throwVkError("VulkanCommandBuffer::create", buffer.error());
+    }
+    commands.buffer = std::move(buffer.value());
+    return commands;
+}
+
+void UploadManager::recordBatch(VkCommandBuffer commandBuffer)
+{
+    // Earlier batches on this queue may still be writing the same destinations.
+    VkMemoryBarrier writeAfterWrite{ VK_STRUCTURE_TYPE_MEMORY_BARRIER };
+    writeAfterWrite.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    writeAfterWrite.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+    std::vector<VkImageMemoryBarrier> barriers{};
+    barriers.reserve(imageCopies_.size());
+    for (const ImageCopies& copies : imageCopies_) {
+        VkImageMemoryBarrier toDst{ VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
+        toDst.srcAccessMask = 0;
+        toDst.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        toDst.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        toDst.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        toDst.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        toDst.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        toDst.image = copies.target.image;
+        toDst.subresourceRange = copies.target.range;
+        barriers.push_back(toDst);
+    }
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+        1, &writeAfterWrite, 0, nullptr, static_cast<uint32_t>(barriers.size()), barriers.data());
+
+    for (const BufferCopies& copies : bufferCopies_) {
+        vkCmdCopyBuffer(commandBuffer, ring_.get(), copies.buffer, static_cast<uint32_t>(copies.regions.size()), copies.regions.data());
+        ++stats_.copyCommands;
+        stats_.copyRegions += copies.regions.size();
+    }
+    for (const ImageCopies& copies : imageCopies_) {
+        vkCmdCopyBufferToImage(commandBuffer, ring_.get(), copies.target.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            static_cast<uint32_t>(copies.regions.size()), copies.regions.data());
+        ++stats_.copyCommands;
+        stats_.copyRegions += copies.regions.size();
+    }
+
+    if (imageCopies_.empty()) {
+        return;
+    }
+    barriers.clear();
+    for (const ImageCopies& copies : imageCopies_) {
+        VkImageMemoryBarrier toFinal{ VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
+        toFinal.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        toFinal.dstAccessMask = 0;
+        toFinal.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        toFinal.newLayout = copies.target.finalLayout;
+        toFinal.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        toFinal.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        toFinal.image = copies.target.image;
+        toFinal.subresourceRange = copies.target.range;
+        barriers.push_back(toFinal);
+    }
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0,
+        0, nullptr, 0, nullptr, static_cast<uint32_t>(barriers.size()), barriers.data());
+}
+
+void UploadManager::submitBatch()
+{
+    if (bufferCopies_.empty() && imageCopies_.empty()) {
+        return;
+    }
+
+    Submission submission{};
+    submission.commands = acquireCommands();
+    VulkanCommandBuffer& commandBuffer = submission.commands.buffer;
+    if (const auto begun = commandBuffer.begin(); !begun) {
+        vkutil::throwVkError("vkBeginCommandBuffer", begun.error());
+    }
+    recordBatch(commandBuffer.get());
+    if (const auto ended = commandBuffer.end(); !ended) {
+        vkutil::throwVkError("vkEndCommandBuffer", ended.error());
+    }
+
+    submission.value = submittedValue_ + 1;
+    const VkCommandBuffer cmd = commandBuffer.get();
+    const VkSemaphore semaphore = timeline_.get();
+    VkTimelineSemaphoreSubmitInfo timelineInfo{ VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO };
+    timelineInfo.signalSemaphoreValueCount = 1;
+    timelineInfo.pSignalSemaphoreValues = &submission.value;
+    VkSubmitInfo submitInfo{ VK_STRUCTURE_TYPE_SUBMIT_INFO };
+    submitInfo.pNext = &timelineInfo;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &cmd;
+    submitInfo.signalSemaphoreCount = 1;
+    submitInfo.pSignalSemaphores = &semaphore;
+    if (const auto submitted = queue_.submit({ submitInfo }, VK_NULL_HANDLE, "uploads"); !submitted) {
+        vkutil::throwVkError("vkQueueSubmit", submitted.error());
+    }
+
+    submittedValue_ = submission.value;
+    submission.ringBytes = batchRingBytes_;
+    inFlight_.push_back(std::move(submission));
+    ++stats_.submissions;
+    stats_.inFlightSubmissions = static_cast<uint32_t>(inFlight_.size());
+
+    bufferCopies_.clear();
+    bufferIndex_.clear();
+    imageCopies_.clear();
+    batchRingBytes_ = 0;
+}
+
+void UploadManager::maybeSubmit()
+{
+    if (batchRingBytes_ >= batchBytes_) {
+        submitBatch();
+    }
+}
@@ -4,63 +4,29 @@
 #include "VkBuffer.h"
 #include "VkUtils.h"
 
-namespace {
-VkDeviceSize getNonCoherentAtomSize(VkPhysicalDevice physicalDevice)
-{
-    VkPhysicalDeviceProperties props{};
-    vkGetPhysicalDeviceProperties(physicalDevice, &props);
-    return std::max<VkDeviceSize>(1, props.limits.nonCoherentAtomSize);
-}
-}
-
-VulkanBuffer::VulkanBuffer(VkDevice device_,
-    VkPhysicalDevice physicalDevice_,
-    VkDeviceSize size_,
-    VkBufferUsageFlags usage,
-    VkMemoryPropertyFlags memoryProperties,
-    bool bufferDeviceAddressEnabled,
-    bool requiresDeviceAddress,
-    AllocationPolicy allocationPolicy,
-    const std::vector<uint32_t>& queueFamilyIndices)
-    : device(device_)
-    , physicalDevice(physicalDevice_)
-    , size(size_)
-    , memoryProps(memoryProperties)
-    , ownedAllocator(std::make_unique<GpuAllocator>(device_, physicalDevice_, bufferDeviceAddressEnabled))
-    , allocator(ownedAllocator.get())
-    , requiresDeviceAddress_(requiresDeviceAddress)
-    , bufferDeviceAddressEnabled_(bufferDeviceAddressEnabled)
-    , allocationPolicy_(allocationPolicy)
-{
-    if (device == VK_NULL_HANDLE || physicalDevice == VK_NULL_HANDLE) {
-        throw std::runtime_error("VulkanBuffer: device/physicalDevice is null");
-    }
-    nonCoherentAtomSize = getNonCoherentAtomSize(physicalDevice);
-    validateAllocationPolicy(memoryProperties);
-    validateDeviceAddressRequirements(usage);
-    createBuffer(size, usage, memoryProperties, queueFamilyIndices);
-}
-
 VulkanBuffer::VulkanBuffer(GpuAllocator& allocator_,
     VkDeviceSize size_,
     VkBufferUsageFlags usage,
     VkMemoryPropertyFlags memoryProperties,
     bool requiresDeviceAddress,
     AllocationPolicy allocationPolicy,
-    const std::vector<uint32_t>& queueFamilyIndices)
+    const std::vector<uint32_t>& queueFamilyIndices,
+    GpuAllocator::Priority priority)
     : device(allocator_.device())
     , physicalDevice(allocator_.physicalDevice())
     , size(size_)
     , memoryProps(memoryProperties)
+    , usage_(usage)
+    , queueFamilyIndices_(queueFamilyIndices)
     , allocator(&allocator_)
     , requiresDeviceAddress_(requiresDeviceAddress)
     , bufferDeviceAddressEnabled_(allocator_.bufferDeviceAddressEnabled())
     , allocationPolicy_(allocationPolicy)
+    , priority_(priority)
 {
     if (!allocator->valid()) {
         throw std::runtime_error("VulkanBuffer: allocator is invalid");
     }
-    nonCoherentAtomSize = allocator->nonCoherentAtomSize();
     validateAllocationPolicy(memoryProperties);
     validateDeviceAddressRequirements(usage);
     createBuffer(size, usage, memoryProperties, queueFamilyIndices);
@@ -116,15 +82,20 @@ void VulkanBuffer::createBuffer(VkDeviceSize size_,
         memoryProperties,
         false);
 
-    allocation = allocator->allocateForBuffer(req, memoryProperties, allocationFlags, buffer, useDedicatedAllocation, lifetimeClass);
+    try {
+        allocation = allocator->allocateForBuffer(req, memoryProperties, allocationFlags, buffer, useDedicatedAllocation,
+            lifetimeClass, poolForPolicy(allocationPolicy_), priority_);
+    }
+    catch (...) {
+        // Out-of-memory is recoverable for the caller, so the half-built buffer must not leak.
+        vkDestroyBuffer(device, buffer, nullptr);
+        buffer = VK_NULL_HANDLE;
+        throw;
+    }
 
     const VkResult bindRes = vkBindBufferMemory(device, buffer, allocation.memory, allocation.offset);
     if (bindRes != VK_SUCCESS) {
-        if (allocator) {
-            allocator->free(allocation);
-        } else {
-            vkFreeMemory(device, allocation.memory, nullptr);
-        }
+        allocator->free(allocation);
         allocation = {};
         vkDestroyBuffer(device, buffer, nullptr);
         buffer = VK_NULL_HANDLE;
@@ -138,15 +109,17 @@ VulkanBuffer::VulkanBuffer(VulkanBuffer&& other) noexcept
     , buffer(std::exchange(other.buffer, VK_NULL_HANDLE))
     , size(std::exchange(other.size, 0))
     , memoryProps(std::exchange(other.memoryProps, 0))
+    , usage_(std::exchange(other.usage_, 0))
+    , queueFamilyIndices_(std::move(other.queueFamilyIndices_))
     , allocator(std::exchange(other.allocator, nullptr))
     , allocation(std::exchange(other.allocation, GpuAllocator::Allocation{}))
     , mappedPtr(std::exchange(other.mappedPtr, nullptr))
     , mappedOffset(std::exchange(other.mappedOffset, 0))
     , mappedSize(std::exchange(other.mappedSize, 0))
-    , nonCoherentAtomSize(std::exchange(other.nonCoherentAtomSize, 1))
     , requiresDeviceAddress_(std::exchange(other.requiresDeviceAddress_, false))
     , bufferDeviceAddressEnabled_(std::exchange(other.bufferDeviceAddressEnabled_, false))
     , allocationPolicy_(std::exchange(other.allocationPolicy_, AllocationPolicy::Auto))
+    , priority_(std::exchange(other.priority_, GpuAllocator::Priority::Normal))
 {}
 
 VulkanBuffer& VulkanBuffer::operator=(VulkanBuffer&& other) noexcept
@@ -158,15 +131,17 @@ VulkanBuffer& VulkanBuffer::operator=(VulkanBuffer&& other) noexcept
         buffer = std::exchange(other.buffer, VK_NULL_HANDLE);
         size = std::exchange(other.size, 0);
         memoryProps = std::exchange(other.memoryProps, 0);
+        usage_ = std::exchange(other.usage_, 0);
+        queueFamilyIndices_ = std::move(other.queueFamilyIndices_);
         allocator = std::exchange(other.allocator, nullptr);
         allocation = std::exchange(other.allocation, GpuAllocator::Allocation{});
         mappedPtr = std::exchange(other.mappedPtr, nullptr);
         mappedOffset = std::exchange(other.mappedOffset, 0);
         mappedSize = std::exchange(other.mappedSize, 0);
-        nonCoherentAtomSize = std::exchange(other.nonCoherentAtomSize, 1);
         requiresDeviceAddress_ = std::exchange(other.requiresDeviceAddress_, false);
         bufferDeviceAddressEnabled_ = std::exchange(other.bufferDeviceAddressEnabled_, false);
         allocationPolicy_ = std::exchange(other.allocationPolicy_, AllocationPolicy::Auto);
+        priority_ = std::exchange(other.priority_, GpuAllocator::Priority::Normal);
     }
     return *this;
 }
@@ -176,6 +151,14 @@ VulkanBuffer::~VulkanBuffer() noexcept
     reset();
 }
 
+VulkanBuffer VulkanBuffer::makeRelocationTarget(VkBufferUsageFlags usageExtra) const
+{
+    if (!valid()) {
+        throw std::runtime_error("VulkanBuffer: cannot relocate an empty buffer");
+    }
+    return VulkanBuffer(*allocator, size, usage_ | usageExtra, memoryProps, requiresDeviceAddress_, allocationPolicy_, queueFamilyIndices_, priority_);
+}
+
 void VulkanBuffer::reset() noexcept
 {
     unmap();
@@ -184,24 +167,22 @@ void VulkanBuffer::reset() noexcept
         vkDestroyBuffer(device, buffer, nullptr);
         buffer = VK_NULL_HANDLE;
     }
-    if (allocation.memory != VK_NULL_HANDLE) {
-        if (allocator) {
-            allocator->free(allocation);
-        } else {
-            vkFreeMemory(device, allocation.memory, nullptr);
-        }
-        allocation = {};
+    if (allocation.memory != VK_NULL_HANDLE && allocator) {
+        allocator->free(allocation);
     }
+    allocation = {};
 
     device = VK_NULL_HANDLE;
     physicalDevice = VK_NULL_HANDLE;
     size = 0;
     memoryProps = 0;
+    usage_ = 0;
+    queueFamilyIndices_.clear();
     allocator = nullptr;
-    nonCoherentAtomSize = 1;
     requiresDeviceAddress_ = false;
     bufferDeviceAddressEnabled_ = false;
     allocationPolicy_ = AllocationPolicy::Auto;
+    priority_ = GpuAllocator::Priority::Normal;
 }
 
 
@@ -234,11 +215,11 @@ vkutil::VkExpected<void*> VulkanBuffer::mapResult(VkDeviceSize offset, VkDeviceS
     }
 
     void* ptr = nullptr;
-    const VkResult mapRes = vkMapMemory(device, allocation.memory, allocation.offset + offset, mapSize, 0, &ptr);
+    const VkResult mapRes = allocator->map(allocation, &ptr);
     if (mapRes != VK_SUCCESS) {
         return vkutil::VkExpected<void*>(mapRes);
     }
-    mappedPtr = ptr;
+    mappedPtr = static_cast<uint8_t*>(ptr) + offset;
     mappedOffset = offset;
     mappedSize = normalizedSize;
     return vkutil::VkExpected<void*>(mappedPtr);
@@ -256,12 +237,10 @@ void* VulkanBuffer::map(VkDeviceSize offset, VkDeviceSize mapSize)
 
 void VulkanBuffer::unmap() noexcept
 {
-    if (mappedPtr && allocation.memory != VK_NULL_HANDLE && device != VK_NULL_HANDLE) {
-        vkUnmapMemory(device, allocation.memory);
-        mappedPtr = nullptr;
-        mappedOffset = 0;
-        mappedSize = 0;
-    }
+    // The memory itself stays mapped by the allocator; this only ends the CPU-access window.
+    mappedPtr = nullptr;
+    mappedOffset = 0;
+    mappedSize = 0;
 }
 
 vkutil::VkExpected<void> VulkanBuffer::flushResult(VkDeviceSize offset, VkDeviceSize flushSize) const
@@ -278,8 +257,8 @@ vkutil::VkExpected<void> VulkanBuffer::flushResult(VkDeviceSize offset, VkDevice
 
     auto rangeRes = prepareMappedRange(offset, flushSize, "flush");
     if (!rangeRes.hasValue()) { return vkutil::VkExpected<void>(rangeRes.error()); }
-    const VkMappedMemoryRange range = rangeRes.value();
-    const VkResult flushRes = vkFlushMappedMemoryRanges(device, 1, &range);
+    const GpuAllocator::MappedRange range = rangeRes.value();
+    const VkResult flushRes = allocator->flush({ &range, 1 });
     if (flushRes != VK_SUCCESS) {
         return vkutil::VkExpected<void>(flushRes);
     }
@@ -300,8 +279,8 @@ vkutil::VkExpected<void> VulkanBuffer::invalidateResult(VkDeviceSize offset, VkD
 
     auto rangeRes = prepareMappedRange(offset, invalidateSize, "invalidate");
     if (!rangeRes.hasValue()) { return vkutil::VkExpected<void>(rangeRes.error()); }
-    const VkMappedMemoryRange range = rangeRes.value();
-    const VkResult invalRes = vkInvalidateMappedMemoryRanges(device, 1, &range);
+    const GpuAllocator::MappedRange range = rangeRes.value();
+    const VkResult invalRes = allocator->invalidate({ &range, 1 });
     if (invalRes != VK_SUCCESS) {
         return vkutil::VkExpected<void>(invalRes);
     }
@@ -324,15 +303,15 @@ void VulkanBuffer::invalidate(VkDeviceSize offset, VkDeviceSize invalidateSize)
     }
 }
 
-vkutil::VkExpected<VkMappedMemoryRange> VulkanBuffer::prepareMappedRange(VkDeviceSize offset, VkDeviceSize requestedSize, const char* opName) const
+vkutil::VkExpected<GpuAllocator::MappedRange> VulkanBuffer::prepareMappedRange(VkDeviceSize offset, VkDeviceSize requestedSize, const char* opName) const
 {
     (void)opName;
     if (!mappedPtr) {
-        return vkutil::VkExpected<VkMappedMemoryRange>(VK_ERROR_MEMORY_MAP_FAILED);
+        return vkutil::VkExpected<GpuAllocator::MappedRange>(VK_ERROR_MEMORY_MAP_FAILED);
     }
 
     if (offset > mappedSize) {
-        return vkutil::VkExpected<VkMappedMemoryRange>(VK_ERROR_INITIALIZATION_FAILED);
+        return vkutil::VkExpected<GpuAllocator::MappedRange>(VK_ERROR_INITIALIZATION_FAILED);
     }
 
     const VkDeviceSize normalizedSize = (requestedSize == VK_WHOLE_SIZE)
@@ -340,26 +319,11 @@ vkutil::VkExpected<VkMappedMemoryRange> VulkanBuffer::prepareMappedRange(VkDevic
         : requestedSize;
 
     if (normalizedSize > (mappedSize - offset)) {
-        return vkutil::VkExpected<VkMappedMemoryRange>(VK_ERROR_INITIALIZATION_FAILED);
-    }
-
-    const VkDeviceSize atom = std::max<VkDeviceSize>(1, nonCoherentAtomSize);
-
-    const VkDeviceSize absoluteOffset = allocation.offset + mappedOffset + offset;
-    const VkDeviceSize alignedOffset = absoluteOffset - (absoluteOffset % atom);
-    const VkDeviceSize absoluteEnd = absoluteOffset + normalizedSize;
-
-    VkDeviceSize alignedSize = VK_WHOLE_SIZE;
-    if (absoluteEnd < (allocation.offset + size)) {
-        const VkDeviceSize roundedEnd = ((absoluteEnd + atom - 1) / atom) * atom;
-        alignedSize = roundedEnd - alignedOffset;
+        return vkutil::VkExpected<GpuAllocator::MappedRange>(VK_ERROR_INITIALIZATION_FAILED);
     }
 
-    VkMappedMemoryRange range{ VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE };
-    range.memory = allocation.memory;
-    range.offset = alignedOffset;
-    range.size = alignedSize;
-    return vkutil::VkExpected<VkMappedMemoryRange>(range);
+    // Atom alignment is the allocator's job, since it knows the memory object's bounds.
+    return vkutil::VkExpected<GpuAllocator::MappedRange>(GpuAllocator::MappedRange{ &allocation, mappedOffset + offset, normalizedSize });
 }
 
 bool VulkanBuffer::usageSupportsDeviceAddress(VkBufferUsageFlags usage) noexcept
@@ -367,6 +331,16 @@ bool VulkanBuffer::usageSupportsDeviceAddress(VkBufferUsageFlags usage) noexcept
     return (usage & VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT) != 0;
 }
 
+GpuAllocator::Pool VulkanBuffer::poolForPolicy(AllocationPolicy policy) noexcept
+{
+    switch (policy) {
+    case AllocationPolicy::Upload: return GpuAllocator::Pool::Upload;
+    case AllocationPolicy::Readback: return GpuAllocator::Pool::Readback;
+    case AllocationPolicy::Transient: return GpuAllocator::Pool::Transient;
+    default: return GpuAllocator::Pool::General;
+    }
+}
+
 void VulkanBuffer::validateDeviceAddressRequirements(VkBufferUsageFlags usage) const
 {
     const bool usageRequestsAddress = usageSupportsDeviceAddress(usage);
@@ -169,6 +169,7 @@ DeviceFeaturePolicy DeviceFeaturePolicy::engineDefault()
     policy.synchronization2 = DeviceFeaturePolicy::Requirement::Optional;
     policy.descriptorIndexing = DeviceFeaturePolicy::Requirement::Optional;
     policy.bufferDeviceAddress = DeviceFeaturePolicy::Requirement::Optional;
+    policy.multiDrawIndirect = DeviceFeaturePolicy::Requirement::Optional;
     policy.requiredExtensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
     return policy;
 }
@@ -553,12 +554,14 @@ void VulkanPhysicalDevice::queryOptionalSupport(VkPhysicalDevice candidate) {
         (caps.descriptorIndexingFeatures.runtimeDescriptorArray == VK_TRUE) &&
         (caps.descriptorIndexingFeatures.shaderSampledImageArrayNonUniformIndexing == VK_TRUE);
     caps.bufferDeviceAddressSupported = (caps.bufferDeviceAddressFeatures.bufferDeviceAddress == VK_TRUE);
+    caps.multiDrawIndirectSupported = (caps.coreFeatures.multiDrawIndirect == VK_TRUE);
 
     caps.timelineSemaphoreEnabled = evaluatePolicyRequirement(featurePolicy.timelineSemaphore, caps.timelineSemaphoreSupported);
     caps.dynamicRenderingEnabled = evaluatePolicyRequirement(featurePolicy.dynamicRendering, caps.dynamicRenderingSupported);
     caps.synchronization2Enabled = evaluatePolicyRequirement(featurePolicy.synchronization2, caps.synchronization2Supported);
     caps.descriptorIndexingEnabled = evaluatePolicyRequirement(featurePolicy.descriptorIndexing, caps.descriptorIndexingSupported);
     caps.bufferDeviceAddressEnabled = evaluatePolicyRequirement(featurePolicy.bufferDeviceAddress, caps.bufferDeviceAddressSupported);
+    caps.multiDrawIndirectEnabled = evaluatePolicyRequirement(featurePolicy.multiDrawIndirect, caps.multiDrawIndirectSupported);
 
     caps.timelineFeatures.timelineSemaphore = caps.timelineSemaphoreEnabled ? VK_TRUE : VK_FALSE;
     caps.dynamicRenderingFeatures.dynamicRendering = caps.dynamicRenderingEnabled ? VK_TRUE : VK_FALSE;
@@ -566,6 +569,7 @@ void VulkanPhysicalDevice::queryOptionalSupport(VkPhysicalDevice candidate) {
     caps.descriptorIndexingFeatures.runtimeDescriptorArray = caps.descriptorIndexingEnabled ? VK_TRUE : VK_FALSE;
     caps.descriptorIndexingFeatures.shaderSampledImageArrayNonUniformIndexing = caps.descriptorIndexingEnabled ? VK_TRUE : VK_FALSE;
     caps.bufferDeviceAddressFeatures.bufferDeviceAddress = caps.bufferDeviceAddressEnabled ? VK_TRUE : VK_FALSE;
+    caps.enabledFeatures2.features.multiDrawIndirect = caps.multiDrawIndirectEnabled ? VK_TRUE : VK_FALSE;
 
     std::unordered_set<std::string> chosen;
     const auto pushExtensionUnique = [&](const char* extensionName, bool required) {
@@ -703,6 +707,7 @@ bool VulkanPhysicalDevice::isSuitable(VkPhysicalDevice candidate) const {
         && descriptorIndexing.shaderSampledImageArrayNonUniformIndexing == VK_TRUE;
     if (featurePolicy.descriptorIndexing == DeviceFeaturePolicy::Requirement::Required && !descriptorIndexingSupported) return false;
     if (featurePolicy.bufferDeviceAddress == DeviceFeaturePolicy::Requirement::Required && bda.bufferDeviceAddress != VK_TRUE) return false;
+    if (featurePolicy.multiDrawIndirect == DeviceFeaturePolicy::Requirement::Required && f2.features.multiDrawIndirect != VK_TRUE) return false;
 
     return true;
 }
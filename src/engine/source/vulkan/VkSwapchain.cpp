@@ -9,28 +9,14 @@
 
 // ===================== VulkanImage =====================
 
-vkutil::VkExpected<VulkanImage> VulkanImage::createResult(VkDevice device,
-    VkPhysicalDevice physicalDevice,
-    const VkImageCreateInfo& createInfo,
-    VkMemoryPropertyFlags memoryProps,
-    GpuAllocator::LifetimeClass lifetimeClass)
-{
-    try {
-        return VulkanImage(device, physicalDevice, createInfo, memoryProps, lifetimeClass);
-    } catch (const vkutil::VkException& ex) {
-        return vkutil::VkExpected<VulkanImage>(ex.result());
-    } catch (...) {
-        return vkutil::VkExpected<VulkanImage>(vkutil::exceptionToVkResult());
-    }
-}
-
 vkutil::VkExpected<VulkanImage> VulkanImage::createResult(GpuAllocator& allocator,
     const VkImageCreateInfo& createInfo,
     VkMemoryPropertyFlags memoryProps,
-    GpuAllocator::LifetimeClass lifetimeClass)
+    GpuAllocator::LifetimeClass lifetimeClass,
+    GpuAllocator::Priority priority)
 {
     try {
-        return VulkanImage(allocator, createInfo, memoryProps, lifetimeClass);
+        return VulkanImage(allocator, createInfo, memoryProps, lifetimeClass, priority);
     } catch (const vkutil::VkException& ex) {
         return vkutil::VkExpected<VulkanImage>(ex.result());
     } catch (...) {
@@ -38,59 +24,30 @@ vkutil::VkExpected<VulkanImage> VulkanImage::createResult(GpuAllocator& allocato
     }
 }
 
-VulkanImage::VulkanImage(VkDevice device_,
-    VkPhysicalDevice pd,
-    const VkImageCreateInfo& ci,
-    VkMemoryPropertyFlags props,
-    GpuAllocator::LifetimeClass lifetimeClass)
-    : device(device_)
-    , physicalDevice(pd)
-    , image(VK_NULL_HANDLE)
-    , memory(VK_NULL_HANDLE)
-    , desiredProps(props)
-    , lifetimeClass_(lifetimeClass)
-    , ownedAllocator(std::make_unique<GpuAllocator>(device_, pd))
-    , allocator(ownedAllocator.get())
-{
-    if (device == VK_NULL_HANDLE) {
-        throw std::runtime_error("VulkanImage: device is VK_NULL_HANDLE");
-    }
-    if (physicalDevice == VK_NULL_HANDLE) {
-        throw std::runtime_error("VulkanImage: physicalDevice is VK_NULL_HANDLE");
-    }
-
-    const VkResult createRes = vkCreateImage(device, &ci, nullptr, &image);
-    if (createRes != VK_SUCCESS) {
-        vkutil::throwVkError("vkCreateImage", createRes);
-    }
-
-    try {
-        allocateAndBind();
-    }
-    catch (...) {
-        if (image != VK_NULL_HANDLE) {
-            vkDestroyImage(device, image, nullptr);
-            image = VK_NULL_HANDLE;
-        }
-        throw;
-    }
-}
-
 VulkanImage::VulkanImage(GpuAllocator& allocator_,
     const VkImageCreateInfo& ci,
     VkMemoryPropertyFlags props,
-    GpuAllocator::LifetimeClass lifetimeClass)
+    GpuAllocator::LifetimeClass lifetimeClass,
+    GpuAllocator::Priority priority)
     : device(allocator_.device())
     , physicalDevice(allocator_.physicalDevice())
     , image(VK_NULL_HANDLE)
     , memory(VK_NULL_HANDLE)
     , desiredProps(props)
     , lifetimeClass_(lifetimeClass)
+    , priority_(priority)
+    , tiling_(ci.tiling)
+    , createInfo_(ci)
     , allocator(&allocator_)
 {
     if (!allocator || !allocator->valid()) {
         throw std::runtime_error("VulkanImage: allocator is invalid");
     }
+    createInfo_.pNext = nullptr;
+    if (ci.sharingMode == VK_SHARING_MODE_CONCURRENT && ci.pQueueFamilyIndices != nullptr) {
+        queueFamilyIndices_.assign(ci.pQueueFamilyIndices, ci.pQueueFamilyIndices + ci.queueFamilyIndexCount);
+    }
+    createInfo_.pQueueFamilyIndices = queueFamilyIndices_.empty() ? nullptr : queueFamilyIndices_.data();
 
     const VkResult createRes = vkCreateImage(device, &ci, nullptr, &image);
     if (createRes != VK_SUCCESS) {
@@ -116,7 +73,10 @@ VulkanImage::VulkanImage(VulkanImage&& other) noexcept
     , memory(std::exchange(other.memory, VK_NULL_HANDLE))
     , desiredProps(std::exchange(other.desiredProps, VkMemoryPropertyFlags{}))
     , lifetimeClass_(std::exchange(other.lifetimeClass_, GpuAllocator::LifetimeClass::Persistent))
-    , ownedAllocator(std::move(other.ownedAllocator))
+    , priority_(std::exchange(other.priority_, GpuAllocator::Priority::Normal))
+    , tiling_(std::exchange(other.tiling_, VK_IMAGE_TILING_OPTIMAL))
+    , createInfo_(std::exchange(other.createInfo_, VkImageCreateInfo{ VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO }))
+    , queueFamilyIndices_(std::move(other.queueFamilyIndices_))
     , allocator(std::exchange(other.allocator, nullptr))
     , allocation(std::exchange(other.allocation, GpuAllocator::Allocation{}))
 {
@@ -128,9 +88,8 @@ VulkanImage& VulkanImage::operator=(VulkanImage&& other) noexcept
         if (image != VK_NULL_HANDLE) {
             vkDestroyImage(device, image, nullptr);
         }
-        if (memory != VK_NULL_HANDLE) {
-            if (allocator) { allocator->free(allocation); }
-            else { vkFreeMemory(device, memory, nullptr); }
+        if (memory != VK_NULL_HANDLE && allocator) {
+            allocator->free(allocation);
         }
 
         device = other.device;
@@ -139,7 +98,10 @@ VulkanImage& VulkanImage::operator=(VulkanImage&& other) noexcept
         memory = other.memory;
         desiredProps = other.desiredProps;
         lifetimeClass_ = other.lifetimeClass_;
-        ownedAllocator = std::move(other.ownedAllocator);
+        priority_ = other.priority_;
+        tiling_ = other.tiling_;
+        createInfo_ = other.createInfo_;
+        queueFamilyIndices_ = std::move(other.queueFamilyIndices_);
         allocator = other.allocator;
         allocation = other.allocation;
 
@@ -149,6 +111,10 @@ VulkanImage& VulkanImage::operator=(VulkanImage&& other) noexcept
         other.memory = VK_NULL_HANDLE;
         other.desiredProps = 0;
         other.lifetimeClass_ = GpuAllocator::LifetimeClass::Persistent;
+        other.priority_ = GpuAllocator::Priority::Normal;
+        other.tiling_ = VK_IMAGE_TILING_OPTIMAL;
+        other.createInfo_ = VkImageCreateInfo{ VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO };
+        other.queueFamilyIndices_.clear();
         other.allocator = nullptr;
         other.allocation = {};
     }
@@ -161,15 +127,21 @@ VulkanImage::~VulkanImage() noexcept
         vkDestroyImage(device, image, nullptr);
         image = VK_NULL_HANDLE;
     }
-    if (memory != VK_NULL_HANDLE) {
-        if (allocator) {
-            allocator->free(allocation);
-        } else {
-            vkFreeMemory(device, memory, nullptr);
-        }
-        memory = VK_NULL_HANDLE;
-        allocation = {};
+    if (memory != VK_NULL_HANDLE && allocator) {
+        allocator->free(allocation);
+    }
+    memory = VK_NULL_HANDLE;
+    allocation = {};
+}
+
+VulkanImage VulkanImage::makeRelocationTarget(VkImageUsageFlags usageExtra) const
+{
+    if (!valid()) {
+        throw std::runtime_error("VulkanImage: cannot relocate an empty image");
     }
+    VkImageCreateInfo ci = createInfo_;
+    ci.usage |= usageExtra;
+    return VulkanImage(*allocator, ci, desiredProps, lifetimeClass_, priority_);
 }
 
 void VulkanImage::allocateAndBind()
@@ -189,7 +161,10 @@ void VulkanImage::allocateAndBind()
         desiredProps,
         false);
 
-    allocation = allocator->allocateForImage(req2.memoryRequirements, desiredProps, image, forceDedicated, lifetimeClass_);
+    const GpuAllocator::Pool pool = lifetimeClass_ == GpuAllocator::LifetimeClass::Transient
+        ? GpuAllocator::Pool::Transient
+        : GpuAllocator::Pool::General;
+    allocation = allocator->allocateForImage(req2.memoryRequirements, desiredProps, image, forceDedicated, lifetimeClass_, pool, priority_, tiling_);
     memory = allocation.memory;
 
     const VkResult bindRes = vkBindImageMemory(device, image, memory, allocation.offset);
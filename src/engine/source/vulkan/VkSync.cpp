@@ -556,6 +556,9 @@ vkutil::VkExpected<SyncTicket> SyncContext::submit(const VulkanQueue& queue,
     if (!submitInfo.externalWaitDependencies.empty() && submitInfo.externalWaitSemaphores.size() != submitInfo.externalWaitDependencies.size()) {
         return vkutil::VkExpected<SyncTicket>(vkutil::makeError("SyncContext::submit", VK_ERROR_INITIALIZATION_FAILED, "sync", "external_wait_dependency_count_mismatch").context());
     }
+    if (!submitInfo.externalSignalValues.empty() && submitInfo.externalSignalSemaphores.size() != submitInfo.externalSignalValues.size()) {
+        return vkutil::VkExpected<SyncTicket>(vkutil::makeError("SyncContext::submit", VK_ERROR_INITIALIZATION_FAILED, "sync", "external_signal_value_count_mismatch").context());
+    }
     if (!timelineMode && !submitInfo.waitTickets.empty()) {
         return vkutil::VkExpected<SyncTicket>(vkutil::makeError("SyncContext::submit", VK_ERROR_VALIDATION_FAILED_EXT, "sync", "fallback_mode_disallows_wait_tickets").context());
     }
@@ -626,10 +629,12 @@ vkutil::VkExpected<SyncTicket> SyncContext::submit(const VulkanQueue& queue,
         return vkutil::VkExpected<SyncTicket>(externalSignalStageRes.context());
     }
 
-    for (VkSemaphore sem : submitInfo.externalSignalSemaphores) {
+    bool signalsExternalTimeline = false;
+    for (size_t i = 0; i < submitInfo.externalSignalSemaphores.size(); ++i) {
         VkSemaphoreSubmitInfo ssi{ VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO };
-        ssi.semaphore = sem;
-        ssi.value = 0;
+        ssi.semaphore = submitInfo.externalSignalSemaphores[i];
+        ssi.value = submitInfo.externalSignalValues.empty() ? 0 : submitInfo.externalSignalValues[i];
+        signalsExternalTimeline = signalsExternalTimeline || ssi.value != 0;
         ssi.stageMask = externalSignalStageRes.value();
         signalInfos.push_back(ssi);
     }
@@ -714,7 +719,8 @@ vkutil::VkExpected<SyncTicket> SyncContext::submit(const VulkanQueue& queue,
         }
 
         VkTimelineSemaphoreSubmitInfo timelineInfo{ VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO };
-        if (timelineMode) {
+        const bool chainTimelineInfo = timelineMode || signalsExternalTimeline;
+        if (chainTimelineInfo) {
             timelineInfo.waitSemaphoreValueCount = static_cast<uint32_t>(waitValues.size());
             timelineInfo.pWaitSemaphoreValues = waitValues.empty() ? nullptr : waitValues.data();
             timelineInfo.signalSemaphoreValueCount = static_cast<uint32_t>(signalValues.size());
@@ -722,7 +728,7 @@ vkutil::VkExpected<SyncTicket> SyncContext::submit(const VulkanQueue& queue,
         }
 
         VkSubmitInfo submit{ VK_STRUCTURE_TYPE_SUBMIT_INFO };
-        submit.pNext = timelineMode ? &timelineInfo : nullptr;
+        submit.pNext = chainTimelineInfo ? &timelineInfo : nullptr;
         submit.waitSemaphoreCount = static_cast<uint32_t>(waitSemaphores.size());
         submit.pWaitSemaphores = waitSemaphores.empty() ? nullptr : waitSemaphores.data();
         submit.pWaitDstStageMask = waitStages.empty() ? nullptr : waitStages.data();